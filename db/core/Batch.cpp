@@ -0,0 +1,52 @@
+#include "Batch.hpp"
+
+#include <EssaUtil/Config.hpp>
+
+namespace Db::Core {
+
+ValueVector ValueVector::constant(Value value) {
+    return ValueVector { Kind::Constant, std::move(value), nullptr };
+}
+
+ValueVector ValueVector::ints(std::vector<int> values, std::vector<uint8_t> nulls) {
+    assert(values.size() == nulls.size());
+    return ValueVector { Kind::Int, {}, std::make_shared<Data const>(Data { .ints = std::move(values), .floats = {}, .nulls = std::move(nulls), .values = {} }) };
+}
+
+ValueVector ValueVector::floats(std::vector<float> values, std::vector<uint8_t> nulls) {
+    assert(values.size() == nulls.size());
+    return ValueVector { Kind::Float, {}, std::make_shared<Data const>(Data { .ints = {}, .floats = std::move(values), .nulls = std::move(nulls), .values = {} }) };
+}
+
+ValueVector ValueVector::generic(std::vector<Value> values) {
+    return ValueVector { Kind::Generic, {}, std::make_shared<Data const>(Data { .ints = {}, .floats = {}, .nulls = {}, .values = std::move(values) }) };
+}
+
+Value ValueVector::value(size_t row) const {
+    switch (m_kind) {
+    case Kind::Constant:
+        return m_constant;
+    case Kind::Int:
+        return m_data->nulls[row] ? Value::null() : Value::create_int(m_data->ints[row]);
+    case Kind::Float:
+        return m_data->nulls[row] ? Value::null() : Value::create_float(m_data->floats[row]);
+    case Kind::Generic:
+        return m_data->values[row];
+    }
+    ESSA_UNREACHABLE;
+}
+
+bool ValueVector::is_null(size_t row) const {
+    switch (m_kind) {
+    case Kind::Constant:
+        return m_constant.is_null();
+    case Kind::Int:
+    case Kind::Float:
+        return m_data->nulls[row];
+    case Kind::Generic:
+        return m_data->values[row].is_null();
+    }
+    ESSA_UNREACHABLE;
+}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Tuple.hpp"
+#include "Value.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Db::Core {
+
+// Maximum number of rows processed at once by batch execution.
+constexpr size_t BatchSize = 1024;
+
+// Ascending positions of rows of a batch that are processed.
+using SelectionVector = std::vector<uint32_t>;
+
+// Values of a single column or expression for every row of a batch. INT and
+// FLOAT vectors are stored as plain arrays, with a separate NULL mask, so
+// that they can be processed in tight loops. Other types are stored as
+// Values. Constant vectors store their value only once. Copying is cheap,
+// since the storage is shared.
+class ValueVector {
+public:
+    enum class Kind {
+        Constant,
+        Int,
+        Float,
+        Generic
+    };
+
+    static ValueVector constant(Value);
+    // `nulls` is nonzero for rows that are NULL. Values of these rows
+    // are unspecified.
+    static ValueVector ints(std::vector<int> values, std::vector<uint8_t> nulls);
+    static ValueVector floats(std::vector<float> values, std::vector<uint8_t> nulls);
+    static ValueVector generic(std::vector<Value>);
+
+    Kind kind() const { return m_kind; }
+
+    Value value(size_t row) const;
+    bool is_null(size_t row) const;
+
+    // Only the ones matching the kind may be called.
+    Value const& constant_value() const { return m_constant; }
+    std::span<int const> ints() const { return m_data->ints; }
+    std::span<float const> floats() const { return m_data->floats; }
+    std::span<uint8_t const> nulls() const { return m_data->nulls; }
+
+private:
+    struct Data {
+        std::vector<int> ints;
+        std::vector<float> floats;
+        std::vector<uint8_t> nulls;
+        std::vector<Value> values;
+    };
+
+    ValueVector(Kind kind, Value constant, std::shared_ptr<Data const> data)
+        : m_kind(kind)
+        , m_constant(std::move(constant))
+        , m_data(std::move(data)) { }
+
+    Kind m_kind;
+    Value m_constant;
+    std::shared_ptr<Data const> m_data;
+};
+
+// Up to BatchSize consecutive rows of a relation, read column by column.
+class RowBatch {
+public:
+    virtual ~RowBatch() = default;
+
+    // Number of row positions in the batch.
+    virtual size_t size() const = 0;
+
+    // Positions that hold rows (e.g. that weren't removed).
+    virtual SelectionVector rows() const = 0;
+
+    virtual ValueVector column(size_t index) const = 0;
+    virtual Tuple read_row(size_t row) const = 0;
+};
+
+class BatchReader {
+public:
+    virtual ~BatchReader() = default;
+
+    // Returns nullptr if there are no more rows.
+    virtual std::unique_ptr<RowBatch> next() = 0;
+};
+
+}
@@ -4,11 +4,36 @@
 #include <EssaUtil/Config.hpp>
 #include <db/core/Table.hpp>
 #include <db/storage/CSVFile.hpp>
+#include <db/storage/ColumnarTable.hpp>
 #include <db/storage/FileBackedTable.hpp>
+#include <db/storage/edb/WriteAheadLog.hpp>
 #include <filesystem>
 
 namespace Db::Core {
 
+namespace {
+
+DbError os_to_db_error(std::string_view action, Util::OsError&& error) {
+    return DbError { fmt::format("{} failed: {}", action, error) };
+}
+
+// Destroy a table that was dropped, together with its file.
+void destroy_table(std::unique_ptr<Table> table) {
+    auto file_backed_table = dynamic_cast<Storage::FileBackedTable*>(table.get());
+    auto path = file_backed_table ? std::optional { file_backed_table->edb_file_path() } : std::nullopt;
+    table.reset();
+    if (path) {
+        std::error_code error;
+        std::filesystem::remove(*path, error);
+        if (error) {
+            Util::OsErrorOr<void> result = Util::OsError { .error = error.value(), .function = "Database remove dropped table file" };
+            result.dump("Internal error: Failed to remove file of dropped table");
+        }
+    }
+}
+
+}
+
 Util::OsErrorOr<Database> Database::create_or_open_file_backed(std::string const& path) {
     Database db;
     db.m_path = path;
@@ -22,10 +47,14 @@ Util::OsErrorOr<Database> Database::create_or_open_file_backed(std::string const
         }
     }
 
+    // Recover committed changes before tables are read.
+    db.m_log = TRY(Storage::EDB::WriteAheadLog::open(path));
+
     // Open all existing tables as edb files
     for (auto const& entry : std::filesystem::directory_iterator { path }) {
         if (entry.path().extension() == ".edb") {
-            auto table = TRY(Storage::FileBackedTable::open(path, entry.path().stem()));
+            auto table = TRY(Storage::FileBackedTable::open(path, entry.path().stem(), *db.m_log));
+            table->set_undo_log(db.m_undo_log.get());
             db.m_tables.insert({ table->name(), std::move(table) });
         }
     }
@@ -36,6 +65,31 @@ Database Database::create_memory_backed() {
     return Database {};
 }
 
+Database::Database() = default;
+Database::Database(Database&&) = default;
+Database& Database::operator=(Database&&) = default;
+
+Database::~Database() {
+    if (in_transaction()) {
+        auto result = rollback_transaction();
+        if (result.is_error()) {
+            result.dump("Internal error: Failed to roll back transaction on destruction");
+        }
+    }
+}
+
+Table* Database::insert_table(std::string const& name, std::unique_ptr<Table> table) {
+    table->set_undo_log(m_undo_log.get());
+    auto& inserted = *m_tables.insert({ name, std::move(table) }).first->second;
+    m_undo_log->record([this, name]() -> DbErrorOr<void> {
+        auto it = m_tables.find(name);
+        destroy_table(std::move(it->second));
+        m_tables.erase(it);
+        return {};
+    });
+    return &inserted;
+}
+
 Core::DbErrorOr<Table*> Database::create_table(TableSetup table_setup, std::shared_ptr<Sql::AST::Check> check, DatabaseEngine engine) {
     if (m_tables.contains(table_setup.name)) {
         return Core::DbError { fmt::format("Table '{}' already exists", table_setup.name) };
@@ -43,8 +97,7 @@ Core::DbErrorOr<Table*> Database::create_table(TableSetup table_setup, std::shar
 
     switch (engine) {
     case DatabaseEngine::Memory: {
-        auto& table = *m_tables.insert({ table_setup.name, std::make_unique<MemoryBackedTable>(std::move(check), table_setup) }).first->second;
-        return &table;
+        return insert_table(table_setup.name, std::make_unique<MemoryBackedTable>(std::move(check), table_setup));
     }
     case DatabaseEngine::EDB: {
         if (!m_path) {
@@ -53,27 +106,74 @@ Core::DbErrorOr<Table*> Database::create_table(TableSetup table_setup, std::shar
         if (!std::filesystem::is_directory(*m_path)) {
             std::filesystem::create_directory(*m_path);
         }
-        auto result = Storage::FileBackedTable::initialize(*m_path, table_setup);
+        // The log may still refer to a dropped table with the same name.
+        auto result = [&]() -> Util::OsErrorOr<std::unique_ptr<Storage::FileBackedTable>> {
+            TRY(m_log->checkpoint());
+            return TRY(Storage::FileBackedTable::initialize(*m_path, table_setup, *m_log));
+        }();
         if (result.is_error()) {
             return Core::DbError { fmt::format("Creating table failed: {}", result.release_error()) };
         }
-        return &*m_tables.insert({ table_setup.name, result.release_value() }).first->second;
+        return insert_table(table_setup.name, result.release_value());
     } break;
+    case DatabaseEngine::Columnar: {
+        if (check && (check->main_rule() || !check->constraints().empty())) {
+            return Core::DbError { "Checks are not supported by the columnar engine" };
+        }
+        return insert_table(table_setup.name, std::make_unique<Storage::ColumnarTable>(table_setup));
+    }
     }
     ESSA_UNREACHABLE;
 }
 
 void Database::add_table(std::unique_ptr<Table> table) {
-    m_tables.insert({ table->name(), std::move(table) });
+    auto name = table->name();
+    insert_table(name, std::move(table));
 }
 
 DbErrorOr<void> Database::drop_table(std::string name) {
     TRY(table(name));
-    m_tables.erase(name);
+    auto it = m_tables.find(name);
+    if (!in_transaction()) {
+        destroy_table(std::move(it->second));
+        m_tables.erase(it);
+        return {};
+    }
+
+    // The table is kept until the transaction ends. Its file is moved out
+    // of the way, so that a table with the same name can be created.
+    auto table = it->second.get();
+    auto file_backed_table = dynamic_cast<Storage::FileBackedTable*>(table);
+    auto file_name = file_backed_table ? file_backed_table->edb_file_name() : "";
+    if (file_backed_table) {
+        TRY(file_backed_table->move_file(fmt::format("{}.dropped{}", file_name, m_dropped_tables.size())));
+    }
+    m_dropped_tables.push_back(std::move(it->second));
+    m_tables.erase(it);
+    m_undo_log->record([this, name, table, file_name]() -> DbErrorOr<void> {
+        auto it = std::find_if(m_dropped_tables.begin(), m_dropped_tables.end(), [&](auto const& dropped) { return dropped.get() == table; });
+        m_tables.insert({ name, std::move(*it) });
+        m_dropped_tables.erase(it);
+        if (auto file_backed_table = dynamic_cast<Storage::FileBackedTable*>(table)) {
+            TRY(file_backed_table->move_file(file_name));
+        }
+        return {};
+    });
     return {};
 }
 
 DbErrorOr<void> Database::restructure_table(std::string const& old_name, TableSetup const& table_setup) {
+    // Don't leave the backup table if copying rows fails.
+    if (!in_transaction()) {
+        TRY(begin_transaction());
+        auto result = restructure_table(old_name, table_setup);
+        if (result.is_error()) {
+            TRY(rollback_transaction());
+            return result.release_error();
+        }
+        return commit_transaction();
+    }
+
     if (old_name != table_setup.name && m_tables.contains(table_setup.name)) {
         return Core::DbError { fmt::format("Table '{}' already exists", table_setup.name) };
     }
@@ -86,6 +186,12 @@ DbErrorOr<void> Database::restructure_table(std::string const& old_name, TableSe
     auto it = m_tables.find(old_name);
     auto backup_table = m_tables.insert({ backup_name, std::move(it->second) }).first->second.get();
     m_tables.erase(it);
+    m_undo_log->record([this, old_name, backup_name]() -> DbErrorOr<void> {
+        auto it = m_tables.find(backup_name);
+        auto table = m_tables.insert({ old_name, std::move(it->second) }).first->second.get();
+        m_tables.erase(it);
+        return table->rename(old_name);
+    });
     TRY(backup_table->rename(backup_name));
 
     // 2. Create a new table
@@ -114,14 +220,14 @@ DbErrorOr<void> Database::restructure_table(std::string const& old_name, TableSe
     }));
 
     // 4. Drop "backup" table.
-    // FIXME: Actually drop data that this table contains (for EDB)
-    m_tables.erase(backup_name);
-
-    return {};
+    return drop_table(backup_name);
 }
 
 DbErrorOr<Table*> Database::create_table_from_query(ResultSet select, std::string name) {
-    return m_tables.insert({ name, TRY(MemoryBackedTable::create_from_select_result(select)) }).first->second.get();
+    if (auto it = m_tables.find(name); it != m_tables.end()) {
+        return it->second.get();
+    }
+    return insert_table(name, TRY(MemoryBackedTable::create_from_select_result(select)));
 }
 
 DbErrorOr<Table*> Database::table(std::string name) {
@@ -149,6 +255,108 @@ DbErrorOr<Table*> Database::import_to_table(std::string const& path, std::string
     ESSA_UNREACHABLE;
 }
 
+DbErrorOr<void> Database::commit() {
+    if (!m_log) {
+        return {};
+    }
+    return m_log->commit().map_error([](Util::OsError&& error) {
+        return os_to_db_error("Commit", std::move(error));
+    });
+}
+
+void Database::set_asynchronous_commit(bool asynchronous) {
+    if (m_log) {
+        m_log->set_asynchronous_commit(asynchronous);
+    }
+}
+
+DbErrorOr<void> Database::sync() {
+    if (!m_log) {
+        return {};
+    }
+    return m_log->sync().map_error([](Util::OsError&& error) {
+        return os_to_db_error("Sync", std::move(error));
+    });
+}
+
+void Database::materialize_open_streams() {
+    // Materialized streams don't refer to tables anymore.
+    auto streams = std::move(m_open_streams);
+    m_open_streams.clear();
+    for (auto* stream : streams) {
+        stream->materialize();
+    }
+}
+
+DbErrorOr<void> Database::begin_transaction() {
+    if (in_transaction()) {
+        return DbError { "Transaction is already running" };
+    }
+    if (m_log) {
+        TRY(m_log->begin_transaction().map_error([](Util::OsError&& error) {
+            return os_to_db_error("Beginning transaction", std::move(error));
+        }));
+    }
+    m_undo_log->begin();
+    return {};
+}
+
+DbErrorOr<void> Database::commit_transaction() {
+    if (!in_transaction()) {
+        return DbError { "No transaction is running" };
+    }
+    if (m_transaction_aborted) {
+        m_transaction_aborted = false;
+        return DbError { "Transaction was rolled back because a statement failed" };
+    }
+    if (m_log) {
+        auto result = m_log->commit_transaction();
+        if (result.is_error()) {
+            // Changes of file-backed tables that weren't logged are lost,
+            // so other tables must not keep them either.
+            TRY(rollback_transaction());
+            return os_to_db_error("Commit", result.release_error());
+        }
+    }
+    m_undo_log->commit();
+    for (auto& table : m_dropped_tables) {
+        destroy_table(std::move(table));
+    }
+    m_dropped_tables.clear();
+    return {};
+}
+
+DbErrorOr<void> Database::rollback_transaction() {
+    if (!in_transaction()) {
+        return DbError { "No transaction is running" };
+    }
+    if (m_transaction_aborted) {
+        m_transaction_aborted = false;
+        return {};
+    }
+    // Files are rolled back first, so that tables that are moved back by
+    // the undo log can be renamed again.
+    auto log_result = m_log ? m_log->rollback_transaction() : Util::OsErrorOr<void> {};
+    auto undo_result = m_undo_log->rollback();
+    if (log_result.is_error()) {
+        return os_to_db_error("Rollback", log_result.release_error());
+    }
+    if (undo_result.is_error()) {
+        return undo_result.release_error();
+    }
+    for (auto const& table : m_tables) {
+        TRY(table.second->reload());
+    }
+    // Commit what was changed by the undo log, e.g. names of tables.
+    return commit();
+}
+
+DbErrorOr<void> Database::abort_transaction() {
+    auto result = rollback_transaction();
+    m_transaction_aborted = true;
+    return result;
+}
+
 void Database::dump_storage_debug() {
     for (auto const& table : m_tables) {
         fmt::print("Table {}:\n", table.first);
@@ -2,22 +2,49 @@
 
 #include <EssaUtil/NonCopyable.hpp>
 #include <db/core/DbError.hpp>
+#include <db/core/ExternalSort.hpp>
 #include <db/core/ImportMode.hpp>
 #include <db/core/Table.hpp>
 #include <db/core/TableSetup.hpp>
+#include <db/core/UndoLog.hpp>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+namespace Db::Storage::EDB {
+class WriteAheadLog;
+}
 
 namespace Db::Core {
 
+// Reader that refers to rows of tables while it's open, e.g a cursor that
+// computes rows of a SELECT while they are read. Writes may free or move
+// these rows, so before anything is changed, every open stream reads its
+// remaining rows into memory (see Database::materialize_open_streams()).
+class OpenStream {
+public:
+    virtual ~OpenStream() = default;
+    virtual void materialize() = 0;
+};
+
 class Database : public Util::NonCopyable {
 public:
     static Util::OsErrorOr<Database> create_or_open_file_backed(std::string const& path);
     static Database create_memory_backed();
 
+    Database(Database&&);
+    Database& operator=(Database&&);
+    ~Database();
+
     void set_default_engine(DatabaseEngine e) { m_default_engine = e; }
     DatabaseEngine default_engine() const { return m_default_engine; }
 
+    // Memory that ORDER BY and DISTINCT of a query may use before they
+    // write rows to temporary files.
+    void set_sort_memory_budget(size_t budget) { m_sort_memory_budget = budget; }
+    size_t sort_memory_budget() const { return m_sort_memory_budget; }
+
     // Create a new table using a specified engine.
     Core::DbErrorOr<Table*> create_table(TableSetup table_setup, std::shared_ptr<Sql::AST::Check> check, DatabaseEngine engine);
 
@@ -52,12 +79,70 @@ public:
 
     void dump_storage_debug();
 
+    // Make changes of file-backed tables durable. They are written to the
+    // log of the database, which is synced before this returns (together
+    // with other commits that wait for it). This does nothing in a
+    // transaction.
+    //
+    // Statements run outside of a transaction are committed one by one,
+    // and a database is used by one thread, so each of them waits for its
+    // own sync of the log. To sync many statements at once, run them in a
+    // transaction or use asynchronous commit.
+    DbErrorOr<void> commit();
+
+    // Let commit() and commit_transaction() return before the log is
+    // synced. The last commits may be lost on system crash then (see
+    // GroupCommitInterval). Off by default.
+    void set_asynchronous_commit(bool);
+
+    // BEGIN / COMMIT / ROLLBACK. Changes made in a transaction are applied
+    // or discarded together: memory-backed tables record how to revert them
+    // in an undo log, and file-backed tables keep them out of the log of the
+    // database until the transaction is committed. AUTO_INCREMENT counters
+    // are not rolled back.
+    DbErrorOr<void> begin_transaction();
+    DbErrorOr<void> commit_transaction();
+    DbErrorOr<void> rollback_transaction();
+    bool in_transaction() const { return m_transaction_aborted || (m_undo_log && m_undo_log->is_active()); }
+
+    // Called when a statement fails in a transaction. The statement may be
+    // applied partially and its changes can't be undone alone, so the whole
+    // transaction is rolled back at once. Like in PostgreSQL, it's still
+    // running until COMMIT (which returns an error) or ROLLBACK, and other
+    // statements fail until then.
+    DbErrorOr<void> abort_transaction();
+    bool is_transaction_aborted() const { return m_transaction_aborted; }
+
+    // Wait until all commits are written to the disk.
+    DbErrorOr<void> sync();
+
+    // Streams must be registered for as long as they are open.
+    void register_stream(OpenStream& stream) { m_open_streams.push_back(&stream); }
+    void unregister_stream(OpenStream& stream) { std::erase(m_open_streams, &stream); }
+
+    // Must be called before changing tables or rows, unless nothing reads
+    // them at the same time. SQL statements do it when they are run.
+    void materialize_open_streams();
+
 private:
-    Database() = default;
+    Database();
+
+    // Insert a new table, so that it's removed if the transaction is
+    // rolled back.
+    Table* insert_table(std::string const& name, std::unique_ptr<Table>);
 
     std::optional<std::string> m_path;
+    // Destroyed after tables, which log their last changes to it.
+    std::unique_ptr<Storage::EDB::WriteAheadLog> m_log;
+    std::unique_ptr<UndoLog> m_undo_log = std::make_unique<UndoLog>();
     std::unordered_map<std::string, std::unique_ptr<Table>> m_tables;
+    // Tables dropped in the running transaction. They are destroyed when
+    // it's committed.
+    std::vector<std::unique_ptr<Table>> m_dropped_tables;
     DatabaseEngine m_default_engine = DatabaseEngine::Memory;
+    size_t m_sort_memory_budget = DefaultSortMemoryBudget;
+    std::vector<OpenStream*> m_open_streams;
+    bool m_transaction_aborted = false;
 };
 
 }
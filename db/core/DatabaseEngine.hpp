@@ -4,7 +4,8 @@ namespace Db::Core {
 
 enum class DatabaseEngine {
     Memory,
-    EDB
+    EDB,
+    Columnar,
 };
 
 }
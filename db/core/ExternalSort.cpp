@@ -0,0 +1,114 @@
+#include "ExternalSort.hpp"
+
+#include <algorithm>
+
+namespace Db::Core {
+
+DbErrorOr<void> ExternalSorter::add(std::string key, Tuple row) {
+    m_memory_used += sizeof(Entry) + key.size() + row.memory_size();
+    m_entries.push_back(Entry { .key = std::move(key), .row = std::move(row) });
+    m_row_count++;
+    if (m_memory_used > m_memory_budget) {
+        TRY(spill());
+    }
+    return {};
+}
+
+void ExternalSorter::sort_entries() {
+    std::stable_sort(m_entries.begin(), m_entries.end(), [](Entry const& lhs, Entry const& rhs) {
+        return lhs.key < rhs.key;
+    });
+}
+
+// Rows of runs are stored with their key as the first value.
+DbErrorOr<void> ExternalSorter::spill() {
+    sort_entries();
+    auto file = TRY(SpillFile::create());
+    for (auto& entry : m_entries) {
+        std::vector<Value> values;
+        values.reserve(entry.row.value_count() + 1);
+        values.push_back(Value::create_varchar(std::move(entry.key)));
+        values.insert(values.end(), entry.row.begin(), entry.row.end());
+        TRY(file.write(Tuple { std::move(values) }));
+    }
+    TRY(file.flush());
+    m_runs.push_back(std::move(file));
+    m_entries.clear();
+    m_memory_used = 0;
+    return {};
+}
+
+DbErrorOr<void> ExternalSorter::finish() {
+    sort_entries();
+    if (m_runs.empty()) {
+        return {};
+    }
+
+    for (auto const& run : m_runs) {
+        m_readers.push_back(run.read());
+    }
+    m_run_heads.resize(m_runs.size() + 1);
+    for (size_t run = 0; run < m_run_heads.size(); run++) {
+        m_run_heads[run] = TRY(read_run(run));
+        if (m_run_heads[run]) {
+            m_heap.push_back(run);
+        }
+    }
+    std::make_heap(m_heap.begin(), m_heap.end(), [this](size_t lhs, size_t rhs) { return heap_less(lhs, rhs); });
+    return {};
+}
+
+DbErrorOr<std::optional<ExternalSorter::Entry>> ExternalSorter::read_run(size_t run) {
+    if (run == m_runs.size()) {
+        if (m_next_entry >= m_entries.size()) {
+            return std::optional<Entry> {};
+        }
+        return std::move(m_entries[m_next_entry++]);
+    }
+    auto tuple = TRY(m_readers[run].next());
+    if (!tuple) {
+        return std::optional<Entry> {};
+    }
+    auto key = std::get<std::string>(tuple->value(0));
+    tuple->remove(0);
+    return Entry { .key = std::move(key), .row = std::move(*tuple) };
+}
+
+// std heap functions keep the greatest element on top, so this is reversed
+// to get the smallest key. Ties are resolved by the run index, as earlier
+// runs contain earlier rows.
+bool ExternalSorter::heap_less(size_t lhs, size_t rhs) const {
+    auto const& lhs_key = m_run_heads[lhs]->key;
+    auto const& rhs_key = m_run_heads[rhs]->key;
+    if (lhs_key != rhs_key) {
+        return lhs_key > rhs_key;
+    }
+    return lhs > rhs;
+}
+
+DbErrorOr<std::optional<Tuple>> ExternalSorter::next() {
+    if (m_runs.empty()) {
+        if (m_next_entry >= m_entries.size()) {
+            return std::optional<Tuple> {};
+        }
+        return std::move(m_entries[m_next_entry++].row);
+    }
+
+    if (m_heap.empty()) {
+        return std::optional<Tuple> {};
+    }
+    auto less = [this](size_t lhs, size_t rhs) { return heap_less(lhs, rhs); };
+    std::pop_heap(m_heap.begin(), m_heap.end(), less);
+    auto run = m_heap.back();
+    auto row = std::move(m_run_heads[run]->row);
+    m_run_heads[run] = TRY(read_run(run));
+    if (m_run_heads[run]) {
+        std::push_heap(m_heap.begin(), m_heap.end(), less);
+    }
+    else {
+        m_heap.pop_back();
+    }
+    return row;
+}
+
+}
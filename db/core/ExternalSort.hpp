@@ -0,0 +1,62 @@
+#pragma once
+
+#include "DbError.hpp"
+#include "SpillFile.hpp"
+#include "Tuple.hpp"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Db::Core {
+
+// Memory that rows of a sort may use before they are written to disk.
+constexpr size_t DefaultSortMemoryBudget = 64 * 1024 * 1024;
+
+// Sorts rows by keys that compare bytewise (see SortKeyEncoder). Rows are
+// sorted in memory until they exceed `memory_budget`; then each sorted run
+// is written to a spill file, and runs are merged while rows are read.
+// Rows with equal keys are returned in the order in which they were added.
+class ExternalSorter {
+public:
+    explicit ExternalSorter(size_t memory_budget = DefaultSortMemoryBudget)
+        : m_memory_budget(memory_budget) { }
+
+    DbErrorOr<void> add(std::string key, Tuple row);
+
+    // Must be called after adding all rows and before reading them.
+    DbErrorOr<void> finish();
+
+    // Returns nullopt after the last row.
+    DbErrorOr<std::optional<Tuple>> next();
+
+    size_t row_count() const { return m_row_count; }
+    size_t spilled_run_count() const { return m_runs.size(); }
+
+private:
+    struct Entry {
+        std::string key;
+        Tuple row;
+    };
+
+    DbErrorOr<void> spill();
+    void sort_entries();
+    // Next entry of a spilled run, or of the in-memory one (the last run).
+    DbErrorOr<std::optional<Entry>> read_run(size_t run);
+    bool heap_less(size_t lhs, size_t rhs) const;
+
+    size_t m_memory_budget;
+    size_t m_memory_used = 0;
+    size_t m_row_count = 0;
+
+    std::vector<Entry> m_entries;
+    size_t m_next_entry = 0;
+
+    std::vector<SpillFile> m_runs;
+    std::vector<SpillFile::Reader> m_readers;
+    // Current entry of every run, and a min-heap of the runs that have one.
+    std::vector<std::optional<Entry>> m_run_heads;
+    std::vector<size_t> m_heap;
+};
+
+}
@@ -0,0 +1,317 @@
+#include "Join.hpp"
+
+#include "Index.hpp"
+#include "JoinImplementation.hpp"
+#include "SpillFile.hpp"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <limits>
+#include <unordered_map>
+
+namespace Db::Core {
+
+namespace {
+
+constexpr size_t MaxSpillPartitions = 256;
+
+// Bytes used by a row of a hash table, roughly.
+size_t estimate_row_size(Tuple const& tuple) {
+    // Chain link and a hash table node, if the key is new.
+    constexpr size_t HashTableOverhead = sizeof(uint32_t) + 64;
+
+    return tuple.memory_size() + HashTableOverhead;
+}
+
+// Rows with equal keys are chained through `next`, in the order in which
+// they were added.
+class HashTable {
+public:
+    static constexpr uint32_t End = std::numeric_limits<uint32_t>::max();
+
+    HashTable(std::vector<Tuple> rows, size_t key_column)
+        : m_rows(std::move(rows))
+        , m_next(m_rows.size(), End) {
+        m_heads.reserve(m_rows.size());
+        for (size_t s = m_rows.size(); s-- > 0;) {
+            auto key = join_key(m_rows[s].value(key_column));
+            if (!key) {
+                continue;
+            }
+            auto [it, inserted] = m_heads.try_emplace(std::move(*key), s);
+            if (!inserted) {
+                m_next[s] = it->second;
+                it->second = s;
+            }
+        }
+    }
+
+    std::vector<Tuple> const& rows() const { return m_rows; }
+
+    uint32_t find(Value const& key) const {
+        auto it = m_heads.find(key);
+        return it == m_heads.end() ? End : it->second;
+    }
+
+    uint32_t next(uint32_t row) const { return m_next[row]; }
+
+private:
+    std::vector<Tuple> m_rows;
+    std::vector<uint32_t> m_next;
+    std::unordered_map<Value, uint32_t, IndexValueHash, IndexValueEqual> m_heads;
+};
+
+class HashJoinRelation : public JoinRelation {
+public:
+    HashJoinRelation(JoinSide lhs, JoinSide rhs, JoinType type, bool build_lhs)
+        : JoinRelation(std::move(lhs), std::move(rhs), type)
+        , m_build_is_lhs(build_lhs) { }
+
+    DbErrorOr<void> build(size_t memory_budget);
+
+    virtual RelationIterator rows() const override;
+    virtual std::vector<std::string> explain() const override;
+
+    JoinSide const& build_side() const { return m_build_is_lhs ? lhs() : rhs(); }
+    JoinSide const& probe_side() const { return m_build_is_lhs ? rhs() : lhs(); }
+    bool preserve_build() const { return m_build_is_lhs ? preserve_lhs() : preserve_rhs(); }
+    bool preserve_probe() const { return m_build_is_lhs ? preserve_rhs() : preserve_lhs(); }
+
+    // Either of the rows may be null, it's then padded with NULLs.
+    Tuple build_probe_tuple(Tuple const* build_row, Tuple const* probe_row) const {
+        return m_build_is_lhs ? joined_tuple(build_row, probe_row) : joined_tuple(probe_row, build_row);
+    }
+
+    struct Partition {
+        SpillFile build;
+        SpillFile probe;
+    };
+
+    // Set if everything fits in memory.
+    std::optional<HashTable> const& hash_table() const { return m_hash_table; }
+    // Set otherwise.
+    std::vector<Partition> const& partitions() const { return m_partitions; }
+
+private:
+    DbErrorOr<void> spill(std::vector<Tuple> build_rows, RelationIterator& remaining_build_rows, size_t memory_budget, size_t memory_used);
+
+    bool m_build_is_lhs;
+
+    std::optional<HashTable> m_hash_table;
+    std::vector<Partition> m_partitions;
+};
+
+DbErrorOr<void> HashJoinRelation::build(size_t memory_budget) {
+    auto const& build = build_side();
+
+    std::vector<Tuple> rows;
+    rows.reserve(build.relation->estimated_size());
+    size_t memory_used = 0;
+
+    auto it = build.relation->rows();
+    for (auto row = it.next(); row; row = it.next()) {
+        auto tuple = row->read();
+        memory_used += estimate_row_size(tuple);
+        rows.push_back(std::move(tuple));
+        if (memory_used > memory_budget) {
+            return spill(std::move(rows), it, memory_budget, memory_used);
+        }
+    }
+    TRY(build.relation->read_error());
+
+    m_hash_table.emplace(std::move(rows), build.key_column);
+    return {};
+}
+
+DbErrorOr<void> HashJoinRelation::spill(std::vector<Tuple> build_rows, RelationIterator& remaining_build_rows, size_t memory_budget, size_t memory_used) {
+    // Aim for partitions that take half of the budget, assuming that
+    // the rows read so far are representative.
+    auto estimated_size = memory_used / build_rows.size() * build_side().relation->estimated_size();
+    auto partition_count = std::clamp<size_t>(estimated_size / std::max<size_t>(memory_budget / 2, 1) + 1, 2, MaxSpillPartitions);
+
+    for (size_t s = 0; s < partition_count; s++) {
+        m_partitions.push_back(Partition { .build = TRY(SpillFile::create()), .probe = TRY(SpillFile::create()) });
+    }
+
+    auto partition_for = [&](Tuple const& row, size_t key_column) {
+        auto key = join_key(row.value(key_column));
+        // Rows with NULL keys don't match anything, so they can go anywhere.
+        if (!key) {
+            return size_t { 0 };
+        }
+        // Use other bits than the hash table in the partition does.
+        auto hash = static_cast<uint64_t>(IndexValueHash {}(*key)) * 0x9e3779b97f4a7c15;
+        return static_cast<size_t>((hash >> 32) % partition_count);
+    };
+
+    auto build_key = build_side().key_column;
+    for (auto const& row : build_rows) {
+        TRY(m_partitions[partition_for(row, build_key)].build.write(row));
+    }
+    build_rows = {};
+    for (auto row = remaining_build_rows.next(); row; row = remaining_build_rows.next()) {
+        auto tuple = row->read();
+        TRY(m_partitions[partition_for(tuple, build_key)].build.write(tuple));
+    }
+    TRY(build_side().relation->read_error());
+
+    auto probe_key = probe_side().key_column;
+    auto probe_rows = probe_side().relation->rows();
+    for (auto row = probe_rows.next(); row; row = probe_rows.next()) {
+        auto tuple = row->read();
+        TRY(m_partitions[partition_for(tuple, probe_key)].probe.write(tuple));
+    }
+    TRY(probe_side().relation->read_error());
+
+    for (auto& partition : m_partitions) {
+        TRY(partition.build.flush());
+        TRY(partition.probe.flush());
+    }
+    return {};
+}
+
+std::vector<std::string> HashJoinRelation::explain() const {
+    auto description = fmt::format("Hash join ({}), hash table of {} side", join_type_to_string(type()), m_build_is_lhs ? "left" : "right");
+    if (!m_partitions.empty()) {
+        description += fmt::format(", spilled to {} partitions", m_partitions.size());
+    }
+    return explain_join(description);
+}
+
+class HashJoinIteratorImpl : public JoinIteratorImpl {
+public:
+    explicit HashJoinIteratorImpl(HashJoinRelation const& join)
+        : JoinIteratorImpl(join)
+        , m_join(join) { }
+
+private:
+    enum class State {
+        Start,
+        Probing,
+        EmittingUnmatchedBuildRows,
+        Done
+    };
+
+    virtual DbErrorOr<std::optional<Tuple>> next_tuple() override;
+    DbErrorOr<void> start_partition();
+    DbErrorOr<std::optional<Tuple>> next_probe_row();
+
+    HashJoinRelation const& m_join;
+    State m_state = State::Start;
+
+    // In spill mode, the hash table of the current partition.
+    size_t m_partition = 0;
+    std::optional<HashTable> m_partition_table;
+    HashTable const* m_table = nullptr;
+    std::vector<bool> m_matched_build_rows;
+
+    std::optional<RelationIterator> m_probe_rows;
+    std::optional<SpillFile::Reader> m_probe_reader;
+
+    std::optional<Tuple> m_probe_row;
+    uint32_t m_match = HashTable::End;
+    size_t m_unmatched_build_row = 0;
+};
+
+DbErrorOr<void> HashJoinIteratorImpl::start_partition() {
+    if (m_join.hash_table()) {
+        m_table = &*m_join.hash_table();
+        m_probe_rows = m_join.probe_side().relation->rows();
+    }
+    else {
+        auto const& partition = m_join.partitions()[m_partition];
+        std::vector<Tuple> rows;
+        rows.reserve(partition.build.row_count());
+        auto reader = partition.build.read();
+        while (auto row = TRY(reader.next())) {
+            rows.push_back(std::move(*row));
+        }
+        m_partition_table.emplace(std::move(rows), m_join.build_side().key_column);
+        m_table = &*m_partition_table;
+        m_probe_reader.emplace(partition.probe.read());
+    }
+    if (m_join.preserve_build()) {
+        m_matched_build_rows.assign(m_table->rows().size(), false);
+    }
+    m_unmatched_build_row = 0;
+    m_state = State::Probing;
+    return {};
+}
+
+DbErrorOr<std::optional<Tuple>> HashJoinIteratorImpl::next_probe_row() {
+    if (m_probe_rows) {
+        auto row = m_probe_rows->next();
+        if (!row) {
+            return std::optional<Tuple> {};
+        }
+        return row->read();
+    }
+    return m_probe_reader->next();
+}
+
+DbErrorOr<std::optional<Tuple>> HashJoinIteratorImpl::next_tuple() {
+    while (true) {
+        switch (m_state) {
+        case State::Start:
+            TRY(start_partition());
+            break;
+        case State::Probing: {
+            if (m_match != HashTable::End) {
+                auto build_row = m_match;
+                m_match = m_table->next(build_row);
+                if (m_join.preserve_build()) {
+                    m_matched_build_rows[build_row] = true;
+                }
+                return m_join.build_probe_tuple(&m_table->rows()[build_row], &*m_probe_row);
+            }
+
+            m_probe_row = TRY(next_probe_row());
+            if (!m_probe_row) {
+                m_state = State::EmittingUnmatchedBuildRows;
+                break;
+            }
+            auto key = join_key(m_probe_row->value(m_join.probe_side().key_column));
+            m_match = key ? m_table->find(*key) : HashTable::End;
+            if (m_match == HashTable::End && m_join.preserve_probe()) {
+                return m_join.build_probe_tuple(nullptr, &*m_probe_row);
+            }
+            break;
+        }
+        case State::EmittingUnmatchedBuildRows:
+            if (m_join.preserve_build()) {
+                while (m_unmatched_build_row < m_table->rows().size()) {
+                    auto build_row = m_unmatched_build_row++;
+                    if (!m_matched_build_rows[build_row]) {
+                        return m_join.build_probe_tuple(&m_table->rows()[build_row], nullptr);
+                    }
+                }
+            }
+            if (++m_partition < m_join.partitions().size()) {
+                TRY(start_partition());
+            }
+            else {
+                m_state = State::Done;
+            }
+            break;
+        case State::Done:
+            return std::optional<Tuple> {};
+        }
+    }
+}
+
+RelationIterator HashJoinRelation::rows() const {
+    return RelationIterator { std::make_unique<HashJoinIteratorImpl>(*this) };
+}
+
+}
+
+DbErrorOr<std::unique_ptr<Relation>> hash_join(JoinSide lhs, JoinSide rhs, JoinType type, size_t memory_budget, std::optional<bool> build_lhs) {
+    if (!build_lhs) {
+        build_lhs = lhs.relation->estimated_size() < rhs.relation->estimated_size();
+    }
+    auto join = std::make_unique<HashJoinRelation>(std::move(lhs), std::move(rhs), type, *build_lhs);
+    TRY(join->build(memory_budget));
+    return join;
+}
+
+}
@@ -0,0 +1,191 @@
+#include "Index.hpp"
+
+#include <EssaUtil/Config.hpp>
+#include <EssaUtil/ScopeGuard.hpp>
+#include <functional>
+#include <tuple>
+
+namespace Db::Core {
+
+static size_t hash_value(Value const& value) {
+    auto hash = std::visit(
+        Util::Overloaded {
+            [](std::monostate) -> size_t { return 0; },
+            [](int i) -> size_t { return std::hash<int> {}(i); },
+            // 0.0 and -0.0 compare equal, so they must hash the same.
+            [](float f) -> size_t { return f == 0 ? 0 : std::hash<float> {}(f); },
+            [](std::string const& s) -> size_t { return std::hash<std::string> {}(s); },
+            [](bool b) -> size_t { return std::hash<bool> {}(b); },
+            [](Date const& d) -> size_t {
+                size_t hash = 0;
+                for (auto field : { d.year, d.month, d.day, d.hour, d.min, d.sec }) {
+                    hash = hash * 31 + std::hash<int> {}(field);
+                }
+                return hash;
+            },
+        },
+        static_cast<ValueBase const&>(value));
+    return hash ^ (static_cast<size_t>(value.type()) << 1);
+}
+
+template<class T>
+static int three_way_compare(T const& lhs, T const& rhs) {
+    if (lhs < rhs) {
+        return -1;
+    }
+    if (rhs < lhs) {
+        return 1;
+    }
+    return 0;
+}
+
+int compare_index_values(Value const& lhs, Value const& rhs) {
+    if (lhs.type() != rhs.type()) {
+        // NULL is Type 0, so it goes first.
+        return three_way_compare(lhs.type(), rhs.type());
+    }
+    switch (lhs.type()) {
+    case Value::Type::Null:
+        return 0;
+    case Value::Type::Int:
+        return three_way_compare(std::get<int>(lhs), std::get<int>(rhs));
+    case Value::Type::Float:
+        return three_way_compare(std::get<float>(lhs), std::get<float>(rhs));
+    case Value::Type::Varchar:
+        return three_way_compare(std::get<std::string>(lhs), std::get<std::string>(rhs));
+    case Value::Type::Bool:
+        return three_way_compare(std::get<bool>(lhs), std::get<bool>(rhs));
+    case Value::Type::Time: {
+        auto const& l = std::get<Date>(lhs);
+        auto const& r = std::get<Date>(rhs);
+        return three_way_compare(std::tie(l.year, l.month, l.day, l.hour, l.min, l.sec), std::tie(r.year, r.month, r.day, r.hour, r.min, r.sec));
+    }
+    }
+    ESSA_UNREACHABLE;
+}
+
+int compare_index_keys(Tuple const& lhs, Tuple const& rhs) {
+    auto count = std::min(lhs.value_count(), rhs.value_count());
+    auto it1 = lhs.begin();
+    auto it2 = rhs.begin();
+    for (size_t s = 0; s < count; s++, it1++, it2++) {
+        if (auto result = compare_index_values(*it1, *it2); result != 0) {
+            return result;
+        }
+    }
+    return three_way_compare(lhs.value_count(), rhs.value_count());
+}
+
+size_t IndexKeyHash::operator()(Tuple const& key) const {
+    size_t hash = 0;
+    for (auto const& value : key) {
+        hash = hash * 31 + hash_value(value);
+    }
+    return hash;
+}
+
+bool IndexKeyEqual::operator()(Tuple const& lhs, Tuple const& rhs) const {
+    return compare_index_keys(lhs, rhs) == 0;
+}
+
+size_t IndexValueHash::operator()(Value const& value) const {
+    return hash_value(value);
+}
+
+bool IndexValueEqual::operator()(Value const& lhs, Value const& rhs) const {
+    return compare_index_values(lhs, rhs) == 0;
+}
+
+Tuple Index::key_for(Tuple const& row) const {
+    std::vector<Value> values;
+    values.reserve(m_columns.size());
+    for (auto column : m_columns) {
+        values.push_back(row.value(column));
+    }
+    return Tuple { std::move(values) };
+}
+
+DbErrorOr<void> HashIndex::insert(Tuple const& key, RowId row) {
+    m_entries.emplace(key, row);
+    return {};
+}
+
+DbErrorOr<void> HashIndex::remove(Tuple const& key, RowId row) {
+    auto [begin, end] = m_entries.equal_range(key);
+    for (auto it = begin; it != end; it++) {
+        if (it->second == row) {
+            m_entries.erase(it);
+            return {};
+        }
+    }
+    return {};
+}
+
+std::optional<RowId> HashIndex::find_first(Tuple const& key) const {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<RowId> HashIndex::find_all(Tuple const& key) const {
+    std::vector<RowId> rows;
+    auto [begin, end] = m_entries.equal_range(key);
+    for (auto it = begin; it != end; it++) {
+        rows.push_back(it->second);
+    }
+    return rows;
+}
+
+DbErrorOr<void> OrderedIndex::insert(Tuple const& key, RowId row) {
+    m_entries.emplace(key, row);
+    return {};
+}
+
+DbErrorOr<void> OrderedIndex::remove(Tuple const& key, RowId row) {
+    auto [begin, end] = m_entries.equal_range(key);
+    for (auto it = begin; it != end; it++) {
+        if (it->second == row) {
+            m_entries.erase(it);
+            return {};
+        }
+    }
+    return {};
+}
+
+std::optional<RowId> OrderedIndex::find_first(Tuple const& key) const {
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<RowId> OrderedIndex::find_all(Tuple const& key) const {
+    std::vector<RowId> rows;
+    auto [begin, end] = m_entries.equal_range(key);
+    for (auto it = begin; it != end; it++) {
+        rows.push_back(it->second);
+    }
+    return rows;
+}
+
+std::vector<RowId> OrderedIndex::find_range(std::optional<Bound> const& lower, std::optional<Bound> const& upper) const {
+    auto begin = !lower ? m_entries.begin()
+        : lower->inclusive
+        ? m_entries.lower_bound(lower->key)
+        : m_entries.upper_bound(lower->key);
+    auto end = !upper ? m_entries.end()
+        : upper->inclusive
+        ? m_entries.upper_bound(upper->key)
+        : m_entries.lower_bound(upper->key);
+
+    std::vector<RowId> rows;
+    for (auto it = begin; it != end && (!upper || compare_index_keys(it->first, upper->key) <= 0); it++) {
+        rows.push_back(it->second);
+    }
+    return rows;
+}
+
+}
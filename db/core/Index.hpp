@@ -0,0 +1,146 @@
+#pragma once
+
+#include <db/core/Relation.hpp>
+#include <db/core/Tuple.hpp>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Db::Core {
+
+// Index keys are compared strictly: values of different types are never
+// equal, and NULL is equal only to NULL. This is consistent with how
+// column constraints treat NULLs. For ordering, NULL is the smallest value.
+int compare_index_keys(Tuple const&, Tuple const&);
+int compare_index_values(Value const&, Value const&);
+
+struct IndexKeyHash {
+    size_t operator()(Tuple const&) const;
+};
+
+struct IndexKeyEqual {
+    bool operator()(Tuple const&, Tuple const&) const;
+};
+
+// Same as IndexKeyHash and IndexKeyEqual, for a single value.
+struct IndexValueHash {
+    size_t operator()(Value const&) const;
+};
+
+struct IndexValueEqual {
+    bool operator()(Value const&, Value const&) const;
+};
+
+struct IndexKeyLess {
+    bool operator()(Tuple const& lhs, Tuple const& rhs) const { return compare_index_keys(lhs, rhs) < 0; }
+};
+
+// A secondary structure that maps keys (values of `columns` of a row) to
+// rows of an IndexedRelation. Indexes are kept in sync by the storage engine,
+// see IndexedRelation::index_row() and friends.
+class Index {
+public:
+    enum class Origin {
+        // Created for primary key or UNIQUE column. Recreated on every
+        // key change.
+        Key,
+        // Created for a column referenced by a foreign key.
+        ForeignKeyReference,
+        // Created by CREATE INDEX.
+        User,
+    };
+
+    struct Bound {
+        Tuple key;
+        bool inclusive;
+    };
+
+    Index(std::string name, std::vector<size_t> columns, bool unique, Origin origin)
+        : m_name(std::move(name))
+        , m_columns(std::move(columns))
+        , m_unique(unique)
+        , m_origin(origin) { }
+
+    virtual ~Index() = default;
+
+    std::string const& name() const { return m_name; }
+    std::vector<size_t> const& columns() const { return m_columns; }
+    bool is_unique() const { return m_unique; }
+    Origin origin() const { return m_origin; }
+
+    // Extract key of this index from a full row.
+    Tuple key_for(Tuple const& row) const;
+
+    // Persistent indexes may fail to allocate storage.
+    virtual DbErrorOr<void> insert(Tuple const& key, RowId) = 0;
+    virtual DbErrorOr<void> remove(Tuple const& key, RowId) = 0;
+    virtual DbErrorOr<void> clear() = 0;
+
+    // Release storage used by the index. Called when index is dropped.
+    virtual DbErrorOr<void> destroy() { return {}; }
+
+    virtual bool contains(Tuple const& key) const = 0;
+    virtual std::optional<RowId> find_first(Tuple const& key) const = 0;
+    virtual std::vector<RowId> find_all(Tuple const& key) const = 0;
+
+    // Ordered indexes support range lookups. Rows are returned in key order.
+    virtual bool is_ordered() const { return false; }
+    virtual std::vector<RowId> find_range(std::optional<Bound> const&, std::optional<Bound> const&) const { return {}; }
+
+private:
+    std::string m_name;
+    std::vector<size_t> m_columns;
+    bool m_unique {};
+    Origin m_origin {};
+};
+
+// Index for equality lookups in O(1).
+class HashIndex : public Index {
+public:
+    using Index::Index;
+
+    virtual DbErrorOr<void> insert(Tuple const& key, RowId) override;
+    virtual DbErrorOr<void> remove(Tuple const& key, RowId) override;
+    virtual DbErrorOr<void> clear() override {
+        m_entries.clear();
+        return {};
+    }
+
+    virtual bool contains(Tuple const& key) const override { return m_entries.contains(key); }
+    virtual std::optional<RowId> find_first(Tuple const& key) const override;
+    virtual std::vector<RowId> find_all(Tuple const& key) const override;
+
+private:
+    // Multimap because non-unique indexes are allowed, and because
+    // UPDATE doesn't check integrity yet.
+    std::unordered_multimap<Tuple, RowId, IndexKeyHash, IndexKeyEqual> m_entries;
+};
+
+// Index for equality and range lookups in O(log n), for memory-backed
+// tables. Storage engines may provide their own, persistent implementation.
+class OrderedIndex : public Index {
+public:
+    using Index::Index;
+
+    virtual DbErrorOr<void> insert(Tuple const& key, RowId) override;
+    virtual DbErrorOr<void> remove(Tuple const& key, RowId) override;
+    virtual DbErrorOr<void> clear() override {
+        m_entries.clear();
+        return {};
+    }
+
+    virtual bool contains(Tuple const& key) const override { return m_entries.contains(key); }
+    virtual std::optional<RowId> find_first(Tuple const& key) const override;
+    virtual std::vector<RowId> find_all(Tuple const& key) const override;
+
+    virtual bool is_ordered() const override { return true; }
+    virtual std::vector<RowId> find_range(std::optional<Bound> const& lower, std::optional<Bound> const& upper) const override;
+
+private:
+    std::multimap<Tuple, RowId, IndexKeyLess> m_entries;
+};
+
+}
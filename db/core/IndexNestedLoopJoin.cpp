@@ -0,0 +1,120 @@
+#include "Join.hpp"
+
+#include "Index.hpp"
+#include "IndexedRelation.hpp"
+#include "JoinImplementation.hpp"
+
+#include <fmt/format.h>
+
+namespace Db::Core {
+
+namespace {
+
+// Index keys have the exact type of the column, so convert join keys to
+// it. Returns nullopt if the key can't be equal to any value of the type.
+std::optional<Value> index_key(Value const& key, Value::Type column_type) {
+    if (key.type() == column_type) {
+        return key;
+    }
+    // join_key() stores integral FLOATs as INTs, so only this conversion is
+    // needed.
+    if (key.type() == Value::Type::Int && column_type == Value::Type::Float) {
+        auto i = std::get<int>(key);
+        auto f = static_cast<float>(i);
+        if (static_cast<double>(f) != static_cast<double>(i)) {
+            return {};
+        }
+        return Value::create_float(f);
+    }
+    return {};
+}
+
+class IndexNestedLoopJoinRelation : public JoinRelation {
+public:
+    IndexNestedLoopJoinRelation(JoinSide lhs, JoinSide rhs, JoinType type, bool inner_is_lhs)
+        : JoinRelation(std::move(lhs), std::move(rhs), type)
+        , m_inner_is_lhs(inner_is_lhs) {
+        assert(!(inner_is_lhs ? preserve_lhs() : preserve_rhs()));
+        m_inner_relation = inner_side().relation->indexed_relation();
+        assert(m_inner_relation);
+        m_index = m_inner_relation->index_for_column(inner_side().key_column);
+        assert(m_index);
+    }
+
+    JoinSide const& inner_side() const { return m_inner_is_lhs ? lhs() : rhs(); }
+    JoinSide const& outer_side() const { return m_inner_is_lhs ? rhs() : lhs(); }
+    bool preserve_outer() const { return m_inner_is_lhs ? preserve_rhs() : preserve_lhs(); }
+    IndexedRelation const& inner_relation() const { return *m_inner_relation; }
+    Index const& index() const { return *m_index; }
+
+    Tuple inner_outer_tuple(Tuple const* inner_row, Tuple const* outer_row) const {
+        return m_inner_is_lhs ? joined_tuple(inner_row, outer_row) : joined_tuple(outer_row, inner_row);
+    }
+
+    virtual RelationIterator rows() const override;
+    virtual std::vector<std::string> explain() const override {
+        return explain_join(fmt::format("Index nested loop join ({}), using index '{}' of {} side",
+            join_type_to_string(type()), m_index->name(), m_inner_is_lhs ? "left" : "right"));
+    }
+
+private:
+    bool m_inner_is_lhs;
+    IndexedRelation const* m_inner_relation = nullptr;
+    Index const* m_index = nullptr;
+};
+
+class IndexNestedLoopJoinIteratorImpl : public JoinIteratorImpl {
+public:
+    explicit IndexNestedLoopJoinIteratorImpl(IndexNestedLoopJoinRelation const& join)
+        : JoinIteratorImpl(join)
+        , m_join(join)
+        , m_outer_rows(join.outer_side().relation->rows())
+        , m_inner_column_type(join.inner_side().relation->columns()[join.inner_side().key_column].type()) { }
+
+private:
+    virtual DbErrorOr<std::optional<Tuple>> next_tuple() override {
+        while (true) {
+            if (m_outer_row && m_next_match < m_matches.size()) {
+                auto inner_row = m_join.inner_relation().read_row(m_matches[m_next_match++]);
+                return std::optional<Tuple> { m_join.inner_outer_tuple(&inner_row, &*m_outer_row) };
+            }
+
+            auto row = m_outer_rows.next();
+            if (!row) {
+                return std::optional<Tuple> {};
+            }
+            m_outer_row = row->read();
+            m_next_match = 0;
+            m_matches.clear();
+
+            auto key = join_key(m_outer_row->value(m_join.outer_side().key_column));
+            auto lookup_key = key ? index_key(*key, m_inner_column_type) : std::nullopt;
+            if (lookup_key) {
+                m_matches = m_join.index().find_all(Tuple { *lookup_key });
+            }
+            if (m_matches.empty() && m_join.preserve_outer()) {
+                return std::optional<Tuple> { m_join.inner_outer_tuple(nullptr, &*m_outer_row) };
+            }
+        }
+    }
+
+    IndexNestedLoopJoinRelation const& m_join;
+    RelationIterator m_outer_rows;
+    Value::Type m_inner_column_type;
+
+    std::optional<Tuple> m_outer_row;
+    std::vector<RowId> m_matches;
+    size_t m_next_match = 0;
+};
+
+RelationIterator IndexNestedLoopJoinRelation::rows() const {
+    return RelationIterator { std::make_unique<IndexNestedLoopJoinIteratorImpl>(*this) };
+}
+
+}
+
+DbErrorOr<std::unique_ptr<Relation>> index_nested_loop_join(JoinSide lhs, JoinSide rhs, JoinType type, bool inner_is_lhs) {
+    return std::make_unique<IndexNestedLoopJoinRelation>(std::move(lhs), std::move(rhs), type, inner_is_lhs);
+}
+
+}
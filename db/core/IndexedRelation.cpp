@@ -0,0 +1,204 @@
+#include "IndexedRelation.hpp"
+
+#include <algorithm>
+#include <db/core/UndoLog.hpp>
+
+namespace Db::Core {
+
+Index* IndexedRelation::index_for_column(size_t column) const {
+    for (auto const& index : m_indexes) {
+        if (index->columns().size() == 1 && index->columns()[0] == column) {
+            return index.get();
+        }
+    }
+    return nullptr;
+}
+
+Index* IndexedRelation::ordered_index_for_column(size_t column) const {
+    for (auto const& index : m_indexes) {
+        if (index->is_ordered() && index->columns().size() == 1 && index->columns()[0] == column) {
+            return index.get();
+        }
+    }
+    return nullptr;
+}
+
+Index* IndexedRelation::index(std::string const& name) const {
+    for (auto const& index : m_indexes) {
+        if (index->name() == name) {
+            return index.get();
+        }
+    }
+    return nullptr;
+}
+
+void IndexedRelation::set_primary_key(std::optional<PrimaryKey> key) {
+    if (auto undo_log = active_undo_log()) {
+        undo_log->record([this, old_key = m_primary_key]() -> DbErrorOr<void> {
+            m_primary_key = old_key;
+            update_key_indexes();
+            return {};
+        });
+    }
+    m_primary_key = std::move(key);
+    update_key_indexes();
+}
+
+void IndexedRelation::add_foreign_key(ForeignKey key) {
+    if (auto undo_log = active_undo_log()) {
+        undo_log->record([this, old_keys = m_foreign_keys]() -> DbErrorOr<void> {
+            m_foreign_keys = old_keys;
+            return {};
+        });
+    }
+    m_foreign_keys.push_back(std::move(key));
+}
+
+void IndexedRelation::drop_foreign_key(std::string const& name) {
+    if (auto undo_log = active_undo_log()) {
+        undo_log->record([this, old_keys = m_foreign_keys]() -> DbErrorOr<void> {
+            m_foreign_keys = old_keys;
+            return {};
+        });
+    }
+    std::erase_if(m_foreign_keys, [&](auto const& fk) { return fk.local_column == name; });
+}
+
+DbErrorOr<void> IndexedRelation::create_index(std::string name, std::vector<size_t> columns, bool unique) {
+    if (index(name)) {
+        return DbError { fmt::format("Index '{}' already exists", name) };
+    }
+
+    auto new_index = TRY(create_ordered_index(std::move(name), std::move(columns), unique));
+    auto it = rows();
+    for (auto row = it.next(); row; row = it.next()) {
+        auto key = new_index->key_for(row->read());
+        if (unique && new_index->contains(key)) {
+            auto name = new_index->name();
+            TRY(new_index->destroy());
+            return DbError { fmt::format("Cannot create unique index '{}' because of duplicate key {}", name, key) };
+        }
+        if (auto inserted = new_index->insert(key, row->row_id()); inserted.is_error()) {
+            // Error of freeing the partial index would hide the original one.
+            (void)new_index->destroy();
+            return inserted.release_error();
+        }
+    }
+    auto undo_log = undoes_index_changes() ? active_undo_log() : nullptr;
+    if (undo_log) {
+        undo_log->record([this, name = new_index->name()]() { return drop_index(name); });
+    }
+    m_indexes.push_back(std::move(new_index));
+    return user_indexes_changed();
+}
+
+DbErrorOr<void> IndexedRelation::drop_index(std::string const& name) {
+    auto it = std::find_if(m_indexes.begin(), m_indexes.end(), [&](auto const& index) {
+        return index->origin() == Index::Origin::User && index->name() == name;
+    });
+    if (it == m_indexes.end()) {
+        return DbError { fmt::format("Index '{}' doesn't exist", name) };
+    }
+    // Rows changed later in the transaction are reverted first, so the
+    // index is filled with the same rows it had when it was dropped.
+    auto undo_log = undoes_index_changes() ? active_undo_log() : nullptr;
+    if (undo_log) {
+        undo_log->record([this, name, columns = (*it)->columns(), unique = (*it)->is_unique()]() {
+            return create_index(name, columns, unique);
+        });
+    }
+    TRY((*it)->destroy());
+    m_indexes.erase(it);
+    return user_indexes_changed();
+}
+
+DbErrorOr<std::unique_ptr<Index>> IndexedRelation::create_ordered_index(std::string name, std::vector<size_t> columns, bool unique) {
+    return std::make_unique<OrderedIndex>(std::move(name), std::move(columns), unique, Index::Origin::User);
+}
+
+DbErrorOr<void> IndexedRelation::index_row(Tuple const& row, RowId id) {
+    for (auto const& index : m_indexes) {
+        TRY(index->insert(index->key_for(row), id));
+    }
+    return {};
+}
+
+DbErrorOr<void> IndexedRelation::unindex_row(Tuple const& row, RowId id) {
+    for (auto const& index : m_indexes) {
+        TRY(index->remove(index->key_for(row), id));
+    }
+    return {};
+}
+
+DbErrorOr<void> IndexedRelation::reindex_row(Tuple const& old_row, Tuple const& new_row, RowId id) {
+    for (auto const& index : m_indexes) {
+        auto old_key = index->key_for(old_row);
+        auto new_key = index->key_for(new_row);
+        if (IndexKeyEqual {}(old_key, new_key)) {
+            continue;
+        }
+        TRY(index->remove(old_key, id));
+        TRY(index->insert(new_key, id));
+    }
+    return {};
+}
+
+void IndexedRelation::ensure_foreign_key_reference_index(size_t column) {
+    if (index_for_column(column)) {
+        return;
+    }
+    auto index = std::make_unique<HashIndex>(fmt::format("FOREIGN({})", columns()[column].name()), std::vector { column }, false, Index::Origin::ForeignKeyReference);
+    // Hash indexes are kept in memory, so filling them can't fail.
+    MUST(fill_index(*index));
+    m_indexes.push_back(std::move(index));
+}
+
+std::optional<Tuple> IndexedRelation::find_first_matching_tuple(size_t column, Value const& value) const {
+    auto index = index_for_column(column);
+    if (!index) {
+        return Relation::find_first_matching_tuple(column, value);
+    }
+    auto row = index->find_first(Tuple { value });
+    if (!row) {
+        return {};
+    }
+    return read_row(*row);
+}
+
+void IndexedRelation::update_key_indexes() {
+    std::erase_if(m_indexes, [](auto const& index) { return index->origin() == Index::Origin::Key; });
+
+    auto has_key_index = [&](size_t column) {
+        return std::any_of(m_indexes.begin(), m_indexes.end(), [&](auto const& index) {
+            return index->origin() == Index::Origin::Key && index->columns() == std::vector { column };
+        });
+    };
+
+    if (m_primary_key) {
+        if (auto column = get_column(m_primary_key->local_column)) {
+            auto index = std::make_unique<HashIndex>("PRIMARY", std::vector { column->index }, true, Index::Origin::Key);
+            MUST(fill_index(*index));
+            m_indexes.push_back(std::move(index));
+        }
+    }
+
+    auto const& columns = this->columns();
+    for (size_t s = 0; s < columns.size(); s++) {
+        if (columns[s].unique() && !has_key_index(s)) {
+            auto index = std::make_unique<HashIndex>(fmt::format("UNIQUE({})", columns[s].name()), std::vector { s }, true, Index::Origin::Key);
+            MUST(fill_index(*index));
+            m_indexes.push_back(std::move(index));
+        }
+    }
+}
+
+DbErrorOr<void> IndexedRelation::fill_index(Index& index) {
+    TRY(index.clear());
+    auto it = rows();
+    for (auto row = it.next(); row; row = it.next()) {
+        TRY(index.insert(index.key_for(row->read()), row->row_id()));
+    }
+    return {};
+}
+
+}
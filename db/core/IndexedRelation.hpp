@@ -1,9 +1,13 @@
 #pragma once
 
+#include <db/core/DbError.hpp>
+#include <db/core/Index.hpp>
 #include <db/core/Relation.hpp>
 
 namespace Db::Core {
 
+class UndoLog;
+
 // TODO: Compound keys
 struct PrimaryKey {
     std::string local_column;
@@ -19,24 +23,80 @@ struct ForeignKey {
 // some accesses.
 class IndexedRelation : public Relation {
 public:
-    void set_primary_key(std::optional<PrimaryKey> key) {
-        m_primary_key = std::move(key);
-    }
-
-    void add_foreign_key(ForeignKey key) {
-        m_foreign_keys.push_back(std::move(key));
-    }
-
-    void drop_foreign_key(std::string const& name) {
-        std::erase_if(m_foreign_keys, [&](auto const& fk) { return fk.local_column == name; });
-    }
+    // Changes of keys and indexes are reverted when the running
+    // transaction is rolled back.
+    void set_primary_key(std::optional<PrimaryKey> key);
+    void add_foreign_key(ForeignKey key);
+    void drop_foreign_key(std::string const& name);
 
     auto const& primary_key() const { return m_primary_key; }
     auto const& foreign_keys() const { return m_foreign_keys; }
+    auto const& indexes() const { return m_indexes; }
+
+    // Find an index which key is exactly the `column`-th column.
+    Index* index_for_column(size_t column) const;
+    // Like index_for_column(), but only considers indexes that support
+    // range lookups.
+    Index* ordered_index_for_column(size_t column) const;
+    Index* index(std::string const& name) const;
+
+    // CREATE INDEX / DROP INDEX
+    DbErrorOr<void> create_index(std::string name, std::vector<size_t> columns, bool unique);
+    DbErrorOr<void> drop_index(std::string const& name);
+
+    // Make sure that `column` is indexed so that foreign keys referencing
+    // it can be checked quickly. Does nothing if an index exists already.
+    void ensure_foreign_key_reference_index(size_t column);
+
+    // ^Relation
+    virtual std::optional<Tuple> find_first_matching_tuple(size_t column, Value const& value) const override;
+    virtual IndexedRelation const* indexed_relation() const override { return this; }
+
+    virtual Tuple read_row(RowId) const = 0;
+
+    // Keep indexes in sync with stored rows. Storage engines must call
+    // these on every insert, update and remove of a row. Persistent
+    // indexes may fail to allocate storage; indexes updated before the
+    // error are left as they are, so the statement's transaction must
+    // be rolled back.
+    DbErrorOr<void> index_row(Tuple const& row, RowId);
+    DbErrorOr<void> unindex_row(Tuple const& row, RowId);
+    DbErrorOr<void> reindex_row(Tuple const& old_row, Tuple const& new_row, RowId);
+
+protected:
+    // Log that changes of keys and indexes are recorded in, if a
+    // transaction is running.
+    virtual UndoLog* active_undo_log() const { return nullptr; }
+
+    // Storage engines that read indexes from storage again on rollback
+    // return false, so that index changes aren't reverted twice.
+    virtual bool undoes_index_changes() const { return true; }
+
+    // (Re)create indexes implied by table structure (primary key and
+    // UNIQUE columns) and fill them with existing rows. This must be
+    // called once columns are known.
+    void update_key_indexes();
+
+    // Create an empty index for CREATE INDEX. Storage engines may
+    // override this to make the index persistent.
+    virtual DbErrorOr<std::unique_ptr<Index>> create_ordered_index(std::string name, std::vector<size_t> columns, bool unique);
+
+    // Called after a user index was created or dropped.
+    virtual DbErrorOr<void> user_indexes_changed() { return {}; }
+
+    // Add an index that is already filled, e.g loaded from storage.
+    void add_filled_index(std::unique_ptr<Index> index) { m_indexes.push_back(std::move(index)); }
+
+    // Forget all indexes, e.g before they are loaded from storage again.
+    void clear_indexes() { m_indexes.clear(); }
+
+    // Clear index and add all rows to it.
+    DbErrorOr<void> fill_index(Index&);
 
 private:
     std::optional<PrimaryKey> m_primary_key;
     std::vector<ForeignKey> m_foreign_keys;
+    std::vector<std::unique_ptr<Index>> m_indexes;
 };
 
 }
@@ -0,0 +1,277 @@
+#include "Join.hpp"
+
+#include "Index.hpp"
+#include "IndexedRelation.hpp"
+#include "JoinImplementation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <limits>
+
+namespace Db::Core {
+
+std::string join_type_to_string(JoinType type) {
+    switch (type) {
+    case JoinType::Inner:
+        return "INNER JOIN";
+    case JoinType::Left:
+        return "LEFT JOIN";
+    case JoinType::Right:
+        return "RIGHT JOIN";
+    case JoinType::Full:
+        return "FULL OUTER JOIN";
+    }
+    ESSA_UNREACHABLE;
+}
+
+std::optional<Value> join_key(Value const& value) {
+    switch (value.type()) {
+    case Value::Type::Null:
+        return {};
+    case Value::Type::Float: {
+        auto f = std::get<float>(value);
+        if (std::isnan(f)) {
+            return {};
+        }
+        // Store integral FLOATs as INTs, so that they match equal INTs.
+        if (f == std::trunc(f) && f >= static_cast<float>(std::numeric_limits<int>::min()) && f < -static_cast<float>(std::numeric_limits<int>::min())) {
+            return Value::create_int(static_cast<int>(f));
+        }
+        return value;
+    }
+    default:
+        return value;
+    }
+}
+
+int compare_join_keys(Value const& lhs, Value const& rhs) {
+    auto is_number = [](Value const& value) {
+        return value.type() == Value::Type::Int || value.type() == Value::Type::Float;
+    };
+    if (is_number(lhs) && is_number(rhs)) {
+        auto to_double = [](Value const& value) {
+            return value.type() == Value::Type::Int ? static_cast<double>(std::get<int>(value)) : static_cast<double>(std::get<float>(value));
+        };
+        auto l = to_double(lhs);
+        auto r = to_double(rhs);
+        return l < r ? -1 : r < l ? 1 : 0;
+    }
+    return compare_index_values(lhs, rhs);
+}
+
+JoinRelation::JoinRelation(JoinSide lhs, JoinSide rhs, JoinType type)
+    : m_lhs(std::move(lhs))
+    , m_rhs(std::move(rhs))
+    , m_type(type) {
+    assert(m_lhs.key_column < m_lhs.relation->columns().size());
+    assert(m_rhs.key_column < m_rhs.relation->columns().size());
+
+    for (auto const* side : { &m_lhs, &m_rhs }) {
+        for (auto const& column : side->relation->columns()) {
+            m_columns.push_back(Column(column.name(), column.type(), false, false, false));
+        }
+    }
+}
+
+Tuple JoinRelation::joined_tuple(Tuple const* lhs_row, Tuple const* rhs_row) const {
+    std::vector<Value> values;
+    values.reserve(m_columns.size());
+    auto append = [&](Tuple const* row, Relation const& relation) {
+        if (row) {
+            values.insert(values.end(), row->begin(), row->end());
+        }
+        else {
+            values.resize(values.size() + relation.columns().size(), Value::null());
+        }
+    };
+    append(lhs_row, *m_lhs.relation);
+    append(rhs_row, *m_rhs.relation);
+    return Tuple { std::move(values) };
+}
+
+size_t JoinRelation::size() const {
+    if (!m_size) {
+        size_t size = 0;
+        auto it = rows();
+        while (it.next()) {
+            size++;
+        }
+        m_size = size;
+    }
+    return *m_size;
+}
+
+DbErrorOr<void> JoinRelation::read_error() const {
+    if (m_read_error) {
+        return *m_read_error;
+    }
+    TRY(m_lhs.relation->read_error());
+    return m_rhs.relation->read_error();
+}
+
+size_t JoinRelation::estimated_size() const {
+    if (m_size) {
+        return *m_size;
+    }
+    // Assume that most rows match a single row of the other side, like
+    // for foreign keys.
+    return std::max(m_lhs.relation->estimated_size(), m_rhs.relation->estimated_size());
+}
+
+std::vector<std::string> JoinRelation::explain_join(std::string const& description) const {
+    std::vector<std::string> lines { description };
+    for (auto const* side : { &m_lhs, &m_rhs }) {
+        for (auto const& line : side->relation->explain()) {
+            lines.push_back("  " + line);
+        }
+    }
+    return lines;
+}
+
+namespace {
+
+class JoinedRowReference : public RowReference {
+public:
+    JoinedRowReference(Tuple tuple, RowId row_id)
+        : m_tuple(std::move(tuple))
+        , m_row_id(row_id) { }
+
+    virtual Tuple read() const override { return m_tuple; }
+    virtual DbErrorOr<void> write(Tuple const&) override { ESSA_UNREACHABLE; }
+    virtual RowId row_id() const override { return m_row_id; }
+    virtual DbErrorOr<void> remove() override { ESSA_UNREACHABLE; }
+    virtual std::unique_ptr<RowReference> clone() const override {
+        return std::make_unique<JoinedRowReference>(*this);
+    }
+
+private:
+    Tuple m_tuple;
+    RowId m_row_id;
+};
+
+}
+
+std::unique_ptr<RowReference> JoinIteratorImpl::next() {
+    if (m_failed) {
+        return {};
+    }
+    auto tuple = next_tuple();
+    if (tuple.is_error()) {
+        m_failed = true;
+        if (!m_relation.m_read_error) {
+            m_relation.m_read_error = tuple.release_error();
+        }
+        return {};
+    }
+    if (!tuple.value()) {
+        return {};
+    }
+    return std::make_unique<JoinedRowReference>(std::move(*tuple.release_value()), m_row_id++);
+}
+
+namespace {
+
+// Costs of operations on a single row, relative to reading it.
+constexpr double ScanCost = 1;
+constexpr double IndexOrderScanCost = 1.5;
+constexpr double HashBuildCost = 2;
+constexpr double HashProbeCost = 1;
+constexpr double MergeCost = 0.5;
+constexpr double HashIndexLookupCost = 2;
+
+enum class SortOrder {
+    None,
+    Rows,
+    Index,
+};
+
+SortOrder sort_order(JoinSide const& side) {
+    if (side.relation->sorted_by() == side.key_column) {
+        return SortOrder::Rows;
+    }
+    auto indexed_relation = side.relation->indexed_relation();
+    if (indexed_relation && indexed_relation->ordered_index_for_column(side.key_column)) {
+        return SortOrder::Index;
+    }
+    return SortOrder::None;
+}
+
+std::optional<double> index_lookup_cost(JoinSide const& side) {
+    auto indexed_relation = side.relation->indexed_relation();
+    if (!indexed_relation) {
+        return {};
+    }
+    auto index = indexed_relation->index_for_column(side.key_column);
+    if (!index) {
+        return {};
+    }
+    if (index->is_ordered()) {
+        return 1 + std::log2(static_cast<double>(side.relation->estimated_size()) + 1) / 2;
+    }
+    return HashIndexLookupCost;
+}
+
+}
+
+JoinPlan plan_join(JoinSide const& lhs, JoinSide const& rhs, JoinType type) {
+    auto lhs_size = static_cast<double>(lhs.relation->estimated_size());
+    auto rhs_size = static_cast<double>(rhs.relation->estimated_size());
+
+    // Build on the smaller side, and keep the order of lhs if the sides
+    // are equal.
+    bool build_lhs = lhs_size < rhs_size;
+    JoinPlan best {
+        .algorithm = JoinAlgorithm::Hash,
+        .inner_is_lhs = build_lhs,
+        .cost = (lhs_size + rhs_size) * ScanCost
+            + std::min(lhs_size, rhs_size) * HashBuildCost
+            + std::max(lhs_size, rhs_size) * HashProbeCost,
+    };
+
+    auto lhs_order = sort_order(lhs);
+    auto rhs_order = sort_order(rhs);
+    if (lhs_order != SortOrder::None && rhs_order != SortOrder::None) {
+        auto scan_cost = [](SortOrder order) { return order == SortOrder::Rows ? ScanCost : IndexOrderScanCost; };
+        auto cost = lhs_size * (scan_cost(lhs_order) + MergeCost) + rhs_size * (scan_cost(rhs_order) + MergeCost);
+        if (cost < best.cost) {
+            best = { .algorithm = JoinAlgorithm::Merge, .inner_is_lhs = false, .cost = cost };
+        }
+    }
+
+    bool preserve_lhs = type == JoinType::Left || type == JoinType::Full;
+    bool preserve_rhs = type == JoinType::Right || type == JoinType::Full;
+    auto consider_index = [&](JoinSide const& inner, bool inner_is_lhs, bool preserve_inner, double outer_size) {
+        if (preserve_inner) {
+            return;
+        }
+        auto lookup_cost = index_lookup_cost(inner);
+        if (!lookup_cost) {
+            return;
+        }
+        // Reading the outer row and, assuming one match, the inner one.
+        auto cost = outer_size * (2 * ScanCost + *lookup_cost);
+        if (cost < best.cost) {
+            best = { .algorithm = JoinAlgorithm::IndexNestedLoop, .inner_is_lhs = inner_is_lhs, .cost = cost };
+        }
+    };
+    consider_index(rhs, false, preserve_rhs, lhs_size);
+    consider_index(lhs, true, preserve_lhs, rhs_size);
+
+    return best;
+}
+
+DbErrorOr<std::unique_ptr<Relation>> join(JoinSide lhs, JoinSide rhs, JoinType type) {
+    auto plan = plan_join(lhs, rhs, type);
+    switch (plan.algorithm) {
+    case JoinAlgorithm::Hash:
+        return hash_join(std::move(lhs), std::move(rhs), type, DefaultHashJoinMemoryBudget, plan.inner_is_lhs);
+    case JoinAlgorithm::Merge:
+        return merge_join(std::move(lhs), std::move(rhs), type);
+    case JoinAlgorithm::IndexNestedLoop:
+        return index_nested_loop_join(std::move(lhs), std::move(rhs), type, plan.inner_is_lhs);
+    }
+    ESSA_UNREACHABLE;
+}
+
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Relation.hpp"
+
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace Db::Core {
+
+enum class JoinType {
+    Inner,
+    Left,
+    Right,
+    Full
+};
+
+std::string join_type_to_string(JoinType);
+
+// Memory that the hash table of a join may use before it is partitioned
+// to disk.
+constexpr size_t DefaultHashJoinMemoryBudget = 64 * 1024 * 1024;
+
+struct JoinSide {
+    std::unique_ptr<Relation> relation;
+    size_t key_column;
+};
+
+// Value that is used to match `value` with rows of the other side of a
+// join, or nullopt if it doesn't match anything (for NULLs). INTs and
+// FLOATs are equal if they have the same numeric value; values of other
+// different types are never equal.
+std::optional<Value> join_key(Value const& value);
+
+// Total order of join keys that is consistent with join_key(): INTs and
+// FLOATs are compared numerically, other values of the same type as by
+// `<`. For values of a single column it is the same as the order of
+// ORDER BY. Returns <0, 0 or >0.
+int compare_join_keys(Value const& lhs, Value const& rhs);
+
+enum class JoinAlgorithm {
+    // Load one side to a hash table, look up rows of the other one.
+    Hash,
+    // Walk both sides at once, in the order of their keys.
+    Merge,
+    // Look up rows of one side using an index of the other one.
+    IndexNestedLoop,
+};
+
+struct JoinPlan {
+    JoinAlgorithm algorithm;
+    // The side that is loaded to the hash table, or the one which index
+    // is used. Unused for merge joins.
+    bool inner_is_lhs = false;
+    // Estimated cost, in units of reading a single row.
+    double cost = 0;
+};
+
+// Choose the cheapest algorithm based on sizes of the sides, their
+// indexes and whether they are sorted by their keys:
+// - Merge join is possible if both sides are sorted by the key (see
+//   Relation::sorted_by()) or have an ordered index on it.
+// - Index nested loop join is possible if a side has an index on the key
+//   and its unmatched rows don't need to be output.
+// - Hash join is always possible.
+JoinPlan plan_join(JoinSide const& lhs, JoinSide const& rhs, JoinType);
+
+// Equi-join of `lhs` and `rhs` on their key columns, using the algorithm
+// chosen by plan_join(). The output has columns of `lhs` followed by
+// columns of `rhs`. Rows that don't match anything are padded with NULLs
+// for outer joins. Joined rows are computed while they are read, so the
+// output is never stored as a whole. The order of rows depends on the
+// algorithm.
+DbErrorOr<std::unique_ptr<Relation>> join(JoinSide lhs, JoinSide rhs, JoinType);
+
+// The `build_lhs` side, or the smaller one if not given, is loaded into a
+// hash table. If it exceeds `memory_budget`, both sides are partitioned by
+// key into temporary files first, and then joined partition by partition.
+// Partitions are not split again, so a partition of the build side is
+// loaded into memory as a whole even if it exceeds the budget. This happens
+// when many rows have the same key (or keys with the same hash), because
+// they always go to the same partition.
+DbErrorOr<std::unique_ptr<Relation>> hash_join(JoinSide lhs, JoinSide rhs, JoinType, size_t memory_budget = DefaultHashJoinMemoryBudget, std::optional<bool> build_lhs = {});
+
+// Both sides must be sorted by the key or have an ordered index on it.
+DbErrorOr<std::unique_ptr<Relation>> merge_join(JoinSide lhs, JoinSide rhs, JoinType);
+
+// The `inner_is_lhs` side must have an index on the key, and must not be
+// preserved by the join type.
+DbErrorOr<std::unique_ptr<Relation>> index_nested_loop_join(JoinSide lhs, JoinSide rhs, JoinType, bool inner_is_lhs);
+
+}
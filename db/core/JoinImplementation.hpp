@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Join.hpp"
+
+#include <EssaUtil/Config.hpp>
+
+// Definitions shared by implementations of join algorithms.
+
+namespace Db::Core {
+
+// Output of a join. Rows are computed by iterators of derived classes.
+class JoinRelation : public Relation {
+public:
+    JoinRelation(JoinSide lhs, JoinSide rhs, JoinType type);
+
+    JoinSide const& lhs() const { return m_lhs; }
+    JoinSide const& rhs() const { return m_rhs; }
+    JoinType type() const { return m_type; }
+    bool preserve_lhs() const { return m_type == JoinType::Left || m_type == JoinType::Full; }
+    bool preserve_rhs() const { return m_type == JoinType::Right || m_type == JoinType::Full; }
+
+    // Either of the rows may be null, it's then padded with NULLs.
+    Tuple joined_tuple(Tuple const* lhs_row, Tuple const* rhs_row) const;
+
+    // ^Relation
+    virtual std::vector<Column> const& columns() const override { return m_columns; }
+    virtual MutableRelationIterator writable_rows() override { ESSA_UNREACHABLE; }
+    // This reads all rows, but only once.
+    virtual size_t size() const override;
+    virtual size_t estimated_size() const override;
+    // Errors of the sides are reported too.
+    virtual DbErrorOr<void> read_error() const override;
+
+protected:
+    // `description` followed by indented lines of both sides.
+    std::vector<std::string> explain_join(std::string const& description) const;
+
+private:
+    JoinSide m_lhs;
+    JoinSide m_rhs;
+    JoinType m_type;
+    std::vector<Column> m_columns;
+
+    mutable std::optional<size_t> m_size;
+
+    friend class JoinIteratorImpl;
+    mutable std::optional<DbError> m_read_error;
+};
+
+class JoinIteratorImpl : public RelationIteratorImpl {
+public:
+    explicit JoinIteratorImpl(JoinRelation const& join)
+        : m_relation(join) { }
+
+    // Ends the rows if next_tuple() fails, keeping the error in the
+    // relation (see Relation::read_error()).
+    virtual std::unique_ptr<RowReference> next() override;
+
+private:
+    // Returns nullopt after the last row.
+    virtual DbErrorOr<std::optional<Tuple>> next_tuple() = 0;
+
+    JoinRelation const& m_relation;
+    RowId m_row_id = 0;
+    bool m_failed = false;
+};
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Kernels.hpp"
+
+#include <algorithm>
+
+// Definitions of implementations of Kernels, for Kernels.cpp and
+// the instruction-set specific files.
+
+namespace Db::Core::Kernels {
+
+extern Implementation const scalar_kernels;
+
+#if defined(__x86_64__) || defined(__i386__)
+#    define ESSADB_X86_KERNELS
+extern Implementation const sse41_kernels;
+extern Implementation const avx2_kernels;
+#endif
+
+inline void merge(IntAggregate& result, IntAggregate const& other) {
+    result.sum += other.sum;
+    result.min = std::min(result.min, other.min);
+    result.max = std::max(result.max, other.max);
+    result.count += other.count;
+}
+
+inline void merge(FloatAggregate& result, FloatAggregate const& other) {
+    result.sum += other.sum;
+    result.min = std::min(result.min, other.min);
+    result.max = std::max(result.max, other.max);
+    result.count += other.count;
+}
+
+}
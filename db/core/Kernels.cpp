@@ -0,0 +1,74 @@
+#include "Kernels.hpp"
+
+#include "KernelImplementations.hpp"
+
+#include <algorithm>
+
+namespace Db::Core::Kernels {
+
+template<class T, class Predicate>
+static void fill_bitmap(std::span<T const> values, std::span<uint64_t> output, Predicate&& predicate) {
+    std::fill_n(output.begin(), bitmap_words(values.size()), 0);
+    for (size_t s = 0; s < values.size(); s++) {
+        output[s / 64] |= uint64_t { predicate(values[s]) } << (s % 64);
+    }
+}
+
+template<class T>
+static void compare_scalar(std::span<T const> values, Comparison comparison, T constant, std::span<uint64_t> output) {
+    visit_comparison(comparison, [&](auto c) {
+        fill_bitmap(values, output, [&](T value) { return compare_values<decltype(c)::value>(value, constant); });
+    });
+}
+
+template<class T>
+static void between_scalar(std::span<T const> values, T min, T max, std::span<uint64_t> output) {
+    fill_bitmap(values, output, [&](T value) {
+        return compare_values<Comparison::GreaterEqual>(value, min) && compare_values<Comparison::LessEqual>(value, max);
+    });
+}
+
+template<class Aggregate, class T>
+static Aggregate aggregate_scalar(std::span<T const> values, std::span<uint64_t const> mask) {
+    Aggregate result;
+    for (size_t s = 0; s < values.size(); s++) {
+        if (!((mask[s / 64] >> (s % 64)) & 1)) {
+            continue;
+        }
+        result.sum += values[s];
+        result.min = std::min(result.min, values[s]);
+        result.max = std::max(result.max, values[s]);
+        result.count++;
+    }
+    return result;
+}
+
+Implementation const scalar_kernels {
+    .name = "scalar",
+    .compare_ints = compare_scalar<int>,
+    .compare_floats = compare_scalar<float>,
+    .between_ints = between_scalar<int>,
+    .between_floats = between_scalar<float>,
+    .aggregate_ints = aggregate_scalar<IntAggregate, int>,
+    .aggregate_floats = aggregate_scalar<FloatAggregate, float>,
+};
+
+std::vector<Implementation const*> const& implementations() {
+    static std::vector<Implementation const*> implementations = [] {
+        std::vector<Implementation const*> result;
+#ifdef ESSADB_X86_KERNELS
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            result.push_back(&avx2_kernels);
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            result.push_back(&sse41_kernels);
+        }
+#endif
+        result.push_back(&scalar_kernels);
+        return result;
+    }();
+    return implementations;
+}
+
+}
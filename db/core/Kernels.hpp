@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Tight loops over INT and FLOAT arrays, used to process columnar data.
+// There are SIMD implementations for some instruction sets; the fastest
+// one supported by the CPU is selected at runtime.
+//
+// Bitmaps have bit N % 64 of word N / 64 set for row N. Output bitmaps
+// must have at least bitmap_words(size) words.
+
+namespace Db::Core::Kernels {
+
+enum class Comparison {
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual
+};
+
+// Same as Value comparison operators, which are all defined in terms
+// of `<` and `==`. For FLOATs, this matters for NaNs.
+template<Comparison C, class T>
+inline bool compare_values(T lhs, T rhs) {
+    if constexpr (C == Comparison::Equal)
+        return lhs == rhs;
+    else if constexpr (C == Comparison::NotEqual)
+        return !(lhs == rhs);
+    else if constexpr (C == Comparison::Less)
+        return lhs < rhs;
+    else if constexpr (C == Comparison::LessEqual)
+        return lhs < rhs || lhs == rhs;
+    else if constexpr (C == Comparison::Greater)
+        return !(lhs < rhs) && !(lhs == rhs);
+    else
+        return !(lhs < rhs);
+}
+
+template<class Callback>
+inline auto visit_comparison(Comparison comparison, Callback&& callback) {
+    switch (comparison) {
+    case Comparison::Equal:
+        return callback(std::integral_constant<Comparison, Comparison::Equal> {});
+    case Comparison::NotEqual:
+        return callback(std::integral_constant<Comparison, Comparison::NotEqual> {});
+    case Comparison::Less:
+        return callback(std::integral_constant<Comparison, Comparison::Less> {});
+    case Comparison::LessEqual:
+        return callback(std::integral_constant<Comparison, Comparison::LessEqual> {});
+    case Comparison::Greater:
+        return callback(std::integral_constant<Comparison, Comparison::Greater> {});
+    case Comparison::GreaterEqual:
+        return callback(std::integral_constant<Comparison, Comparison::GreaterEqual> {});
+    }
+    __builtin_unreachable();
+}
+
+inline size_t bitmap_words(size_t size) { return (size + 63) / 64; }
+
+struct IntAggregate {
+    int64_t sum = 0;
+    int min = std::numeric_limits<int>::max();
+    int max = std::numeric_limits<int>::min();
+    size_t count = 0;
+};
+
+struct FloatAggregate {
+    double sum = 0;
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+    size_t count = 0;
+};
+
+// Kernels for a particular instruction set. All of them give the same
+// results, except for order of FLOAT additions.
+struct Implementation {
+    char const* name;
+
+    // Sets bits of rows for which `values[row] <comparison> constant`.
+    void (*compare_ints)(std::span<int const> values, Comparison, int constant, std::span<uint64_t> output);
+    void (*compare_floats)(std::span<float const> values, Comparison, float constant, std::span<uint64_t> output);
+
+    // Sets bits of rows for which `values[row] >= min && values[row] <= max`.
+    void (*between_ints)(std::span<int const> values, int min, int max, std::span<uint64_t> output);
+    void (*between_floats)(std::span<float const> values, float min, float max, std::span<uint64_t> output);
+
+    // Aggregates rows which bits are set in `mask`.
+    IntAggregate (*aggregate_ints)(std::span<int const> values, std::span<uint64_t const> mask);
+    FloatAggregate (*aggregate_floats)(std::span<float const> values, std::span<uint64_t const> mask);
+};
+
+// Implementations supported by this CPU, the fastest first. The last one
+// is portable scalar code.
+std::vector<Implementation const*> const& implementations();
+
+inline Implementation const& best() { return *implementations().front(); }
+inline Implementation const& scalar() { return *implementations().back(); }
+
+inline void compare(std::span<int const> values, Comparison comparison, int constant, std::span<uint64_t> output) {
+    best().compare_ints(values, comparison, constant, output);
+}
+inline void compare(std::span<float const> values, Comparison comparison, float constant, std::span<uint64_t> output) {
+    best().compare_floats(values, comparison, constant, output);
+}
+inline void between(std::span<int const> values, int min, int max, std::span<uint64_t> output) {
+    best().between_ints(values, min, max, output);
+}
+inline void between(std::span<float const> values, float min, float max, std::span<uint64_t> output) {
+    best().between_floats(values, min, max, output);
+}
+inline IntAggregate aggregate(std::span<int const> values, std::span<uint64_t const> mask) {
+    return best().aggregate_ints(values, mask);
+}
+inline FloatAggregate aggregate(std::span<float const> values, std::span<uint64_t const> mask) {
+    return best().aggregate_floats(values, mask);
+}
+
+}
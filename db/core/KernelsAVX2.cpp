@@ -0,0 +1,165 @@
+#include "KernelImplementations.hpp"
+
+#ifdef ESSADB_X86_KERNELS
+
+#    include <immintrin.h>
+
+#    pragma GCC push_options
+#    pragma GCC target("avx2")
+
+#    include "KernelsSIMD.hpp"
+
+namespace Db::Core::Kernels {
+
+// All lanes set for rows which bits are set in `bits`.
+static __m256i expand_8_bits(uint32_t bits) {
+    auto selector = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), selector), selector);
+}
+
+struct AVX2Ints {
+    using Element = int;
+    using Aggregate = IntAggregate;
+    using Vector = __m256i;
+    static constexpr size_t Lanes = 8;
+
+    static Vector load(int const* values) { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(values)); }
+    static Vector broadcast(int value) { return _mm256_set1_epi32(value); }
+    static uint32_t bits(Vector mask) { return _mm256_movemask_ps(_mm256_castsi256_ps(mask)); }
+
+    template<Comparison C>
+    static uint32_t compare(Vector values, Vector constant) {
+        if constexpr (C == Comparison::Equal)
+            return bits(_mm256_cmpeq_epi32(values, constant));
+        else if constexpr (C == Comparison::NotEqual)
+            return ~bits(_mm256_cmpeq_epi32(values, constant)) & 0xff;
+        else if constexpr (C == Comparison::Less)
+            return bits(_mm256_cmpgt_epi32(constant, values));
+        else if constexpr (C == Comparison::LessEqual)
+            return ~bits(_mm256_cmpgt_epi32(values, constant)) & 0xff;
+        else if constexpr (C == Comparison::Greater)
+            return bits(_mm256_cmpgt_epi32(values, constant));
+        else
+            return ~bits(_mm256_cmpgt_epi32(constant, values)) & 0xff;
+    }
+
+    static uint32_t between(Vector values, Vector min, Vector max) {
+        return ~bits(_mm256_or_si256(_mm256_cmpgt_epi32(min, values), _mm256_cmpgt_epi32(values, max))) & 0xff;
+    }
+
+    struct Accumulator {
+        __m256i sum_low;
+        __m256i sum_high;
+        __m256i min;
+        __m256i max;
+
+        Accumulator()
+            : sum_low(_mm256_setzero_si256())
+            , sum_high(_mm256_setzero_si256())
+            , min(_mm256_set1_epi32(std::numeric_limits<int>::max()))
+            , max(_mm256_set1_epi32(std::numeric_limits<int>::min())) {
+        }
+
+        void add(Vector values, uint32_t bits) {
+            auto lanes = expand_8_bits(bits);
+            auto masked = _mm256_and_si256(values, lanes);
+            sum_low = _mm256_add_epi64(sum_low, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(masked)));
+            sum_high = _mm256_add_epi64(sum_high, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(masked, 1)));
+            min = _mm256_min_epi32(min, _mm256_blendv_epi8(min, values, lanes));
+            max = _mm256_max_epi32(max, _mm256_blendv_epi8(max, values, lanes));
+        }
+
+        IntAggregate result() const {
+            alignas(32) int64_t sums[4];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(sums), _mm256_add_epi64(sum_low, sum_high));
+            alignas(32) int mins[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(mins), min);
+            alignas(32) int maxs[8];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), max);
+
+            IntAggregate result;
+            result.sum = sums[0] + sums[1] + sums[2] + sums[3];
+            result.min = *std::min_element(mins, mins + 8);
+            result.max = *std::max_element(maxs, maxs + 8);
+            return result;
+        }
+    };
+};
+
+struct AVX2Floats {
+    using Element = float;
+    using Aggregate = FloatAggregate;
+    using Vector = __m256;
+    static constexpr size_t Lanes = 8;
+
+    static Vector load(float const* values) { return _mm256_loadu_ps(values); }
+    static Vector broadcast(float value) { return _mm256_set1_ps(value); }
+
+    // Predicates that agree with compare_values() also for NaNs.
+    template<Comparison C>
+    static uint32_t compare(Vector values, Vector constant) {
+        if constexpr (C == Comparison::Equal)
+            return _mm256_movemask_ps(_mm256_cmp_ps(values, constant, _CMP_EQ_OQ));
+        else if constexpr (C == Comparison::NotEqual)
+            return _mm256_movemask_ps(_mm256_cmp_ps(values, constant, _CMP_NEQ_UQ));
+        else if constexpr (C == Comparison::Less)
+            return _mm256_movemask_ps(_mm256_cmp_ps(values, constant, _CMP_LT_OQ));
+        else if constexpr (C == Comparison::LessEqual)
+            return _mm256_movemask_ps(_mm256_cmp_ps(values, constant, _CMP_LE_OQ));
+        else if constexpr (C == Comparison::Greater)
+            return _mm256_movemask_ps(_mm256_cmp_ps(values, constant, _CMP_NLE_UQ));
+        else
+            return _mm256_movemask_ps(_mm256_cmp_ps(values, constant, _CMP_NLT_UQ));
+    }
+
+    static uint32_t between(Vector values, Vector min, Vector max) {
+        return _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(values, min, _CMP_NLT_UQ), _mm256_cmp_ps(values, max, _CMP_LE_OQ)));
+    }
+
+    struct Accumulator {
+        __m256d sum_low;
+        __m256d sum_high;
+        __m256 min;
+        __m256 max;
+
+        Accumulator()
+            : sum_low(_mm256_setzero_pd())
+            , sum_high(_mm256_setzero_pd())
+            , min(_mm256_set1_ps(std::numeric_limits<float>::infinity()))
+            , max(_mm256_set1_ps(-std::numeric_limits<float>::infinity())) {
+        }
+
+        void add(Vector values, uint32_t bits) {
+            auto lanes = _mm256_castsi256_ps(expand_8_bits(bits));
+            auto masked = _mm256_and_ps(values, lanes);
+            sum_low = _mm256_add_pd(sum_low, _mm256_cvtps_pd(_mm256_castps256_ps128(masked)));
+            sum_high = _mm256_add_pd(sum_high, _mm256_cvtps_pd(_mm256_extractf128_ps(masked, 1)));
+            // New value goes first, so that NaNs are skipped like in std::min().
+            min = _mm256_min_ps(_mm256_blendv_ps(min, values, lanes), min);
+            max = _mm256_max_ps(_mm256_blendv_ps(max, values, lanes), max);
+        }
+
+        FloatAggregate result() const {
+            alignas(32) double sums[4];
+            _mm256_store_pd(sums, _mm256_add_pd(sum_low, sum_high));
+            alignas(32) float mins[8];
+            _mm256_store_ps(mins, min);
+            alignas(32) float maxs[8];
+            _mm256_store_ps(maxs, max);
+
+            FloatAggregate result;
+            result.sum = sums[0] + sums[1] + sums[2] + sums[3];
+            result.min = *std::min_element(mins, mins + 8);
+            result.max = *std::max_element(maxs, maxs + 8);
+            return result;
+        }
+    };
+};
+
+Implementation const avx2_kernels = simd_kernels<AVX2Ints, AVX2Floats>("avx2");
+
+}
+
+#    pragma GCC pop_options
+
+#endif
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "KernelImplementations.hpp"
+
+// Block loops of the SIMD kernels, shared by the instruction-set specific
+// files. They are parametrized by traits of a vector of INTs or FLOATs:
+//
+//  - `Element`, `Aggregate` and `Vector` types, and the `Lanes` count,
+//  - `load()` of `Lanes` elements and `broadcast()` of a constant,
+//  - `compare<C>()` and `between()`, returning bits of matching lanes,
+//  - `Accumulator`, which `add()`s lanes which bits are set, and gives
+//    the `result()` without a count.
+//
+// Rows are processed in blocks of 64 (a bitmap word), the rest is left
+// to the scalar implementation.
+//
+// Include this after the `#pragma GCC target` of the including file, so
+// that the loops are compiled for its instruction set.
+
+namespace Db::Core::Kernels {
+
+template<class V>
+void compare_simd(std::span<typename V::Element const> values, Comparison comparison, typename V::Element constant, std::span<uint64_t> output) {
+    auto blocks = values.size() / 64;
+    visit_comparison(comparison, [&](auto c) {
+        auto constant_vector = V::broadcast(constant);
+        for (size_t b = 0; b < blocks; b++) {
+            uint64_t word = 0;
+            for (size_t s = 0; s < 64 / V::Lanes; s++) {
+                auto bits = V::template compare<decltype(c)::value>(V::load(&values[b * 64 + s * V::Lanes]), constant_vector);
+                word |= uint64_t { bits } << (s * V::Lanes);
+            }
+            output[b] = word;
+        }
+    });
+    if constexpr (std::is_same_v<typename V::Element, int>)
+        scalar_kernels.compare_ints(values.subspan(blocks * 64), comparison, constant, output.subspan(blocks));
+    else
+        scalar_kernels.compare_floats(values.subspan(blocks * 64), comparison, constant, output.subspan(blocks));
+}
+
+template<class V>
+void between_simd(std::span<typename V::Element const> values, typename V::Element min, typename V::Element max, std::span<uint64_t> output) {
+    auto blocks = values.size() / 64;
+    auto min_vector = V::broadcast(min);
+    auto max_vector = V::broadcast(max);
+    for (size_t b = 0; b < blocks; b++) {
+        uint64_t word = 0;
+        for (size_t s = 0; s < 64 / V::Lanes; s++) {
+            auto bits = V::between(V::load(&values[b * 64 + s * V::Lanes]), min_vector, max_vector);
+            word |= uint64_t { bits } << (s * V::Lanes);
+        }
+        output[b] = word;
+    }
+    if constexpr (std::is_same_v<typename V::Element, int>)
+        scalar_kernels.between_ints(values.subspan(blocks * 64), min, max, output.subspan(blocks));
+    else
+        scalar_kernels.between_floats(values.subspan(blocks * 64), min, max, output.subspan(blocks));
+}
+
+template<class V>
+typename V::Aggregate aggregate_simd(std::span<typename V::Element const> values, std::span<uint64_t const> mask) {
+    auto blocks = values.size() / 64;
+    constexpr uint64_t LaneBits = (uint64_t { 1 } << V::Lanes) - 1;
+
+    typename V::Accumulator accumulator;
+    size_t count = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        auto word = mask[b];
+        if (word == 0) {
+            continue;
+        }
+        count += __builtin_popcountll(word);
+        for (size_t s = 0; s < 64 / V::Lanes; s++) {
+            auto bits = static_cast<uint32_t>((word >> (s * V::Lanes)) & LaneBits);
+            accumulator.add(V::load(&values[b * 64 + s * V::Lanes]), bits);
+        }
+    }
+
+    auto result = accumulator.result();
+    result.count = count;
+    if constexpr (std::is_same_v<typename V::Element, int>)
+        merge(result, scalar_kernels.aggregate_ints(values.subspan(blocks * 64), mask.subspan(blocks)));
+    else
+        merge(result, scalar_kernels.aggregate_floats(values.subspan(blocks * 64), mask.subspan(blocks)));
+    return result;
+}
+
+template<class Ints, class Floats>
+constexpr Implementation simd_kernels(char const* name) {
+    return {
+        .name = name,
+        .compare_ints = compare_simd<Ints>,
+        .compare_floats = compare_simd<Floats>,
+        .between_ints = between_simd<Ints>,
+        .between_floats = between_simd<Floats>,
+        .aggregate_ints = aggregate_simd<Ints>,
+        .aggregate_floats = aggregate_simd<Floats>,
+    };
+}
+
+}
@@ -0,0 +1,165 @@
+#include "KernelImplementations.hpp"
+
+#ifdef ESSADB_X86_KERNELS
+
+#    include <immintrin.h>
+
+#    pragma GCC push_options
+#    pragma GCC target("sse4.1")
+
+#    include "KernelsSIMD.hpp"
+
+namespace Db::Core::Kernels {
+
+// All lanes set for rows which bits are set in `bits`.
+static __m128i expand_4_bits(uint32_t bits) {
+    auto selector = _mm_setr_epi32(1, 2, 4, 8);
+    return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), selector), selector);
+}
+
+struct SSE41Ints {
+    using Element = int;
+    using Aggregate = IntAggregate;
+    using Vector = __m128i;
+    static constexpr size_t Lanes = 4;
+
+    static Vector load(int const* values) { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(values)); }
+    static Vector broadcast(int value) { return _mm_set1_epi32(value); }
+    static uint32_t bits(Vector mask) { return _mm_movemask_ps(_mm_castsi128_ps(mask)); }
+
+    template<Comparison C>
+    static uint32_t compare(Vector values, Vector constant) {
+        if constexpr (C == Comparison::Equal)
+            return bits(_mm_cmpeq_epi32(values, constant));
+        else if constexpr (C == Comparison::NotEqual)
+            return ~bits(_mm_cmpeq_epi32(values, constant)) & 0xf;
+        else if constexpr (C == Comparison::Less)
+            return bits(_mm_cmpgt_epi32(constant, values));
+        else if constexpr (C == Comparison::LessEqual)
+            return ~bits(_mm_cmpgt_epi32(values, constant)) & 0xf;
+        else if constexpr (C == Comparison::Greater)
+            return bits(_mm_cmpgt_epi32(values, constant));
+        else
+            return ~bits(_mm_cmpgt_epi32(constant, values)) & 0xf;
+    }
+
+    static uint32_t between(Vector values, Vector min, Vector max) {
+        return ~bits(_mm_or_si128(_mm_cmpgt_epi32(min, values), _mm_cmpgt_epi32(values, max))) & 0xf;
+    }
+
+    struct Accumulator {
+        __m128i sum_low;
+        __m128i sum_high;
+        __m128i min;
+        __m128i max;
+
+        Accumulator()
+            : sum_low(_mm_setzero_si128())
+            , sum_high(_mm_setzero_si128())
+            , min(_mm_set1_epi32(std::numeric_limits<int>::max()))
+            , max(_mm_set1_epi32(std::numeric_limits<int>::min())) {
+        }
+
+        void add(Vector values, uint32_t bits) {
+            auto lanes = expand_4_bits(bits);
+            auto masked = _mm_and_si128(values, lanes);
+            sum_low = _mm_add_epi64(sum_low, _mm_cvtepi32_epi64(masked));
+            sum_high = _mm_add_epi64(sum_high, _mm_cvtepi32_epi64(_mm_srli_si128(masked, 8)));
+            min = _mm_min_epi32(min, _mm_blendv_epi8(min, values, lanes));
+            max = _mm_max_epi32(max, _mm_blendv_epi8(max, values, lanes));
+        }
+
+        IntAggregate result() const {
+            alignas(16) int64_t sums[2];
+            _mm_store_si128(reinterpret_cast<__m128i*>(sums), _mm_add_epi64(sum_low, sum_high));
+            alignas(16) int mins[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(mins), min);
+            alignas(16) int maxs[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(maxs), max);
+
+            IntAggregate result;
+            result.sum = sums[0] + sums[1];
+            result.min = *std::min_element(mins, mins + 4);
+            result.max = *std::max_element(maxs, maxs + 4);
+            return result;
+        }
+    };
+};
+
+struct SSE41Floats {
+    using Element = float;
+    using Aggregate = FloatAggregate;
+    using Vector = __m128;
+    static constexpr size_t Lanes = 4;
+
+    static Vector load(float const* values) { return _mm_loadu_ps(values); }
+    static Vector broadcast(float value) { return _mm_set1_ps(value); }
+
+    // Predicates that agree with compare_values() also for NaNs.
+    template<Comparison C>
+    static uint32_t compare(Vector values, Vector constant) {
+        if constexpr (C == Comparison::Equal)
+            return _mm_movemask_ps(_mm_cmpeq_ps(values, constant));
+        else if constexpr (C == Comparison::NotEqual)
+            return _mm_movemask_ps(_mm_cmpneq_ps(values, constant));
+        else if constexpr (C == Comparison::Less)
+            return _mm_movemask_ps(_mm_cmplt_ps(values, constant));
+        else if constexpr (C == Comparison::LessEqual)
+            return _mm_movemask_ps(_mm_cmple_ps(values, constant));
+        else if constexpr (C == Comparison::Greater)
+            return _mm_movemask_ps(_mm_cmpnle_ps(values, constant));
+        else
+            return _mm_movemask_ps(_mm_cmpnlt_ps(values, constant));
+    }
+
+    static uint32_t between(Vector values, Vector min, Vector max) {
+        return _mm_movemask_ps(_mm_and_ps(_mm_cmpnlt_ps(values, min), _mm_cmple_ps(values, max)));
+    }
+
+    struct Accumulator {
+        __m128d sum_low;
+        __m128d sum_high;
+        __m128 min;
+        __m128 max;
+
+        Accumulator()
+            : sum_low(_mm_setzero_pd())
+            , sum_high(_mm_setzero_pd())
+            , min(_mm_set1_ps(std::numeric_limits<float>::infinity()))
+            , max(_mm_set1_ps(-std::numeric_limits<float>::infinity())) {
+        }
+
+        void add(Vector values, uint32_t bits) {
+            auto lanes = _mm_castsi128_ps(expand_4_bits(bits));
+            auto masked = _mm_and_ps(values, lanes);
+            sum_low = _mm_add_pd(sum_low, _mm_cvtps_pd(masked));
+            sum_high = _mm_add_pd(sum_high, _mm_cvtps_pd(_mm_movehl_ps(masked, masked)));
+            // New value goes first, so that NaNs are skipped like in std::min().
+            min = _mm_min_ps(_mm_blendv_ps(min, values, lanes), min);
+            max = _mm_max_ps(_mm_blendv_ps(max, values, lanes), max);
+        }
+
+        FloatAggregate result() const {
+            alignas(16) double sums[2];
+            _mm_store_pd(sums, _mm_add_pd(sum_low, sum_high));
+            alignas(16) float mins[4];
+            _mm_store_ps(mins, min);
+            alignas(16) float maxs[4];
+            _mm_store_ps(maxs, max);
+
+            FloatAggregate result;
+            result.sum = sums[0] + sums[1];
+            result.min = *std::min_element(mins, mins + 4);
+            result.max = *std::max_element(maxs, maxs + 4);
+            return result;
+        }
+    };
+};
+
+Implementation const sse41_kernels = simd_kernels<SSE41Ints, SSE41Floats>("sse4.1");
+
+}
+
+#    pragma GCC pop_options
+
+#endif
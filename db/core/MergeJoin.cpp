@@ -0,0 +1,206 @@
+#include "Join.hpp"
+
+#include "Index.hpp"
+#include "IndexedRelation.hpp"
+#include "JoinImplementation.hpp"
+
+#include <deque>
+#include <fmt/format.h>
+
+namespace Db::Core {
+
+namespace {
+
+// Reads rows of a join side in the order of its key, either directly if
+// the relation is sorted already, or through its ordered index.
+class SortedReader {
+public:
+    explicit SortedReader(JoinSide const& side)
+        : m_key_column(side.key_column) {
+        if (side.relation->sorted_by() == side.key_column) {
+            m_iterator.emplace(side.relation->rows());
+            return;
+        }
+        m_relation = side.relation->indexed_relation();
+        assert(m_relation);
+        auto index = m_relation->ordered_index_for_column(side.key_column);
+        assert(index);
+        m_row_ids = index->find_range(std::nullopt, std::nullopt);
+    }
+
+    // Returns nullopt after the last row.
+    std::optional<Tuple> next() {
+        if (m_iterator) {
+            auto row = m_iterator->next();
+            if (!row) {
+                return {};
+            }
+            return row->read();
+        }
+        if (m_next_row >= m_row_ids.size()) {
+            return {};
+        }
+        return m_relation->read_row(m_row_ids[m_next_row++]);
+    }
+
+    size_t key_column() const { return m_key_column; }
+
+private:
+    size_t m_key_column;
+
+    std::optional<RelationIterator> m_iterator;
+
+    IndexedRelation const* m_relation = nullptr;
+    std::vector<RowId> m_row_ids;
+    size_t m_next_row = 0;
+};
+
+std::string describe_order(JoinSide const& side) {
+    if (side.relation->sorted_by() == side.key_column) {
+        return "sorted";
+    }
+    return fmt::format("read by index '{}'", side.relation->indexed_relation()->ordered_index_for_column(side.key_column)->name());
+}
+
+class MergeJoinRelation : public JoinRelation {
+public:
+    MergeJoinRelation(JoinSide lhs, JoinSide rhs, JoinType type)
+        : JoinRelation(std::move(lhs), std::move(rhs), type) { }
+
+    virtual RelationIterator rows() const override;
+    virtual std::vector<std::string> explain() const override {
+        return explain_join(fmt::format("Merge join ({}), left side {}, right side {}",
+            join_type_to_string(type()), describe_order(lhs()), describe_order(rhs())));
+    }
+};
+
+// The right side is read in groups of rows with equal keys. Each left
+// row with that key is joined with the whole group.
+class MergeJoinIteratorImpl : public JoinIteratorImpl {
+public:
+    explicit MergeJoinIteratorImpl(MergeJoinRelation const& join)
+        : JoinIteratorImpl(join)
+        , m_join(join)
+        , m_lhs(join.lhs())
+        , m_rhs(join.rhs()) {
+        m_lhs_row = m_lhs.next();
+        m_rhs_row = m_rhs.next();
+    }
+
+private:
+    virtual DbErrorOr<std::optional<Tuple>> next_tuple() override {
+        while (m_pending.empty()) {
+            if (!step()) {
+                return std::optional<Tuple> {};
+            }
+        }
+        auto tuple = std::move(m_pending.front());
+        m_pending.pop_front();
+        return std::optional<Tuple> { std::move(tuple) };
+    }
+
+    // Consumes at least one row, possibly adding output rows to m_pending.
+    // Returns false if there is nothing more to output.
+    bool step() {
+        auto lhs_key = m_lhs_row ? join_key(m_lhs_row->value(m_lhs.key_column())) : std::nullopt;
+
+        if (!m_group.empty()) {
+            if (lhs_key && compare_join_keys(*lhs_key, m_group_key) == 0) {
+                for (auto const& rhs_row : m_group) {
+                    m_pending.push_back(m_join.joined_tuple(&*m_lhs_row, &rhs_row));
+                }
+                m_lhs_row = m_lhs.next();
+                return true;
+            }
+            m_group.clear();
+        }
+
+        if (!m_lhs_row && !m_rhs_row) {
+            return false;
+        }
+        if (!m_lhs_row) {
+            if (!m_join.preserve_rhs()) {
+                return false;
+            }
+            emit_unmatched_rhs();
+            return true;
+        }
+        if (!m_rhs_row) {
+            if (!m_join.preserve_lhs()) {
+                return false;
+            }
+            emit_unmatched_lhs();
+            return true;
+        }
+
+        // NULLs never match, but they may be anywhere in the order.
+        if (!lhs_key) {
+            emit_unmatched_lhs();
+            return true;
+        }
+        auto rhs_key = join_key(m_rhs_row->value(m_rhs.key_column()));
+        if (!rhs_key) {
+            emit_unmatched_rhs();
+            return true;
+        }
+
+        auto comparison = compare_join_keys(*lhs_key, *rhs_key);
+        if (comparison < 0) {
+            emit_unmatched_lhs();
+        }
+        else if (comparison > 0) {
+            emit_unmatched_rhs();
+        }
+        else {
+            m_group_key = std::move(*rhs_key);
+            while (m_rhs_row) {
+                auto key = join_key(m_rhs_row->value(m_rhs.key_column()));
+                if (!key || compare_join_keys(*key, m_group_key) != 0) {
+                    break;
+                }
+                m_group.push_back(std::move(*m_rhs_row));
+                m_rhs_row = m_rhs.next();
+            }
+        }
+        return true;
+    }
+
+    void emit_unmatched_lhs() {
+        if (m_join.preserve_lhs()) {
+            m_pending.push_back(m_join.joined_tuple(&*m_lhs_row, nullptr));
+        }
+        m_lhs_row = m_lhs.next();
+    }
+
+    void emit_unmatched_rhs() {
+        if (m_join.preserve_rhs()) {
+            m_pending.push_back(m_join.joined_tuple(nullptr, &*m_rhs_row));
+        }
+        m_rhs_row = m_rhs.next();
+    }
+
+    MergeJoinRelation const& m_join;
+    SortedReader m_lhs;
+    SortedReader m_rhs;
+    std::optional<Tuple> m_lhs_row;
+    std::optional<Tuple> m_rhs_row;
+
+    // Right rows with key equal to m_group_key, that left rows are joined
+    // with.
+    std::vector<Tuple> m_group;
+    Value m_group_key;
+
+    std::deque<Tuple> m_pending;
+};
+
+RelationIterator MergeJoinRelation::rows() const {
+    return RelationIterator { std::make_unique<MergeJoinIteratorImpl>(*this) };
+}
+
+}
+
+DbErrorOr<std::unique_ptr<Relation>> merge_join(JoinSide lhs, JoinSide rhs, JoinType type) {
+    return std::make_unique<MergeJoinRelation>(std::move(lhs), std::move(rhs), type);
+}
+
+}
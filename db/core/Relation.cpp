@@ -1,22 +1,67 @@
 #include "Relation.hpp"
 
+#include <db/core/IndexedRelation.hpp>
+#include <db/core/UndoLog.hpp>
+
 namespace Db::Core {
 
-std::optional<Tuple const*> Relation::find_first_matching_tuple(size_t column, Value value) {
-    std::optional<Tuple const*> tuple;
-    rows().for_each_row([&](auto const& row) {
-        // FIXME: Stop iterating if value is found.
-        if (tuple) {
-            return;
+DbErrorOr<void> MutableMemoryBackedRelationIteratorImpl::RowReferenceImpl::write(Tuple const& tuple) {
+    if (m_undo_log && m_undo_log->is_active()) {
+        m_undo_log->record([relation = m_relation, it = m_it, old_tuple = *m_it]() -> DbErrorOr<void> {
+            if (relation) {
+                TRY(relation->reindex_row(*it, old_tuple, reinterpret_cast<RowId>(&*it)));
+            }
+            *it = old_tuple;
+            return {};
+        });
+    }
+    if (m_relation) {
+        TRY(m_relation->reindex_row(*m_it, tuple, row_id()));
+    }
+    *m_it = tuple;
+    return {};
+}
+
+DbErrorOr<void> MutableMemoryBackedRelationIteratorImpl::RowReferenceImpl::remove() {
+    if (m_relation) {
+        TRY(m_relation->unindex_row(*m_it, row_id()));
+    }
+    if (!m_undo_log || !m_undo_log->is_active()) {
+        m_list.erase(m_it);
+        return {};
+    }
+    // The row is moved out of the list without being destroyed, so that it
+    // can be put back at its place with the same row id.
+    auto removed = std::make_shared<List>();
+    auto next = std::next(m_it);
+    removed->splice(removed->end(), m_list, m_it);
+    m_undo_log->record([&list = m_list, relation = m_relation, removed, next]() -> DbErrorOr<void> {
+        auto it = removed->begin();
+        list.splice(next, *removed, it);
+        if (relation) {
+            TRY(relation->index_row(*it, reinterpret_cast<RowId>(&*it)));
         }
-        if (row.value(column).type() != value.type()) {
-            return;
+        return {};
+    });
+    return {};
+}
+
+std::vector<std::string> Relation::explain() const {
+    return { "Scan" };
+}
+
+std::optional<Tuple> Relation::find_first_matching_tuple(size_t column, Value const& value) const {
+    auto it = rows();
+    for (auto row = it.next(); row; row = it.next()) {
+        auto tuple = row->read();
+        if (tuple.value(column).type() != value.type()) {
+            continue;
         }
-        if (MUST(row.value(column) == value)) {
-            tuple = &row;
+        if (MUST(tuple.value(column) == value)) {
+            return tuple;
         }
-    });
-    return tuple;
+    }
+    return {};
 }
 
 std::optional<Relation::ResolvedColumn> Relation::get_column(std::string const& name) const {
@@ -1,26 +1,38 @@
 #pragma once
 
+#include "Batch.hpp"
 #include "Column.hpp"
 #include "Tuple.hpp"
 
 #include <EssaUtil/Config.hpp>
 #include <EssaUtil/Error.hpp>
+#include <cstdint>
 #include <list>
 #include <memory>
+#include <optional>
+#include <string>
 #include <type_traits>
 #include <vector>
 
 namespace Db::Core {
 
+class IndexedRelation;
+class UndoLog;
+
+// Opaque, storage-engine specific identifier of a row. It stays valid as
+// long as the row is not removed.
+using RowId = uint64_t;
+
 class RowReference {
 public:
     RowReference() = default;
     virtual ~RowReference() = default;
     virtual Tuple read() const = 0;
-    virtual void write(Tuple const&) = 0;
+    virtual DbErrorOr<void> write(Tuple const&) = 0;
+    virtual RowId row_id() const = 0;
 
     // Remove a row. This must NOT invalidate other references.
-    virtual void remove() = 0;
+    virtual DbErrorOr<void> remove() = 0;
     virtual std::unique_ptr<RowReference> clone() const = 0;
 };
 
@@ -86,6 +98,9 @@ private:
     std::unique_ptr<RelationIteratorImpl> m_impl {};
 };
 
+// Number of rows that are read by a single task of a parallel scan.
+constexpr size_t MorselSize = 16384;
+
 // A database thing that has columns and rows. Note that it *doesn't allow*
 // modifying a table; iterator returns a tuple as a value (For example, join
 // or subquery result cannot be modified).
@@ -102,9 +117,39 @@ public:
     virtual size_t size() const = 0;
 
     // Find tuple that which `column`-th value is equal to `value`.
-    // By default, this just iterates over the table; this may be
-    // optimized by indexes in the future.
-    virtual std::optional<Tuple const*> find_first_matching_tuple(size_t column, Value value);
+    // By default, this just iterates over the table until a match
+    // is found; IndexedRelation uses indexes if possible.
+    virtual std::optional<Tuple> find_first_matching_tuple(size_t column, Value const& value) const;
+
+    // Relation that holds the actual rows and indexes of this relation,
+    // if there is one. This is used to look up rows using indexes.
+    virtual IndexedRelation const* indexed_relation() const { return nullptr; }
+
+    // Reader of rows in batches, for relations that store values by
+    // column. Returns nullptr if batches are not supported.
+    virtual std::unique_ptr<BatchReader> batches() const { return nullptr; }
+
+    // Consecutive ranges of about `rows_per_morsel` rows, in the order of
+    // rows(), that may be read by different threads at the same time.
+    // Returns an empty vector if rows can't be read this way.
+    virtual std::vector<RelationIterator> morsels(size_t /* rows_per_morsel */) const { return {}; }
+
+    // Number of rows, possibly approximate, for relations for which size()
+    // needs to compute all rows (e.g. joins). Used to plan joins.
+    virtual size_t estimated_size() const { return size(); }
+
+    // Column by which rows are known to be sorted in ascending order (see
+    // compare_join_keys()), if any. Used to plan joins.
+    virtual std::optional<size_t> sorted_by() const { return {}; }
+
+    // Iterators can't return errors, so relations which rows are computed
+    // in a way that may fail (e.g joins that spill to disk) end the rows
+    // early and keep the error here. Whoever reads all rows must check it.
+    virtual DbErrorOr<void> read_error() const { return {}; }
+
+    // Lines describing how rows are produced, for EXPLAIN. Lines of
+    // relations that this one reads from are indented.
+    virtual std::vector<std::string> explain() const;
 
     struct ResolvedColumn {
         size_t index;
@@ -125,8 +170,12 @@ public:
     using Iterator = List::const_iterator;
 
     explicit MemoryBackedRelationIteratorImpl(List const& list)
-        : m_list(list)
-        , m_current(list.begin()) { }
+        : MemoryBackedRelationIteratorImpl(list.begin(), list.end()) { }
+
+    // Iterates over rows in [begin, end).
+    MemoryBackedRelationIteratorImpl(Iterator begin, Iterator end)
+        : m_current(begin)
+        , m_end(end) { }
 
     class RowReferenceImpl : public RowReference {
     public:
@@ -137,10 +186,13 @@ public:
         virtual Tuple read() const override {
             return *m_it;
         }
-        virtual void write(Tuple const&) override {
+        virtual DbErrorOr<void> write(Tuple const&) override {
             ESSA_UNREACHABLE;
         }
-        virtual void remove() override {
+        virtual RowId row_id() const override {
+            return reinterpret_cast<RowId>(&*m_it);
+        }
+        virtual DbErrorOr<void> remove() override {
             ESSA_UNREACHABLE;
         }
         virtual std::unique_ptr<RowReference> clone() const override {
@@ -152,42 +204,47 @@ public:
     };
 
     virtual std::unique_ptr<RowReference> next() override {
-        if (m_current == m_list.end())
+        if (m_current == m_end)
             return {};
         return std::make_unique<RowReferenceImpl>(m_current++);
     }
 
 private:
-    List const& m_list;
     Iterator m_current;
+    Iterator m_end;
 };
 
 // An abstract table iterator that iterates over a container
-// of rows stored in memory.
+// of rows stored in memory. If `relation` is given, its indexes
+// are updated on every write and remove.
 class MutableMemoryBackedRelationIteratorImpl : public RelationIteratorImpl {
 public:
     using List = std::list<Tuple>;
     using Iterator = List::iterator;
 
-    explicit MutableMemoryBackedRelationIteratorImpl(List& list)
+    // Changes are recorded in `undo_log` if a transaction is running.
+    explicit MutableMemoryBackedRelationIteratorImpl(List& list, IndexedRelation* relation = nullptr, UndoLog* undo_log = nullptr)
         : m_list(list)
+        , m_relation(relation)
+        , m_undo_log(undo_log)
         , m_current(list.begin()) { }
 
     class RowReferenceImpl : public RowReference {
     public:
-        explicit RowReferenceImpl(List& list, Iterator it)
+        explicit RowReferenceImpl(List& list, IndexedRelation* relation, UndoLog* undo_log, Iterator it)
             : m_list(list)
+            , m_relation(relation)
+            , m_undo_log(undo_log)
             , m_it(it) {
         }
 
         virtual Tuple read() const override {
             return *m_it;
         }
-        virtual void write(Tuple const& tuple) override {
-            *m_it = tuple;
-        }
-        virtual void remove() override {
-            m_list.erase(m_it);
+        virtual DbErrorOr<void> write(Tuple const& tuple) override;
+        virtual DbErrorOr<void> remove() override;
+        virtual RowId row_id() const override {
+            return reinterpret_cast<RowId>(&*m_it);
         }
         virtual std::unique_ptr<RowReference> clone() const override {
             return std::make_unique<RowReferenceImpl>(*this);
@@ -195,17 +252,21 @@ public:
 
     private:
         List& m_list;
+        IndexedRelation* m_relation;
+        UndoLog* m_undo_log;
         Iterator m_it;
     };
 
     virtual std::unique_ptr<RowReference> next() override {
         if (m_current == m_list.end())
             return {};
-        return std::make_unique<RowReferenceImpl>(m_list, m_current++);
+        return std::make_unique<RowReferenceImpl>(m_list, m_relation, m_undo_log, m_current++);
     }
 
 private:
     List& m_list;
+    IndexedRelation* m_relation;
+    UndoLog* m_undo_log;
     Iterator m_current;
 };
 
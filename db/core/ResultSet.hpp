@@ -21,6 +21,7 @@ public:
     ~ResultSet();
 
     std::vector<Tuple> const& rows() const { return m_rows; }
+    std::vector<Tuple> release_rows() && { return std::move(m_rows); }
     std::vector<std::string> column_names() const { return m_column_names; }
     DbErrorOr<bool> compare(ResultSet const&) const;
 
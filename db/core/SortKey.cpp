@@ -0,0 +1,96 @@
+#include "SortKey.hpp"
+
+#include <bit>
+#include <cstdint>
+
+namespace Db::Core {
+
+// Types that are ordered differently get different tags, in the order of
+// the types.
+enum class SortKeyTag : uint8_t {
+    Null,
+    Number,
+    Varchar,
+    Bool,
+    Time,
+};
+
+template<class T>
+static void append_big_endian(std::string& key, T value) {
+    for (size_t s = sizeof(T); s > 0; s--) {
+        key.push_back(static_cast<char>((value >> ((s - 1) * 8)) & 0xff));
+    }
+}
+
+// Both INTs and FLOATs are converted to doubles, which represent them
+// exactly.
+static void append_number(std::string& key, double d) {
+    // -0 is equal to 0.
+    if (d == 0) {
+        d = 0;
+    }
+    auto bits = std::bit_cast<uint64_t>(d);
+    // Negative numbers are ordered backwards by their magnitude.
+    constexpr uint64_t SignBit = uint64_t { 1 } << 63;
+    bits = (bits & SignBit) ? ~bits : (bits | SignBit);
+    append_big_endian(key, bits);
+}
+
+static void append_value(std::string& key, Value const& value) {
+    auto append_tag = [&](SortKeyTag tag) {
+        key.push_back(static_cast<char>(tag));
+    };
+
+    switch (value.type()) {
+    case Value::Type::Null:
+        append_tag(SortKeyTag::Null);
+        return;
+    case Value::Type::Int:
+        append_tag(SortKeyTag::Number);
+        append_number(key, std::get<int>(value));
+        return;
+    case Value::Type::Float:
+        append_tag(SortKeyTag::Number);
+        append_number(key, std::get<float>(value));
+        return;
+    case Value::Type::Varchar:
+        append_tag(SortKeyTag::Varchar);
+        // Zero bytes are escaped, so that a terminator sorts before any
+        // byte and shorter strings come before their extensions.
+        for (auto c : std::get<std::string>(value)) {
+            key.push_back(c);
+            if (c == 0) {
+                key.push_back(static_cast<char>(0xff));
+            }
+        }
+        key.push_back(0);
+        key.push_back(0);
+        return;
+    case Value::Type::Bool:
+        append_tag(SortKeyTag::Bool);
+        key.push_back(std::get<bool>(value) ? 1 : 0);
+        return;
+    case Value::Type::Time:
+        append_tag(SortKeyTag::Time);
+        // Flipping the sign bit makes two's complement order unsigned.
+        append_big_endian(key, static_cast<uint64_t>(std::get<Date>(value).to_utc_epoch()) ^ (uint64_t { 1 } << 63));
+        return;
+    }
+    __builtin_unreachable();
+}
+
+std::string SortKeyEncoder::encode(std::vector<Value> const& values) const {
+    std::string key;
+    for (size_t s = 0; s < values.size(); s++) {
+        auto column_start = key.size();
+        append_value(key, values[s]);
+        if (m_descending[s]) {
+            for (size_t i = column_start; i < key.size(); i++) {
+                key[i] = static_cast<char>(~key[i]);
+            }
+        }
+    }
+    return key;
+}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Value.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Db::Core {
+
+// Encodes tuples of values into byte strings that compare (bytewise, like
+// std::string and memcmp) in the same order as the values compared one by
+// one with `<` and `==`, so that sorting doesn't have to compare Values.
+// NULLs come first, descending columns have their bytes inverted.
+//
+// Values of different types are compared by converting one to the type of
+// the other, which is not a consistent order, so keys order them by type
+// instead. INTs and FLOATs are both numbers and are compared numerically.
+class SortKeyEncoder {
+public:
+    explicit SortKeyEncoder(std::vector<bool> descending)
+        : m_descending(std::move(descending)) { }
+
+    std::string encode(std::vector<Value> const&) const;
+
+private:
+    std::vector<bool> m_descending;
+};
+
+}
@@ -0,0 +1,199 @@
+#include "SpillFile.hpp"
+
+#include <EssaUtil/Config.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fmt/format.h>
+#include <unistd.h>
+#include <utility>
+
+namespace Db::Core {
+
+static constexpr size_t WriteBufferSize = 64 * 1024;
+static constexpr size_t ReadBufferSize = 64 * 1024;
+
+static DbError os_error(std::string const& action) {
+    return DbError { fmt::format("Failed to {} spill file: {}", action, strerror(errno)) };
+}
+
+template<class T>
+static void append(std::string& buffer, T value) {
+    buffer.append(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+static void serialize_value(std::string& buffer, Value const& value) {
+    append(buffer, static_cast<uint8_t>(value.type()));
+    switch (value.type()) {
+    case Value::Type::Null:
+        return;
+    case Value::Type::Int:
+        append(buffer, std::get<int>(value));
+        return;
+    case Value::Type::Float:
+        append(buffer, std::get<float>(value));
+        return;
+    case Value::Type::Varchar: {
+        auto const& string = std::get<std::string>(value);
+        append(buffer, static_cast<uint32_t>(string.size()));
+        buffer.append(string);
+        return;
+    }
+    case Value::Type::Bool:
+        append(buffer, static_cast<uint8_t>(std::get<bool>(value)));
+        return;
+    case Value::Type::Time:
+        append(buffer, std::get<Date>(value));
+        return;
+    }
+    ESSA_UNREACHABLE;
+}
+
+DbErrorOr<SpillFile> SpillFile::create() {
+    auto path = (std::filesystem::temp_directory_path() / "essadb-spill-XXXXXX").string();
+    int fd = mkstemp(path.data());
+    if (fd < 0) {
+        return os_error("create");
+    }
+    unlink(path.c_str());
+    return SpillFile { fd };
+}
+
+SpillFile::SpillFile(SpillFile&& other)
+    : m_fd(std::exchange(other.m_fd, -1))
+    , m_write_buffer(std::move(other.m_write_buffer))
+    , m_size(other.m_size)
+    , m_row_count(other.m_row_count) { }
+
+SpillFile& SpillFile::operator=(SpillFile&& other) {
+    if (this == &other) {
+        return *this;
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+    m_fd = std::exchange(other.m_fd, -1);
+    m_write_buffer = std::move(other.m_write_buffer);
+    m_size = other.m_size;
+    m_row_count = other.m_row_count;
+    return *this;
+}
+
+SpillFile::~SpillFile() {
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+DbErrorOr<void> SpillFile::write(Tuple const& tuple) {
+    append(m_write_buffer, static_cast<uint32_t>(tuple.value_count()));
+    for (auto const& value : tuple) {
+        serialize_value(m_write_buffer, value);
+    }
+    m_row_count++;
+    if (m_write_buffer.size() >= WriteBufferSize) {
+        TRY(flush());
+    }
+    return {};
+}
+
+DbErrorOr<void> SpillFile::flush() {
+    size_t written = 0;
+    while (written < m_write_buffer.size()) {
+        auto result = pwrite(m_fd, m_write_buffer.data() + written, m_write_buffer.size() - written, m_size + written);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return os_error("write");
+        }
+        written += result;
+    }
+    m_size += written;
+    m_write_buffer.clear();
+    return {};
+}
+
+// Makes sure that at least `size` bytes are buffered. Returns false if
+// the file ends before that.
+DbErrorOr<bool> SpillFile::Reader::fill(size_t size) {
+    if (m_buffer.size() - m_buffer_offset >= size) {
+        return true;
+    }
+    m_buffer.erase(0, m_buffer_offset);
+    m_buffer_offset = 0;
+    while (m_buffer.size() < size) {
+        auto old_size = m_buffer.size();
+        auto to_read = std::max(ReadBufferSize, size - old_size);
+        m_buffer.resize(old_size + to_read);
+        auto result = pread(m_file.m_fd, m_buffer.data() + old_size, to_read, m_file_offset);
+        if (result < 0) {
+            m_buffer.resize(old_size);
+            if (errno == EINTR) {
+                continue;
+            }
+            return os_error("read");
+        }
+        m_buffer.resize(old_size + result);
+        m_file_offset += result;
+        if (result == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+DbErrorOr<std::optional<Tuple>> SpillFile::Reader::next() {
+    auto read_value = [&]<class T>() -> DbErrorOr<T> {
+        if (!TRY(fill(sizeof(T)))) {
+            return DbError { "Spill file is truncated" };
+        }
+        T value;
+        memcpy(&value, m_buffer.data() + m_buffer_offset, sizeof(T));
+        m_buffer_offset += sizeof(T);
+        return value;
+    };
+
+    if (!TRY(fill(sizeof(uint32_t)))) {
+        return std::optional<Tuple> {};
+    }
+    auto value_count = TRY(read_value.operator()<uint32_t>());
+
+    std::vector<Value> values;
+    values.reserve(value_count);
+    for (size_t s = 0; s < value_count; s++) {
+        auto type = static_cast<Value::Type>(TRY(read_value.operator()<uint8_t>()));
+        switch (type) {
+        case Value::Type::Null:
+            values.push_back(Value::null());
+            break;
+        case Value::Type::Int:
+            values.push_back(Value::create_int(TRY(read_value.operator()<int>())));
+            break;
+        case Value::Type::Float:
+            values.push_back(Value::create_float(TRY(read_value.operator()<float>())));
+            break;
+        case Value::Type::Varchar: {
+            auto length = TRY(read_value.operator()<uint32_t>());
+            if (!TRY(fill(length))) {
+                return DbError { "Spill file is truncated" };
+            }
+            values.push_back(Value::create_varchar(m_buffer.substr(m_buffer_offset, length)));
+            m_buffer_offset += length;
+            break;
+        }
+        case Value::Type::Bool:
+            values.push_back(Value::create_bool(TRY(read_value.operator()<uint8_t>())));
+            break;
+        case Value::Type::Time:
+            values.push_back(Value::create_time(TRY(read_value.operator()<Date>())));
+            break;
+        default:
+            return DbError { "Spill file is corrupted" };
+        }
+    }
+    return Tuple { std::move(values) };
+}
+
+}
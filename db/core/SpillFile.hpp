@@ -0,0 +1,61 @@
+#pragma once
+
+#include "DbError.hpp"
+#include "Tuple.hpp"
+
+#include <optional>
+#include <string>
+
+namespace Db::Core {
+
+// Anonymous temporary file that holds rows that don't fit in memory, e.g.
+// partitions of a hash join. It is removed from the filesystem as soon as
+// it is created, so it goes away when closed. Rows are appended, and can
+// then be read any number of times by independent readers.
+class SpillFile {
+public:
+    static DbErrorOr<SpillFile> create();
+
+    SpillFile(SpillFile&&);
+    SpillFile& operator=(SpillFile&&);
+    ~SpillFile();
+
+    DbErrorOr<void> write(Tuple const&);
+
+    // Must be called after writing and before reading.
+    DbErrorOr<void> flush();
+
+    size_t row_count() const { return m_row_count; }
+
+    class Reader {
+    public:
+        // Returns nullopt after the last row.
+        DbErrorOr<std::optional<Tuple>> next();
+
+    private:
+        friend class SpillFile;
+
+        explicit Reader(SpillFile const& file)
+            : m_file(file) { }
+
+        DbErrorOr<bool> fill(size_t size);
+
+        SpillFile const& m_file;
+        std::string m_buffer;
+        size_t m_buffer_offset = 0;
+        size_t m_file_offset = 0;
+    };
+
+    Reader read() const { return Reader { *this }; }
+
+private:
+    explicit SpillFile(int fd)
+        : m_fd(fd) { }
+
+    int m_fd = -1;
+    std::string m_write_buffer;
+    size_t m_size = 0;
+    size_t m_row_count = 0;
+};
+
+}
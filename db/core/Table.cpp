@@ -6,6 +6,7 @@
 #include <db/core/DbError.hpp>
 #include <db/core/ResultSet.hpp>
 #include <db/core/TupleFromValues.hpp>
+#include <db/core/UndoLog.hpp>
 #include <db/storage/CSVFile.hpp>
 #include <fstream>
 #include <iostream>
@@ -22,6 +23,19 @@
 
 namespace Db::Core {
 
+bool Table::contains_value(size_t column, Value const& value) const {
+    if (auto index = index_for_column(column)) {
+        return index->contains(Tuple { value });
+    }
+    bool found = false;
+    rows().for_each_row([&](Tuple const& row) {
+        if (!found && IndexKeyEqual {}(Tuple { row.value(column) }, Tuple { value })) {
+            found = true;
+        }
+    });
+    return found;
+}
+
 DbErrorOr<void> Table::check_value_validity(Tuple const& row, size_t column_index) const {
     auto const& column = columns()[column_index];
     if (!row.value(column_index).is_null() && column.type() != row.value(column_index).type()) {
@@ -37,12 +51,8 @@ DbErrorOr<void> Table::check_value_validity(Tuple const& row, size_t column_inde
         return DbError { fmt::format("NULL given for NOT NULL column '{}'", column.name()) };
     }
 
-    if (column.unique()) {
-        TRY(rows().try_for_each_row([&](Tuple const& other_row) -> DbErrorOr<void> {
-            if (TRY(other_row.value(column_index) == row.value(column_index)))
-                return DbError { fmt::format("Column '{}' must contain unique values", column.name()) };
-            return {};
-        }));
+    if (column.unique() && contains_value(column_index, row.value(column_index))) {
+        return DbError { fmt::format("Column '{}' must contain unique values", column.name()) };
     }
 
     return {};
@@ -68,11 +78,9 @@ DbErrorOr<void> Table::perform_table_integrity_checks(Tuple const& row) const {
         if (value.is_null()) {
             return DbError { "Primary key may not be null" };
         }
-        TRY(rows().try_for_each_row([&](Tuple const& other_row) -> DbErrorOr<void> {
-            if (TRY(other_row.value(column->index) == value))
-                return DbError { "Primary key must be unique" };
-            return {};
-        }));
+        if (contains_value(column->index, value)) {
+            return DbError { "Primary key must be unique" };
+        }
     }
 
     // Column types, NON NULL, UNIQUE
@@ -80,6 +88,17 @@ DbErrorOr<void> Table::perform_table_integrity_checks(Tuple const& row) const {
         TRY(check_value_validity(row, s));
     }
 
+    // Unique indexes (created by CREATE UNIQUE INDEX)
+    for (auto const& index : indexes()) {
+        if (index->origin() != Index::Origin::User || !index->is_unique()) {
+            continue;
+        }
+        auto key = index->key_for(row);
+        if (index->contains(key)) {
+            return DbError { fmt::format("Duplicate key {} for unique index '{}'", key, index->name()) };
+        }
+    }
+
     return {};
 }
 
@@ -106,6 +125,8 @@ DbErrorOr<void> Table::perform_database_integrity_checks(Database* db, Tuple con
             continue;
         }
 
+        referenced_table->ensure_foreign_key_reference_index(referenced_column->index);
+
         if (!referenced_table->find_first_matching_tuple(referenced_column->index, local_value)) {
             return DbError {
                 fmt::format("Foreign key '{}' requires matching value in referenced column '{}.{}'",
@@ -216,11 +237,45 @@ DbErrorOr<void> MemoryBackedTable::rename(std::string const& new_name) {
     return {};
 }
 
+std::vector<RelationIterator> MemoryBackedTable::morsels(size_t rows_per_morsel) const {
+    std::vector<RelationIterator> morsels;
+    auto begin = m_rows.begin();
+    while (begin != m_rows.end()) {
+        auto end = begin;
+        for (size_t s = 0; s < rows_per_morsel && end != m_rows.end(); s++) {
+            ++end;
+        }
+        morsels.emplace_back(std::make_unique<MemoryBackedRelationIteratorImpl>(begin, end));
+        begin = end;
+    }
+    return morsels;
+}
+
+Tuple MemoryBackedTable::read_row(RowId id) const {
+    return *reinterpret_cast<Tuple const*>(id);
+}
+
 DbErrorOr<void> MemoryBackedTable::insert_unchecked(Tuple const& row) {
-    m_rows.push_back(row);
+    auto const& inserted = m_rows.emplace_back(row);
+    TRY(index_row(inserted, reinterpret_cast<RowId>(&inserted)));
+    if (auto undo_log = active_undo_log()) {
+        undo_log->record([this, it = std::prev(m_rows.end())]() -> DbErrorOr<void> {
+            TRY(unindex_row(*it, reinterpret_cast<RowId>(&*it)));
+            m_rows.erase(it);
+            return {};
+        });
+    }
     return {};
 }
 
+UndoLog* Table::active_undo_log() const {
+    return m_undo_log && m_undo_log->is_active() ? m_undo_log : nullptr;
+}
+
+std::vector<std::string> Table::explain() const {
+    return { fmt::format("Scan table {} ({} rows)", name(), size()) };
+}
+
 void Table::export_to_csv(const std::string& path) const {
     std::ofstream f_out(path);
 
@@ -18,11 +18,15 @@
 
 namespace Db::Core {
 
+class UndoLog;
+
 class Table : public Util::NonCopyable
     , public IndexedRelation {
 public:
     virtual DatabaseEngine engine() const = 0;
     virtual std::string name() const = 0;
+    // AUTO_INCREMENT counters are not restored when a transaction is
+    // rolled back, so values taken by rolled back rows are skipped.
     virtual int next_auto_increment_value(std::string const& column) = 0;
     virtual int increment(std::string const& column) = 0;
     virtual DbErrorOr<void> rename(std::string const& new_name) = 0;
@@ -35,17 +39,40 @@ public:
     void export_to_csv(const std::string& path) const;
     DbErrorOr<void> import_from_csv(Database* db, Storage::CSVFile const& file);
 
+    // Give space of removed rows back to the system. This may move rows,
+    // so it invalidates row ids. Storage engines may not be able to give
+    // back all of it; see EDBFile::vacuum().
+    virtual DbErrorOr<void> vacuum() { return {}; }
+
     virtual void dump_storage_debug() { }
 
+    // Changes of rows are recorded in this log while it's active, so that
+    // they can be rolled back.
+    void set_undo_log(UndoLog* log) { m_undo_log = log; }
+
+    // Read table again after its storage was rolled back.
+    virtual DbErrorOr<void> reload() { return {}; }
+
+    // ^Relation
+    virtual std::vector<std::string> explain() const override;
+
 protected:
+    // ^IndexedRelation
+    virtual UndoLog* active_undo_log() const override;
+
     // Check integrity with database, i.e foreign keys, checks, constraints, ...
     virtual DbErrorOr<void> perform_database_integrity_checks(Database* db, Tuple const& row) const;
 
 private:
+    // Check if any row has `value` in `column`. Uses index if available.
+    bool contains_value(size_t column, Value const& value) const;
+
     DbErrorOr<void> check_value_validity(Tuple const& row, size_t column_index) const;
 
     // Check integrity with table, i.e if types match, if columns are NON NULL/UNIQUE, primary keys, ...
     DbErrorOr<void> perform_table_integrity_checks(Tuple const& row) const;
+
+    UndoLog* m_undo_log = nullptr;
 };
 
 class MemoryBackedTable : public Table {
@@ -56,7 +83,9 @@ public:
     MemoryBackedTable(std::shared_ptr<Sql::AST::Check> check, TableSetup const& setup)
         : m_columns(setup.columns)
         , m_check(std::move(check))
-        , m_name(setup.name) { }
+        , m_name(setup.name) {
+        update_key_indexes();
+    }
 
     static DbErrorOr<std::unique_ptr<MemoryBackedTable>> create_from_select_result(ResultSet const& select);
 
@@ -67,10 +96,12 @@ public:
         return RelationIterator { std::make_unique<MemoryBackedRelationIteratorImpl>(m_rows) };
     }
     virtual MutableRelationIterator writable_rows() override {
-        return MutableRelationIterator { std::make_unique<MutableMemoryBackedRelationIteratorImpl>(m_rows) };
+        return MutableRelationIterator { std::make_unique<MutableMemoryBackedRelationIteratorImpl>(m_rows, this, active_undo_log()) };
     }
 
     virtual size_t size() const override { return m_rows.size(); }
+    virtual std::vector<RelationIterator> morsels(size_t rows_per_morsel) const override;
+    virtual Tuple read_row(RowId) const override;
 
     std::list<Tuple> const& raw_rows() const { return m_rows; }
     std::list<Tuple>& raw_rows() { return m_rows; }
@@ -0,0 +1,110 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace Db::Core {
+
+namespace {
+
+// Pool and index of the worker that runs on this thread, if any.
+thread_local ThreadPool const* s_current_pool = nullptr;
+thread_local size_t s_current_worker = 0;
+
+}
+
+ThreadPool::ThreadPool(size_t thread_count) {
+    thread_count = std::max<size_t>(thread_count, 1);
+    for (size_t s = 0; s < thread_count; s++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t s = 0; s < thread_count; s++) {
+        m_workers[s]->thread = std::thread { [this, s] { run(s); } };
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock { m_mutex };
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (auto& worker : m_workers) {
+        worker->thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool { std::thread::hardware_concurrency() };
+    return pool;
+}
+
+void ThreadPool::submit(Task task) {
+    auto index = s_current_pool == this
+        ? s_current_worker
+        : m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+
+    // The counter is incremented first, so that it never drops below the
+    // number of tasks in queues. Workers that wake up before the task is
+    // pushed just look for it again.
+    {
+        std::lock_guard lock { m_mutex };
+        m_queued_tasks++;
+    }
+    {
+        auto& worker = *m_workers[index];
+        std::lock_guard lock { worker.mutex };
+        worker.tasks.push_back(std::move(task));
+    }
+    m_condition.notify_one();
+}
+
+std::optional<ThreadPool::Task> ThreadPool::take_task(size_t index) {
+    {
+        auto& worker = *m_workers[index];
+        std::lock_guard lock { worker.mutex };
+        if (!worker.tasks.empty()) {
+            auto task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            return task;
+        }
+    }
+    for (size_t s = 1; s < m_workers.size(); s++) {
+        auto& victim = *m_workers[(index + s) % m_workers.size()];
+        std::lock_guard lock { victim.mutex };
+        if (!victim.tasks.empty()) {
+            auto task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return task;
+        }
+    }
+    return {};
+}
+
+void ThreadPool::run(size_t index) {
+    s_current_pool = this;
+    s_current_worker = index;
+    while (true) {
+        if (auto task = take_task(index)) {
+            {
+                std::lock_guard lock { m_mutex };
+                m_queued_tasks--;
+            }
+            (*task)();
+            continue;
+        }
+
+        std::unique_lock lock { m_mutex };
+        if (m_queued_tasks > 0) {
+            // A task is being pushed right now.
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        if (m_stopping) {
+            return;
+        }
+        m_condition.wait(lock, [this] { return m_queued_tasks > 0 || m_stopping; });
+    }
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Db::Core {
+
+// Pool of worker threads. Every worker has its own queue of tasks: it runs
+// the most recently pushed ones first, and when its queue is empty, it
+// steals the oldest tasks of other workers, so that all workers are kept
+// busy even if tasks take different time.
+//
+// Tasks must not wait for other tasks, as that may block all workers.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t thread_count);
+    ~ThreadPool();
+
+    // Pool with a thread for every core, shared by all queries.
+    static ThreadPool& global();
+
+    size_t thread_count() const { return m_workers.size(); }
+
+    // Tasks submitted by a worker are pushed to its own queue, other ones
+    // are distributed between workers in turn.
+    void submit(Task);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    void run(size_t index);
+    std::optional<Task> take_task(size_t index);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_next_worker = 0;
+
+    // Number of tasks in all queues, which idle workers wait for.
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    size_t m_queued_tasks = 0;
+    bool m_stopping = false;
+};
+
+}
@@ -11,6 +11,16 @@ Column::Column(std::string name, Value::Type type, bool ai, bool un, bool nn, st
     , m_not_null(nn)
     , m_default_value(std::move(def_val)) { }
 
+size_t Tuple::memory_size() const {
+    size_t size = sizeof(Tuple) + m_values.size() * sizeof(Value);
+    for (auto const& value : m_values) {
+        if (value.type() == Value::Type::Varchar) {
+            size += std::get<std::string>(value).size();
+        }
+    }
+    return size;
+}
+
 bool operator<(Tuple const& lhs, Tuple const& rhs) {
     for (size_t s = 0; s < std::max(lhs.value_count(), rhs.value_count()); s++) {
         auto const& lhs_value = s >= lhs.value_count() ? Value::null() : lhs.value(s);
@@ -51,6 +51,9 @@ public:
 
     void clear_row() { m_values.clear(); }
 
+    // Approximate number of bytes that the tuple takes in memory.
+    size_t memory_size() const;
+
 private:
     friend std::ostream& operator<<(std::ostream&, Tuple const&);
 
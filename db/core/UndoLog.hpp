@@ -0,0 +1,59 @@
+#pragma once
+
+#include <db/core/DbError.hpp>
+#include <functional>
+#include <optional>
+#include <ranges>
+#include <vector>
+
+namespace Db::Core {
+
+// Actions that revert changes made in the running transaction. Storage
+// engines that change data in place record how to revert every change,
+// and these actions are run in reverse order on rollback.
+class UndoLog {
+public:
+    using Action = std::function<DbErrorOr<void>()>;
+
+    bool is_active() const { return m_active; }
+
+    void begin() {
+        m_active = true;
+    }
+
+    // Does nothing if no transaction is running.
+    void record(Action action) {
+        if (m_active) {
+            m_actions.push_back(std::move(action));
+        }
+    }
+
+    void commit() {
+        m_active = false;
+        m_actions.clear();
+    }
+
+    // All actions are run even if some of them fail. The first error is
+    // returned.
+    DbErrorOr<void> rollback() {
+        m_active = false;
+        std::optional<DbError> error;
+        for (auto& action : m_actions | std::views::reverse) {
+            auto result = action();
+            if (result.is_error() && !error) {
+                error = result.release_error();
+            }
+        }
+        m_actions.clear();
+        if (error) {
+            return *error;
+        }
+        return {};
+    }
+
+private:
+    std::vector<Action> m_actions;
+    bool m_active = false;
+};
+
+}
@@ -25,7 +25,8 @@ public:
     Value as_value() const { return std::get<Value>(*this); }
 
     bool is_result_set() const { return std::holds_alternative<ResultSet>(*this); }
-    ResultSet as_result_set() const { return std::get<ResultSet>(*this); }
+    ResultSet const& as_result_set() const& { return std::get<ResultSet>(*this); }
+    ResultSet as_result_set() && { return std::get<ResultSet>(std::move(*this)); }
 
     void repl_dump(std::ostream& out, ResultSet::FancyDump fancy) const {
         if (is_value()) {
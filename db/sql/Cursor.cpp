@@ -0,0 +1,128 @@
+#include "Cursor.hpp"
+
+#include <db/sql/Select.hpp>
+#include <db/sql/ast/Statement.hpp>
+
+namespace Db::Sql {
+
+Cursor::Cursor(Core::ValueOrResultSet result) {
+    if (result.is_value()) {
+        m_value = result.as_value();
+        return;
+    }
+    auto result_set = std::move(result).as_result_set();
+    m_column_names = result_set.column_names();
+    m_rows = std::move(result_set).release_rows();
+}
+
+Cursor::Cursor(Cursor&&) = default;
+Cursor& Cursor::operator=(Cursor&&) = default;
+Cursor::~Cursor() = default;
+
+Cursor::Stream::Stream(Core::Database& db, std::unique_ptr<AST::Statement> statement)
+    : m_db(db)
+    , m_statement(std::move(statement)) {
+    m_context.db = &db;
+}
+
+Cursor::Stream::~Stream() {
+    m_db.unregister_stream(*this);
+}
+
+SQLErrorOr<void> Cursor::Stream::open() {
+    m_iterator = TRY(m_statement->open(m_context));
+    if (m_iterator) {
+        m_db.register_stream(*this);
+    }
+    return {};
+}
+
+std::vector<std::string> const& Cursor::Stream::column_names() const {
+    return m_iterator->column_names();
+}
+
+SQLErrorOr<std::optional<Core::Tuple>> Cursor::Stream::next() {
+    if (!m_materialized_rows.empty()) {
+        auto row = std::move(m_materialized_rows.front());
+        m_materialized_rows.pop_front();
+        return row;
+    }
+    if (m_materialize_error) {
+        auto error = std::move(*m_materialize_error);
+        m_materialize_error.reset();
+        return error;
+    }
+    if (!m_iterator) {
+        return std::optional<Core::Tuple> {};
+    }
+    return m_iterator->next();
+}
+
+void Cursor::Stream::materialize() {
+    while (true) {
+        auto row = m_iterator->next();
+        if (row.is_error()) {
+            m_materialize_error = row.release_error();
+            break;
+        }
+        if (!row.value()) {
+            break;
+        }
+        m_materialized_rows.push_back(std::move(*row.release_value()));
+    }
+    // This also waits for tasks reading the tables.
+    m_iterator.reset();
+}
+
+SQLErrorOr<Cursor> Cursor::open(Core::Database& db, std::unique_ptr<AST::Statement> statement) {
+    TRY(statement->check_transaction(db));
+    auto stream = std::make_unique<Stream>(db, std::move(statement));
+    TRY(stream->open());
+    if (!stream->is_query()) {
+        // Rows of open cursors may be changed by the statement.
+        db.materialize_open_streams();
+        return Cursor { TRY(stream->statement().run(db)) };
+    }
+
+    Cursor cursor;
+    cursor.m_column_names = stream->column_names();
+    cursor.m_stream = std::move(stream);
+    return cursor;
+}
+
+SQLErrorOr<std::vector<Core::Tuple>> Cursor::next_batch(size_t max_rows) {
+    std::vector<Core::Tuple> rows;
+    if (m_stream) {
+        while (rows.size() < max_rows) {
+            auto row = TRY(m_stream->next());
+            if (!row) {
+                // Release the source (and its frame) as soon as possible.
+                m_stream.reset();
+                break;
+            }
+            rows.push_back(std::move(*row));
+        }
+        return rows;
+    }
+    while (rows.size() < max_rows && m_next_row < m_rows.size()) {
+        rows.push_back(std::move(m_rows[m_next_row++]));
+    }
+    return rows;
+}
+
+SQLErrorOr<Core::ValueOrResultSet> Cursor::collect() {
+    if (m_value) {
+        return *m_value;
+    }
+    std::vector<Core::Tuple> rows;
+    while (true) {
+        auto batch = TRY(next_batch());
+        if (batch.empty()) {
+            break;
+        }
+        rows.insert(rows.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    }
+    return Core::ResultSet { m_column_names, std::move(rows) };
+}
+
+}
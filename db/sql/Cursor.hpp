@@ -0,0 +1,101 @@
+#pragma once
+
+#include <db/core/Database.hpp>
+#include <db/core/ValueOrResultSet.hpp>
+#include <db/sql/SQLError.hpp>
+#include <db/sql/ast/EvaluationContext.hpp>
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Db::Sql {
+
+namespace AST {
+class SelectIterator;
+class Statement;
+}
+
+// Result of a query. Rows of SELECTs are computed while they are read,
+// in batches of requested size, so that only these are held in memory.
+// Other statements are run when the cursor is created.
+//
+// While rows are computed, the cursor refers to rows of tables (or reads
+// them on other threads, see ParallelScanOperator). So before the next
+// statement changes anything, all remaining rows of open cursors are read
+// into memory, and these cursors return the rows as they were before the
+// change. Code that changes tables directly, not through SQL, must call
+// Database::materialize_open_streams() first.
+class Cursor {
+public:
+    static constexpr size_t DefaultBatchSize = 1024;
+
+    // Result that is computed already.
+    explicit Cursor(Core::ValueOrResultSet);
+
+    // Runs `statement`, streaming its rows if possible.
+    static SQLErrorOr<Cursor> open(Core::Database&, std::unique_ptr<AST::Statement>);
+
+    Cursor(Cursor&&);
+    Cursor& operator=(Cursor&&);
+    ~Cursor();
+
+    // A single value instead of rows, e.g. from PRINT.
+    bool is_value() const { return m_value.has_value(); }
+    Core::Value const& value() const { return *m_value; }
+
+    std::vector<std::string> const& column_names() const { return m_column_names; }
+
+    // Returns up to `max_rows` next rows, or an empty vector after the
+    // last row.
+    SQLErrorOr<std::vector<Core::Tuple>> next_batch(size_t max_rows = DefaultBatchSize);
+
+    // Reads all remaining rows.
+    SQLErrorOr<Core::ValueOrResultSet> collect();
+
+private:
+    // The statement and context are referenced by the iterator.
+    class Stream : public Core::OpenStream {
+    public:
+        Stream(Core::Database&, std::unique_ptr<AST::Statement>);
+        virtual ~Stream() override;
+
+        SQLErrorOr<void> open();
+        std::vector<std::string> const& column_names() const;
+        bool is_query() const { return m_iterator != nullptr; }
+        AST::Statement const& statement() const { return *m_statement; }
+
+        // Returns nullopt after the last row.
+        SQLErrorOr<std::optional<Core::Tuple>> next();
+
+        // ^OpenStream
+        virtual void materialize() override;
+
+    private:
+        Core::Database& m_db;
+        std::unique_ptr<AST::Statement> m_statement;
+        AST::EvaluationContext m_context;
+        std::unique_ptr<AST::SelectIterator> m_iterator;
+
+        // Rows read by materialize(), followed by the error that stopped
+        // reading them, if any.
+        std::deque<Core::Tuple> m_materialized_rows;
+        std::optional<SQLError> m_materialize_error;
+    };
+
+    Cursor() = default;
+
+    std::optional<Core::Value> m_value;
+    std::vector<std::string> m_column_names;
+
+    // Set if rows are computed while they are read.
+    std::unique_ptr<Stream> m_stream;
+
+    // Rows that were computed already.
+    std::vector<Core::Tuple> m_rows;
+    size_t m_next_row = 0;
+};
+
+}
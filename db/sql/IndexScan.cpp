@@ -0,0 +1,249 @@
+#include "IndexScan.hpp"
+
+#include <map>
+#include <set>
+
+namespace Db::Sql::AST {
+
+namespace {
+
+using Bound = Core::Index::Bound;
+
+// What is known about values of a single column from the WHERE clause.
+struct ColumnLookup {
+    // Set if the column must be equal to one of these values.
+    std::optional<std::vector<Core::Value>> keys;
+    bool keys_match_null = false;
+
+    std::optional<Bound> lower;
+    std::optional<Bound> upper;
+    // Rows with NULL may match the range even though NULL is out of it.
+    bool range_matches_null = true;
+};
+
+}
+
+// Only types for which SQL comparison agrees with index key ordering.
+static bool is_indexable_type(Core::Value::Type type) {
+    return type == Core::Value::Type::Int || type == Core::Value::Type::Float || type == Core::Value::Type::Varchar;
+}
+
+static std::optional<size_t> resolve_column(Expression const& expression, TableExpression const& from, Core::Database* db) {
+    auto identifier = dynamic_cast<Identifier const*>(&expression);
+    if (!identifier) {
+        return {};
+    }
+    auto column = from.resolve_identifier(db, *identifier);
+    if (column.is_error()) {
+        return {};
+    }
+    return column.release_value();
+}
+
+// Index keys are typed, so only values of the column type can be looked up.
+static std::optional<Core::Value> literal_value(Expression const& expression, Core::Value::Type type) {
+    auto literal = dynamic_cast<Literal const*>(&expression);
+    if (!literal || literal->value().type() != type) {
+        return {};
+    }
+    return literal->value();
+}
+
+static void collect_conjuncts(Expression const& expression, std::vector<Expression const*>& output) {
+    auto binary = dynamic_cast<BinaryOperator const*>(&expression);
+    if (binary && binary->operation() == BinaryOperator::Operation::And) {
+        collect_conjuncts(binary->lhs(), output);
+        collect_conjuncts(*binary->rhs(), output);
+        return;
+    }
+    output.push_back(&expression);
+}
+
+static void tighten_lower(ColumnLookup& lookup, Bound bound) {
+    if (lookup.lower) {
+        auto result = Core::compare_index_keys(bound.key, lookup.lower->key);
+        if (result < 0 || (result == 0 && bound.inclusive)) {
+            return;
+        }
+    }
+    lookup.lower = std::move(bound);
+}
+
+static void tighten_upper(ColumnLookup& lookup, Bound bound) {
+    if (lookup.upper) {
+        auto result = Core::compare_index_keys(bound.key, lookup.upper->key);
+        if (result > 0 || (result == 0 && bound.inclusive)) {
+            return;
+        }
+    }
+    lookup.upper = std::move(bound);
+}
+
+static void add_comparison(ColumnLookup& lookup, BinaryOperator::Operation operation, Core::Value value, bool matches_null) {
+    using Operation = BinaryOperator::Operation;
+    switch (operation) {
+    case Operation::Equal:
+        if (!lookup.keys) {
+            lookup.keys = std::vector { std::move(value) };
+            lookup.keys_match_null = matches_null;
+        }
+        return;
+    case Operation::Greater:
+    case Operation::GreaterEqual:
+        tighten_lower(lookup, { .key = Core::Tuple { std::move(value) }, .inclusive = operation == Operation::GreaterEqual });
+        break;
+    case Operation::Less:
+    case Operation::LessEqual:
+        tighten_upper(lookup, { .key = Core::Tuple { std::move(value) }, .inclusive = operation == Operation::LessEqual });
+        break;
+    default:
+        return;
+    }
+    lookup.range_matches_null &= matches_null;
+}
+
+static BinaryOperator::Operation flip_comparison(BinaryOperator::Operation operation) {
+    using Operation = BinaryOperator::Operation;
+    switch (operation) {
+    case Operation::Greater:
+        return Operation::Less;
+    case Operation::GreaterEqual:
+        return Operation::LessEqual;
+    case Operation::Less:
+        return Operation::Greater;
+    case Operation::LessEqual:
+        return Operation::GreaterEqual;
+    default:
+        return operation;
+    }
+}
+
+static void analyze_conjunct(Expression const& expression, Core::IndexedRelation const& table, TableExpression const& from,
+    Core::Database* db, std::map<size_t, ColumnLookup>& lookups) {
+
+    auto column_type = [&](size_t column) { return table.columns()[column].type(); };
+
+    if (auto binary = dynamic_cast<BinaryOperator const*>(&expression)) {
+        using Operation = BinaryOperator::Operation;
+        auto operation = binary->operation();
+        if (operation != Operation::Equal && operation != Operation::Greater && operation != Operation::GreaterEqual
+            && operation != Operation::Less && operation != Operation::LessEqual) {
+            return;
+        }
+
+        // NULL compares as smaller than anything, so `NULL < x` is true.
+        // This is covered by range with no lower bound. Comparisons with
+        // a column on the right side convert NULL in weird ways, so in this
+        // case NULLs are just always checked.
+        if (auto column = resolve_column(binary->lhs(), from, db); column && is_indexable_type(column_type(*column))) {
+            if (auto value = literal_value(*binary->rhs(), column_type(*column))) {
+                add_comparison(lookups[*column], operation, std::move(*value), false);
+            }
+        }
+        else if (auto column = resolve_column(*binary->rhs(), from, db); column && is_indexable_type(column_type(*column))) {
+            if (auto value = literal_value(binary->lhs(), column_type(*column))) {
+                add_comparison(lookups[*column], flip_comparison(operation), std::move(*value), true);
+            }
+        }
+        return;
+    }
+
+    if (auto between = dynamic_cast<BetweenExpression const*>(&expression)) {
+        auto column = resolve_column(between->lhs(), from, db);
+        if (!column || !is_indexable_type(column_type(*column))) {
+            return;
+        }
+        auto min = literal_value(between->min(), column_type(*column));
+        auto max = literal_value(between->max(), column_type(*column));
+        if (!min || !max) {
+            return;
+        }
+        add_comparison(lookups[*column], BinaryOperator::Operation::GreaterEqual, std::move(*min), false);
+        add_comparison(lookups[*column], BinaryOperator::Operation::LessEqual, std::move(*max), false);
+        return;
+    }
+
+    if (auto in = dynamic_cast<InExpression const*>(&expression)) {
+        // IN compares values as strings. This is the same as comparing
+        // values for ints and varchars, but not for floats.
+        auto column = resolve_column(in->lhs(), from, db);
+        if (!column || (column_type(*column) != Core::Value::Type::Int && column_type(*column) != Core::Value::Type::Varchar)) {
+            return;
+        }
+        std::vector<Core::Value> keys;
+        bool matches_null = false;
+        for (auto const& arg : in->args()) {
+            auto value = literal_value(*arg, column_type(*column));
+            if (!value) {
+                return;
+            }
+            if (value->type() == Core::Value::Type::Varchar && std::get<std::string>(*value) == "null") {
+                matches_null = true;
+            }
+            keys.push_back(std::move(*value));
+        }
+        auto& lookup = lookups[*column];
+        if (!lookup.keys) {
+            lookup.keys = std::move(keys);
+            lookup.keys_match_null = matches_null;
+        }
+    }
+}
+
+static std::vector<Core::RowId> find_keys(Core::Index const& index, std::vector<Core::Value> const& values, bool match_null) {
+    std::set<Core::Tuple, Core::IndexKeyLess> keys;
+    for (auto const& value : values) {
+        keys.insert(Core::Tuple { value });
+    }
+    if (match_null) {
+        keys.insert(Core::Tuple { Core::Value::null() });
+    }
+
+    std::vector<Core::RowId> rows;
+    for (auto const& key : keys) {
+        auto key_rows = index.find_all(key);
+        rows.insert(rows.end(), key_rows.begin(), key_rows.end());
+    }
+    return rows;
+}
+
+std::optional<std::vector<Core::RowId>> find_rows_using_index(Core::IndexedRelation const& table, TableExpression const& from, Core::Database* db, Expression const& where) {
+    std::vector<Expression const*> conjuncts;
+    collect_conjuncts(where, conjuncts);
+
+    std::map<size_t, ColumnLookup> lookups;
+    for (auto const& conjunct : conjuncts) {
+        analyze_conjunct(*conjunct, table, from, db, lookups);
+    }
+
+    // Equality lookups are the most selective, so try them first.
+    for (auto const& [column, lookup] : lookups) {
+        if (!lookup.keys) {
+            continue;
+        }
+        if (auto index = table.index_for_column(column)) {
+            return find_keys(*index, *lookup.keys, lookup.keys_match_null);
+        }
+    }
+
+    for (auto const& [column, lookup] : lookups) {
+        if (!lookup.lower && !lookup.upper) {
+            continue;
+        }
+        auto index = table.ordered_index_for_column(column);
+        if (!index) {
+            continue;
+        }
+        auto rows = index->find_range(lookup.lower, lookup.upper);
+        // Rows with NULL are not in range if it has a lower bound.
+        if (lookup.lower && lookup.range_matches_null) {
+            auto null_rows = index->find_all(Core::Tuple { Core::Value::null() });
+            rows.insert(rows.end(), null_rows.begin(), null_rows.end());
+        }
+        return rows;
+    }
+
+    return {};
+}
+
+}
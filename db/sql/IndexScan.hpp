@@ -0,0 +1,19 @@
+#pragma once
+
+#include <db/core/IndexedRelation.hpp>
+#include <db/sql/ast/Expression.hpp>
+#include <db/sql/ast/TableExpression.hpp>
+#include <optional>
+#include <vector>
+
+namespace Db::Sql::AST {
+
+// Find rows of `table` that may match `where` using its indexes. This
+// recognizes `col = x`, `col IN (x, ...)`, `col BETWEEN x AND y` and
+// comparisons of a column with a literal, also when joined with AND.
+// The returned rows are only candidates, the caller must still evaluate
+// `where` on them. Returns nullopt if no index can be used, meaning that
+// the whole table must be scanned.
+std::optional<std::vector<Core::RowId>> find_rows_using_index(Core::IndexedRelation const& table, TableExpression const& from, Core::Database*, Expression const& where);
+
+}
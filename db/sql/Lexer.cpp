@@ -57,11 +57,13 @@ std::vector<Token> Lexer::lex() {
                 { "ALTER", Token::Type::KeywordAlter },
                 { "AND", Token::Type::KeywordAnd },
                 { "AS", Token::Type::KeywordAs },
+                { "BEGIN", Token::Type::KeywordBegin },
                 { "BETWEEN", Token::Type::KeywordBetween },
                 { "BY", Token::Type::KeywordBy },
                 { "CASE", Token::Type::KeywordCase },
                 { "CHECK", Token::Type::KeywordCheck },
                 { "COLUMN", Token::Type::KeywordColumn },
+                { "COMMIT", Token::Type::KeywordCommit },
                 { "CONSTRAINT", Token::Type::KeywordConstraint },
                 { "CREATE", Token::Type::KeywordCreate },
                 { "DEFAULT", Token::Type::KeywordDefault },
@@ -71,7 +73,9 @@ std::vector<Token> Lexer::lex() {
                 { "ELSE", Token::Type::KeywordElse },
                 { "END", Token::Type::KeywordEnd },
                 { "ENGINE", Token::Type::KeywordEngine },
+                { "EXCEPT", Token::Type::KeywordExcept },
                 { "EXISTS", Token::Type::KeywordExists },
+                { "EXPLAIN", Token::Type::KeywordExplain },
                 { "FROM", Token::Type::KeywordFrom },
                 { "FOREIGN", Token::Type::KeywordForeign },
                 { "FULL", Token::Type::KeywordFull },
@@ -80,8 +84,10 @@ std::vector<Token> Lexer::lex() {
                 { "IMPORT", Token::Type::KeywordImport },
                 { "IF", Token::Type::KeywordIf },
                 { "IN", Token::Type::KeywordIn },
+                { "INDEX", Token::Type::KeywordIndex },
                 { "INNER", Token::Type::KeywordInner },
                 { "INSERT", Token::Type::KeywordInsert },
+                { "INTERSECT", Token::Type::KeywordIntersect },
                 { "INTO", Token::Type::KeywordInto },
                 { "IS", Token::Type::KeywordIs },
                 { "JOIN", Token::Type::KeywordJoin },
@@ -99,6 +105,7 @@ std::vector<Token> Lexer::lex() {
                 { "PRIMARY", Token::Type::KeywordPrimary },
                 { "PRINT", Token::Type::KeywordPrint },
                 { "REFERENCES", Token::Type::KeywordReferences },
+                { "ROLLBACK", Token::Type::KeywordRollback },
                 { "SELECT", Token::Type::KeywordSelect },
                 { "SET", Token::Type::KeywordSet },
                 { "SHOW", Token::Type::KeywordShow },
@@ -106,10 +113,12 @@ std::vector<Token> Lexer::lex() {
                 { "TABLES", Token::Type::KeywordTables },
                 { "THEN", Token::Type::KeywordThen },
                 { "TOP", Token::Type::KeywordTop },
+                { "TRANSACTION", Token::Type::KeywordTransaction },
                 { "TRUNCATE", Token::Type::KeywordTruncate },
                 { "UNION", Token::Type::KeywordUnion },
                 { "UNIQUE", Token::Type::KeywordUnique },
                 { "UPDATE", Token::Type::KeywordUpdate },
+                { "VACUUM", Token::Type::KeywordVacuum },
                 { "VALUES", Token::Type::KeywordValues },
                 { "WHEN", Token::Type::KeywordWhen },
                 { "WHERE", Token::Type::KeywordWhere },
@@ -12,11 +12,13 @@ struct Token {
         KeywordAlter,
         KeywordAnd,
         KeywordAs,
+        KeywordBegin,
         KeywordBetween,
         KeywordBy,
         KeywordCase,
         KeywordCheck,
         KeywordColumn,
+        KeywordCommit,
         KeywordConstraint,
         KeywordCreate,
         KeywordDefault,
@@ -26,7 +28,9 @@ struct Token {
         KeywordElse,
         KeywordEnd,
         KeywordEngine,
+        KeywordExcept,
         KeywordExists,
+        KeywordExplain,
         KeywordFrom,
         KeywordForeign,
         KeywordFull,
@@ -35,8 +39,10 @@ struct Token {
         KeywordImport,
         KeywordIf,
         KeywordIn,
+        KeywordIndex,
         KeywordInner,
         KeywordInsert,
+        KeywordIntersect,
         KeywordInto,
         KeywordIs,
         KeywordJoin,
@@ -54,6 +60,7 @@ struct Token {
         KeywordPrimary,
         KeywordPrint,
         KeywordReferences,
+        KeywordRollback,
         KeywordSelect,
         KeywordSet,
         KeywordShow,
@@ -61,10 +68,12 @@ struct Token {
         KeywordTables,
         KeywordThen,
         KeywordTop,
+        KeywordTransaction,
         KeywordTruncate,
         KeywordUnion,
         KeywordUnique,
         KeywordUpdate,
+        KeywordVacuum,
         KeywordValues,
         KeywordWhen,
         KeywordWhere,
@@ -63,37 +63,65 @@ SQLErrorOr<std::unique_ptr<AST::Statement>> Parser::parse_statement_impl() {
         ssize_t start = m_offset;
         auto lhs = TRY(parse_select());
 
-        if (m_tokens[m_offset].type == Token::Type::KeywordUnion) {
-            m_offset++;
-
-            bool distinct = true;
-
-            if (m_tokens[m_offset].type == Token::Type::KeywordAll) {
+        std::vector<AST::Select> selects;
+        std::vector<AST::SetOperation::Type> operations;
+        while (true) {
+            auto type = m_tokens[m_offset].type;
+            std::optional<AST::SetOperation::Type> operation;
+            if (type == Token::Type::KeywordUnion) {
+                m_offset++;
+                operation = AST::SetOperation::Type::Union;
+                if (m_tokens[m_offset].type == Token::Type::KeywordAll) {
+                    m_offset++;
+                    operation = AST::SetOperation::Type::UnionAll;
+                }
+            }
+            else if (type == Token::Type::KeywordIntersect) {
+                m_offset++;
+                operation = AST::SetOperation::Type::Intersect;
+            }
+            else if (type == Token::Type::KeywordExcept) {
                 m_offset++;
-                distinct = false;
+                operation = AST::SetOperation::Type::Except;
+            }
+            else {
+                break;
             }
 
             if (m_tokens[m_offset].type != Token::Type::KeywordSelect)
-                return expected("'SELECT' after 'UNION' statement", m_tokens[m_offset], m_offset);
+                return expected("'SELECT' after set operator", m_tokens[m_offset], m_offset);
 
-            auto rhs = TRY(parse_select());
-
-            return std::make_unique<AST::Union>(start, std::move(lhs), std::move(rhs), distinct);
+            operations.push_back(*operation);
+            selects.push_back(TRY(parse_select()));
         }
-        else {
+
+        if (selects.empty()) {
             return std::make_unique<AST::SelectStatement>(start, std::move(lhs));
         }
+        selects.insert(selects.begin(), std::move(lhs));
+        return std::make_unique<AST::SetOperation>(start, std::move(selects), std::move(operations));
+    }
+    else if (keyword.type == Token::Type::KeywordExplain) {
+        ssize_t start = m_offset++;
+        if (m_tokens[m_offset].type != Token::Type::KeywordSelect)
+            return expected("'SELECT' after 'EXPLAIN'", m_tokens[m_offset], m_offset);
+        return std::make_unique<AST::Explain>(start, TRY(parse_select()));
     }
     else if (keyword.type == Token::Type::KeywordCreate) {
         auto what_to_create = m_tokens[m_offset + 1];
         if (what_to_create.type == Token::Type::KeywordTable)
             return TRY(parse_create_table());
+        if (what_to_create.type == Token::Type::KeywordIndex
+            || (what_to_create.type == Token::Type::KeywordUnique && m_tokens[m_offset + 2].type == Token::Type::KeywordIndex))
+            return TRY(parse_create_index());
         return expected("thing to create", what_to_create, m_offset + 1);
     }
     else if (keyword.type == Token::Type::KeywordDrop) {
         auto what_to_drop = m_tokens[m_offset + 1];
         if (what_to_drop.type == Token::Type::KeywordTable)
             return TRY(parse_drop_table());
+        if (what_to_drop.type == Token::Type::KeywordIndex)
+            return TRY(parse_drop_index());
         return expected("thing to drop", what_to_drop, m_offset + 1);
     }
     else if (keyword.type == Token::Type::KeywordTruncate) {
@@ -137,6 +165,12 @@ SQLErrorOr<std::unique_ptr<AST::Statement>> Parser::parse_statement_impl() {
     else if (keyword.type == Token::Type::KeywordPrint) {
         return TRY(parse_print());
     }
+    else if (keyword.type == Token::Type::KeywordVacuum) {
+        return TRY(parse_vacuum());
+    }
+    else if (keyword.type == Token::Type::KeywordBegin || keyword.type == Token::Type::KeywordCommit || keyword.type == Token::Type::KeywordRollback) {
+        return TRY(parse_transaction());
+    }
     return expected("statement", keyword, m_offset);
 }
 
@@ -452,6 +486,42 @@ SQLErrorOr<std::unique_ptr<AST::Print>> Parser::parse_print() {
     return std::make_unique<AST::Print>(start, std::move(statement));
 }
 
+SQLErrorOr<std::unique_ptr<AST::Vacuum>> Parser::parse_vacuum() {
+    auto start = m_offset;
+    m_offset++; // VACUUM
+
+    // All tables if no table is given
+    auto table_name = m_tokens[m_offset];
+    if (table_name.type != Token::Type::Identifier) {
+        return std::make_unique<AST::Vacuum>(start, std::optional<std::string> {});
+    }
+    m_offset++;
+    return std::make_unique<AST::Vacuum>(start, table_name.value);
+}
+
+SQLErrorOr<std::unique_ptr<AST::Transaction>> Parser::parse_transaction() {
+    auto start = m_offset;
+    auto keyword = m_tokens[m_offset++];
+    auto type = [&]() {
+        switch (keyword.type) {
+        case Token::Type::KeywordBegin:
+            return AST::Transaction::Type::Begin;
+        case Token::Type::KeywordCommit:
+            return AST::Transaction::Type::Commit;
+        case Token::Type::KeywordRollback:
+            return AST::Transaction::Type::Rollback;
+        default:
+            ESSA_UNREACHABLE;
+        }
+    }();
+
+    // TRANSACTION is optional
+    if (m_tokens[m_offset].type == Token::Type::KeywordTransaction) {
+        m_offset++;
+    }
+    return std::make_unique<AST::Transaction>(start, type);
+}
+
 SQLErrorOr<std::unique_ptr<AST::DeleteFrom>> Parser::parse_delete_from() {
     auto start = m_offset;
     m_offset++;
@@ -840,6 +910,73 @@ SQLErrorOr<std::unique_ptr<AST::AlterTable>> Parser::parse_alter_table() {
         std::move(constraint_to_add), std::move(constraint_to_alter), std::move(constraint_to_drop));
 }
 
+SQLErrorOr<std::unique_ptr<AST::CreateIndex>> Parser::parse_create_index() {
+    auto start = m_offset;
+    m_offset++; // CREATE
+
+    bool unique = false;
+    if (m_tokens[m_offset].type == Token::Type::KeywordUnique) {
+        unique = true;
+        m_offset++;
+    }
+    m_offset++; // INDEX
+
+    auto index_name = m_tokens[m_offset++];
+    if (index_name.type != Token::Type::Identifier)
+        return expected("index name", index_name, m_offset - 1);
+
+    auto on = m_tokens[m_offset++];
+    if (on.type != Token::Type::KeywordOn)
+        return expected("'ON'", on, m_offset - 1);
+
+    auto table_name = m_tokens[m_offset++];
+    if (table_name.type != Token::Type::Identifier)
+        return expected("table name", table_name, m_offset - 1);
+
+    auto paren_open = m_tokens[m_offset++];
+    if (paren_open.type != Token::Type::ParenOpen)
+        return expected("'(' to open column list", paren_open, m_offset - 1);
+
+    std::vector<std::string> columns;
+    while (true) {
+        auto name = m_tokens[m_offset++];
+        if (name.type != Token::Type::Identifier)
+            return expected("column name", name, m_offset - 1);
+
+        columns.push_back(name.value);
+
+        auto comma = m_tokens[m_offset];
+        if (comma.type != Token::Type::Comma)
+            break;
+        m_offset++;
+    }
+
+    auto paren_close = m_tokens[m_offset++];
+    if (paren_close.type != Token::Type::ParenClose)
+        return expected("')' to close column list", paren_close, m_offset - 1);
+
+    return std::make_unique<AST::CreateIndex>(start, index_name.value, table_name.value, std::move(columns), unique);
+}
+
+SQLErrorOr<std::unique_ptr<AST::DropIndex>> Parser::parse_drop_index() {
+    auto start = m_offset;
+    m_offset += 2; // DROP INDEX
+
+    auto index_name = m_tokens[m_offset++];
+    if (index_name.type != Token::Type::Identifier)
+        return expected("index name", index_name, m_offset - 1);
+
+    auto on = m_tokens[m_offset++];
+    if (on.type != Token::Type::KeywordOn)
+        return expected("'ON'", on, m_offset - 1);
+
+    auto table_name = m_tokens[m_offset++];
+    if (table_name.type != Token::Type::Identifier)
+        return expected("table name", table_name, m_offset - 1);
+
+    return std::make_unique<AST::DropIndex>(start, index_name.value, table_name.value);
+}
+
 SQLErrorOr<std::unique_ptr<AST::InsertInto>> Parser::parse_insert_into() {
     auto start = m_offset;
     m_offset += 2; // INSERT INTO
@@ -1044,8 +1181,11 @@ SQLErrorOr<std::optional<Core::DatabaseEngine>> Parser::parse_engine_specificati
             else if (compare_case_insensitive(engine_identifier.value, "MEMORY")) {
                 return Core::DatabaseEngine::Memory;
             }
+            else if (compare_case_insensitive(engine_identifier.value, "COLUMNAR")) {
+                return Core::DatabaseEngine::Columnar;
+            }
             else {
-                return SQLError { "Invalid database engine, expected 'EDB' or 'MEMORY'", m_offset - 1 };
+                return SQLError { "Invalid database engine, expected 'EDB', 'MEMORY' or 'COLUMNAR'", m_offset - 1 };
             }
         }
         else {
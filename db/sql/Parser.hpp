@@ -34,11 +34,15 @@ private:
     SQLErrorOr<std::unique_ptr<AST::DropTable>> parse_drop_table();
     SQLErrorOr<std::unique_ptr<AST::TruncateTable>> parse_truncate_table();
     SQLErrorOr<std::unique_ptr<AST::AlterTable>> parse_alter_table();
+    SQLErrorOr<std::unique_ptr<AST::CreateIndex>> parse_create_index();
+    SQLErrorOr<std::unique_ptr<AST::DropIndex>> parse_drop_index();
     SQLErrorOr<std::unique_ptr<AST::InsertInto>> parse_insert_into();
     SQLErrorOr<std::unique_ptr<AST::DeleteFrom>> parse_delete_from();
     SQLErrorOr<std::unique_ptr<AST::Update>> parse_update();
     SQLErrorOr<std::unique_ptr<AST::Import>> parse_import();
     SQLErrorOr<std::unique_ptr<AST::Print>> parse_print();
+    SQLErrorOr<std::unique_ptr<AST::Vacuum>> parse_vacuum();
+    SQLErrorOr<std::unique_ptr<AST::Transaction>> parse_transaction();
     SQLErrorOr<std::unique_ptr<AST::Expression>> parse_expression(int min_precedence = 0);
     SQLErrorOr<std::unique_ptr<AST::Expression>> parse_expression_or_index(Sql::AST::SelectColumns const&);
     SQLErrorOr<std::vector<std::unique_ptr<AST::Expression>>> parse_expression_list(std::string const& name_in_error_message = "expression list");
@@ -0,0 +1,289 @@
+#include "Pipeline.hpp"
+
+#include <db/core/SortKey.hpp>
+
+namespace Db::Sql::AST {
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> ScanOperator::next() {
+    auto row = m_rows.next();
+    if (!row) {
+        return std::optional<Core::TupleWithSource> {};
+    }
+    row_was_read();
+    auto tuple = row->read();
+    return Core::TupleWithSource { .tuple = tuple, .source = tuple };
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> IndexScanOperator::next() {
+    if (m_next_row >= m_row_ids.size()) {
+        return std::optional<Core::TupleWithSource> {};
+    }
+    row_was_read();
+    auto tuple = m_relation.read_row(m_row_ids[m_next_row++]);
+    return Core::TupleWithSource { .tuple = tuple, .source = tuple };
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> BatchScanOperator::next() {
+    while (!m_batch || m_next_row >= m_selection.size()) {
+        m_batch = m_batches->next();
+        if (!m_batch) {
+            return std::optional<Core::TupleWithSource> {};
+        }
+        m_next_row = 0;
+        m_selection = m_batch->rows();
+        if (!m_selection.empty()) {
+            row_was_read();
+        }
+        if (m_where) {
+            m_selection = TRY(m_where->filter_batch(m_context, *m_batch, m_selection));
+        }
+        m_column_values.clear();
+        if (m_project) {
+            for (auto const& column : m_context.current_frame().columns.columns()) {
+                m_column_values.push_back(TRY(column.column->evaluate_batch(m_context, *m_batch, m_selection)));
+            }
+        }
+    }
+
+    auto row = m_selection[m_next_row++];
+    auto source = m_batch->read_row(row);
+    if (!m_project) {
+        return Core::TupleWithSource { .tuple = source, .source = source };
+    }
+    std::vector<Core::Value> values;
+    values.reserve(m_column_values.size());
+    for (auto const& column_value : m_column_values) {
+        values.push_back(column_value.value(row));
+    }
+    return Core::TupleWithSource { .tuple = { values }, .source = std::move(source) };
+}
+
+ParallelScanOperator::ParallelScanOperator(Core::ThreadPool& pool, std::vector<Core::RelationIterator> morsels, EvaluationContext& context, Expression const* where, bool project)
+    : m_pool(pool)
+    , m_morsels(std::move(morsels))
+    , m_context(context)
+    , m_where(where)
+    , m_project(project) {
+    // Enough to keep all threads busy while rows are returned.
+    for (size_t s = 0; s < 2 * m_pool.thread_count(); s++) {
+        submit_next_morsel();
+    }
+}
+
+ParallelScanOperator::~ParallelScanOperator() {
+    // Tasks use the relation and the expressions, which may be destroyed
+    // after this operator.
+    for (auto const& morsel : m_pending_morsels) {
+        morsel.wait();
+    }
+}
+
+void ParallelScanOperator::submit_next_morsel() {
+    if (m_next_morsel >= m_morsels.size()) {
+        return;
+    }
+
+    struct Task {
+        Core::RelationIterator rows;
+        // Every task evaluates expressions in its own copy of frames.
+        EvaluationContext context;
+        std::promise<SQLErrorOr<Morsel>> result;
+    };
+    auto task = std::make_shared<Task>(Task { .rows = std::move(m_morsels[m_next_morsel++]), .context = m_context, .result = {} });
+    m_pending_morsels.push_back(task->result.get_future());
+    m_pool.submit([task, where = m_where, project = m_project] {
+        task->result.set_value(read_morsel(task->rows, task->context, where, project));
+    });
+}
+
+SQLErrorOr<ParallelScanOperator::Morsel> ParallelScanOperator::read_morsel(Core::RelationIterator& rows, EvaluationContext& context, Expression const* where, bool project) {
+    auto& frame = context.current_frame();
+    Morsel morsel;
+    while (auto row = rows.next()) {
+        morsel.read_any_row = true;
+        auto tuple = row->read();
+        if (where) {
+            frame.row = { .tuple = tuple, .source = {} };
+            if (!TRY(TRY(where->evaluate(context)).to_bool().map_error(DbToSQLError { where->start() }))) {
+                continue;
+            }
+        }
+        if (!project) {
+            morsel.rows.push_back(Core::TupleWithSource { .tuple = tuple, .source = tuple });
+            continue;
+        }
+        frame.row = { .tuple = tuple, .source = tuple };
+        std::vector<Core::Value> values;
+        for (auto const& column : frame.columns.columns()) {
+            values.push_back(TRY(column.column->evaluate(context)));
+        }
+        morsel.rows.push_back(Core::TupleWithSource { .tuple = { values }, .source = std::move(tuple) });
+    }
+    return morsel;
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> ParallelScanOperator::next() {
+    while (m_next_row >= m_rows.size()) {
+        if (m_pending_morsels.empty()) {
+            return std::optional<Core::TupleWithSource> {};
+        }
+        auto morsel = m_pending_morsels.front().get();
+        m_pending_morsels.pop_front();
+        submit_next_morsel();
+
+        if (morsel.is_error()) {
+            return morsel.release_error();
+        }
+        auto result = morsel.release_value();
+        if (result.read_any_row) {
+            row_was_read();
+        }
+        m_rows = std::move(result.rows);
+        m_next_row = 0;
+    }
+    return std::move(m_rows[m_next_row++]);
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> FilterOperator::next() {
+    auto& frame = m_context.current_frame();
+    while (true) {
+        auto row = TRY(m_input->next());
+        if (!row) {
+            return std::optional<Core::TupleWithSource> {};
+        }
+        frame.row = { .tuple = row->tuple, .source = {} };
+        if (TRY(TRY(m_condition.evaluate(m_context)).to_bool().map_error(DbToSQLError { m_condition.start() }))) {
+            return row;
+        }
+    }
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> ProjectOperator::next() {
+    auto row = TRY(m_input->next());
+    if (!row) {
+        return std::optional<Core::TupleWithSource> {};
+    }
+    auto& frame = m_context.current_frame();
+    frame.row = { .tuple = row->tuple, .source = row->tuple };
+    std::vector<Core::Value> values;
+    for (auto const& column : frame.columns.columns()) {
+        values.push_back(TRY(column.column->evaluate(m_context)));
+    }
+    return Core::TupleWithSource { .tuple = { values }, .source = std::move(row->tuple) };
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> LimitOperator::next() {
+    if (m_returned >= m_limit) {
+        return std::optional<Core::TupleWithSource> {};
+    }
+    auto row = TRY(m_input->next());
+    if (row) {
+        m_returned++;
+    }
+    return row;
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> DistinctOperator::next() {
+    if (!m_sorter) {
+        while (true) {
+            auto row = TRY(m_input->next());
+            if (!row) {
+                return row;
+            }
+            if (!m_seen_rows.insert(row->tuple).second) {
+                continue;
+            }
+            m_memory_used += sizeof(Core::Tuple) + row->tuple.memory_size();
+            if (m_memory_used > m_memory_budget) {
+                TRY(sort_rest());
+            }
+            return row;
+        }
+    }
+
+    // Sorted rows are stored as: whether the row was returned already, the
+    // number of its values, whether it has a source, values and source.
+    // Within rows with the same key, the returned one comes first.
+    while (true) {
+        auto stored = TRY(m_sorter->next().map_error(DbToSQLError { m_start }));
+        if (!stored) {
+            return std::optional<Core::TupleWithSource> {};
+        }
+        auto returned = std::get<bool>(stored->value(0));
+        auto value_count = static_cast<size_t>(std::get<int>(stored->value(1)));
+        auto has_source = std::get<bool>(stored->value(2));
+        std::vector<Core::Value> values { stored->begin() + 3, stored->begin() + 3 + value_count };
+        Core::TupleWithSource row { .tuple = Core::Tuple { std::move(values) }, .source = {} };
+        if (has_source) {
+            row.source = Core::Tuple { std::vector<Core::Value> { stored->begin() + 3 + value_count, stored->end() } };
+        }
+
+        auto key = distinct_key(row.tuple);
+        if (key == m_last_key) {
+            continue;
+        }
+        m_last_key = std::move(key);
+        if (!returned) {
+            return row;
+        }
+    }
+}
+
+std::string DistinctOperator::distinct_key(Core::Tuple const& tuple) const {
+    // Sort keys order INTs and FLOATs as numbers, so types are added to
+    // make them different.
+    static Core::SortKeyEncoder const encoder { { false } };
+    std::string key;
+    for (auto const& value : tuple) {
+        key.push_back(static_cast<char>(value.type()));
+        key += encoder.encode({ value });
+    }
+    return key;
+}
+
+SQLErrorOr<void> DistinctOperator::sort_rest() {
+    m_sorter = std::make_unique<Core::ExternalSorter>(m_memory_budget);
+    auto add = [&](Core::Tuple const& tuple, std::optional<Core::Tuple> const& source, bool returned) -> SQLErrorOr<void> {
+        std::vector<Core::Value> values;
+        values.reserve(3 + tuple.value_count() + (source ? source->value_count() : 0));
+        values.push_back(Core::Value::create_bool(returned));
+        values.push_back(Core::Value::create_int(static_cast<int>(tuple.value_count())));
+        values.push_back(Core::Value::create_bool(source.has_value()));
+        values.insert(values.end(), tuple.begin(), tuple.end());
+        if (source) {
+            values.insert(values.end(), source->begin(), source->end());
+        }
+        auto key = distinct_key(tuple);
+        key.push_back(returned ? 0 : 1);
+        TRY(m_sorter->add(std::move(key), Core::Tuple { std::move(values) }).map_error(DbToSQLError { m_start }));
+        return {};
+    };
+
+    for (auto const& tuple : m_seen_rows) {
+        TRY(add(tuple, {}, true));
+    }
+    m_seen_rows.clear();
+    m_memory_used = 0;
+    while (auto row = TRY(m_input->next())) {
+        TRY(add(row->tuple, row->source, false));
+    }
+    TRY(m_sorter->finish().map_error(DbToSQLError { m_start }));
+    return {};
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> SortOperator::next() {
+    auto row = TRY(m_sorter->next().map_error(DbToSQLError { m_start }));
+    if (!row) {
+        return std::optional<Core::TupleWithSource> {};
+    }
+    return Core::TupleWithSource { .tuple = std::move(*row), .source = {} };
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> MaterializedOperator::next() {
+    if (m_next_row >= m_rows.size()) {
+        return std::optional<Core::TupleWithSource> {};
+    }
+    return std::move(m_rows[m_next_row++]);
+}
+
+}
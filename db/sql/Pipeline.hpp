@@ -0,0 +1,244 @@
+#pragma once
+
+#include <db/core/Batch.hpp>
+#include <db/core/ExternalSort.hpp>
+#include <db/core/Index.hpp>
+#include <db/core/IndexedRelation.hpp>
+#include <db/core/Relation.hpp>
+#include <db/core/ThreadPool.hpp>
+#include <db/core/Tuple.hpp>
+#include <db/sql/SQLError.hpp>
+#include <db/sql/ast/EvaluationContext.hpp>
+#include <db/sql/ast/Expression.hpp>
+#include <db/sql/ast/SelectColumns.hpp>
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <unordered_set>
+#include <vector>
+
+// Pull-based (Volcano-style) operators that SELECT is evaluated with.
+// Every call to next() computes just enough to return a single row, so
+// queries without blocking clauses (GROUP BY, DISTINCT, ORDER BY) stream
+// rows to the caller without reading the whole source first.
+
+namespace Db::Sql::AST {
+
+class Operator {
+public:
+    virtual ~Operator() = default;
+
+    // Returns nullopt after the last row.
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() = 0;
+};
+
+// Operator that reads rows of a relation.
+class SourceOperator : public Operator {
+public:
+    // Whether next() returned any row, used to special-case empty tables.
+    bool read_any_row() const { return m_read_any_row; }
+
+protected:
+    void row_was_read() { m_read_any_row = true; }
+
+private:
+    bool m_read_any_row = false;
+};
+
+class ScanOperator : public SourceOperator {
+public:
+    explicit ScanOperator(Core::RelationIterator rows)
+        : m_rows(std::move(rows)) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    Core::RelationIterator m_rows;
+};
+
+// Reads rows that were found using an index, in the order of `row_ids`.
+class IndexScanOperator : public SourceOperator {
+public:
+    IndexScanOperator(Core::IndexedRelation const& relation, std::vector<Core::RowId> row_ids)
+        : m_relation(relation)
+        , m_row_ids(std::move(row_ids)) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    Core::IndexedRelation const& m_relation;
+    std::vector<Core::RowId> m_row_ids;
+    size_t m_next_row = 0;
+};
+
+// Reads rows in batches, filtering them with `where` (if given) and, if
+// `project` is set, evaluating the columns of the frame for a whole batch
+// at once. Only a single batch is kept in memory. `where` and columns must
+// be batchable.
+class BatchScanOperator : public SourceOperator {
+public:
+    BatchScanOperator(std::unique_ptr<Core::BatchReader> batches, EvaluationContext& context, Expression const* where, bool project)
+        : m_batches(std::move(batches))
+        , m_context(context)
+        , m_where(where)
+        , m_project(project) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    std::unique_ptr<Core::BatchReader> m_batches;
+    EvaluationContext& m_context;
+    Expression const* m_where;
+    bool m_project;
+
+    std::unique_ptr<Core::RowBatch> m_batch;
+    Core::SelectionVector m_selection;
+    std::vector<Core::ValueVector> m_column_values;
+    size_t m_next_row = 0;
+};
+
+// Reads morsels (see Core::Relation::morsels()) on a thread pool, filtering
+// them with `where` (if given) and, if `project` is set, evaluating the
+// columns of the frame. Rows are returned in the order of the relation.
+// Only a few morsels are read ahead of the one that rows are returned from.
+// `where` and columns must be batchable, since these only read the row and
+// can be evaluated by many threads at once.
+// Morsels are read on other threads even when next() isn't called, so the
+// relation must not be changed until the operator is destroyed. Cursors
+// ensure this by reading all their rows before a statement changes tables
+// (see Database::materialize_open_streams()).
+class ParallelScanOperator : public SourceOperator {
+public:
+    ParallelScanOperator(Core::ThreadPool& pool, std::vector<Core::RelationIterator> morsels, EvaluationContext& context, Expression const* where, bool project);
+    virtual ~ParallelScanOperator() override;
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    struct Morsel {
+        std::vector<Core::TupleWithSource> rows;
+        bool read_any_row = false;
+    };
+
+    static SQLErrorOr<Morsel> read_morsel(Core::RelationIterator&, EvaluationContext&, Expression const* where, bool project);
+    void submit_next_morsel();
+
+    Core::ThreadPool& m_pool;
+    std::vector<Core::RelationIterator> m_morsels;
+    EvaluationContext& m_context;
+    Expression const* m_where;
+    bool m_project;
+
+    size_t m_next_morsel = 0;
+    std::deque<std::future<SQLErrorOr<Morsel>>> m_pending_morsels;
+    std::vector<Core::TupleWithSource> m_rows;
+    size_t m_next_row = 0;
+};
+
+// WHERE
+class FilterOperator : public Operator {
+public:
+    FilterOperator(std::unique_ptr<Operator> input, EvaluationContext& context, Expression const& condition)
+        : m_input(std::move(input))
+        , m_context(context)
+        , m_condition(condition) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    std::unique_ptr<Operator> m_input;
+    EvaluationContext& m_context;
+    Expression const& m_condition;
+};
+
+// Evaluates columns of the current frame. Output rows have the input row
+// as their source.
+class ProjectOperator : public Operator {
+public:
+    ProjectOperator(std::unique_ptr<Operator> input, EvaluationContext& context)
+        : m_input(std::move(input))
+        , m_context(context) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    std::unique_ptr<Operator> m_input;
+    EvaluationContext& m_context;
+};
+
+// TOP n. The input is not read anymore after `limit` rows.
+class LimitOperator : public Operator {
+public:
+    LimitOperator(std::unique_ptr<Operator> input, size_t limit)
+        : m_input(std::move(input))
+        , m_limit(limit) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    std::unique_ptr<Operator> m_input;
+    size_t m_limit;
+    size_t m_returned = 0;
+};
+
+// DISTINCT. Returns first occurrences of rows as they are read, comparing
+// them as index keys: values of different types are never equal, and NULLs
+// are equal to each other. Only the returned rows are kept in memory. When
+// they exceed `memory_budget`, the rest of the input is read at once and
+// deduplicated by an external sort, together with the returned rows, and
+// the remaining rows are returned in the order of the sort. `start` is used
+// to report errors.
+class DistinctOperator : public Operator {
+public:
+    DistinctOperator(std::unique_ptr<Operator> input, size_t memory_budget, size_t start)
+        : m_input(std::move(input))
+        , m_memory_budget(memory_budget)
+        , m_start(start) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    // Sort key that is equal only for rows that are equal as index keys.
+    std::string distinct_key(Core::Tuple const&) const;
+    SQLErrorOr<void> sort_rest();
+
+    std::unique_ptr<Operator> m_input;
+    size_t m_memory_budget;
+    size_t m_start;
+    size_t m_memory_used = 0;
+    std::unordered_set<Core::Tuple, Core::IndexKeyHash, Core::IndexKeyEqual> m_seen_rows;
+
+    std::unique_ptr<Core::ExternalSorter> m_sorter;
+    std::optional<std::string> m_last_key;
+};
+
+// Rows of a finished sort. `start` is used to report errors.
+class SortOperator : public Operator {
+public:
+    SortOperator(std::unique_ptr<Core::ExternalSorter> sorter, size_t start)
+        : m_sorter(std::move(sorter))
+        , m_start(start) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    std::unique_ptr<Core::ExternalSorter> m_sorter;
+    size_t m_start;
+};
+
+// Rows that were computed already, e.g. by blocking clauses.
+class MaterializedOperator : public Operator {
+public:
+    explicit MaterializedOperator(std::vector<Core::TupleWithSource> rows)
+        : m_rows(std::move(rows)) { }
+
+    virtual SQLErrorOr<std::optional<Core::TupleWithSource>> next() override;
+
+private:
+    std::vector<Core::TupleWithSource> m_rows;
+    size_t m_next_row = 0;
+};
+
+}
@@ -12,7 +12,7 @@
 
 namespace Db::Sql {
 
-SQLErrorOr<Core::ValueOrResultSet> run_query(Core::Database& db, std::string const& query) {
+SQLErrorOr<Cursor> run_query(Core::Database& db, std::string const& query) {
     std::istringstream in { query };
     Db::Sql::Lexer lexer { in };
     auto tokens = lexer.lex();
@@ -21,9 +21,7 @@ SQLErrorOr<Core::ValueOrResultSet> run_query(Core::Database& db, std::string con
     // }
 
     auto statement = TRY(Db::Sql::Parser::parse_statement(tokens));
-    auto result = TRY(statement->execute(db));
-    // result.repl_dump(std::cerr);
-    return result;
+    return Cursor::open(db, std::move(statement));
 }
 
 void display_error(SQLError const& error, ssize_t error_start, ssize_t error_end, std::string const& query) {
@@ -3,10 +3,15 @@
 #include <db/core/Database.hpp>
 #include <db/core/Value.hpp>
 #include <db/core/ValueOrResultSet.hpp>
+#include <db/sql/Cursor.hpp>
 
 namespace Db::Sql {
 
-SQLErrorOr<Core::ValueOrResultSet> run_query(Core::Database&, std::string const&);
+// Rows of SELECT are computed while they are read from the cursor. Use
+// Cursor::collect() to get all of them at once. Running a statement that
+// isn't a query reads remaining rows of all open cursors into memory
+// first, so that they aren't changed under them (see Cursor).
+SQLErrorOr<Cursor> run_query(Core::Database&, std::string const&);
 void display_error(SQLError const& error, ssize_t error_start, ssize_t error_end, std::string const& query);
 
 }
@@ -2,28 +2,216 @@
 
 #include <EssaUtil/Is.hpp>
 #include <EssaUtil/ScopeGuard.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <db/core/Database.hpp>
 #include <db/core/DbError.hpp>
+#include <db/core/Index.hpp>
+#include <db/core/SortKey.hpp>
 #include <db/core/Table.hpp>
+#include <db/core/ThreadPool.hpp>
 #include <db/core/Tuple.hpp>
 #include <db/core/Value.hpp>
+#include <db/sql/IndexScan.hpp>
 #include <db/sql/Printing.hpp>
 #include <db/sql/SQLError.hpp>
+#include <db/sql/ast/Function.hpp>
+#include <future>
 #include <memory>
+#include <numeric>
+#include <unordered_map>
 
 namespace Db::Sql::AST {
 
+namespace {
+
+// Groups of GROUP BY, with accumulators of aggregate functions.
+class GroupTable {
+public:
+    struct Group {
+        Core::Tuple key;
+        // Morsel that the first row was read from, see merge().
+        size_t first_morsel;
+        Core::Tuple first_row;
+        std::vector<AggregateFunction::Accumulator> accumulators;
+    };
+
+    explicit GroupTable(size_t aggregate_count)
+        : m_aggregate_count(aggregate_count) { }
+
+    Group& group(Core::Tuple key, Core::Tuple const& row, size_t morsel) {
+        auto [it, inserted] = m_indices.try_emplace(std::move(key), m_groups.size());
+        if (inserted) {
+            m_groups.push_back(Group { .key = it->first, .first_morsel = morsel, .first_row = row, .accumulators = std::vector<AggregateFunction::Accumulator>(m_aggregate_count) });
+        }
+        return m_groups[it->second];
+    }
+
+    // Adds a row of the current frame (which is set to `row`) to its group.
+    SQLErrorOr<void> add_row(EvaluationContext& context, Core::Tuple row, std::vector<size_t> const& key_columns,
+        std::vector<AggregateFunction const*> const& aggregates, size_t morsel) {
+        std::vector<Core::Value> key;
+        key.reserve(key_columns.size());
+        for (auto column : key_columns) {
+            key.push_back(row.value(column));
+        }
+        auto& group = this->group(Core::Tuple { std::move(key) }, row, morsel);
+
+        context.current_frame().row = { .tuple = std::move(row), .source = {} };
+        for (size_t s = 0; s < aggregates.size(); s++) {
+            TRY(aggregates[s]->update(context, group.accumulators[s]));
+        }
+        return {};
+    }
+
+    // Merges partial aggregation of other rows. The first row of a group is
+    // taken from the earliest morsel, so that it doesn't depend on which
+    // thread read which morsel.
+    void merge(GroupTable&& other, std::vector<AggregateFunction const*> const& aggregates) {
+        for (auto& other_group : other.m_groups) {
+            auto& group = this->group(std::move(other_group.key), other_group.first_row, other_group.first_morsel);
+            if (other_group.first_morsel < group.first_morsel) {
+                group.first_morsel = other_group.first_morsel;
+                group.first_row = std::move(other_group.first_row);
+            }
+            for (size_t s = 0; s < aggregates.size(); s++) {
+                aggregates[s]->merge(group.accumulators[s], other_group.accumulators[s]);
+            }
+        }
+    }
+
+    std::vector<Group>& groups() { return m_groups; }
+
+private:
+    size_t m_aggregate_count;
+    std::vector<Group> m_groups;
+    std::unordered_map<Core::Tuple, size_t, Core::IndexKeyHash, Core::IndexKeyEqual> m_indices;
+};
+
+// Takes morsels until there are none left, and aggregates their rows that
+// match `where`.
+SQLErrorOr<GroupTable> aggregate_morsels(EvaluationContext& context, std::vector<Core::RelationIterator>& morsels, std::atomic<size_t>& next_morsel,
+    Expression const* where, std::vector<size_t> const& key_columns, std::vector<AggregateFunction const*> const& aggregates) {
+    GroupTable table { aggregates.size() };
+    auto& frame = context.current_frame();
+    for (auto morsel = next_morsel++; morsel < morsels.size(); morsel = next_morsel++) {
+        while (auto row = morsels[morsel].next()) {
+            auto tuple = row->read();
+            if (where) {
+                frame.row = { .tuple = tuple, .source = {} };
+                if (!TRY(TRY(where->evaluate(context)).to_bool().map_error(DbToSQLError { where->start() }))) {
+                    continue;
+                }
+            }
+            TRY(table.add_row(context, std::move(tuple), key_columns, aggregates, morsel));
+        }
+    }
+    return table;
+}
+
+// Every worker of the thread pool aggregates morsels into its own table
+// (with its own copy of frames), and the tables are merged at the end.
+// `where` and aggregated expressions must be batchable, so that they can be
+// evaluated by many threads at once.
+SQLErrorOr<GroupTable> aggregate_in_parallel(EvaluationContext& context, std::vector<Core::RelationIterator> morsels, Expression const* where,
+    std::vector<size_t> const& key_columns, std::vector<AggregateFunction const*> const& aggregates) {
+    auto& pool = Core::ThreadPool::global();
+    std::atomic<size_t> next_morsel = 0;
+    std::vector<std::future<SQLErrorOr<GroupTable>>> partial_tables;
+    for (size_t s = 0; s < pool.thread_count(); s++) {
+        auto task = std::make_shared<std::packaged_task<SQLErrorOr<GroupTable>()>>([&, worker_context = context]() mutable {
+            auto table = aggregate_morsels(worker_context, morsels, next_morsel, where, key_columns, aggregates);
+            if (table.is_error()) {
+                // Make other workers stop.
+                next_morsel = morsels.size();
+            }
+            return table;
+        });
+        partial_tables.push_back(task->get_future());
+        pool.submit([task] { (*task)(); });
+    }
+
+    // All tasks must finish before returning, since they use the morsels.
+    std::vector<SQLErrorOr<GroupTable>> results;
+    for (auto& partial_table : partial_tables) {
+        results.push_back(partial_table.get());
+    }
+    GroupTable table { aggregates.size() };
+    for (auto& result : results) {
+        if (result.is_error()) {
+            return result.release_error();
+        }
+        table.merge(result.release_value(), aggregates);
+    }
+    return table;
+}
+
+}
+
+SelectIterator::~SelectIterator() {
+    if (m_frame) {
+        m_context.frames.erase(*m_frame);
+    }
+}
+
+SQLErrorOr<std::optional<Core::TupleWithSource>> SelectIterator::next_row() {
+    if (m_finished) {
+        return std::optional<Core::TupleWithSource> {};
+    }
+    auto row = TRY(m_rows->next());
+    if (!row) {
+        m_finished = true;
+        // Rows of the relation may have ended early because of an error.
+        if (m_relation) {
+            TRY(m_relation->read_error().map_error(DbToSQLError { m_select.m_start }));
+        }
+        // Special-case for empty sets
+        if (m_source && !m_source->read_any_row() && m_relation->size() == 0) {
+            TRY(m_select.check_columns_for_empty_table(m_context, *m_relation));
+        }
+    }
+    return row;
+}
+
+SQLErrorOr<std::optional<Core::Tuple>> SelectIterator::next() {
+    auto row = TRY(next_row());
+    if (!row) {
+        return std::optional<Core::Tuple> {};
+    }
+    return std::move(row->tuple);
+}
+
 SQLErrorOr<Core::ResultSet> Select::execute(EvaluationContext& context) const {
+    auto iterator = TRY(open(context));
+    std::vector<Core::Tuple> output_rows;
+    while (auto row = TRY(iterator->next())) {
+        output_rows.push_back(std::move(*row));
+    }
+
+    Core::ResultSet result { iterator->column_names(), std::move(output_rows) };
+
+    if (context.db && m_options.select_into) {
+        // TODO: Insert, not overwrite records
+        if (context.db->exists(*m_options.select_into))
+            TRY(context.db->drop_table(*m_options.select_into).map_error(DbToSQLError { m_start }));
+        TRY(context.db->create_table_from_query(std::move(result), *m_options.select_into).map_error(DbToSQLError { m_start }));
+    }
+    return result;
+}
+
+SQLErrorOr<std::unique_ptr<SelectIterator>> Select::open(EvaluationContext& context) const {
     // Comments specify SQL Conceptional Evaluation:
     // https://docs.microsoft.com/en-us/sql/t-sql/queries/select-transact-sql#logical-processing-order-of-the-select-statement
-    // FROM
+    std::unique_ptr<SelectIterator> iterator { new SelectIterator { *this, context } };
 
-    std::unique_ptr<Core::Relation> relation = m_options.from ? TRY(m_options.from->evaluate(context)) : nullptr;
-
-    SelectColumns select_all_columns;
+    // FROM
+    if (m_options.from) {
+        iterator->m_relation = TRY(m_options.from->evaluate(context));
+    }
+    auto table = iterator->m_relation.get();
 
-    SelectColumns const& columns = *TRY([this, table = relation.get(), &select_all_columns]() -> SQLErrorOr<SelectColumns const*> {
+    SelectColumns const& columns = *TRY([&]() -> SQLErrorOr<SelectColumns const*> {
         if (m_options.columns.select_all()) {
             if (!table) {
                 return SQLError { "You need a table to do SELECT *", m_start };
@@ -32,276 +220,479 @@ SQLErrorOr<Core::ResultSet> Select::execute(EvaluationContext& context) const {
             for (size_t s = 0; s < table->columns().size(); s++) {
                 all_columns.push_back(SelectColumns::Column { .column = std::make_unique<IndexExpression>(m_start + 1, s, table->columns()[s].name()) });
             }
-            select_all_columns = SelectColumns { std::move(all_columns) };
-            return &select_all_columns;
+            iterator->m_select_all_columns = SelectColumns { std::move(all_columns) };
+            return &iterator->m_select_all_columns;
         }
         return &m_options.columns;
     }());
 
-    auto& frame = context.frames.emplace_back(m_options.from.get(), columns);
-    Util::ScopeGuard guard { [&] { context.frames.pop_back(); } };
+    for (auto const& column : columns.columns()) {
+        if (column.alias)
+            iterator->m_column_names.push_back(*column.alias);
+        else
+            iterator->m_column_names.push_back(column.column->to_string());
+    }
 
-    auto rows = TRY([&]() -> SQLErrorOr<std::vector<Core::TupleWithSource>> {
-        if (m_options.from) {
-            // SELECT etc.
-            // TODO: Make use of iterator capabilities of this instead of
-            //       reading everything into memory.
-            return collect_rows(context, *relation);
-        }
+    iterator->m_frame = context.frames.emplace(context.frames.end(), m_options.from.get(), columns);
+    auto& frame = **iterator->m_frame;
 
+    if (!table) {
         std::vector<Core::Value> values;
         for (auto const& column : m_options.columns.columns()) {
             values.push_back(TRY(column.column->evaluate(context)));
         }
-        return std::vector<Core::TupleWithSource> { { .tuple = Core::Tuple { values }, .source = {} } };
-    }());
+        iterator->m_rows = std::make_unique<MaterializedOperator>(std::vector<Core::TupleWithSource> { { .tuple = Core::Tuple { values }, .source = {} } });
+    }
+    else if (m_options.group_by || should_group(columns)) {
+        // SELECT etc.
+        iterator->m_rows = std::make_unique<MaterializedOperator>(TRY(collect_rows(context, *table)));
+        TRY(table->read_error().map_error(DbToSQLError { m_start }));
+    }
+    else {
+        // WHERE, SELECT
+        iterator->m_rows = TRY(scan(context, *table, find_index_rows(context, *table), true, iterator->m_source));
+    }
 
-    frame.row_type = EvaluationContextFrame::RowType::FromResultSet;
+    // Known if rows were counted by a blocking clause.
+    std::optional<size_t> row_count;
 
     // DISTINCT
     if (m_options.distinct) {
-        std::vector<Core::TupleWithSource> occurences;
-
-        // FIXME: O(n^2)
-        for (const auto& row : rows) {
-            bool distinct = true;
-            for (const auto& to_compare : occurences) {
-                if (TRY((row == to_compare).map_error(DbToSQLError { m_start }))) {
-                    distinct = false;
-                    break;
-                }
-            }
-
-            if (distinct)
-                occurences.push_back(row);
-        }
-
-        rows = std::move(occurences);
+        iterator->m_rows = std::make_unique<DistinctOperator>(std::move(iterator->m_rows), sort_memory_budget(context), m_start);
     }
 
     // ORDER BY
     if (m_options.order_by) {
-        auto generate_tuple_pair_for_ordering = [&](Core::TupleWithSource const& lhs, Core::TupleWithSource const& rhs) -> SQLErrorOr<std::pair<Core::Tuple, Core::Tuple>> {
-            std::vector<Core::Value> lhs_values;
-            std::vector<Core::Value> rhs_values;
-
-            for (auto const& column : m_options.order_by->columns) {
-                frame.row = lhs;
-                auto lhs_value = TRY(column.expression->evaluate(context));
-                frame.row = rhs;
-                auto rhs_value = TRY(column.expression->evaluate(context));
-
-                if (column.order == OrderBy::Order::Ascending) {
-                    lhs_values.push_back(std::move(lhs_value));
-                    rhs_values.push_back(std::move(rhs_value));
-                }
-                else {
-                    lhs_values.push_back(std::move(rhs_value));
-                    rhs_values.push_back(std::move(lhs_value));
-                }
-            }
-
-            return std::pair<Core::Tuple, Core::Tuple> { Core::Tuple { lhs_values }, Core::Tuple { rhs_values } };
-        };
-
-        std::optional<SQLError> error;
-        std::stable_sort(rows.begin(), rows.end(), [&](Core::TupleWithSource const& lhs, Core::TupleWithSource const& rhs) -> bool {
-            auto pair = generate_tuple_pair_for_ordering(lhs, rhs);
-            if (pair.is_error()) {
-                error = pair.release_error();
-                return false;
-            }
-            auto [lhs_value, rhs_value] = pair.release_value();
-            // std::cout << lhs_value << " < " << rhs_value << std::endl;
-            return lhs_value < rhs_value;
-        });
-        if (error)
-            return *error;
+        if (m_options.top && m_options.top->unit == Top::Unit::Val) {
+            // TOP n ... ORDER BY: Keep only n best rows instead of sorting
+            // all of them.
+            auto rows = TRY(top_n_rows(context, *iterator, m_options.top->value));
+            frame.row_type = EvaluationContextFrame::RowType::FromResultSet;
+            iterator->set_rows(std::make_unique<MaterializedOperator>(std::move(rows)));
+            return iterator;
+        }
+        auto sorter = TRY(sort_rows(context, *iterator));
+        frame.row_type = EvaluationContextFrame::RowType::FromResultSet;
+        row_count = sorter->row_count();
+        iterator->set_rows(std::make_unique<SortOperator>(std::move(sorter), m_start));
     }
 
+    // TOP
     if (m_options.top) {
+        size_t limit = m_options.top->value;
         if (m_options.top->unit == Top::Unit::Perc) {
+            if (!row_count) {
+                std::vector<Core::TupleWithSource> rows;
+                while (auto row = TRY(iterator->next_row())) {
+                    rows.push_back(std::move(*row));
+                }
+                frame.row_type = EvaluationContextFrame::RowType::FromResultSet;
+                row_count = rows.size();
+                iterator->set_rows(std::make_unique<MaterializedOperator>(std::move(rows)));
+            }
             float mul = static_cast<float>(std::min(m_options.top->value, (unsigned)100)) / 100;
-            rows.resize(rows.size() * mul, Core::TupleWithSource { {}, {} });
+            limit = *row_count * mul;
         }
-        else {
-            rows.resize(std::min<size_t>(m_options.top->value, rows.size()), Core::TupleWithSource { {}, {} });
+        iterator->m_rows = std::make_unique<LimitOperator>(std::move(iterator->m_rows), limit);
+    }
+
+    return iterator;
+}
+
+SQLErrorOr<std::string> Select::order_by_key(EvaluationContext& context, Core::SortKeyEncoder const& encoder, Core::TupleWithSource const& row) const {
+    auto& frame = context.current_frame();
+    auto row_type = frame.row_type;
+    frame.row_type = EvaluationContextFrame::RowType::FromResultSet;
+    frame.row = row;
+    std::vector<Core::Value> values;
+    for (auto const& column : m_options.order_by->columns) {
+        auto value = column.expression->evaluate(context);
+        if (value.is_error()) {
+            frame.row_type = row_type;
+            return value.release_error();
         }
+        values.push_back(value.release_value());
     }
+    frame.row_type = row_type;
+    return encoder.encode(values);
+}
 
-    std::vector<std::string> column_names;
-    for (auto const& column : columns.columns()) {
-        if (column.alias)
-            column_names.push_back(*column.alias);
-        else
-            column_names.push_back(column.column->to_string());
+Core::SortKeyEncoder Select::order_by_key_encoder() const {
+    std::vector<bool> descending;
+    for (auto const& column : m_options.order_by->columns) {
+        descending.push_back(column.order == OrderBy::Order::Descending);
     }
+    return Core::SortKeyEncoder { std::move(descending) };
+}
 
-    std::vector<Core::Tuple> output_rows;
-    for (auto const& row : rows)
-        output_rows.push_back(std::move(row.tuple));
+SQLErrorOr<std::vector<Core::TupleWithSource>> Select::top_n_rows(EvaluationContext& context, SelectIterator& iterator, size_t limit) const {
+    if (limit == 0) {
+        return std::vector<Core::TupleWithSource> {};
+    }
 
-    Core::ResultSet result { column_names, std::move(output_rows) };
+    struct HeapEntry {
+        std::string key;
+        size_t index;
+        Core::TupleWithSource row;
+    };
+    // Ties are resolved by the input order, so that the result is the same
+    // as of a stable sort.
+    auto less = [](HeapEntry const& lhs, HeapEntry const& rhs) {
+        if (lhs.key != rhs.key)
+            return lhs.key < rhs.key;
+        return lhs.index < rhs.index;
+    };
 
-    if (context.db && m_options.select_into) {
-        // TODO: Insert, not overwrite records
-        if (context.db->exists(*m_options.select_into))
-            TRY(context.db->drop_table(*m_options.select_into).map_error(DbToSQLError { m_start }));
-        TRY(context.db->create_table_from_query(std::move(result), *m_options.select_into).map_error(DbToSQLError { m_start }));
+    // Max-heap of the best `limit` rows read so far, with the worst one on
+    // top.
+    auto encoder = order_by_key_encoder();
+    std::vector<HeapEntry> heap;
+    size_t index = 0;
+    while (auto row = TRY(iterator.next_row())) {
+        HeapEntry entry { .key = TRY(order_by_key(context, encoder, *row)), .index = index++, .row = std::move(*row) };
+        if (heap.size() < limit) {
+            heap.push_back(std::move(entry));
+            std::push_heap(heap.begin(), heap.end(), less);
+        }
+        else if (less(entry, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), less);
+            heap.back() = std::move(entry);
+            std::push_heap(heap.begin(), heap.end(), less);
+        }
     }
-    return result;
+
+    std::sort_heap(heap.begin(), heap.end(), less);
+    std::vector<Core::TupleWithSource> rows;
+    rows.reserve(heap.size());
+    for (auto& entry : heap) {
+        rows.push_back(std::move(entry.row));
+    }
+    return rows;
 }
 
-SQLErrorOr<std::vector<Core::TupleWithSource>> Select::collect_rows(EvaluationContext& context, Core::Relation& table) const {
-    auto& frame = context.current_frame();
+SQLErrorOr<std::unique_ptr<Core::ExternalSorter>> Select::sort_rows(EvaluationContext& context, SelectIterator& iterator) const {
+    auto encoder = order_by_key_encoder();
+    auto sorter = std::make_unique<Core::ExternalSorter>(sort_memory_budget(context));
+    while (auto row = TRY(iterator.next_row())) {
+        auto key = TRY(order_by_key(context, encoder, *row));
+        TRY(sorter->add(std::move(key), std::move(row->tuple)).map_error(DbToSQLError { m_start }));
+    }
+    TRY(sorter->finish().map_error(DbToSQLError { m_start }));
+    return sorter;
+}
 
-    auto should_include_row = [&](Core::Tuple const& row) -> SQLErrorOr<bool> {
-        if (!m_options.where)
-            return true;
-        frame.row = { .tuple = row, .source = {} };
-        return TRY(m_options.where->evaluate(context)).to_bool().map_error(DbToSQLError { m_start });
-    };
+size_t Select::sort_memory_budget(EvaluationContext& context) {
+    return context.db ? context.db->sort_memory_budget() : Core::DefaultSortMemoryBudget;
+}
 
-    // Collect all rows that should be included (applying WHERE and GROUP BY)
-    // There rows are not yet SELECT'ed - they contain columns from table, no aliases etc.
-    std::map<Core::Tuple, std::vector<Core::Tuple>> nonaggregated_row_groups;
+bool Select::should_group(SelectColumns const& columns) const {
+    if (m_options.group_by) {
+        return m_options.group_by->type == GroupBy::GroupOrPartition::GROUP;
+    }
+    return std::any_of(columns.columns().begin(), columns.columns().end(), [](auto const& column) {
+        return column.column->contains_aggregate_function();
+    });
+}
 
-    TRY(table.rows().try_for_each_row([&](Core::Tuple const& row) -> SQLErrorOr<void> {
-        // WHERE
-        if (!TRY(should_include_row(row)))
-            return {};
-
-        std::vector<Core::Value> group_key;
-
-        if (m_options.group_by) {
-            for (const auto& column_name : m_options.group_by->columns) {
-                // TODO: Handle aliases, indexes ("GROUP BY 1") and aggregate functions ("GROUP BY COUNT(x)")
-                // https://docs.microsoft.com/en-us/sql/t-sql/queries/select-transact-sql?view=sql-server-ver16#g-using-group-by-with-an-expression
-                auto column = table.get_column(column_name);
-                if (!column) {
-                    if (m_options.group_by->type == GroupBy::GroupOrPartition::GROUP)
-                        return SQLError { "Nonexistent column used in GROUP BY: '" + column_name + "'", m_start };
-                    else if (m_options.group_by->type == GroupBy::GroupOrPartition::PARTITION)
-                        return SQLError { "Nonexistent column used in PARTITION BY: '" + column_name + "'", m_start };
-                }
-                group_key.push_back(row.value(column->index));
-            }
+std::optional<std::vector<Core::RowId>> Select::find_index_rows(EvaluationContext& context, Core::Relation const& table) const {
+    // Use an index to find rows if WHERE allows it.
+    auto indexed_relation = table.indexed_relation();
+    if (!indexed_relation || !m_options.where || !m_options.from) {
+        return {};
+    }
+    return find_rows_using_index(*indexed_relation, *m_options.from, context.db, *m_options.where);
+}
+
+SQLErrorOr<std::unique_ptr<Operator>> Select::scan(EvaluationContext& context, Core::Relation const& table, std::optional<std::vector<Core::RowId>> index_rows, bool project, SourceOperator const*& source) const {
+    auto const& columns = context.current_frame().columns.columns();
+
+    std::unique_ptr<Operator> rows;
+    if (index_rows) {
+        auto index_scan = std::make_unique<IndexScanOperator>(*table.indexed_relation(), std::move(*index_rows));
+        source = index_scan.get();
+        rows = std::move(index_scan);
+    }
+    else if (auto batches = !m_options.where || m_options.where->is_batchable(context) ? table.batches() : nullptr) {
+        // Filter rows in batches. Columns are evaluated in batches too,
+        // if possible.
+        bool project_batches = project && std::all_of(columns.begin(), columns.end(), [&](auto const& column) {
+            return column.column->is_batchable(context);
+        });
+        auto batch_scan = std::make_unique<BatchScanOperator>(std::move(batches), context, m_options.where.get(), project_batches);
+        source = batch_scan.get();
+        if (project && !project_batches) {
+            return std::make_unique<ProjectOperator>(std::move(batch_scan), context);
         }
+        return batch_scan;
+    }
+    else if (auto morsels = parallel_scan_morsels(context, table); morsels.size() > 1) {
+        // Filter and evaluate columns of large tables on many threads.
+        bool project_parallel = project && std::all_of(columns.begin(), columns.end(), [&](auto const& column) {
+            return column.column->is_batchable(context);
+        });
+        auto parallel_scan = std::make_unique<ParallelScanOperator>(Core::ThreadPool::global(), std::move(morsels), context, m_options.where.get(), project_parallel);
+        source = parallel_scan.get();
+        if (project && !project_parallel) {
+            return std::make_unique<ProjectOperator>(std::move(parallel_scan), context);
+        }
+        return parallel_scan;
+    }
+    else {
+        auto table_scan = std::make_unique<ScanOperator>(table.rows());
+        source = table_scan.get();
+        rows = std::move(table_scan);
+    }
 
-        nonaggregated_row_groups[{ group_key }].push_back(row);
+    if (m_options.where) {
+        rows = std::make_unique<FilterOperator>(std::move(rows), context, *m_options.where);
+    }
+    if (project) {
+        rows = std::make_unique<ProjectOperator>(std::move(rows), context);
+    }
+    return rows;
+}
+
+std::vector<Core::RelationIterator> Select::parallel_scan_morsels(EvaluationContext& context, Core::Relation const& table) const {
+    if (Core::ThreadPool::global().thread_count() < 2 || table.estimated_size() <= Core::MorselSize) {
+        return {};
+    }
+    if (m_options.where && !m_options.where->is_batchable(context)) {
         return {};
-    }));
+    }
+    return table.morsels(Core::MorselSize);
+}
 
-    // Check if grouping / aggregation should be performed
-    bool should_group = false;
-    if (m_options.group_by) {
-        should_group = true;
+SQLErrorOr<void> Select::check_columns_for_empty_table(EvaluationContext& context, Core::Relation const& table) const {
+    auto& frame = context.current_frame();
+    std::vector<Core::Value> values;
+    for (size_t s = 0; s < table.columns().size(); s++) {
+        values.push_back(Core::Value::null());
     }
-    else {
+    Core::Tuple dummy_row { values };
+    frame.row_group = std::span { &dummy_row, 1 };
+    for (auto const& column : m_options.columns.columns()) {
+        frame.row = { .tuple = dummy_row, .source = {} };
+        TRY(column.column->evaluate(context));
+    }
+    frame.row_group = {};
+    return {};
+}
+
+SQLErrorOr<std::vector<size_t>> Select::group_by_columns(Core::Relation const& table) const {
+    std::vector<size_t> columns;
+    if (!m_options.group_by) {
+        return columns;
+    }
+    for (const auto& column_name : m_options.group_by->columns) {
+        // TODO: Handle aliases, indexes ("GROUP BY 1") and aggregate functions ("GROUP BY COUNT(x)")
+        // https://docs.microsoft.com/en-us/sql/t-sql/queries/select-transact-sql?view=sql-server-ver16#g-using-group-by-with-an-expression
+        auto column = table.get_column(column_name);
+        if (!column) {
+            if (m_options.group_by->type == GroupBy::GroupOrPartition::GROUP)
+                return SQLError { "Nonexistent column used in GROUP BY: '" + column_name + "'", m_start };
+            else
+                return SQLError { "Nonexistent column used in PARTITION BY: '" + column_name + "'", m_start };
+        }
+        columns.push_back(column->index);
+    }
+    return columns;
+}
+
+SQLErrorOr<std::vector<Core::TupleWithSource>> Select::collect_rows(EvaluationContext& context, Core::Relation& table) const {
+    auto& frame = context.current_frame();
+    if (!should_group(frame.columns)) {
+        return partition_rows(context, table);
+    }
+
+    std::vector<Core::TupleWithSource> aggregated_rows;
+
+    // Aggregates over the whole table are computed in batches, if all
+    // columns are aggregates.
+    std::vector<AggregateFunction const*> aggregates;
+    if (!m_options.group_by && !m_options.having && table.size() != 0) {
         for (auto const& column : frame.columns.columns()) {
-            if (column.column->contains_aggregate_function()) {
-                should_group = true;
+            auto aggregate = dynamic_cast<AggregateFunction const*>(column.column.get());
+            if (!aggregate || !aggregate->is_batch_aggregatable(context)) {
+                aggregates.clear();
                 break;
             }
+            aggregates.push_back(aggregate);
         }
     }
 
-    if (m_options.group_by && m_options.group_by->type == GroupBy::GroupOrPartition::PARTITION) {
-        should_group = false;
-    }
+    auto index_rows = find_index_rows(context, table);
+    auto batches = !aggregates.empty() && !index_rows && (!m_options.where || m_options.where->is_batchable(context))
+        ? table.batches()
+        : nullptr;
+    if (batches) {
+        std::vector<AggregateFunction::Accumulator> aggregate_states(aggregates.size());
+        bool aggregated_any_row = false;
+
+        while (auto batch = batches->next()) {
+            auto rows = batch->rows();
+            if (m_options.where)
+                rows = TRY(m_options.where->filter_batch(context, *batch, rows));
+
+            aggregated_any_row |= !rows.empty();
+            for (size_t s = 0; s < aggregates.size(); s++) {
+                TRY(aggregates[s]->update_batch(context, *batch, rows, aggregate_states[s]));
+            }
+        }
 
-    // Special-case for empty sets
-    if (table.size() == 0) {
-        if (should_group) {
-            // We need to create at least one group to make aggregate
-            // functions return one row with value "0".
-            nonaggregated_row_groups.insert({ Core::Tuple {}, {} });
+        // Like when grouping, there are no groups if no rows matched.
+        if (aggregated_any_row) {
+            std::vector<Core::Value> values;
+            for (size_t s = 0; s < aggregates.size(); s++) {
+                values.push_back(TRY(aggregates[s]->finalize(aggregate_states[s])));
+            }
+            aggregated_rows.push_back(Core::TupleWithSource { .tuple = { values }, .source = {} });
         }
+        return aggregated_rows;
+    }
 
-        // Let's also check column expressions for validity, even
-        // if they won't run on real rows.
-        std::vector<Core::Value> values;
-        for (size_t s = 0; s < table.columns().size(); s++) {
-            values.push_back(Core::Value::null());
+    // Hash aggregation: Only state of aggregate functions (and the first
+    // row, for columns that are grouped by) is kept for every group.
+    aggregates.clear();
+    for (auto const& column : frame.columns.columns()) {
+        column.column->collect_aggregate_functions(aggregates);
+    }
+    if (m_options.having) {
+        m_options.having->collect_aggregate_functions(aggregates);
+    }
+
+    auto key_columns = TRY(group_by_columns(table));
+    frame.row_group = {};
+
+    GroupTable group_table { aggregates.size() };
+    auto morsels = index_rows ? std::vector<Core::RelationIterator> {} : parallel_scan_morsels(context, table);
+    bool aggregate_parallel = morsels.size() > 1 && std::all_of(aggregates.begin(), aggregates.end(), [&](auto const* aggregate) {
+        return aggregate->is_batch_aggregatable(context);
+    });
+    if (aggregate_parallel) {
+        group_table = TRY(aggregate_in_parallel(context, std::move(morsels), m_options.where.get(), key_columns, aggregates));
+    }
+    else {
+        // WHERE
+        SourceOperator const* source = nullptr;
+        auto rows = TRY(scan(context, table, std::move(index_rows), false, source));
+        while (auto row = TRY(rows->next())) {
+            TRY(group_table.add_row(context, std::move(row->tuple), key_columns, aggregates, 0));
         }
-        Core::Tuple dummy_row { values };
-        frame.row_group = std::span { &dummy_row, 1 };
-        for (auto const& column : m_options.columns.columns()) {
-            frame.row = { .tuple = dummy_row, .source = {} };
-            TRY(column.column->evaluate(context));
+
+        // Special-case for empty sets. Computing size() of joins requires
+        // reading them again, so avoid it if possible.
+        if (!source->read_any_row() && table.size() == 0) {
+            // We need to create at least one group to make aggregate
+            // functions return one row with value "0".
+            std::vector<Core::Value> null_row(table.columns().size(), Core::Value::null());
+            group_table.group(Core::Tuple {}, Core::Tuple { null_row }, 0);
+            TRY(check_columns_for_empty_table(context, table));
         }
     }
+    auto& groups = group_table.groups();
 
-    // std::cout << "should_group: " << should_group << std::endl;
-    // std::cout << "nonaggregated_row_groups.size(): " << nonaggregated_row_groups.size() << std::endl;
+    // Groups are returned in the order of their keys.
+    std::vector<size_t> group_order(groups.size());
+    std::iota(group_order.begin(), group_order.end(), 0);
+    std::sort(group_order.begin(), group_order.end(), [&](size_t lhs, size_t rhs) {
+        return Core::compare_index_keys(groups[lhs].key, groups[rhs].key) < 0;
+    });
 
-    // Group + aggregate rows if needed, otherwise just evaluate column expressions
-    std::vector<Core::TupleWithSource> aggregated_rows;
-    if (should_group) {
-        auto should_include_group = [&](EvaluationContext& context, Core::TupleWithSource const& row) -> SQLErrorOr<bool> {
-            if (!m_options.having)
-                return true;
-            frame.row = row;
-            return TRY(m_options.having->evaluate(context)).to_bool().map_error(DbToSQLError { m_start });
-        };
-
-        auto is_in_group_by = [&](SelectColumns::Column const& column) {
-            if (!m_options.group_by)
-                return false;
-            for (auto const& group_by_column : m_options.group_by->columns) {
-                auto referenced_columns = column.column->referenced_columns();
-                if (std::find(referenced_columns.begin(), referenced_columns.end(), group_by_column) != referenced_columns.end())
-                    return true;
-            }
+    auto is_in_group_by = [&](SelectColumns::Column const& column) {
+        if (!m_options.group_by)
             return false;
-        };
+        for (auto const& group_by_column : m_options.group_by->columns) {
+            auto referenced_columns = column.column->referenced_columns();
+            if (std::find(referenced_columns.begin(), referenced_columns.end(), group_by_column) != referenced_columns.end())
+                return true;
+        }
+        return false;
+    };
 
-        for (auto const& group : nonaggregated_row_groups) {
-            frame.row_type = EvaluationContextFrame::RowType::FromTable;
-            frame.row_group = group.second;
-            std::vector<Core::Value> values;
-            for (auto& column : frame.columns.columns()) {
-                if (column.column->contains_aggregate_function()) {
-                    frame.row = {};
-                    values.push_back(TRY(column.column->evaluate(context)));
-                }
-                else if (is_in_group_by(column)) {
-                    frame.row = { .tuple = group.second[0], .source = {} };
-                    values.push_back(TRY(column.column->evaluate(context)));
-                }
-                else {
-                    // "All columns must be either aggregate or occur in GROUP BY clause"
-                    // TODO: Store (better) location info
-                    return SQLError { "Column '" + column.column->to_string() + "' must be either aggregate or occur in GROUP BY clause", m_start };
-                }
+    std::unordered_map<AggregateFunction const*, Core::Value> aggregate_values;
+    frame.aggregate_values = &aggregate_values;
+    Util::ScopeGuard guard { [&] { frame.aggregate_values = nullptr; } };
+
+    for (auto index : group_order) {
+        auto const& group = groups[index];
+        aggregate_values.clear();
+        for (size_t s = 0; s < aggregates.size(); s++) {
+            aggregate_values[aggregates[s]] = TRY(aggregates[s]->finalize(group.accumulators[s]));
+        }
+
+        frame.row_type = EvaluationContextFrame::RowType::FromTable;
+        std::vector<Core::Value> values;
+        for (auto& column : frame.columns.columns()) {
+            if (column.column->contains_aggregate_function()) {
+                frame.row = {};
+                values.push_back(TRY(column.column->evaluate(context)));
+            }
+            else if (is_in_group_by(column)) {
+                frame.row = { .tuple = group.first_row, .source = {} };
+                values.push_back(TRY(column.column->evaluate(context)));
+            }
+            else {
+                // "All columns must be either aggregate or occur in GROUP BY clause"
+                // TODO: Store (better) location info
+                return SQLError { "Column '" + column.column->to_string() + "' must be either aggregate or occur in GROUP BY clause", m_start };
             }
+        }
 
-            frame.row_type = EvaluationContextFrame::RowType::FromResultSet;
+        frame.row_type = EvaluationContextFrame::RowType::FromResultSet;
 
-            Core::TupleWithSource aggregated_row { .tuple = { values }, .source = {} };
+        Core::TupleWithSource aggregated_row { .tuple = { values }, .source = {} };
 
-            // HAVING
-            if (!TRY(should_include_group(context, aggregated_row)))
+        // HAVING
+        if (m_options.having) {
+            frame.row = aggregated_row;
+            if (!TRY(TRY(m_options.having->evaluate(context)).to_bool().map_error(DbToSQLError { m_start })))
                 continue;
+        }
 
-            aggregated_rows.push_back(std::move(aggregated_row));
+        aggregated_rows.push_back(std::move(aggregated_row));
+    }
+
+    return aggregated_rows;
+}
+
+SQLErrorOr<std::vector<Core::TupleWithSource>> Select::partition_rows(EvaluationContext& context, Core::Relation& table) const {
+    auto& frame = context.current_frame();
+
+    // Collect all rows that should be included (applying WHERE and PARTITION BY)
+    // There rows are not yet SELECT'ed - they contain columns from table, no aliases etc.
+    std::map<Core::Tuple, std::vector<Core::Tuple>> row_groups;
+    auto key_columns = TRY(group_by_columns(table));
+
+    // WHERE
+    SourceOperator const* source = nullptr;
+    auto rows = TRY(scan(context, table, find_index_rows(context, table), false, source));
+    while (auto row = TRY(rows->next())) {
+        std::vector<Core::Value> key;
+        for (auto column : key_columns) {
+            key.push_back(row->tuple.value(column));
         }
+        row_groups[{ key }].push_back(std::move(row->tuple));
     }
-    else {
-        for (auto const& group : nonaggregated_row_groups) {
-            for (auto const& row : group.second) {
-                std::vector<Core::Value> values;
-                frame.row_group = group.second;
-                for (auto& column : frame.columns.columns()) {
-                    frame.row = { .tuple = row, .source = row };
-                    values.push_back(TRY(column.column->evaluate(context)));
-                }
-                aggregated_rows.push_back(Core::TupleWithSource { .tuple = { values }, .source = row });
+
+    // Special-case for empty sets
+    if (!source->read_any_row() && table.size() == 0) {
+        TRY(check_columns_for_empty_table(context, table));
+    }
+
+    std::vector<Core::TupleWithSource> result_rows;
+    for (auto const& group : row_groups) {
+        for (auto const& row : group.second) {
+            std::vector<Core::Value> values;
+            frame.row_group = group.second;
+            for (auto& column : frame.columns.columns()) {
+                frame.row = { .tuple = row, .source = row };
+                values.push_back(TRY(column.column->evaluate(context)));
             }
+            result_rows.push_back(Core::TupleWithSource { .tuple = { values }, .source = row });
         }
     }
 
-    return aggregated_rows;
+    return result_rows;
 }
 
 std::string Select::to_string() const {
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <db/core/Database.hpp>
+#include <db/core/SortKey.hpp>
+#include <db/sql/Pipeline.hpp>
 #include <db/sql/ast/Expression.hpp>
 #include <db/sql/ast/TableExpression.hpp>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
@@ -51,6 +54,48 @@ struct Top {
     unsigned value = 100;
 };
 
+class Select;
+
+// Rows of a SELECT, computed while they are read. The query's frame stays
+// on the evaluation context until the iterator is destroyed, so it must be
+// the innermost frame whenever next() is called.
+class SelectIterator {
+public:
+    ~SelectIterator();
+
+    std::vector<std::string> const& column_names() const { return m_column_names; }
+
+    // Returns nullopt after the last row.
+    SQLErrorOr<std::optional<Core::Tuple>> next();
+
+private:
+    friend class Select;
+
+    SelectIterator(Select const& select, EvaluationContext& context)
+        : m_select(select)
+        , m_context(context) { }
+
+    SQLErrorOr<std::optional<Core::TupleWithSource>> next_row();
+    // Replaces rows with the result of a blocking clause.
+    void set_rows(std::unique_ptr<Operator> rows) {
+        m_rows = std::move(rows);
+        m_source = nullptr;
+        m_finished = false;
+    }
+
+    Select const& m_select;
+    EvaluationContext& m_context;
+    std::unique_ptr<Core::Relation> m_relation;
+    SelectColumns m_select_all_columns;
+    std::optional<std::list<EvaluationContextFrame>::iterator> m_frame;
+    std::vector<std::string> m_column_names;
+    std::unique_ptr<Operator> m_rows;
+
+    // Set if rows are read from m_relation as they are requested.
+    SourceOperator const* m_source = nullptr;
+    bool m_finished = false;
+};
+
 class Select {
 public:
     struct SelectOptions {
@@ -70,11 +115,43 @@ public:
         , m_options(std::move(options)) { }
 
     SQLErrorOr<Core::ResultSet> execute(EvaluationContext&) const;
+    // Queries without GROUP BY and ORDER BY stream rows from the
+    // FROM table; otherwise all rows are computed when the first one is
+    // read.
+    SQLErrorOr<std::unique_ptr<SelectIterator>> open(EvaluationContext&) const;
     auto const& from() const { return m_options.from; }
+    auto const& order_by() const { return m_options.order_by; }
+    auto const& select_into() const { return m_options.select_into; }
     std::string to_string() const;
 
 private:
+    friend class SelectIterator;
+
+    bool should_group(SelectColumns const&) const;
+    std::optional<std::vector<Core::RowId>> find_index_rows(EvaluationContext&, Core::Relation const&) const;
+    // Rows of the table that match WHERE, with columns evaluated if
+    // `project` is set. `source` is set to the operator reading the table.
+    SQLErrorOr<std::unique_ptr<Operator>> scan(EvaluationContext&, Core::Relation const&, std::optional<std::vector<Core::RowId>> index_rows, bool project, SourceOperator const*& source) const;
+    // Morsels of `table` if it's worth to scan it in parallel, empty otherwise.
+    std::vector<Core::RelationIterator> parallel_scan_morsels(EvaluationContext&, Core::Relation const&) const;
+    // Let's check column expressions for validity, even if they won't run
+    // on real rows.
+    SQLErrorOr<void> check_columns_for_empty_table(EvaluationContext&, Core::Relation const&) const;
+    SQLErrorOr<std::vector<size_t>> group_by_columns(Core::Relation const&) const;
+    // Rows of GROUP BY or of aggregates over the whole table.
     SQLErrorOr<std::vector<Core::TupleWithSource>> collect_rows(EvaluationContext&, Core::Relation&) const;
+    // Rows of PARTITION BY, where aggregates are computed over partitions.
+    SQLErrorOr<std::vector<Core::TupleWithSource>> partition_rows(EvaluationContext&, Core::Relation&) const;
+    // ORDER BY values of a row, encoded to be compared bytewise.
+    SQLErrorOr<std::string> order_by_key(EvaluationContext&, Core::SortKeyEncoder const&, Core::TupleWithSource const&) const;
+    Core::SortKeyEncoder order_by_key_encoder() const;
+    // Reads all rows of the iterator, keeping only `limit` first ones in
+    // ORDER BY order, using a bounded heap.
+    SQLErrorOr<std::vector<Core::TupleWithSource>> top_n_rows(EvaluationContext&, SelectIterator&, size_t limit) const;
+    // Reads all rows of the iterator into a sorter, which spills them to
+    // disk if they don't fit in memory.
+    SQLErrorOr<std::unique_ptr<Core::ExternalSorter>> sort_rows(EvaluationContext&, SelectIterator&) const;
+    static size_t sort_memory_budget(EvaluationContext&);
 
     size_t m_start {};
     SelectOptions m_options;
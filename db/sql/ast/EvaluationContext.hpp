@@ -2,12 +2,15 @@
 
 #include <db/sql/ast/SelectColumns.hpp>
 
+#include <unordered_map>
+
 namespace Db::Core {
 class Database;
 }
 
 namespace Db::Sql::AST {
 
+class AggregateFunction;
 class TableExpression;
 
 struct EvaluationContextFrame {
@@ -16,6 +19,9 @@ struct EvaluationContextFrame {
     Core::TupleWithSource row {};
 
     std::optional<std::span<Core::Tuple const>> row_group {};
+    // Results of aggregate functions for the current group, if they were
+    // computed already (see Select::collect_rows()).
+    std::unordered_map<AggregateFunction const*, Core::Value> const* aggregate_values = nullptr;
     enum class RowType {
         FromTable,
         FromResultSet
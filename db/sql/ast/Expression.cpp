@@ -1,17 +1,21 @@
 #include "Expression.hpp"
 #include "db/sql/SQLError.hpp"
 
+#include <algorithm>
 #include <cstddef>
 #include <db/core/Column.hpp>
 #include <db/core/Database.hpp>
 #include <db/core/DbError.hpp>
+#include <db/core/Kernels.hpp>
 #include <db/core/Regex.hpp>
 #include <db/core/Table.hpp>
 #include <db/core/Tuple.hpp>
 #include <db/core/Value.hpp>
 #include <db/sql/ast/TableExpression.hpp>
+#include <iterator>
 #include <map>
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 namespace Db::Sql::AST {
@@ -91,6 +95,84 @@ SQLErrorOr<void> Check::drop_constraint(const std::string& name) {
     return {};
 }
 
+namespace {
+
+// Typed access to INT or FLOAT vectors, including constant ones.
+template<class T>
+struct TypedVector {
+    T const* values = nullptr;
+    uint8_t const* nulls = nullptr;
+    T constant {};
+
+    bool is_null(size_t row) const { return nulls && nulls[row]; }
+    T get(size_t row) const { return values ? values[row] : constant; }
+};
+
+}
+
+template<class T>
+static std::optional<TypedVector<T>> typed_vector(Core::ValueVector const& vector) {
+    static_assert(std::is_same_v<T, int> || std::is_same_v<T, float>);
+    constexpr auto type = std::is_same_v<T, int> ? Core::Value::Type::Int : Core::Value::Type::Float;
+    constexpr auto kind = std::is_same_v<T, int> ? Core::ValueVector::Kind::Int : Core::ValueVector::Kind::Float;
+
+    if (vector.kind() == Core::ValueVector::Kind::Constant) {
+        if (vector.constant_value().type() != type) {
+            return {};
+        }
+        return TypedVector<T> { .constant = std::get<T>(vector.constant_value()) };
+    }
+    if (vector.kind() != kind) {
+        return {};
+    }
+    if constexpr (std::is_same_v<T, int>) {
+        return TypedVector<T> { .values = vector.ints().data(), .nulls = vector.nulls().data() };
+    }
+    else {
+        return TypedVector<T> { .values = vector.floats().data(), .nulls = vector.nulls().data() };
+    }
+}
+
+// Boolean vector that is true for `rows` and false otherwise.
+static Core::ValueVector bool_vector(size_t size, Core::SelectionVector const& rows) {
+    std::vector<Core::Value> values(size, Core::Value::create_bool(false));
+    for (auto row : rows) {
+        values[row] = Core::Value::create_bool(true);
+    }
+    return Core::ValueVector::generic(std::move(values));
+}
+
+bool Expression::contains_aggregate_function() const {
+    std::vector<AggregateFunction const*> functions;
+    collect_aggregate_functions(functions);
+    return !functions.empty();
+}
+
+SQLErrorOr<Core::ValueVector> Expression::evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const {
+    return SQLError { "Internal error: expression can't be evaluated in batches", start() };
+}
+
+SQLErrorOr<Core::SelectionVector> Expression::filter_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    auto values = TRY(evaluate_batch(context, batch, selection));
+
+    Core::SelectionVector result;
+    if (auto ints = typed_vector<int>(values)) {
+        // NULL converts to 0, so it is false.
+        for (auto row : selection) {
+            if (!ints->is_null(row) && ints->get(row) != 0) {
+                result.push_back(row);
+            }
+        }
+        return result;
+    }
+    for (auto row : selection) {
+        if (TRY(values.value(row).to_bool().map_error(DbToSQLError { start() }))) {
+            result.push_back(row);
+        }
+    }
+    return result;
+}
+
 std::string Literal::to_string() const {
     return m_value.to_sql_serialized_string();
 }
@@ -123,6 +205,29 @@ SQLErrorOr<Core::Value> Identifier::evaluate(EvaluationContext& context) const {
     return TRY(context.current_frame().columns.resolve_value(context, *this));
 }
 
+std::optional<size_t> Identifier::batch_column(EvaluationContext& context) const {
+    if (!context.db) {
+        return {};
+    }
+    auto const& frame = context.current_frame();
+    if (frame.row_type != EvaluationContextFrame::RowType::FromTable || !frame.table) {
+        return {};
+    }
+    auto index = frame.table->resolve_identifier(context.db, *this);
+    if (index.is_error()) {
+        return {};
+    }
+    return index.release_value();
+}
+
+SQLErrorOr<Core::ValueVector> Identifier::evaluate_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const&) const {
+    auto index = batch_column(context);
+    if (!index) {
+        return SQLError { "Invalid identifier", start() };
+    }
+    return batch.column(*index);
+}
+
 // FIXME: Char ranges doesn't work in row
 static Core::DbErrorOr<bool> wildcard_parser(std::string const& needle, std::string const& pattern) {
     auto is_string_valid = [](std::string const& needle, std::string const& pattern) {
@@ -270,6 +375,164 @@ SQLErrorOr<bool> BinaryOperator::is_true(EvaluationContext& context) const {
     __builtin_unreachable();
 }
 
+// Only for comparison operations.
+static Core::Kernels::Comparison kernel_comparison(BinaryOperator::Operation operation) {
+    using Operation = BinaryOperator::Operation;
+    switch (operation) {
+    case Operation::Equal:
+        return Core::Kernels::Comparison::Equal;
+    case Operation::NotEqual:
+        return Core::Kernels::Comparison::NotEqual;
+    case Operation::Greater:
+        return Core::Kernels::Comparison::Greater;
+    case Operation::GreaterEqual:
+        return Core::Kernels::Comparison::GreaterEqual;
+    case Operation::Less:
+        return Core::Kernels::Comparison::Less;
+    case Operation::LessEqual:
+        return Core::Kernels::Comparison::LessEqual;
+    default:
+        break;
+    }
+    ESSA_UNREACHABLE;
+}
+
+static Core::DbErrorOr<bool> compare_values(BinaryOperator::Operation operation, Core::Value const& lhs, Core::Value const& rhs) {
+    using Operation = BinaryOperator::Operation;
+    switch (operation) {
+    case Operation::Equal:
+        return lhs == rhs;
+    case Operation::NotEqual:
+        return lhs != rhs;
+    case Operation::Greater:
+        return lhs > rhs;
+    case Operation::GreaterEqual:
+        return lhs >= rhs;
+    case Operation::Less:
+        return lhs < rhs;
+    case Operation::LessEqual:
+        return lhs <= rhs;
+    default:
+        break;
+    }
+    ESSA_UNREACHABLE;
+}
+
+// Rows of `selection` which bits are set in `bitmap`. The bitmap is not
+// meaningful for rows that are NULL in `values`, `check_null` is called
+// for them instead.
+template<class CheckNull>
+static Core::DbErrorOr<Core::SelectionVector> select_from_bitmap(std::span<uint64_t const> bitmap, Core::ValueVector const& values,
+    Core::SelectionVector const& selection, CheckNull&& check_null) {
+    Core::SelectionVector result;
+    auto nulls = values.nulls();
+    for (auto row : selection) {
+        bool matches = nulls[row] ? TRY(check_null(row)) : (bitmap[row / 64] >> (row % 64)) & 1;
+        if (matches) {
+            result.push_back(row);
+        }
+    }
+    return result;
+}
+
+static Core::DbErrorOr<Core::SelectionVector> filter_comparison(BinaryOperator::Operation operation, Core::ValueVector const& lhs, Core::ValueVector const& rhs, Core::SelectionVector const& selection) {
+    auto compare_nulls = [&](size_t row) { return compare_values(operation, lhs.value(row), rhs.value(row)); };
+
+    // Column compared to a constant is done for the whole batch at once.
+    if (rhs.kind() == Core::ValueVector::Kind::Constant) {
+        std::vector<uint64_t> bitmap;
+        if (lhs.kind() == Core::ValueVector::Kind::Int && rhs.constant_value().type() == Core::Value::Type::Int) {
+            bitmap.resize(Core::Kernels::bitmap_words(lhs.ints().size()));
+            Core::Kernels::compare(lhs.ints(), kernel_comparison(operation), std::get<int>(rhs.constant_value()), bitmap);
+            return select_from_bitmap(bitmap, lhs, selection, compare_nulls);
+        }
+        if (lhs.kind() == Core::ValueVector::Kind::Float && rhs.constant_value().type() == Core::Value::Type::Float) {
+            bitmap.resize(Core::Kernels::bitmap_words(lhs.floats().size()));
+            Core::Kernels::compare(lhs.floats(), kernel_comparison(operation), std::get<float>(rhs.constant_value()), bitmap);
+            return select_from_bitmap(bitmap, lhs, selection, compare_nulls);
+        }
+    }
+
+    Core::SelectionVector result;
+
+    auto filter_typed = [&]<class T>(TypedVector<T> lhs_values, TypedVector<T> rhs_values) -> Core::DbErrorOr<void> {
+        return Core::Kernels::visit_comparison(kernel_comparison(operation), [&](auto comparison) -> Core::DbErrorOr<void> {
+            for (auto row : selection) {
+                // NULLs are compared in special ways, leave them to Value.
+                bool matches = lhs_values.is_null(row) || rhs_values.is_null(row)
+                    ? TRY(compare_nulls(row))
+                    : Core::Kernels::compare_values<decltype(comparison)::value>(lhs_values.get(row), rhs_values.get(row));
+                if (matches) {
+                    result.push_back(row);
+                }
+            }
+            return {};
+        });
+    };
+
+    if (auto lhs_ints = typed_vector<int>(lhs), rhs_ints = typed_vector<int>(rhs); lhs_ints && rhs_ints) {
+        TRY(filter_typed(*lhs_ints, *rhs_ints));
+        return result;
+    }
+    if (auto lhs_floats = typed_vector<float>(lhs), rhs_floats = typed_vector<float>(rhs); lhs_floats && rhs_floats) {
+        TRY(filter_typed(*lhs_floats, *rhs_floats));
+        return result;
+    }
+    for (auto row : selection) {
+        if (TRY(compare_nulls(row))) {
+            result.push_back(row);
+        }
+    }
+    return result;
+}
+
+bool BinaryOperator::is_batchable(EvaluationContext& context) const {
+    switch (m_operation) {
+    case Operation::Not:
+        return m_lhs->is_batchable(context);
+    case Operation::Like:
+    case Operation::Match:
+    case Operation::Invalid:
+        return false;
+    default:
+        return m_lhs->is_batchable(context) && m_rhs->is_batchable(context);
+    }
+}
+
+SQLErrorOr<Core::ValueVector> BinaryOperator::evaluate_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    return bool_vector(batch.size(), TRY(filter_batch(context, batch, selection)));
+}
+
+SQLErrorOr<Core::SelectionVector> BinaryOperator::filter_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    switch (m_operation) {
+    case Operation::And: {
+        // Like in is_true(), rhs is evaluated only if lhs is true.
+        auto lhs_rows = TRY(m_lhs->filter_batch(context, batch, selection));
+        return m_rhs->filter_batch(context, batch, lhs_rows);
+    }
+    case Operation::Or: {
+        auto lhs_rows = TRY(m_lhs->filter_batch(context, batch, selection));
+        Core::SelectionVector remaining_rows;
+        std::set_difference(selection.begin(), selection.end(), lhs_rows.begin(), lhs_rows.end(), std::back_inserter(remaining_rows));
+        auto rhs_rows = TRY(m_rhs->filter_batch(context, batch, remaining_rows));
+        Core::SelectionVector result;
+        std::merge(lhs_rows.begin(), lhs_rows.end(), rhs_rows.begin(), rhs_rows.end(), std::back_inserter(result));
+        return result;
+    }
+    case Operation::Not:
+        return m_lhs->filter_batch(context, batch, selection);
+    case Operation::Like:
+    case Operation::Match:
+    case Operation::Invalid:
+        return SQLError { "Internal error: expression can't be evaluated in batches", start() };
+    default: {
+        auto lhs = TRY(m_lhs->evaluate_batch(context, batch, selection));
+        auto rhs = TRY(m_rhs->evaluate_batch(context, batch, selection));
+        return filter_comparison(m_operation, lhs, rhs, selection).map_error(DbToSQLError { start() });
+    }
+    }
+}
+
 SQLErrorOr<Core::Value> ArithmeticOperator::evaluate(EvaluationContext& context) const {
     auto lhs = TRY(m_lhs->evaluate(context));
     auto rhs = TRY(m_rhs->evaluate(context));
@@ -289,6 +552,89 @@ SQLErrorOr<Core::Value> ArithmeticOperator::evaluate(EvaluationContext& context)
     __builtin_unreachable();
 }
 
+template<class T>
+static Core::DbErrorOr<Core::ValueVector> compute_typed(ArithmeticOperator::Operation operation, TypedVector<T> lhs, TypedVector<T> rhs, size_t size, Core::SelectionVector const& selection) {
+    std::vector<T> values(size);
+    std::vector<uint8_t> nulls(size, 1);
+
+    auto compute = [&](auto operation) -> Core::DbErrorOr<void> {
+        for (auto row : selection) {
+            if (lhs.is_null(row) || rhs.is_null(row)) {
+                continue;
+            }
+            values[row] = TRY(operation(lhs.get(row), rhs.get(row)));
+            nulls[row] = 0;
+        }
+        return {};
+    };
+
+    using Operation = ArithmeticOperator::Operation;
+    switch (operation) {
+    case Operation::Add:
+        TRY(compute([](T lhs, T rhs) -> Core::DbErrorOr<T> { return lhs + rhs; }));
+        break;
+    case Operation::Sub:
+        TRY(compute([](T lhs, T rhs) -> Core::DbErrorOr<T> { return lhs - rhs; }));
+        break;
+    case Operation::Mul:
+        TRY(compute([](T lhs, T rhs) -> Core::DbErrorOr<T> { return lhs * rhs; }));
+        break;
+    case Operation::Div:
+        TRY(compute([](T lhs, T rhs) -> Core::DbErrorOr<T> {
+            if (rhs == 0)
+                return Core::DbError { "Cannot divide by 0" };
+            return lhs / rhs;
+        }));
+        break;
+    case Operation::Invalid:
+        ESSA_UNREACHABLE;
+    }
+
+    if constexpr (std::is_same_v<T, int>) {
+        return Core::ValueVector::ints(std::move(values), std::move(nulls));
+    }
+    else {
+        return Core::ValueVector::floats(std::move(values), std::move(nulls));
+    }
+}
+
+static Core::DbErrorOr<Core::Value> compute_values(ArithmeticOperator::Operation operation, Core::Value const& lhs, Core::Value const& rhs) {
+    using Operation = ArithmeticOperator::Operation;
+    switch (operation) {
+    case Operation::Add:
+        return lhs + rhs;
+    case Operation::Sub:
+        return lhs - rhs;
+    case Operation::Mul:
+        return lhs * rhs;
+    case Operation::Div:
+        return lhs / rhs;
+    case Operation::Invalid:
+        break;
+    }
+    ESSA_UNREACHABLE;
+}
+
+SQLErrorOr<Core::ValueVector> ArithmeticOperator::evaluate_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    auto lhs = TRY(m_lhs->evaluate_batch(context, batch, selection));
+    auto rhs = TRY(m_rhs->evaluate_batch(context, batch, selection));
+
+    auto result = [&]() -> Core::DbErrorOr<Core::ValueVector> {
+        if (auto lhs_ints = typed_vector<int>(lhs), rhs_ints = typed_vector<int>(rhs); lhs_ints && rhs_ints) {
+            return compute_typed(m_operation, *lhs_ints, *rhs_ints, batch.size(), selection);
+        }
+        if (auto lhs_floats = typed_vector<float>(lhs), rhs_floats = typed_vector<float>(rhs); lhs_floats && rhs_floats) {
+            return compute_typed(m_operation, *lhs_floats, *rhs_floats, batch.size(), selection);
+        }
+        std::vector<Core::Value> values(batch.size());
+        for (auto row : selection) {
+            values[row] = TRY(compute_values(m_operation, lhs.value(row), rhs.value(row)));
+        }
+        return Core::ValueVector::generic(std::move(values));
+    }();
+    return result.map_error(DbToSQLError { start() });
+}
+
 std::string ArithmeticOperator::to_string() const {
     std::string string;
     string += "(" + m_lhs->to_string();
@@ -332,6 +678,71 @@ SQLErrorOr<Core::Value> BetweenExpression::evaluate(EvaluationContext& context)
         && TRY((value <= max).map_error(DbToSQLError { start() })));
 }
 
+SQLErrorOr<Core::ValueVector> BetweenExpression::evaluate_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    return bool_vector(batch.size(), TRY(filter_batch(context, batch, selection)));
+}
+
+SQLErrorOr<Core::SelectionVector> BetweenExpression::filter_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    auto value = TRY(m_lhs->evaluate_batch(context, batch, selection));
+    auto min = TRY(m_min->evaluate_batch(context, batch, selection));
+    auto max = TRY(m_max->evaluate_batch(context, batch, selection));
+
+    auto is_between = [](Core::Value const& value, Core::Value const& min, Core::Value const& max) -> Core::DbErrorOr<bool> {
+        return TRY(value >= min) && TRY(value <= max);
+    };
+
+    auto check_nulls = [&](size_t row) { return is_between(value.value(row), min.value(row), max.value(row)); };
+
+    // Column compared to constants is done for the whole batch at once.
+    if (min.kind() == Core::ValueVector::Kind::Constant && max.kind() == Core::ValueVector::Kind::Constant) {
+        auto const& min_value = min.constant_value();
+        auto const& max_value = max.constant_value();
+        std::vector<uint64_t> bitmap;
+        if (value.kind() == Core::ValueVector::Kind::Int && min_value.type() == Core::Value::Type::Int && max_value.type() == Core::Value::Type::Int) {
+            bitmap.resize(Core::Kernels::bitmap_words(value.ints().size()));
+            Core::Kernels::between(value.ints(), std::get<int>(min_value), std::get<int>(max_value), bitmap);
+            return select_from_bitmap(bitmap, value, selection, check_nulls).map_error(DbToSQLError { start() });
+        }
+        if (value.kind() == Core::ValueVector::Kind::Float && min_value.type() == Core::Value::Type::Float && max_value.type() == Core::Value::Type::Float) {
+            bitmap.resize(Core::Kernels::bitmap_words(value.floats().size()));
+            Core::Kernels::between(value.floats(), std::get<float>(min_value), std::get<float>(max_value), bitmap);
+            return select_from_bitmap(bitmap, value, selection, check_nulls).map_error(DbToSQLError { start() });
+        }
+    }
+
+    Core::SelectionVector result;
+    auto filter_typed = [&]<class T>(TypedVector<T> values, TypedVector<T> mins, TypedVector<T> maxs) -> Core::DbErrorOr<void> {
+        using Core::Kernels::Comparison;
+        for (auto row : selection) {
+            bool matches = values.is_null(row) || mins.is_null(row) || maxs.is_null(row)
+                ? TRY(check_nulls(row))
+                : Core::Kernels::compare_values<Comparison::GreaterEqual>(values.get(row), mins.get(row))
+                    && Core::Kernels::compare_values<Comparison::LessEqual>(values.get(row), maxs.get(row));
+            if (matches) {
+                result.push_back(row);
+            }
+        }
+        return {};
+    };
+
+    auto filter = [&]() -> Core::DbErrorOr<void> {
+        if (auto values = typed_vector<int>(value), mins = typed_vector<int>(min), maxs = typed_vector<int>(max); values && mins && maxs) {
+            return filter_typed(*values, *mins, *maxs);
+        }
+        if (auto values = typed_vector<float>(value), mins = typed_vector<float>(min), maxs = typed_vector<float>(max); values && mins && maxs) {
+            return filter_typed(*values, *mins, *maxs);
+        }
+        for (auto row : selection) {
+            if (TRY(check_nulls(row))) {
+                result.push_back(row);
+            }
+        }
+        return {};
+    };
+    TRY(filter().map_error(DbToSQLError { start() }));
+    return result;
+}
+
 SQLErrorOr<Core::Value> InExpression::evaluate(EvaluationContext& context) const {
     // TODO: Implement this for strings etc
     auto value = TRY(TRY(m_lhs->evaluate(context)).to_string().map_error(DbToSQLError { start() }));
@@ -344,6 +755,51 @@ SQLErrorOr<Core::Value> InExpression::evaluate(EvaluationContext& context) const
     return Core::Value::create_bool(false);
 }
 
+SQLErrorOr<Core::ValueVector> InExpression::evaluate_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    return bool_vector(batch.size(), TRY(filter_batch(context, batch, selection)));
+}
+
+SQLErrorOr<Core::SelectionVector> InExpression::filter_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    auto values = TRY(m_lhs->evaluate_batch(context, batch, selection));
+
+    // Values are compared as strings. For two INTs, this is the same as
+    // comparing them directly.
+    auto value_ints = typed_vector<int>(values);
+    std::vector<std::string> value_strings(batch.size());
+    for (auto row : selection) {
+        if (!value_ints || value_ints->is_null(row)) {
+            value_strings[row] = TRY(values.value(row).to_string().map_error(DbToSQLError { start() }));
+        }
+    }
+
+    Core::SelectionVector result;
+    Core::SelectionVector remaining_rows = selection;
+    for (auto const& arg : m_args) {
+        if (remaining_rows.empty()) {
+            break;
+        }
+        // Like in evaluate(), args are evaluated only until a match is found.
+        auto arg_values = TRY(arg->evaluate_batch(context, batch, remaining_rows));
+        auto arg_ints = typed_vector<int>(arg_values);
+
+        Core::SelectionVector unmatched_rows;
+        for (auto row : remaining_rows) {
+            bool matches = false;
+            if (value_ints && !value_ints->is_null(row) && arg_ints && !arg_ints->is_null(row)) {
+                matches = value_ints->get(row) == arg_ints->get(row);
+            }
+            else {
+                auto value_string = value_ints && !value_ints->is_null(row) ? std::to_string(value_ints->get(row)) : value_strings[row];
+                matches = value_string == TRY(arg_values.value(row).to_string().map_error(DbToSQLError { start() }));
+            }
+            (matches ? result : unmatched_rows).push_back(row);
+        }
+        remaining_rows = std::move(unmatched_rows);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
 SQLErrorOr<Core::Value> IsExpression::evaluate(EvaluationContext& context) const {
     auto lhs = TRY(m_lhs->evaluate(context));
     switch (m_what) {
@@ -355,6 +811,21 @@ SQLErrorOr<Core::Value> IsExpression::evaluate(EvaluationContext& context) const
     __builtin_unreachable();
 }
 
+SQLErrorOr<Core::ValueVector> IsExpression::evaluate_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    return bool_vector(batch.size(), TRY(filter_batch(context, batch, selection)));
+}
+
+SQLErrorOr<Core::SelectionVector> IsExpression::filter_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    auto values = TRY(m_lhs->evaluate_batch(context, batch, selection));
+    Core::SelectionVector result;
+    for (auto row : selection) {
+        if (values.is_null(row) == (m_what == What::Null)) {
+            result.push_back(row);
+        }
+    }
+    return result;
+}
+
 SQLErrorOr<Core::Value> CaseExpression::evaluate(EvaluationContext& context) const {
     for (const auto& case_expression : m_cases) {
         if (TRY(TRY(case_expression.expr->evaluate(context)).to_bool().map_error(DbToSQLError { start() })))
@@ -378,8 +849,20 @@ std::vector<std::string> NonOwningExpressionProxy::referenced_columns() const {
     return m_expression.referenced_columns();
 }
 
-bool NonOwningExpressionProxy::contains_aggregate_function() const {
-    return m_expression.contains_aggregate_function();
+void NonOwningExpressionProxy::collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const {
+    m_expression.collect_aggregate_functions(functions);
+}
+
+bool NonOwningExpressionProxy::is_batchable(EvaluationContext& context) const {
+    return m_expression.is_batchable(context);
+}
+
+SQLErrorOr<Core::ValueVector> NonOwningExpressionProxy::evaluate_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    return m_expression.evaluate_batch(context, batch, selection);
+}
+
+SQLErrorOr<Core::SelectionVector> NonOwningExpressionProxy::filter_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection) const {
+    return m_expression.filter_batch(context, batch, selection);
 }
 
 SQLErrorOr<Core::Value> IndexExpression::evaluate(EvaluationContext& context) const {
@@ -398,4 +881,12 @@ std::vector<std::string> IndexExpression::referenced_columns() const {
     return {};
 }
 
+bool IndexExpression::is_batchable(EvaluationContext& context) const {
+    return context.current_frame().row_type == EvaluationContextFrame::RowType::FromTable;
+}
+
+SQLErrorOr<Core::ValueVector> IndexExpression::evaluate_batch(EvaluationContext&, Core::RowBatch const& batch, Core::SelectionVector const&) const {
+    return batch.column(m_index);
+}
+
 }
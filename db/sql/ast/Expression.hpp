@@ -1,5 +1,6 @@
 #pragma once
 
+#include <db/core/Batch.hpp>
 #include <db/core/DbError.hpp>
 #include <db/core/Tuple.hpp>
 #include <db/sql/Printing.hpp>
@@ -20,6 +21,7 @@ class Database;
 
 namespace Db::Sql::AST {
 
+class AggregateFunction;
 class Expression;
 struct EvaluationContext;
 class Identifier;
@@ -33,7 +35,18 @@ public:
     virtual SQLErrorOr<Core::Value> evaluate(EvaluationContext&) const = 0;
     virtual std::string to_string() const = 0;
     virtual std::vector<std::string> referenced_columns() const { return {}; }
-    virtual bool contains_aggregate_function() const { return false; }
+    bool contains_aggregate_function() const;
+    // Appends aggregate functions that the expression consists of.
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>&) const { }
+
+    // Batch evaluation, used when rows are read in batches (see
+    // Core::RowBatch). It may be used only if is_batchable() returns true.
+    // Values are computed only for rows in `selection`.
+    virtual bool is_batchable(EvaluationContext&) const { return false; }
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const& selection) const;
+
+    // Returns rows of `selection` for which the expression is true.
+    virtual SQLErrorOr<Core::SelectionVector> filter_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const& selection) const;
 };
 
 class Check : public Expression {
@@ -68,6 +81,10 @@ public:
 
     virtual SQLErrorOr<Core::Value> evaluate(EvaluationContext&) const override { return m_value; }
     virtual std::string to_string() const override;
+    virtual bool is_batchable(EvaluationContext&) const override { return true; }
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override {
+        return Core::ValueVector::constant(m_value);
+    }
 
     Core::Value value() const { return m_value; }
 
@@ -85,11 +102,17 @@ public:
     virtual SQLErrorOr<Core::Value> evaluate(EvaluationContext&) const override;
     virtual std::string to_string() const override { return Printing::escape_identifier(m_id); }
     virtual std::vector<std::string> referenced_columns() const override { return { m_id }; }
+    virtual bool is_batchable(EvaluationContext& context) const override { return batch_column(context).has_value(); }
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
 
     std::string id() const { return m_id; }
     auto table() const { return m_table; }
 
 private:
+    // Column of rows being read that this identifier refers to. Outer
+    // query columns can't be read in batches.
+    std::optional<size_t> batch_column(EvaluationContext&) const;
+
     std::string m_id;
     std::optional<std::string> m_table;
 };
@@ -129,7 +152,17 @@ public:
         lhs_columns.insert(lhs_columns.begin(), rhs_columns.begin(), rhs_columns.end());
         return lhs_columns;
     }
-    virtual bool contains_aggregate_function() const override { return m_lhs->contains_aggregate_function() || m_rhs->contains_aggregate_function(); }
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override {
+        m_lhs->collect_aggregate_functions(functions);
+        m_rhs->collect_aggregate_functions(functions);
+    }
+    virtual bool is_batchable(EvaluationContext&) const override;
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+    virtual SQLErrorOr<Core::SelectionVector> filter_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+
+    Expression const& lhs() const { return *m_lhs; }
+    Operation operation() const { return m_operation; }
+    Expression const* rhs() const { return m_rhs.get(); }
 
 private:
     SQLErrorOr<bool> is_true(EvaluationContext&) const;
@@ -167,7 +200,12 @@ public:
         return lhs_columns;
     }
 
-    virtual bool contains_aggregate_function() const override { return m_lhs->contains_aggregate_function() || m_rhs->contains_aggregate_function(); }
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override {
+        m_lhs->collect_aggregate_functions(functions);
+        m_rhs->collect_aggregate_functions(functions);
+    }
+    virtual bool is_batchable(EvaluationContext& context) const override { return m_lhs->is_batchable(context) && m_rhs->is_batchable(context); }
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
 
 private:
     std::unique_ptr<Expression> m_lhs;
@@ -194,8 +232,8 @@ public:
         return m_operand->referenced_columns();
     }
 
-    virtual bool contains_aggregate_function() const override {
-        return m_operand->contains_aggregate_function();
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override {
+        m_operand->collect_aggregate_functions(functions);
     }
 
 private:
@@ -229,7 +267,20 @@ public:
         return lhs_columns;
     }
 
-    virtual bool contains_aggregate_function() const override { return m_lhs->contains_aggregate_function() || m_min->contains_aggregate_function() || m_max->contains_aggregate_function(); }
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override {
+        m_lhs->collect_aggregate_functions(functions);
+        m_min->collect_aggregate_functions(functions);
+        m_max->collect_aggregate_functions(functions);
+    }
+    virtual bool is_batchable(EvaluationContext& context) const override {
+        return m_lhs->is_batchable(context) && m_min->is_batchable(context) && m_max->is_batchable(context);
+    }
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+    virtual SQLErrorOr<Core::SelectionVector> filter_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+
+    Expression const& lhs() const { return *m_lhs; }
+    Expression const& min() const { return *m_min; }
+    Expression const& max() const { return *m_max; }
 
 private:
     std::unique_ptr<Expression> m_lhs;
@@ -269,16 +320,28 @@ public:
         return lhs_columns;
     }
 
-    virtual bool contains_aggregate_function() const override {
-        if (m_lhs->contains_aggregate_function())
-            return true;
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override {
+        m_lhs->collect_aggregate_functions(functions);
         for (auto const& arg : m_args) {
-            if (arg->contains_aggregate_function())
-                return true;
+            arg->collect_aggregate_functions(functions);
         }
-        return false;
     }
 
+    virtual bool is_batchable(EvaluationContext& context) const override {
+        if (!m_lhs->is_batchable(context))
+            return false;
+        for (auto const& arg : m_args) {
+            if (!arg->is_batchable(context))
+                return false;
+        }
+        return true;
+    }
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+    virtual SQLErrorOr<Core::SelectionVector> filter_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+
+    Expression const& lhs() const { return *m_lhs; }
+    auto const& args() const { return m_args; }
+
 private:
     std::unique_ptr<Expression> m_lhs;
     std::vector<std::unique_ptr<Expression>> m_args;
@@ -306,10 +369,14 @@ public:
         return m_lhs->referenced_columns();
     }
 
-    virtual bool contains_aggregate_function() const override {
-        return m_lhs->contains_aggregate_function();
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override {
+        m_lhs->collect_aggregate_functions(functions);
     }
 
+    virtual bool is_batchable(EvaluationContext& context) const override { return m_lhs->is_batchable(context); }
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+    virtual SQLErrorOr<Core::SelectionVector> filter_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+
 private:
     std::unique_ptr<Expression> m_lhs;
     What m_what {};
@@ -351,14 +418,11 @@ public:
         return else_columns;
     }
 
-    virtual bool contains_aggregate_function() const override {
-        if (m_else_value->contains_aggregate_function())
-            return true;
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override {
+        m_else_value->collect_aggregate_functions(functions);
         for (auto const& case_ : m_cases) {
-            if (case_.expr->contains_aggregate_function())
-                return true;
+            case_.expr->collect_aggregate_functions(functions);
         }
-        return false;
     }
 
 private:
@@ -376,7 +440,10 @@ public:
     virtual SQLErrorOr<Core::Value> evaluate(EvaluationContext&) const override;
     virtual std::string to_string() const override;
     virtual std::vector<std::string> referenced_columns() const override;
-    virtual bool contains_aggregate_function() const override;
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>&) const override;
+    virtual bool is_batchable(EvaluationContext&) const override;
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
+    virtual SQLErrorOr<Core::SelectionVector> filter_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
 
 private:
     Expression const& m_expression;
@@ -392,6 +459,8 @@ public:
     virtual SQLErrorOr<Core::Value> evaluate(EvaluationContext&) const override;
     virtual std::string to_string() const override;
     virtual std::vector<std::string> referenced_columns() const override;
+    virtual bool is_batchable(EvaluationContext&) const override;
+    virtual SQLErrorOr<Core::ValueVector> evaluate_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&) const override;
 
 private:
     size_t m_index = 0;
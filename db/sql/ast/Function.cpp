@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <ctime>
 #include <db/core/DbError.hpp>
+#include <db/core/Kernels.hpp>
 #include <db/core/Value.hpp>
 #include <db/sql/Parser.hpp>
 #include <functional>
@@ -483,6 +484,12 @@ std::string Function::to_string() const {
 
 SQLErrorOr<Core::Value> AggregateFunction::evaluate(EvaluationContext& context) const {
     auto& frame = context.current_frame();
+    if (frame.aggregate_values) {
+        auto it = frame.aggregate_values->find(this);
+        if (it != frame.aggregate_values->end()) {
+            return it->second;
+        }
+    }
     if (frame.row_group) {
         return TRY(aggregate(context, *frame.row_group));
     }
@@ -495,63 +502,141 @@ SQLErrorOr<Core::Value> AggregateFunction::aggregate(EvaluationContext& context,
     auto& frame = context.frames.emplace_back(context.current_frame().table, context.current_frame().columns);
     Util::ScopeGuard guard { [&] { context.frames.pop_back(); } };
 
-    switch (m_function) {
-    case Function::Count: {
-        int count = 0;
-        for (auto& row : rows) {
-            frame.row = { .tuple = row, .source = {} };
-            auto value = TRY(m_expression->evaluate(context));
-            if (value.type() != Core::Value::Type::Null)
-                count += 1;
-        }
-        return Core::Value::create_int(count);
+    Accumulator accumulator;
+    for (auto& row : rows) {
+        frame.row = { .tuple = row, .source = {} };
+        TRY(update(context, accumulator));
     }
-    case Function::Sum: {
-        float sum = 0;
-        for (auto& row : rows) {
-            frame.row = { .tuple = row, .source = {} };
-            auto value = TRY(m_expression->evaluate(context));
-            sum += TRY(value.to_float().map_error(DbToSQLError { start() }));
+    return TRY(finalize(accumulator));
+}
+
+SQLErrorOr<void> AggregateFunction::update_batch(EvaluationContext& context, Core::RowBatch const& batch, Core::SelectionVector const& selection, Accumulator& accumulator) const {
+    auto values = TRY(m_expression->evaluate_batch(context, batch, selection));
+
+    // Non-NULL INTs and FLOATs of the selection are aggregated by kernels.
+    // NULLs count as 0, except for COUNT.
+    auto aggregate_typed = [&](auto span, auto& sum) {
+        std::vector<uint64_t> mask(Core::Kernels::bitmap_words(span.size()));
+        bool has_nulls = false;
+        for (auto row : selection) {
+            if (values.nulls()[row]) {
+                has_nulls = true;
+                continue;
+            }
+            mask[row / 64] |= uint64_t { 1 } << (row % 64);
         }
+        auto result = Core::Kernels::aggregate(span, mask);
+
+        switch (m_function) {
+        case Function::Count:
+            accumulator.count += result.count;
+            break;
+        case Function::Sum:
+        case Function::Avg:
+            sum += result.sum;
+            accumulator.count += selection.size();
+            break;
+        case Function::Min:
+        case Function::Max:
+            if (result.count > 0) {
+                accumulator.min = std::min(accumulator.min, static_cast<double>(result.min));
+                accumulator.max = std::max(accumulator.max, static_cast<double>(result.max));
+            }
+            if (has_nulls) {
+                accumulator.min = std::min(accumulator.min, 0.0);
+                accumulator.max = std::max(accumulator.max, 0.0);
+            }
+            accumulator.count += selection.size();
+            break;
+        default:
+            ESSA_UNREACHABLE;
+        }
+    };
 
-        return Core::Value::create_float(sum);
+    if (values.kind() == Core::ValueVector::Kind::Int) {
+        aggregate_typed(values.ints(), accumulator.int_sum);
+        return {};
+    }
+    if (values.kind() == Core::ValueVector::Kind::Float) {
+        accumulator.has_floats = true;
+        aggregate_typed(values.floats(), accumulator.float_sum);
+        return {};
     }
-    case Function::Min: {
-        float min = std::numeric_limits<float>::max();
-        for (auto& row : rows) {
-            frame.row = { .tuple = row, .source = {} };
-            auto value = TRY(m_expression->evaluate(context));
-            min = std::min(min, TRY(value.to_float().map_error(DbToSQLError { start() })));
-        }
 
-        return Core::Value::create_float(min);
+    for (auto row : selection) {
+        TRY(update(accumulator, values.value(row)));
     }
-    case Function::Max: {
-        float max = std::numeric_limits<float>::min();
-        for (auto& row : rows) {
-            frame.row = { .tuple = row, .source = {} };
-            auto value = TRY(m_expression->evaluate(context));
-            max = std::max(max, TRY(value.to_float().map_error(DbToSQLError { start() })));
-        }
+    return {};
+}
+
+SQLErrorOr<void> AggregateFunction::update(EvaluationContext& context, Accumulator& accumulator) const {
+    return update(accumulator, TRY(m_expression->evaluate(context)));
+}
 
-        return Core::Value::create_float(max);
+SQLErrorOr<void> AggregateFunction::update(Accumulator& accumulator, Core::Value const& value) const {
+    if (m_function == Function::Count) {
+        if (!value.is_null())
+            accumulator.count++;
+        return {};
     }
-    case Function::Avg: {
-        float sum = 0;
-        size_t count = 0;
-        for (auto& row : rows) {
-            frame.row = { .tuple = row, .source = {} };
-            auto value = TRY(m_expression->evaluate(context));
-            sum += TRY(value.to_int().map_error(DbToSQLError { start() }));
-            count++;
-        }
 
-        return Core::Value::create_float(sum / (count != 0 ? count : 1));
+    // INTs (and values that are converted to 0 or 1) are summed exactly.
+    double number = 0;
+    switch (value.type()) {
+    case Core::Value::Type::Null:
+    case Core::Value::Type::Int:
+    case Core::Value::Type::Bool: {
+        auto int_value = TRY(value.to_int().map_error(DbToSQLError { start() }));
+        accumulator.int_sum += int_value;
+        number = int_value;
+        break;
+    }
+    default: {
+        auto float_value = TRY(value.to_float().map_error(DbToSQLError { start() }));
+        accumulator.float_sum += float_value;
+        accumulator.has_floats = true;
+        number = float_value;
+        break;
+    }
     }
+    accumulator.min = std::min(accumulator.min, number);
+    accumulator.max = std::max(accumulator.max, number);
+    accumulator.count++;
+    return {};
+}
+
+void AggregateFunction::merge(Accumulator& accumulator, Accumulator const& other) const {
+    accumulator.int_sum += other.int_sum;
+    accumulator.float_sum += other.float_sum;
+    accumulator.has_floats |= other.has_floats;
+    accumulator.min = std::min(accumulator.min, other.min);
+    accumulator.max = std::max(accumulator.max, other.max);
+    accumulator.count += other.count;
+}
+
+SQLErrorOr<Core::Value> AggregateFunction::finalize(Accumulator const& accumulator) const {
+    auto sum = static_cast<double>(accumulator.int_sum) + accumulator.float_sum;
+    switch (m_function) {
+    case Function::Count:
+        return Core::Value::create_int(static_cast<int>(accumulator.count));
+    case Function::Sum:
+        if (!accumulator.has_floats) {
+            if (accumulator.int_sum < std::numeric_limits<int>::min() || accumulator.int_sum > std::numeric_limits<int>::max()) {
+                return SQLError { fmt::format("SUM of INTs is out of range: {}", accumulator.int_sum), start() };
+            }
+            return Core::Value::create_int(static_cast<int>(accumulator.int_sum));
+        }
+        return Core::Value::create_float(static_cast<float>(sum));
+    case Function::Min:
+        return accumulator.count != 0 ? Core::Value::create_float(static_cast<float>(accumulator.min)) : Core::Value::null();
+    case Function::Max:
+        return accumulator.count != 0 ? Core::Value::create_float(static_cast<float>(accumulator.max)) : Core::Value::null();
+    case Function::Avg:
+        return Core::Value::create_float(static_cast<float>(sum / static_cast<double>(accumulator.count != 0 ? accumulator.count : 1)));
     default:
         break;
     }
-    __builtin_unreachable();
+    ESSA_UNREACHABLE;
 }
 
 std::string AggregateFunction::to_string() const {
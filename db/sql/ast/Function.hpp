@@ -1,6 +1,8 @@
 #pragma once
 
 #include <db/sql/ast/Expression.hpp>
+#include <cstdint>
+#include <limits>
 
 namespace Db::Sql::AST {
 
@@ -50,8 +52,30 @@ public:
 
     SQLErrorOr<Core::Value> aggregate(EvaluationContext&, std::span<Core::Tuple const> rows) const;
 
+    // State of an aggregation. A default-constructed accumulator is the
+    // initial state; values are added with update() and update_batch(),
+    // accumulators of parts of the same rows can be merged, and the result
+    // is computed by finalize(). Sums of INTs are kept exactly, and SUM of
+    // only INTs is an INT.
+    struct Accumulator {
+        int64_t int_sum = 0;
+        double float_sum = 0;
+        bool has_floats = false;
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+        size_t count = 0;
+    };
+    bool is_batch_aggregatable(EvaluationContext& context) const { return m_expression->is_batchable(context); }
+    SQLErrorOr<void> update_batch(EvaluationContext&, Core::RowBatch const&, Core::SelectionVector const&, Accumulator&) const;
+    // Adds the row of the current frame.
+    SQLErrorOr<void> update(EvaluationContext&, Accumulator&) const;
+    SQLErrorOr<void> update(Accumulator&, Core::Value const&) const;
+    void merge(Accumulator&, Accumulator const&) const;
+    // Fails if SUM of INTs doesn't fit in an INT.
+    SQLErrorOr<Core::Value> finalize(Accumulator const&) const;
+
     virtual std::vector<std::string> referenced_columns() const override { return m_expression->referenced_columns(); }
-    virtual bool contains_aggregate_function() const override { return true; }
+    virtual void collect_aggregate_functions(std::vector<AggregateFunction const*>& functions) const override { functions.push_back(this); }
 
 private:
     Function m_function {};
@@ -1,15 +1,119 @@
 #include <db/sql/ast/Select.hpp>
 
+#include <db/core/Index.hpp>
+#include <db/core/Join.hpp>
 #include <db/core/TupleFromValues.hpp>
 
+#include <algorithm>
+#include <fmt/format.h>
+#include <unordered_set>
+
 namespace Db::Sql::AST {
 
+namespace {
+
+// Result of a subquery, which may be known to be sorted so that it can be
+// merge joined.
+class SubqueryRelation : public Core::Relation {
+public:
+    SubqueryRelation(std::unique_ptr<Core::MemoryBackedTable> table, std::optional<size_t> sorted_by)
+        : m_table(std::move(table))
+        , m_sorted_by(sorted_by) { }
+
+    virtual std::vector<Core::Column> const& columns() const override { return m_table->columns(); }
+    virtual Core::RelationIterator rows() const override { return m_table->rows(); }
+    virtual Core::MutableRelationIterator writable_rows() override { return m_table->writable_rows(); }
+    virtual size_t size() const override { return m_table->size(); }
+    virtual std::unique_ptr<Core::BatchReader> batches() const override { return m_table->batches(); }
+    virtual std::vector<Core::RelationIterator> morsels(size_t rows_per_morsel) const override { return m_table->morsels(rows_per_morsel); }
+    virtual std::optional<size_t> sorted_by() const override { return m_sorted_by; }
+    virtual std::vector<std::string> explain() const override {
+        auto description = fmt::format("Subquery ({} rows)", size());
+        if (m_sorted_by) {
+            description += fmt::format(", sorted by {}", columns()[*m_sorted_by].name());
+        }
+        return { description };
+    }
+
+private:
+    std::unique_ptr<Core::MemoryBackedTable> m_table;
+    std::optional<size_t> m_sorted_by;
+};
+
+// The column that the first ORDER BY expression of `select` names, if it is
+// ascending.
+std::optional<size_t> ordered_column(Select const& select, std::vector<std::string> const& column_names) {
+    if (!select.order_by() || select.order_by()->columns.empty()) {
+        return {};
+    }
+    auto const& first = select.order_by()->columns.front();
+    auto identifier = dynamic_cast<Identifier const*>(first.expression.get());
+    if (!identifier || first.order != OrderBy::Order::Ascending) {
+        return {};
+    }
+    auto it = std::find(column_names.begin(), column_names.end(), identifier->id());
+    if (it == column_names.end()) {
+        return {};
+    }
+    return it - column_names.begin();
+}
+
+using RowSet = std::unordered_set<Core::Tuple, Core::IndexKeyHash, Core::IndexKeyEqual>;
+
+// Rows are compared like in DISTINCT, and results keep the order of `lhs`
+// (followed by `rhs` for UNION).
+std::vector<Core::Tuple> combine_rows(SetOperation::Type type, std::vector<Core::Tuple> lhs, std::vector<Core::Tuple> rhs) {
+    std::vector<Core::Tuple> result;
+    switch (type) {
+    case SetOperation::Type::UnionAll:
+        result = std::move(lhs);
+        result.insert(result.end(), std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+        break;
+    case SetOperation::Type::Union: {
+        RowSet seen_rows;
+        for (auto* rows : { &lhs, &rhs }) {
+            for (auto& row : *rows) {
+                if (seen_rows.insert(row).second) {
+                    result.push_back(std::move(row));
+                }
+            }
+        }
+        break;
+    }
+    case SetOperation::Type::Intersect: {
+        // Matched rows are removed, so that they are returned only once.
+        RowSet rhs_rows { std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()) };
+        for (auto& row : lhs) {
+            if (rhs_rows.erase(row) > 0) {
+                result.push_back(std::move(row));
+            }
+        }
+        break;
+    }
+    case SetOperation::Type::Except: {
+        // Returned rows are added, so that they are returned only once.
+        RowSet rhs_rows { std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()) };
+        for (auto& row : lhs) {
+            if (rhs_rows.insert(row).second) {
+                result.push_back(std::move(row));
+            }
+        }
+        break;
+    }
+    }
+    return result;
+}
+
+}
+
 SQLErrorOr<Core::Value> SelectExpression::evaluate(EvaluationContext& context) const {
-    auto result_set = TRY(m_select.execute(context));
-    if (!result_set.is_convertible_to_value()) {
+    // Rows after the second one don't need to be computed.
+    auto rows = TRY(m_select.open(context));
+    auto row = TRY(rows->next());
+    if (rows->column_names().size() != 1 || !row || TRY(rows->next())) {
         return SQLError { "Select expression must return a single row with a single value", start() };
     }
-    return result_set.as_value();
+    return row->value(0);
 }
 
 SQLErrorOr<std::unique_ptr<Core::Relation>> SelectTableExpression::evaluate(EvaluationContext& context) const {
@@ -21,17 +125,38 @@ SQLErrorOr<std::unique_ptr<Core::Relation>> SelectTableExpression::evaluate(Eval
     std::vector<Core::Column> columns;
     size_t i = 0;
     for (const auto& name : result.column_names()) {
-        Core::Value::Type type = result.rows().empty() ? Core::Value::Type::Null : result.rows().front().value(i).type();
+        // The first rows may be NULLs, especially if they are sorted.
+        Core::Value::Type type = Core::Value::Type::Null;
+        for (auto const& row : result.rows()) {
+            if (!row.value(i).is_null()) {
+                type = row.value(i).type();
+                break;
+            }
+        }
         columns.push_back(Core::Column(name, type, 0, 0, 0));
         i++;
     }
 
+    // ORDER BY doesn't order values exactly as joins do, so check if they
+    // really are sorted.
+    auto sorted_by = ordered_column(m_select, result.column_names());
+    std::optional<Core::Value> previous_key;
+
     auto table = std::make_unique<Core::MemoryBackedTable>(nullptr, Core::TableSetup { "SelectTableExpression", columns });
     for (const auto& row : result.rows()) {
+        if (sorted_by) {
+            auto key = Core::join_key(row.value(*sorted_by));
+            if (key) {
+                if (previous_key && Core::compare_join_keys(*previous_key, *key) > 0) {
+                    sorted_by = {};
+                }
+                previous_key = std::move(key);
+            }
+        }
         TRY(table->insert(context.db, row).map_error(DbToSQLError { start() }));
     }
 
-    return table;
+    return std::make_unique<SubqueryRelation>(std::move(table), sorted_by);
 }
 
 SQLErrorOr<Core::ValueOrResultSet> SelectStatement::execute(Core::Database& db) const {
@@ -39,44 +164,68 @@ SQLErrorOr<Core::ValueOrResultSet> SelectStatement::execute(Core::Database& db)
     return TRY(m_select.execute(context));
 }
 
-SQLErrorOr<Core::ValueOrResultSet> Union::execute(Core::Database& db) const {
-    EvaluationContext context { .db = &db };
-    auto lhs = TRY(m_lhs.execute(context));
-    auto rhs = TRY(m_rhs.execute(context));
-
-    if (lhs.column_names().size() != rhs.column_names().size())
-        return SQLError { "Queries with different column count", 0 };
-
-    for (size_t i = 0; i < lhs.column_names().size(); i++) {
-        if (lhs.column_names()[i] != rhs.column_names()[i])
-            return SQLError { "Queries with different column set", 0 };
+SQLErrorOr<std::unique_ptr<SelectIterator>> SelectStatement::open(EvaluationContext& context) const {
+    // SELECT INTO needs all rows.
+    if (m_select.select_into()) {
+        return std::unique_ptr<SelectIterator> {};
     }
+    return m_select.open(context);
+}
 
+SQLErrorOr<Core::ValueOrResultSet> Explain::execute(Core::Database& db) const {
+    EvaluationContext context { .db = &db };
     std::vector<Core::Tuple> rows;
-
-    for (const auto& row : lhs.rows()) {
-        rows.push_back(row);
+    if (m_select.from()) {
+        auto relation = TRY(m_select.from()->evaluate(context));
+        for (auto const& line : relation->explain()) {
+            rows.push_back(Core::Tuple { Core::Value::create_varchar(line) });
+        }
+    }
+    else {
+        rows.push_back(Core::Tuple { Core::Value::create_varchar("No table") });
     }
+    return Core::ResultSet { { "plan" }, std::move(rows) };
+}
 
-    for (const auto& row : rhs.rows()) {
-        if (m_distinct) {
-            bool distinct = true;
-            for (const auto& to_compare : lhs.rows()) {
-                if (TRY((row == to_compare).map_error(DbToSQLError { start() }))) {
-                    distinct = false;
-                    break;
-                }
-            }
+SQLErrorOr<Core::ValueOrResultSet> SetOperation::execute(Core::Database& db) const {
+    EvaluationContext context { .db = &db };
+
+    std::vector<std::string> column_names;
+    auto execute_select = [&](Select const& select) -> SQLErrorOr<std::vector<Core::Tuple>> {
+        auto result = TRY(select.execute(context));
+        if (column_names.empty()) {
+            column_names = result.column_names();
+        }
+        else {
+            if (result.column_names().size() != column_names.size())
+                return SQLError { "Queries with different column count", 0 };
+            if (result.column_names() != column_names)
+                return SQLError { "Queries with different column set", 0 };
+        }
+        return std::move(result).release_rows();
+    };
 
-            if (distinct)
-                rows.push_back(row);
+    // INTERSECTs first...
+    std::vector<std::vector<Core::Tuple>> terms;
+    std::vector<Type> term_operations;
+    terms.push_back(TRY(execute_select(m_selects[0])));
+    for (size_t s = 0; s < m_operations.size(); s++) {
+        auto rows = TRY(execute_select(m_selects[s + 1]));
+        if (m_operations[s] == Type::Intersect) {
+            terms.back() = combine_rows(Type::Intersect, std::move(terms.back()), std::move(rows));
         }
         else {
-            rows.push_back(row);
+            terms.push_back(std::move(rows));
+            term_operations.push_back(m_operations[s]);
         }
     }
 
-    return Core::ResultSet { lhs.column_names(), std::move(rows) };
+    // ...then the rest, from left to right.
+    auto rows = std::move(terms[0]);
+    for (size_t s = 0; s < term_operations.size(); s++) {
+        rows = combine_rows(term_operations[s], std::move(rows), std::move(terms[s + 1]));
+    }
+    return Core::ResultSet { column_names, std::move(rows) };
 }
 
 SQLErrorOr<std::optional<size_t>> SelectTableExpression::resolve_identifier(Core::Database* db, Identifier const& id) const {
@@ -40,25 +40,51 @@ public:
         , m_select(std::move(select)) { }
 
     virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const override;
+    virtual SQLErrorOr<std::unique_ptr<SelectIterator>> open(EvaluationContext&) const override;
 
 private:
     Select m_select;
 };
 
-class Union : public Statement {
+// EXPLAIN SELECT ...: Shows how rows of FROM would be read, one line of
+// the plan per row.
+class Explain : public Statement {
 public:
-    Union(ssize_t start, Select lhs, Select rhs, bool distinct)
+    Explain(ssize_t start, Select select)
         : Statement(start)
-        , m_lhs(std::move(lhs))
-        , m_rhs(std::move(rhs))
-        , m_distinct(distinct) { }
+        , m_select(std::move(select)) { }
+
+    virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const override;
+
+private:
+    Select m_select;
+};
+
+// SELECTs combined with UNION [ALL], INTERSECT and EXCEPT. INTERSECT binds
+// tighter than the others, which are evaluated from left to right. Except
+// for UNION ALL, results have no duplicates.
+class SetOperation : public Statement {
+public:
+    enum class Type {
+        Union,
+        UnionAll,
+        Intersect,
+        Except
+    };
+
+    // There is one operation between every two SELECTs.
+    SetOperation(ssize_t start, std::vector<Select> selects, std::vector<Type> operations)
+        : Statement(start)
+        , m_selects(std::move(selects))
+        , m_operations(std::move(operations)) {
+        assert(m_operations.size() + 1 == m_selects.size());
+    }
 
     virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const override;
 
 private:
-    Select m_lhs;
-    Select m_rhs;
-    bool m_distinct;
+    std::vector<Select> m_selects;
+    std::vector<Type> m_operations;
 };
 
 class InsertInto : public Statement {
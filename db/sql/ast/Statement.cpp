@@ -10,6 +10,8 @@
 #include <db/core/IndexedRelation.hpp>
 #include <db/core/Table.hpp>
 #include <db/core/ValueOrResultSet.hpp>
+#include <db/sql/IndexScan.hpp>
+#include <db/sql/Select.hpp>
 #include <db/sql/ast/EvaluationContext.hpp>
 #include <db/sql/ast/TableExpression.hpp>
 #include <iostream>
@@ -18,16 +20,72 @@
 
 namespace Db::Sql::AST {
 
+SQLErrorOr<std::unique_ptr<SelectIterator>> Statement::open(EvaluationContext&) const {
+    return std::unique_ptr<SelectIterator> {};
+}
+
+SQLErrorOr<void> Statement::check_transaction(Core::Database& db) const {
+    if (db.is_transaction_aborted() && !controls_transaction()) {
+        return SQLError { "Transaction was aborted because a statement failed, statements are ignored until COMMIT or ROLLBACK", start() };
+    }
+    return {};
+}
+
+SQLErrorOr<Core::ValueOrResultSet> Statement::run(Core::Database& db) const {
+    TRY(check_transaction(db));
+    if (controls_transaction()) {
+        return execute(db);
+    }
+    if (db.in_transaction()) {
+        auto result = execute(db);
+        if (result.is_error()) {
+            TRY(db.abort_transaction().map_error(DbToSQLError { start() }));
+        }
+        return result;
+    }
+
+    TRY(db.begin_transaction().map_error(DbToSQLError { start() }));
+    auto result = execute(db);
+    if (result.is_error()) {
+        TRY(db.rollback_transaction().map_error(DbToSQLError { start() }));
+        return result.release_error();
+    }
+    TRY(db.commit_transaction().map_error(DbToSQLError { start() }));
+    return result.release_value();
+}
+
 SQLErrorOr<Core::ValueOrResultSet> StatementList::execute(Core::Database& db) const {
     if (m_statements.empty()) {
         return SQLError { "Empty statement list", 0 };
     }
 
+    auto controls_transaction = std::any_of(m_statements.begin(), m_statements.end(), [](auto const& stmt) {
+        return stmt->controls_transaction();
+    });
+    if (controls_transaction || db.in_transaction()) {
+        std::optional<Core::ValueOrResultSet> result;
+        for (auto const& stmt : m_statements) {
+            result = TRY(stmt->run(db));
+        }
+        return std::move(*result);
+    }
+
+    TRY(db.begin_transaction().map_error(DbToSQLError { start() }));
+    auto result = execute_statements(db);
+    if (result.is_error()) {
+        TRY(db.rollback_transaction().map_error(DbToSQLError { start() }));
+        return result.release_error();
+    }
+    TRY(db.commit_transaction().map_error(DbToSQLError { start() }));
+    return result.release_value();
+}
+
+SQLErrorOr<Core::ValueOrResultSet> StatementList::execute_statements(Core::Database& db) const {
     std::optional<Core::ValueOrResultSet> result;
     for (auto const& stmt : m_statements) {
-        TRY(stmt->execute(db));
+        result = TRY(stmt->execute(db));
     }
-    return *result;
+    return std::move(*result);
 }
 
 SQLErrorOr<Core::ValueOrResultSet> DeleteFrom::execute(Core::Database& db) const {
@@ -45,26 +103,29 @@ SQLErrorOr<Core::ValueOrResultSet> DeleteFrom::execute(Core::Database& db) const
         return TRY(m_where->evaluate(context)).to_bool().map_error(DbToSQLError { start() });
     };
 
-    std::set<size_t> rows_to_remove;
-    {
-        size_t idx = 0;
+    std::set<Core::RowId> rows_to_remove;
+    auto index_rows = m_where ? find_rows_using_index(*table, id, &db, *m_where) : std::nullopt;
+    if (index_rows) {
+        for (auto row_id : *index_rows) {
+            if (TRY(should_include_row(table->read_row(row_id)))) {
+                rows_to_remove.insert(row_id);
+            }
+        }
+    }
+    else {
         TRY(table->writable_rows().try_for_each_row_reference([&](Core::RowReference const& ref) -> SQLErrorOr<void> {
-            auto should_include = TRY(should_include_row(ref.read()));
-            if (should_include) {
-                rows_to_remove.insert(idx);
+            if (TRY(should_include_row(ref.read()))) {
+                rows_to_remove.insert(ref.row_id());
             }
-            idx++;
             return {};
         }));
     }
 
-    {
-        size_t idx = 0;
+    if (!rows_to_remove.empty()) {
         TRY(table->writable_rows().try_for_each_row_reference([&](Core::RowReference& ref) -> SQLErrorOr<void> {
-            if (rows_to_remove.contains(idx)) {
-                ref.remove();
+            if (rows_to_remove.contains(ref.row_id())) {
+                TRY(ref.remove().map_error(DbToSQLError { start() }));
             }
-            idx++;
             return {};
         }));
     }
@@ -89,7 +150,7 @@ SQLErrorOr<Core::ValueOrResultSet> Update::execute(Core::Database& db) const {
             auto tuple = row.read();
             context.current_frame().row = { .tuple = tuple, .source = {} };
             tuple.set_value(column->index, TRY(update_pair.expr->evaluate(context)));
-            row.write(tuple);
+            TRY(row.write(tuple).map_error(DbToSQLError { start() }));
             return {};
         }));
     }
@@ -281,4 +342,60 @@ SQLErrorOr<Core::ValueOrResultSet> Print::execute(Core::Database& db) const {
     return result;
 }
 
+SQLErrorOr<Core::ValueOrResultSet> Vacuum::execute(Core::Database& db) const {
+    if (db.in_transaction()) {
+        return SQLError { "VACUUM cannot be run in a transaction", start() };
+    }
+    std::vector<Core::Table*> tables;
+    if (m_table) {
+        tables.push_back(TRY(db.table(*m_table).map_error(DbToSQLError { start() })));
+    }
+    else {
+        db.for_each_table([&](auto const& table) {
+            tables.push_back(table.second.get());
+        });
+    }
+    for (auto table : tables) {
+        TRY(table->vacuum().map_error(DbToSQLError { start() }));
+    }
+    return { Core::Value::null() };
+}
+
+SQLErrorOr<Core::ValueOrResultSet> Transaction::execute(Core::Database& db) const {
+    switch (m_type) {
+    case Type::Begin:
+        TRY(db.begin_transaction().map_error(DbToSQLError { start() }));
+        break;
+    case Type::Commit:
+        TRY(db.commit_transaction().map_error(DbToSQLError { start() }));
+        break;
+    case Type::Rollback:
+        TRY(db.rollback_transaction().map_error(DbToSQLError { start() }));
+        break;
+    }
+    return { Core::Value::null() };
+}
+
+SQLErrorOr<Core::ValueOrResultSet> CreateIndex::execute(Core::Database& db) const {
+    auto table = TRY(db.table(m_table).map_error(DbToSQLError { start() }));
+
+    std::vector<size_t> columns;
+    for (auto const& column_name : m_columns) {
+        auto column = table->get_column(column_name);
+        if (!column) {
+            return SQLError { "Column '" + column_name + "' does not exist in table '" + m_table + "'", start() };
+        }
+        columns.push_back(column->index);
+    }
+
+    TRY(table->create_index(m_name, std::move(columns), m_unique).map_error(DbToSQLError { start() }));
+    return { Core::Value::null() };
+}
+
+SQLErrorOr<Core::ValueOrResultSet> DropIndex::execute(Core::Database& db) const {
+    auto table = TRY(db.table(m_table).map_error(DbToSQLError { start() }));
+    TRY(table->drop_index(m_name).map_error(DbToSQLError { start() }));
+    return { Core::Value::null() };
+}
+
 }
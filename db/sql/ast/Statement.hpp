@@ -24,6 +24,7 @@ struct ParsedColumn {
 
 class Expression;
 class Check;
+class SelectIterator;
 
 class Statement : public ASTNode {
 public:
@@ -32,6 +33,25 @@ public:
 
     virtual ~Statement() = default;
     virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const = 0;
+
+    // Rows of the result, computed while they are read, or nullptr if the
+    // statement must be run with execute(). The iterator references the
+    // statement and `context`, so they must outlive it.
+    virtual SQLErrorOr<std::unique_ptr<SelectIterator>> open(EvaluationContext&) const;
+
+    // BEGIN, COMMIT and ROLLBACK, and statements that can't be run in a
+    // transaction. Other statements that change anything are run in a
+    // transaction if no transaction is running.
+    virtual bool controls_transaction() const { return false; }
+
+    // Fails if the running transaction was aborted (see
+    // Database::abort_transaction()), unless this statement ends it.
+    SQLErrorOr<void> check_transaction(Core::Database&) const;
+
+    // Runs execute() in its own transaction, unless the statement controls
+    // transactions or one is running already. If it fails in a running
+    // transaction, the transaction is aborted.
+    SQLErrorOr<Core::ValueOrResultSet> run(Core::Database&) const;
 };
 
 class StatementList : public ASTNode {
@@ -40,9 +60,14 @@ public:
         : ASTNode(start)
         , m_statements(std::move(statements)) { }
 
+    // Statements are run in a single transaction, unless they control
+    // transactions themselves or one is running already. Then each is run
+    // separately (see Statement::run()).
     SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const;
 
 private:
+    SQLErrorOr<Core::ValueOrResultSet> execute_statements(Core::Database&) const;
+
     std::vector<std::unique_ptr<Statement>> m_statements;
 };
 
@@ -109,6 +134,44 @@ private:
     std::unique_ptr<Statement> m_statement;
 };
 
+// Give space of removed rows back to the system. For EDB tables, only
+// whole free blocks at the end of file are given back. Rows are moved to
+// make them free, but VARCHAR data and indexes are not, so a live value
+// near the end of file still keeps the blocks before it.
+class Vacuum : public Statement {
+public:
+    Vacuum(ssize_t start, std::optional<std::string> table)
+        : Statement(start)
+        , m_table(std::move(table)) { }
+
+    virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const override;
+
+    // File is truncated at once, so changes before must be committed.
+    virtual bool controls_transaction() const override { return true; }
+
+private:
+    std::optional<std::string> m_table;
+};
+
+class Transaction : public Statement {
+public:
+    enum class Type {
+        Begin,
+        Commit,
+        Rollback,
+    };
+
+    Transaction(ssize_t start, Type type)
+        : Statement(start)
+        , m_type(type) { }
+
+    virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const override;
+    virtual bool controls_transaction() const override { return true; }
+
+private:
+    Type m_type;
+};
+
 class TableStatement : public Statement {
 public:
     enum class ExistenceCondition {
@@ -201,4 +264,36 @@ private:
     std::vector<std::string> m_constraint_to_drop;
 };
 
+class CreateIndex : public Statement {
+public:
+    CreateIndex(ssize_t start, std::string name, std::string table, std::vector<std::string> columns, bool unique)
+        : Statement(start)
+        , m_name(std::move(name))
+        , m_table(std::move(table))
+        , m_columns(std::move(columns))
+        , m_unique(unique) { }
+
+    virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const override;
+
+private:
+    std::string m_name;
+    std::string m_table;
+    std::vector<std::string> m_columns;
+    bool m_unique;
+};
+
+class DropIndex : public Statement {
+public:
+    DropIndex(ssize_t start, std::string name, std::string table)
+        : Statement(start)
+        , m_name(std::move(name))
+        , m_table(std::move(table)) { }
+
+    virtual SQLErrorOr<Core::ValueOrResultSet> execute(Core::Database&) const override;
+
+private:
+    std::string m_name;
+    std::string m_table;
+};
+
 }
@@ -3,8 +3,10 @@
 #include "db/sql/SQLError.hpp"
 
 #include <EssaUtil/Config.hpp>
+#include <algorithm>
 #include <db/core/Database.hpp>
 #include <db/core/DbError.hpp>
+#include <db/core/Join.hpp>
 
 namespace Db::Sql::AST {
 
@@ -28,6 +30,12 @@ public:
     virtual Core::RelationIterator rows() const { return m_other.rows(); }
     virtual Core::MutableRelationIterator writable_rows() { ESSA_UNREACHABLE; }
     virtual size_t size() const { return m_other.size(); }
+    virtual size_t estimated_size() const { return m_other.estimated_size(); }
+    virtual std::optional<size_t> sorted_by() const { return m_other.sorted_by(); }
+    virtual std::vector<std::string> explain() const { return m_other.explain(); }
+    virtual Core::IndexedRelation const* indexed_relation() const { return m_other.indexed_relation(); }
+    virtual std::unique_ptr<Core::BatchReader> batches() const { return m_other.batches(); }
+    virtual std::vector<Core::RelationIterator> morsels(size_t rows_per_morsel) const { return m_other.morsels(rows_per_morsel); }
 
 private:
     Core::Relation const& m_other;
@@ -94,144 +102,40 @@ SQLErrorOr<std::unique_ptr<Core::Relation>> JoinExpression::evaluate(EvaluationC
     auto lhs = TRY(m_lhs->evaluate(context));
     auto rhs = TRY(m_rhs->evaluate(context));
 
-    std::vector<Core::Column> columns;
-    std::multimap<Core::Value, std::pair<Core::Relation*, Core::Tuple>, Core::ValueSorter> contents;
-
-    auto add_columns = [&columns, &contents, this](Core::Relation& source_table, Identifier const* on_id) -> SQLErrorOr<void> {
-        bool add_to_index = true;
-        size_t index = 0;
-        for (const auto& column : source_table.columns()) {
-            if (column.name() == on_id->referenced_columns().front())
-                add_to_index = false;
-            if (add_to_index)
-                index++;
-            columns.push_back(Core::Column(column.name(), column.type(), false, false, false));
+    auto key_column = [this](Core::Relation const& relation, Identifier const& on_id) -> SQLErrorOr<size_t> {
+        auto const& columns = relation.columns();
+        auto it = std::find_if(columns.begin(), columns.end(), [&](auto const& column) {
+            return column.name() == on_id.referenced_columns().front();
+        });
+        if (it == columns.end()) {
+            return SQLError { fmt::format("Invalid column `{}` used in join expression", on_id.to_string()), start() };
         }
-        TRY(source_table.rows().try_for_each_row([&](auto const& row) -> SQLErrorOr<void> {
-            if (index >= row.value_count()) {
-                return SQLError { fmt::format("Invalid column `{}` used in join expression", on_id->to_string()), start() };
-            }
-            contents.insert(std::pair(row.value(index), std::make_pair(&source_table, row)));
-            return {};
-        }));
-        return {};
+        return it - columns.begin();
     };
 
-    TRY(add_columns(*lhs, m_on_lhs.get()));
-    TRY(add_columns(*rhs, m_on_rhs.get()));
-    auto table = std::make_unique<Core::MemoryBackedTable>(nullptr, Core::TableSetup { "Join", columns });
-
-    auto beg = contents.begin();
-    beg++;
-    auto last = contents.begin();
-
-    switch (m_join_type) {
-    case Type::InnerJoin: {
-        for (auto it = beg; it != contents.end(); it++) {
-            if (last->second.first == lhs.get() && it->second.first == rhs.get()) {
-                if (TRY((it->first == last->first).map_error(DbToSQLError { start() }))) {
-                    auto row = create_joined_tuple(last->second.second, it->second.second);
-                    TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-                    it++;
-                    if (it == contents.end())
-                        break;
-                }
-            }
-            last = it;
-        }
-
-        break;
-    }
-
-    case Type::LeftJoin: {
-        for (auto it = beg; it != contents.end(); it++) {
-            if (last->second.first == lhs.get()) {
-                if (TRY((it->first == last->first).map_error(DbToSQLError { start() }))) {
-                    auto row = create_joined_tuple(last->second.second, it->second.second);
-                    TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-                    it++;
-                    if (it == contents.end())
-                        break;
-                }
-                else {
-                    std::vector<Core::Value> values(rhs->columns().size(), Core::Value::null());
-                    Core::Tuple dummy(values);
-
-                    auto row = create_joined_tuple(last->second.second, dummy);
-
-                    TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-                }
-            }
-            last = it;
-        }
-
-        break;
-    }
-
-    case Type::RightJoin: {
-        for (auto it = beg; it != contents.end(); it++) {
-            if (last->second.first == rhs.get() || it->second.first == rhs.get()) {
-                if (TRY((it->first == last->first).map_error(DbToSQLError { start() }))) {
-                    auto row = create_joined_tuple(last->second.second, it->second.second);
-                    TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-                    it++;
-                    if (it == contents.end())
-                        break;
-
-                    last = it;
-                }
-                else {
-                    std::vector<Core::Value> values(lhs->columns().size(), Core::Value::null());
-                    Core::Tuple dummy(values);
-
-                    auto row = create_joined_tuple(dummy, it->second.second);
-
-                    TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-                }
-            }
-            last = it;
-        }
-
-        break;
-    }
-
-    case Type::OuterJoin: {
-        for (auto it = beg; it != contents.end(); it++) {
-            if (last->second.first == lhs.get() && it->second.first == rhs.get() && TRY((it->first == last->first).map_error(DbToSQLError { start() }))) {
-                auto row = create_joined_tuple(last->second.second, it->second.second);
-                TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-                it++;
-                if (it == contents.end())
-                    break;
-            }
-            else if (last->second.first == lhs.get()) {
-                std::vector<Core::Value> values(rhs->columns().size(), Core::Value::null());
-                Core::Tuple dummy(values);
-
-                auto row = create_joined_tuple(last->second.second, dummy);
-
-                TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-            }
-            else if (last->second.first == rhs.get()) {
-                std::vector<Core::Value> values(lhs->columns().size(), Core::Value::null());
-                Core::Tuple dummy(values);
-
-                auto row = create_joined_tuple(dummy, it->second.second);
-
-                TRY(table->insert_unchecked(row).map_error(DbToSQLError { start() }));
-            }
-            last = it;
+    auto lhs_key = TRY(key_column(*lhs, *m_on_lhs));
+    auto rhs_key = TRY(key_column(*rhs, *m_on_rhs));
+
+    auto type = [&]() -> std::optional<Core::JoinType> {
+        switch (m_join_type) {
+        case Type::InnerJoin:
+            return Core::JoinType::Inner;
+        case Type::LeftJoin:
+            return Core::JoinType::Left;
+        case Type::RightJoin:
+            return Core::JoinType::Right;
+        case Type::OuterJoin:
+            return Core::JoinType::Full;
+        case Type::Invalid:
+            return {};
         }
-
-        break;
-    }
-
-    case Type::Invalid:
+        ESSA_UNREACHABLE;
+    }();
+    if (!type) {
         return SQLError { fmt::format("Internal error: Invalid join type"), start() };
-        break;
     }
 
-    return table;
+    return Core::join({ std::move(lhs), lhs_key }, { std::move(rhs), rhs_key }, *type).map_error(DbToSQLError { start() });
 }
 
 SQLErrorOr<std::optional<size_t>> JoinExpression::resolve_identifier(Core::Database* db, Identifier const& id) const {
@@ -0,0 +1,240 @@
+#include "ColumnarTable.hpp"
+
+#include <EssaUtil/Config.hpp>
+#include <db/core/UndoLog.hpp>
+
+namespace Db::Storage {
+
+namespace {
+
+// Iterates over slots that are not removed. If `writable_table` is not
+// set, rows can't be written or removed.
+class ColumnarRelationIteratorImpl : public Core::RelationIteratorImpl {
+public:
+    ColumnarRelationIteratorImpl(ColumnarTable const& table, ColumnarTable* writable_table)
+        : m_table(table)
+        , m_writable_table(writable_table) { }
+
+    class RowReferenceImpl : public Core::RowReference {
+    public:
+        RowReferenceImpl(ColumnarTable const& table, ColumnarTable* writable_table, size_t slot)
+            : m_table(table)
+            , m_writable_table(writable_table)
+            , m_slot(slot) { }
+
+        virtual Core::Tuple read() const override { return m_table.read_row(m_slot); }
+        virtual Core::DbErrorOr<void> write(Core::Tuple const& tuple) override {
+            assert(m_writable_table);
+            return m_writable_table->write_slot(m_slot, tuple);
+        }
+        virtual Core::DbErrorOr<void> remove() override {
+            assert(m_writable_table);
+            return m_writable_table->remove_slot(m_slot);
+        }
+        virtual Core::RowId row_id() const override { return m_slot; }
+        virtual std::unique_ptr<Core::RowReference> clone() const override {
+            return std::make_unique<RowReferenceImpl>(*this);
+        }
+
+    private:
+        ColumnarTable const& m_table;
+        ColumnarTable* m_writable_table;
+        size_t m_slot;
+    };
+
+    virtual std::unique_ptr<Core::RowReference> next() override {
+        while (m_slot < m_table.slot_count() && m_table.is_removed(m_slot)) {
+            m_slot++;
+        }
+        if (m_slot >= m_table.slot_count()) {
+            return {};
+        }
+        return std::make_unique<RowReferenceImpl>(m_table, m_writable_table, m_slot++);
+    }
+
+private:
+    ColumnarTable const& m_table;
+    ColumnarTable* m_writable_table;
+    size_t m_slot = 0;
+};
+
+// Consecutive slots, including removed ones, which are not selected.
+class ColumnarRowBatch : public Core::RowBatch {
+public:
+    ColumnarRowBatch(ColumnarTable const& table, size_t first_slot, size_t size)
+        : m_table(table)
+        , m_first_slot(first_slot)
+        , m_size(size) { }
+
+    virtual size_t size() const override { return m_size; }
+
+    virtual Core::SelectionVector rows() const override {
+        Core::SelectionVector rows;
+        rows.reserve(m_size);
+        for (size_t s = 0; s < m_size; s++) {
+            if (!m_table.is_removed(m_first_slot + s)) {
+                rows.push_back(s);
+            }
+        }
+        return rows;
+    }
+
+    virtual Core::ValueVector column(size_t index) const override {
+        auto const& data = m_table.column_data(index);
+
+        std::vector<uint8_t> nulls(m_size);
+        for (size_t s = 0; s < m_size; s++) {
+            nulls[s] = data.is_null(m_first_slot + s);
+        }
+
+        switch (data.type()) {
+        case Core::Value::Type::Int: {
+            auto ints = data.ints().subspan(m_first_slot, m_size);
+            return Core::ValueVector::ints({ ints.begin(), ints.end() }, std::move(nulls));
+        }
+        case Core::Value::Type::Float: {
+            auto floats = data.floats().subspan(m_first_slot, m_size);
+            return Core::ValueVector::floats({ floats.begin(), floats.end() }, std::move(nulls));
+        }
+        default: {
+            std::vector<Core::Value> values;
+            values.reserve(m_size);
+            for (size_t s = 0; s < m_size; s++) {
+                values.push_back(data.get(m_first_slot + s));
+            }
+            return Core::ValueVector::generic(std::move(values));
+        }
+        }
+    }
+
+    virtual Core::Tuple read_row(size_t row) const override {
+        return m_table.read_row(m_first_slot + row);
+    }
+
+private:
+    ColumnarTable const& m_table;
+    size_t m_first_slot;
+    size_t m_size;
+};
+
+class ColumnarBatchReader : public Core::BatchReader {
+public:
+    explicit ColumnarBatchReader(ColumnarTable const& table)
+        : m_table(table) { }
+
+    virtual std::unique_ptr<Core::RowBatch> next() override {
+        if (m_slot >= m_table.slot_count()) {
+            return nullptr;
+        }
+        auto size = std::min(Core::BatchSize, m_table.slot_count() - m_slot);
+        auto batch = std::make_unique<ColumnarRowBatch>(m_table, m_slot, size);
+        m_slot += size;
+        return batch;
+    }
+
+private:
+    ColumnarTable const& m_table;
+    size_t m_slot = 0;
+};
+
+}
+
+ColumnarTable::ColumnarTable(Core::TableSetup const& setup)
+    : m_columns(setup.columns)
+    , m_name(setup.name) {
+    for (auto const& column : m_columns) {
+        m_data.emplace_back(column.type());
+    }
+    update_key_indexes();
+}
+
+Core::RelationIterator ColumnarTable::rows() const {
+    return Core::RelationIterator { std::make_unique<ColumnarRelationIteratorImpl>(*this, nullptr) };
+}
+
+Core::MutableRelationIterator ColumnarTable::writable_rows() {
+    return Core::MutableRelationIterator { std::make_unique<ColumnarRelationIteratorImpl>(*this, this) };
+}
+
+std::unique_ptr<Core::BatchReader> ColumnarTable::batches() const {
+    return std::make_unique<ColumnarBatchReader>(*this);
+}
+
+Core::Tuple ColumnarTable::read_row(Core::RowId slot) const {
+    assert(slot < m_slot_count && !m_removed[slot]);
+    std::vector<Core::Value> values;
+    values.reserve(m_data.size());
+    for (auto const& data : m_data) {
+        values.push_back(data.get(slot));
+    }
+    return Core::Tuple { std::move(values) };
+}
+
+Core::DbErrorOr<void> ColumnarTable::rename(std::string const& new_name) {
+    m_name = new_name;
+    return {};
+}
+
+Core::DbErrorOr<void> ColumnarTable::insert_unchecked(Core::Tuple const& row) {
+    assert(row.value_count() == m_data.size());
+    for (size_t s = 0; s < m_data.size(); s++) {
+        if (auto result = m_data[s].append(row.value(s)); result.is_error()) {
+            for (size_t t = 0; t < s; t++) {
+                m_data[t].remove_last();
+            }
+            return result.release_error();
+        }
+    }
+    m_removed.push_back(false);
+    auto slot = m_slot_count++;
+    // Values may have been converted, so index what was actually stored.
+    TRY(index_row(read_row(slot), slot));
+    if (auto undo_log = active_undo_log()) {
+        undo_log->record([this, slot]() -> Core::DbErrorOr<void> {
+            return remove_slot(slot);
+        });
+    }
+    return {};
+}
+
+Core::DbErrorOr<void> ColumnarTable::write_slot(size_t slot, Core::Tuple const& row) {
+    assert(row.value_count() == m_data.size());
+    auto old_row = read_row(slot);
+    for (size_t s = 0; s < m_data.size(); s++) {
+        if (auto result = m_data[s].set(slot, row.value(s)); result.is_error()) {
+            // Values that were read from the columns can always be stored back.
+            for (size_t t = 0; t < s; t++) {
+                MUST(m_data[t].set(slot, old_row.value(t)));
+            }
+            return result.release_error();
+        }
+    }
+    TRY(reindex_row(old_row, read_row(slot), slot));
+    if (auto undo_log = active_undo_log()) {
+        undo_log->record([this, slot, old_row = std::move(old_row)]() -> Core::DbErrorOr<void> {
+            return write_slot(slot, old_row);
+        });
+    }
+    return {};
+}
+
+Core::DbErrorOr<void> ColumnarTable::remove_slot(size_t slot) {
+    TRY(unindex_row(read_row(slot), slot));
+    m_removed[slot] = true;
+    m_removed_count++;
+    if (auto undo_log = active_undo_log()) {
+        undo_log->record([this, slot]() -> Core::DbErrorOr<void> {
+            return restore_slot(slot);
+        });
+    }
+    return {};
+}
+
+Core::DbErrorOr<void> ColumnarTable::restore_slot(size_t slot) {
+    assert(m_removed[slot]);
+    m_removed[slot] = false;
+    m_removed_count--;
+    return index_row(read_row(slot), slot);
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <db/core/Table.hpp>
+#include <db/storage/columnar/ColumnData.hpp>
+
+namespace Db::Storage {
+
+// In-memory table that stores every column in a separate contiguous
+// array, which makes scans over a few columns cheap. Rows are addressed
+// by their position (slot). Removed rows are only marked as such, so
+// that positions of other rows don't change.
+class ColumnarTable : public Core::Table {
+public:
+    explicit ColumnarTable(Core::TableSetup const&);
+
+    // ^Relation
+    virtual std::vector<Core::Column> const& columns() const override { return m_columns; }
+    virtual Core::RelationIterator rows() const override;
+    virtual Core::MutableRelationIterator writable_rows() override;
+    virtual size_t size() const override { return m_slot_count - m_removed_count; }
+    virtual std::unique_ptr<Core::BatchReader> batches() const override;
+
+    // ^IndexedRelation
+    virtual Core::Tuple read_row(Core::RowId) const override;
+
+    // ^Table
+    virtual Core::DatabaseEngine engine() const override { return Core::DatabaseEngine::Columnar; }
+    virtual std::string name() const override { return m_name; }
+    virtual int next_auto_increment_value(std::string const& column) override { return m_auto_increment_values[column] + 1; }
+    virtual int increment(std::string const& column) override { return ++m_auto_increment_values[column]; }
+    virtual Core::DbErrorOr<void> rename(std::string const& new_name) override;
+    virtual Core::DbErrorOr<void> insert_unchecked(Core::Tuple const&) override;
+
+    // Direct access to column data, for processing many rows at once.
+    // Slots include removed rows, which must be skipped.
+    Columnar::ColumnData const& column_data(size_t column) const { return m_data[column]; }
+    size_t slot_count() const { return m_slot_count; }
+    bool is_removed(size_t slot) const { return m_removed[slot]; }
+
+    Core::DbErrorOr<void> write_slot(size_t slot, Core::Tuple const&);
+    Core::DbErrorOr<void> remove_slot(size_t slot);
+
+private:
+    // Undo remove_slot().
+    Core::DbErrorOr<void> restore_slot(size_t slot);
+
+    std::vector<Core::Column> m_columns;
+    std::vector<Columnar::ColumnData> m_data;
+    std::vector<bool> m_removed;
+    size_t m_slot_count = 0;
+    size_t m_removed_count = 0;
+    std::map<std::string, int> m_auto_increment_values;
+    std::string m_name;
+};
+
+}
@@ -4,26 +4,36 @@
 #include <EssaUtil/Error.hpp>
 #include <db/core/Column.hpp>
 #include <db/core/Relation.hpp>
+#include <db/storage/edb/BTree.hpp>
+#include <db/storage/edb/EDBIndex.hpp>
 #include <db/storage/edb/EDBRelationIterator.hpp>
 #include <fcntl.h>
 
 namespace Db::Storage {
 
-Util::OsErrorOr<std::unique_ptr<FileBackedTable>> FileBackedTable::initialize(std::string database_path, Core::TableSetup setup) {
+Util::OsErrorOr<std::unique_ptr<FileBackedTable>> FileBackedTable::initialize(std::string database_path, Core::TableSetup setup, EDB::WriteAheadLog& log) {
     auto path = fmt::format("{}/{}.edb", database_path, setup.name);
     Util::File file { ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644), true };
     auto table = TRY(FileBackedTable::create(TRY(EDB::EDBFile::initialize(std::move(file), setup))));
     table->m_database_path = std::move(database_path);
-    table->m_table_name = std::move(setup.name);
+    table->m_file_name = fmt::format("{}.edb", setup.name);
+    // The new file is written directly, so that it's complete even if the
+    // table is created in a transaction that isn't committed yet.
+    TRY(table->m_file->commit());
+    table->m_log = &log;
+    log.attach(*table->m_file, table->edb_file_name());
     return table;
 }
 
-Util::OsErrorOr<std::unique_ptr<FileBackedTable>> FileBackedTable::open(std::string database_path, std::string table_name) {
+Util::OsErrorOr<std::unique_ptr<FileBackedTable>> FileBackedTable::open(std::string database_path, std::string table_name, EDB::WriteAheadLog& log) {
     auto path = fmt::format("{}/{}.edb", database_path, table_name);
+    TRY(EDB::EDBFile::upgrade(path));
     Util::File file { ::open(path.c_str(), O_RDWR), true };
     auto table = TRY(FileBackedTable::create(TRY(EDB::EDBFile::open(std::move(file)))));
     table->m_database_path = std::move(database_path);
-    table->m_table_name = std::move(table_name);
+    table->m_file_name = fmt::format("{}.edb", table_name);
+    table->m_log = &log;
+    log.attach(*table->m_file, table->edb_file_name());
     return table;
 }
 
@@ -34,6 +44,8 @@ FileBackedTable::FileBackedTable(std::unique_ptr<EDB::EDBFile> file)
 Util::OsErrorOr<std::unique_ptr<FileBackedTable>> FileBackedTable::create(std::unique_ptr<EDB::EDBFile> file) {
     auto table = std::make_unique<FileBackedTable>(std::move(file));
     TRY(table->read_header());
+    TRY(table->load_indexes());
+    table->update_key_indexes();
     return table;
 }
 
@@ -42,6 +54,27 @@ Util::OsErrorOr<void> FileBackedTable::read_header() {
     return {};
 }
 
+Util::OsErrorOr<void> FileBackedTable::load_indexes() {
+    for (auto const& key : m_file->read_keys()) {
+        if (key.type != EDB::KeyType::Index && key.type != EDB::KeyType::UniqueIndex) {
+            continue;
+        }
+        auto name = m_file->read_heap(key.index_name).decode_infallible().encode();
+        std::vector<size_t> columns { key.index_columns, key.index_columns + key.index_column_count };
+        add_filled_index(std::make_unique<EDB::EDBIndex>(*m_file, key.index_root, key_types(columns),
+            std::move(name), std::move(columns), key.type == EDB::KeyType::UniqueIndex));
+    }
+    return {};
+}
+
+std::vector<Core::Value::Type> FileBackedTable::key_types(std::vector<size_t> const& columns) const {
+    std::vector<Core::Value::Type> types;
+    for (auto column : columns) {
+        types.push_back(m_columns[column].type());
+    }
+    return types;
+}
+
 std::vector<Core::Column> const& FileBackedTable::columns() const {
     return m_columns;
 }
@@ -51,13 +84,39 @@ Core::RelationIterator FileBackedTable::rows() const {
 }
 
 Core::MutableRelationIterator FileBackedTable::writable_rows() {
-    return Core::MutableRelationIterator { std::make_unique<EDB::EDBRelationIteratorImpl>(*m_file) };
+    return Core::MutableRelationIterator { std::make_unique<EDB::EDBRelationIteratorImpl>(*m_file, this) };
 }
 
 size_t FileBackedTable::size() const {
     return m_file->header().row_count;
 }
 
+// Morsels end at block boundaries, so that every block is read by a
+// single thread. Only the links between rows are read here.
+std::vector<Core::RelationIterator> FileBackedTable::morsels(size_t rows_per_morsel) const {
+    std::vector<Core::RelationIterator> morsels;
+    auto begin = m_file->header().first_row_ptr;
+    auto ptr = begin;
+    size_t rows = 0;
+    while (!ptr.is_null()) {
+        if (rows >= rows_per_morsel && ptr.block != begin.block) {
+            morsels.emplace_back(std::make_unique<EDB::EDBRelationIteratorImpl>(*m_file, begin, ptr));
+            begin = ptr;
+            rows = 0;
+        }
+        ptr = m_file->read<EDB::Table::RowSpec>(ptr).next_row;
+        rows++;
+    }
+    if (!begin.is_null()) {
+        morsels.emplace_back(std::make_unique<EDB::EDBRelationIteratorImpl>(*m_file, begin, EDB::HeapPtr { 0, 0 }));
+    }
+    return morsels;
+}
+
+Core::Tuple FileBackedTable::read_row(Core::RowId id) const {
+    return m_file->read_row(EDB::row_id_to_heap_ptr(id)).release_value_but_fixme_should_propagate_errors();
+}
+
 std::string FileBackedTable::name() const {
     return m_file->read_heap(m_file->header().table_name).decode_infallible().encode();
 }
@@ -74,23 +133,92 @@ int FileBackedTable::increment(std::string const&) {
 
 Core::DbError os_to_db_error(Util::OsError&& error) {
     return Core::DbError { fmt::format("OSError: {}: {}", error.function, strerror(error.error)) };
-};
+}
 
 Core::DbErrorOr<void> FileBackedTable::rename(std::string const& new_name) {
     // 1. Update header
     TRY(m_file->rename(new_name).map_error(os_to_db_error));
 
     // 2. Actually move the file.
+    return move_file(fmt::format("{}.edb", new_name));
+}
+
+Core::DbErrorOr<void> FileBackedTable::move_file(std::string file_name) {
+    // The log must not refer to the old name anymore, so it's checkpointed
+    // first.
+    TRY(m_log->checkpoint().map_error(os_to_db_error));
     auto old_edb_file_path = edb_file_path();
-    m_table_name = new_name;
+    m_file_name = std::move(file_name);
     if (::rename(old_edb_file_path.c_str(), edb_file_path().c_str()) < 0) {
         return Core::DbError { fmt::format("File rename failed: {}", strerror(errno)) };
     }
+    m_log->attach(*m_file, edb_file_name());
     return {};
 }
 
 Core::DbErrorOr<void> FileBackedTable::insert_unchecked(Core::Tuple const& tuple) {
-    TRY(m_file->insert(tuple).map_error(os_to_db_error));
+    auto row_ptr = TRY(m_file->insert(tuple).map_error(os_to_db_error));
+    return index_row(tuple, EDB::heap_ptr_to_row_id(row_ptr));
+}
+
+// Rows are moved, so indexes are filled again. They are cleared first, so
+// that blocks of their nodes are free when the file is truncated. The file
+// is actually truncated when the log is checkpointed, which is done at once.
+Core::DbErrorOr<void> FileBackedTable::vacuum() {
+    for (auto const& index : indexes()) {
+        TRY(index->clear());
+    }
+    TRY(m_file->vacuum().map_error(os_to_db_error));
+    for (auto const& index : indexes()) {
+        TRY(fill_index(*index));
+    }
+    TRY(m_log->checkpoint().map_error(os_to_db_error));
+    return {};
+}
+
+// Indexes may have been created or dropped in the rolled back changes.
+Core::DbErrorOr<void> FileBackedTable::reload() {
+    TRY(read_header().map_error(os_to_db_error));
+    clear_indexes();
+    TRY(load_indexes().map_error(os_to_db_error));
+    update_key_indexes();
+    return {};
+}
+
+Core::DbErrorOr<std::unique_ptr<Core::Index>> FileBackedTable::create_ordered_index(std::string name, std::vector<size_t> columns, bool unique) {
+    if (columns.size() > EDB::MaxIndexColumns) {
+        return Core::DbError { fmt::format("Index may have at most {} columns", EDB::MaxIndexColumns) };
+    }
+    auto types = key_types(columns);
+    if (!EDB::BTree::can_store_keys(*m_file, types)) {
+        return Core::DbError { "Index key is too big for this table" };
+    }
+    auto root = TRY(EDB::BTree::create(*m_file).map_error(os_to_db_error));
+    return std::make_unique<EDB::EDBIndex>(*m_file, root, std::move(types), std::move(name), std::move(columns), unique);
+}
+
+Core::DbErrorOr<void> FileBackedTable::user_indexes_changed() {
+    for (auto const& key : m_file->read_keys()) {
+        if (key.type == EDB::KeyType::Index || key.type == EDB::KeyType::UniqueIndex) {
+            TRY(m_file->heap_free(key.index_name.offset).map_error(os_to_db_error));
+        }
+    }
+
+    std::vector<EDB::Key> keys;
+    for (auto const& index : indexes()) {
+        auto edb_index = dynamic_cast<EDB::EDBIndex const*>(index.get());
+        if (!edb_index) {
+            continue;
+        }
+        EDB::Key key {};
+        key.type = index->is_unique() ? EDB::KeyType::UniqueIndex : EDB::KeyType::Index;
+        key.index_name = TRY(m_file->copy_to_heap(index->name()).map_error(os_to_db_error));
+        key.index_column_count = index->columns().size();
+        std::copy(index->columns().begin(), index->columns().end(), key.index_columns);
+        key.index_root = edb_index->root();
+        keys.push_back(key);
+    }
+    TRY(m_file->write_keys(keys).map_error(os_to_db_error));
     return {};
 }
 
@@ -100,7 +228,11 @@ void FileBackedTable::dump_storage_debug() {
 }
 
 std::string FileBackedTable::edb_file_path() const {
-    return fmt::format("{}/{}.edb", m_database_path, m_table_name);
+    return fmt::format("{}/{}", m_database_path, edb_file_name());
+}
+
+std::string FileBackedTable::edb_file_name() const {
+    return m_file_name;
 }
 
 }
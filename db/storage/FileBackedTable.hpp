@@ -4,19 +4,25 @@
 #include <db/core/Table.hpp>
 #include <db/storage/edb/Definitions.hpp>
 #include <db/storage/edb/EDBFile.hpp>
+#include <db/storage/edb/WriteAheadLog.hpp>
 
 namespace Db::Storage {
 
 class FileBackedTable : public Core::Table {
 public:
-    static Util::OsErrorOr<std::unique_ptr<FileBackedTable>> initialize(std::string database_path, Core::TableSetup);
-    static Util::OsErrorOr<std::unique_ptr<FileBackedTable>> open(std::string database_path, std::string table_name);
+    // Changes of the table are logged to `log`.
+    static Util::OsErrorOr<std::unique_ptr<FileBackedTable>> initialize(std::string database_path, Core::TableSetup, EDB::WriteAheadLog& log);
+    static Util::OsErrorOr<std::unique_ptr<FileBackedTable>> open(std::string database_path, std::string table_name, EDB::WriteAheadLog& log);
 
     // ^Relation
     virtual std::vector<Core::Column> const& columns() const override;
     virtual Core::RelationIterator rows() const override;
     virtual Core::MutableRelationIterator writable_rows() override;
     virtual size_t size() const override;
+    virtual std::vector<Core::RelationIterator> morsels(size_t rows_per_morsel) const override;
+
+    // ^IndexedRelation
+    virtual Core::Tuple read_row(Core::RowId) const override;
 
     // ^Table
     virtual Core::DatabaseEngine engine() const override { return Core::DatabaseEngine::EDB; }
@@ -25,9 +31,24 @@ public:
     virtual int increment(std::string const& column) override;
     virtual Core::DbErrorOr<void> rename(std::string const& new_name) override;
     virtual Core::DbErrorOr<void> insert_unchecked(Core::Tuple const&) override;
+    virtual Core::DbErrorOr<void> vacuum() override;
+    virtual Core::DbErrorOr<void> reload() override;
     virtual void dump_storage_debug() override;
 
     std::string edb_file_path() const;
+    std::string edb_file_name() const;
+
+    // Move file of the table within the database directory, without
+    // renaming the table. Files that don't end with ".edb" aren't opened
+    // with the database.
+    Core::DbErrorOr<void> move_file(std::string file_name);
+
+protected:
+    // ^IndexedRelation
+    virtual Core::DbErrorOr<std::unique_ptr<Core::Index>> create_ordered_index(std::string name, std::vector<size_t> columns, bool unique) override;
+    virtual Core::DbErrorOr<void> user_indexes_changed() override;
+    // Indexes are read from the rolled back file by reload().
+    virtual bool undoes_index_changes() const override { return false; }
 
 private:
     friend std::unique_ptr<FileBackedTable> std::make_unique<FileBackedTable>(std::unique_ptr<Db::Storage::EDB::EDBFile>&&);
@@ -35,10 +56,13 @@ private:
     FileBackedTable(std::unique_ptr<EDB::EDBFile>);
     static Util::OsErrorOr<std::unique_ptr<FileBackedTable>> create(std::unique_ptr<EDB::EDBFile>);
     Util::OsErrorOr<void> read_header();
+    Util::OsErrorOr<void> load_indexes();
+    std::vector<Core::Value::Type> key_types(std::vector<size_t> const& columns) const;
 
     std::unique_ptr<EDB::EDBFile> m_file;
+    EDB::WriteAheadLog* m_log = nullptr;
     std::string m_database_path;
-    std::string m_table_name;
+    std::string m_file_name;
     std::vector<Core::Column> m_columns;
 };
 
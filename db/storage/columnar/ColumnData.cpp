@@ -0,0 +1,143 @@
+#include "ColumnData.hpp"
+
+#include <EssaUtil/Config.hpp>
+
+namespace Db::Storage::Columnar {
+
+ColumnData::ColumnData(Core::Value::Type type)
+    : m_type(type) {
+    switch (type) {
+    case Core::Value::Type::Null:
+        break;
+    case Core::Value::Type::Int:
+        m_values = std::vector<int> {};
+        break;
+    case Core::Value::Type::Float:
+        m_values = std::vector<float> {};
+        break;
+    case Core::Value::Type::Varchar:
+        m_values = std::vector<StringId> {};
+        break;
+    case Core::Value::Type::Bool:
+        m_values = std::vector<uint8_t> {};
+        break;
+    case Core::Value::Type::Time:
+        m_values = std::vector<Core::Date> {};
+        break;
+    }
+}
+
+Core::DbErrorOr<void> ColumnData::append(Core::Value const& value) {
+    std::visit(
+        [](auto& values) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(values)>, std::monostate>) {
+                values.emplace_back();
+            }
+        },
+        m_values);
+    if (m_size % 64 == 0) {
+        m_null_bitmap.push_back(0);
+    }
+    m_size++;
+    if (auto result = store(m_size - 1, value); result.is_error()) {
+        remove_last();
+        return result.release_error();
+    }
+    return {};
+}
+
+Core::DbErrorOr<void> ColumnData::set(size_t row, Core::Value const& value) {
+    assert(row < m_size);
+    return store(row, value);
+}
+
+void ColumnData::remove_last() {
+    assert(m_size > 0);
+    std::visit(
+        [](auto& values) {
+            if constexpr (!std::is_same_v<std::decay_t<decltype(values)>, std::monostate>) {
+                values.pop_back();
+            }
+        },
+        m_values);
+    m_size--;
+    if (m_size % 64 == 0) {
+        m_null_bitmap.pop_back();
+    }
+}
+
+// Values are converted before anything is written, so that the row
+// stays unchanged on error.
+Core::DbErrorOr<void> ColumnData::store(size_t row, Core::Value const& value) {
+    // Only NULLs can be stored in a NULL column.
+    if (value.is_null() || m_type == Core::Value::Type::Null) {
+        set_null(row, true);
+        return {};
+    }
+
+    switch (m_type) {
+    case Core::Value::Type::Null:
+        ESSA_UNREACHABLE;
+    case Core::Value::Type::Int:
+        std::get<std::vector<int>>(m_values)[row] = TRY(value.to_int());
+        break;
+    case Core::Value::Type::Float:
+        std::get<std::vector<float>>(m_values)[row] = TRY(value.to_float());
+        break;
+    case Core::Value::Type::Varchar:
+        std::get<std::vector<StringId>>(m_values)[row] = intern(TRY(value.to_string()));
+        break;
+    case Core::Value::Type::Bool:
+        std::get<std::vector<uint8_t>>(m_values)[row] = TRY(value.to_bool());
+        break;
+    case Core::Value::Type::Time:
+        std::get<std::vector<Core::Date>>(m_values)[row] = TRY(value.to_time());
+        break;
+    }
+    set_null(row, false);
+    return {};
+}
+
+Core::Value ColumnData::get(size_t row) const {
+    assert(row < m_size);
+    if (is_null(row)) {
+        return Core::Value::null();
+    }
+    switch (m_type) {
+    case Core::Value::Type::Null:
+        return Core::Value::null();
+    case Core::Value::Type::Int:
+        return Core::Value::create_int(ints()[row]);
+    case Core::Value::Type::Float:
+        return Core::Value::create_float(floats()[row]);
+    case Core::Value::Type::Varchar:
+        return Core::Value::create_varchar(string(string_ids()[row]));
+    case Core::Value::Type::Bool:
+        return Core::Value::create_bool(bools()[row]);
+    case Core::Value::Type::Time:
+        return Core::Value::create_time(times()[row]);
+    }
+    ESSA_UNREACHABLE;
+}
+
+void ColumnData::set_null(size_t row, bool null) {
+    auto mask = uint64_t { 1 } << (row % 64);
+    if (null) {
+        m_null_bitmap[row / 64] |= mask;
+    }
+    else {
+        m_null_bitmap[row / 64] &= ~mask;
+    }
+}
+
+ColumnData::StringId ColumnData::intern(std::string const& string) {
+    if (auto it = m_string_ids.find(string); it != m_string_ids.end()) {
+        return it->second;
+    }
+    auto id = static_cast<StringId>(m_strings.size());
+    auto const& stored = m_strings.emplace_back(string);
+    m_string_ids.insert({ stored, id });
+    return id;
+}
+
+}
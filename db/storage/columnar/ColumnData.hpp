@@ -0,0 +1,74 @@
+#pragma once
+
+#include <db/core/Value.hpp>
+#include <deque>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace Db::Storage::Columnar {
+
+// Values of a single column of a ColumnarTable, stored as a contiguous
+// array of the column type, with NULLs kept in a separate bitmap.
+// Varchars are deduplicated in a dictionary and stored as ids into it.
+class ColumnData {
+public:
+    using StringId = uint32_t;
+
+    explicit ColumnData(Core::Value::Type type);
+
+    Core::Value::Type type() const { return m_type; }
+    size_t size() const { return m_size; }
+
+    // Values of other types than the column type are converted to it.
+    // If this is not possible, an error is returned and the column is
+    // left unchanged.
+    Core::DbErrorOr<void> append(Core::Value const&);
+    Core::DbErrorOr<void> set(size_t row, Core::Value const&);
+    void remove_last();
+    Core::Value get(size_t row) const;
+
+    bool is_null(size_t row) const { return (m_null_bitmap[row / 64] >> (row % 64)) & 1; }
+
+    // Bit N of word N/64 is set if row N is NULL. Values of NULL rows are
+    // unspecified.
+    std::span<uint64_t const> null_bitmap() const { return m_null_bitmap; }
+
+    // Raw values; only the one matching the column type may be called.
+    std::span<int const> ints() const { return std::get<std::vector<int>>(m_values); }
+    std::span<float const> floats() const { return std::get<std::vector<float>>(m_values); }
+    std::span<StringId const> string_ids() const { return std::get<std::vector<StringId>>(m_values); }
+    std::span<uint8_t const> bools() const { return std::get<std::vector<uint8_t>>(m_values); }
+    std::span<Core::Date const> times() const { return std::get<std::vector<Core::Date>>(m_values); }
+
+    std::string const& string(StringId id) const { return m_strings[id]; }
+
+private:
+    void set_null(size_t row, bool);
+    Core::DbErrorOr<void> store(size_t row, Core::Value const&);
+    StringId intern(std::string const&);
+
+    // Alternatives are in the order of Core::Value::Type.
+    using Values = std::variant<
+        std::monostate,
+        std::vector<int>,
+        std::vector<float>,
+        std::vector<StringId>,
+        std::vector<uint8_t>,
+        std::vector<Core::Date>>;
+
+    Core::Value::Type m_type;
+    Values m_values;
+    std::vector<uint64_t> m_null_bitmap;
+    size_t m_size = 0;
+
+    // Strings are never removed from the dictionary. Deque is used so
+    // that views in m_string_ids stay valid.
+    std::deque<std::string> m_strings;
+    std::unordered_map<std::string_view, StringId> m_string_ids;
+};
+
+}
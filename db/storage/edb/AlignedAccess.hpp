@@ -82,8 +82,8 @@ public:
     ~AllocatingAlignedAccess() {
         if (m_ptr) {
             flush();
-            free(m_object);
         }
+        free(m_object);
     }
 
     AllocatingAlignedAccess(AllocatingAlignedAccess const&) = delete;
@@ -123,6 +123,11 @@ public:
         m_size = 0;
     }
 
+    // Keep the copy, but don't flush it, so that it can be only read.
+    void discard() {
+        m_ptr = nullptr;
+    }
+
 private:
     uint8_t* m_ptr = nullptr;
     T* m_object = nullptr;
@@ -0,0 +1,330 @@
+#include "BTree.hpp"
+
+#include <EssaUtil/Config.hpp>
+#include <db/storage/edb/EDBFile.hpp>
+#include <iterator>
+#include <tuple>
+
+namespace Db::Storage::EDB {
+
+static int compare_heap_ptrs(HeapPtr lhs, HeapPtr rhs) {
+    auto lhs_tuple = std::make_tuple(lhs.block.value(), lhs.offset.value());
+    auto rhs_tuple = std::make_tuple(rhs.block.value(), rhs.offset.value());
+    if (lhs_tuple < rhs_tuple) {
+        return -1;
+    }
+    if (rhs_tuple < lhs_tuple) {
+        return 1;
+    }
+    return 0;
+}
+
+static int compare_entry(auto const& entry, Core::Tuple const& key, HeapPtr row) {
+    if (auto result = Core::compare_index_keys(entry.key, key); result != 0) {
+        return result;
+    }
+    return compare_heap_ptrs(entry.row, row);
+}
+
+// Returns child in which entry (key, row) should be placed.
+static BlockIndex child_for(auto const& node, Core::Tuple const& key, HeapPtr row) {
+    BlockIndex child = node.first_child;
+    for (auto const& entry : node.entries) {
+        if (compare_entry(entry, key, row) > 0) {
+            break;
+        }
+        child = entry.child;
+    }
+    return child;
+}
+
+Util::OsErrorOr<BlockIndex> BTree::create(EDBFile& file) {
+    auto root = TRY(file.allocate_block(BlockType::Index));
+    BTree tree { file, root, {} };
+    tree.write_node(root, Node {});
+    return root;
+}
+
+size_t BTree::entry_size(size_t key_size, bool is_leaf) {
+    return key_size + sizeof(HeapPtr) + (is_leaf ? 0 : sizeof(BlockIndex));
+}
+
+size_t BTree::max_entries(EDBFile const& file, size_t key_size, bool is_leaf) {
+    return (file.block_size() - sizeof(Block) - sizeof(Index::Node)) / entry_size(key_size, is_leaf);
+}
+
+size_t BTree::max_entries(bool is_leaf) const {
+    return max_entries(m_file, m_key_types.size() * sizeof(StoredValue), is_leaf);
+}
+
+bool BTree::can_store_keys(EDBFile const& file, std::vector<Core::Value::Type> const& key_types) {
+    // Splitting requires at least 2 entries on each side, plus one that
+    // goes to the parent.
+    return max_entries(file, key_types.size() * sizeof(StoredValue), false) >= 4;
+}
+
+BTree::Node BTree::read_node(BlockIndex block) {
+    auto key_size = m_key_types.size() * sizeof(StoredValue);
+    auto access = m_file.read<Index::Node>({ block, sizeof(Block) }, m_file.block_size() - sizeof(Block));
+
+    Node node;
+    node.is_leaf = access->is_leaf;
+    node.next_leaf = access->next_leaf;
+    node.first_child = access->first_child;
+
+    auto size = entry_size(key_size, node.is_leaf);
+    uint8_t const* ptr = access->data;
+    for (size_t s = 0; s < access->entry_count; s++, ptr += size) {
+        Entry entry;
+        entry.stored_key.resize(m_key_types.size());
+        std::memcpy(entry.stored_key.data(), ptr, key_size);
+
+        std::vector<Core::Value> values;
+        for (size_t c = 0; c < m_key_types.size(); c++) {
+            auto const& stored = entry.stored_key[c];
+            values.push_back(stored.is_null ? Core::Value::null() : m_file.read_edb_value(m_key_types[c], stored.value()));
+        }
+        entry.key = Core::Tuple { std::move(values) };
+
+        std::memcpy(&entry.row, ptr + key_size, sizeof(HeapPtr));
+        if (!node.is_leaf) {
+            LittleEndian<BlockIndex> child;
+            std::memcpy(&child, ptr + key_size + sizeof(HeapPtr), sizeof(BlockIndex));
+            entry.child = child;
+        }
+        node.entries.push_back(std::move(entry));
+    }
+    return node;
+}
+
+void BTree::write_node(BlockIndex block, Node const& node) {
+    assert(node.entries.size() <= max_entries(node.is_leaf));
+
+    auto key_size = m_key_types.size() * sizeof(StoredValue);
+    auto size = entry_size(key_size, node.is_leaf);
+    Index::Node header {};
+    header.is_leaf = node.is_leaf;
+    header.entry_count = node.entries.size();
+    header.next_leaf = node.next_leaf;
+    header.first_child = node.first_child;
+
+    // Space after the entries is not used, so it's not written.
+    std::vector<uint8_t> data(sizeof(Index::Node) + node.entries.size() * size);
+    std::memcpy(data.data(), &header, sizeof(Index::Node));
+    uint8_t* ptr = data.data() + sizeof(Index::Node);
+    for (auto const& entry : node.entries) {
+        std::memcpy(ptr, entry.stored_key.data(), key_size);
+        std::memcpy(ptr + key_size, &entry.row, sizeof(HeapPtr));
+        if (!node.is_leaf) {
+            LittleEndian<BlockIndex> child { entry.child };
+            std::memcpy(ptr + key_size + sizeof(HeapPtr), &child, sizeof(BlockIndex));
+        }
+        ptr += size;
+    }
+    // Entries that were only moved are logged too, but entries before
+    // the changed one and the rest of the block are not.
+    m_file.write_changes({ block, sizeof(Block) }, data);
+}
+
+Util::OsErrorOr<BTree::Entry> BTree::make_entry(Core::Tuple const& key, HeapPtr row) {
+    assert(key.value_count() == m_key_types.size());
+
+    Entry entry;
+    entry.key = key;
+    entry.row = row;
+    for (size_t s = 0; s < m_key_types.size(); s++) {
+        auto value = key.value(s);
+        if (value.is_null()) {
+            entry.stored_key.push_back({ .is_null = 1, .value_bytes = {} });
+            continue;
+        }
+        if (value.type() != m_key_types[s]) {
+            return Util::OsError { .error = 0, .function = "BTree: Key type doesn't match column type" };
+        }
+        auto edb_value = TRY(m_file.write_edb_value(value));
+        StoredValue stored { .is_null = 0, .value_bytes = {} };
+        std::memcpy(stored.value_bytes, &edb_value, sizeof(Value));
+        entry.stored_key.push_back(stored);
+    }
+    return entry;
+}
+
+Util::OsErrorOr<void> BTree::free_entry(Entry const& entry) {
+    for (size_t s = 0; s < m_key_types.size(); s++) {
+        auto const& stored = entry.stored_key[s];
+        if (!stored.is_null && m_key_types[s] == Core::Value::Type::Varchar) {
+            TRY(m_file.heap_free(stored.value().varchar_value.offset));
+        }
+    }
+    return {};
+}
+
+Util::OsErrorOr<void> BTree::insert(Core::Tuple const& key, HeapPtr row) {
+    auto separator = TRY(insert_into(m_root, TRY(make_entry(key, row))));
+    if (!separator) {
+        return {};
+    }
+
+    // Root was split. Move its contents to a new block, so that root
+    // stays in place, and make it point to both halves.
+    auto left_block = TRY(m_file.allocate_block(BlockType::Index));
+    write_node(left_block, read_node(m_root));
+
+    Node new_root;
+    new_root.is_leaf = false;
+    new_root.first_child = left_block;
+    new_root.entries.push_back(std::move(*separator));
+    write_node(m_root, new_root);
+    return {};
+}
+
+Util::OsErrorOr<std::optional<BTree::Entry>> BTree::insert_into(BlockIndex block, Entry entry) {
+    auto node = read_node(block);
+
+    auto insert_sorted = [&](Entry entry) {
+        auto it = std::find_if(node.entries.begin(), node.entries.end(), [&](auto const& other) {
+            return compare_entry(other, entry.key, entry.row) > 0;
+        });
+        node.entries.insert(it, std::move(entry));
+    };
+
+    if (node.is_leaf) {
+        insert_sorted(std::move(entry));
+    }
+    else {
+        auto child = child_for(node, entry.key, entry.row);
+        auto child_separator = TRY(insert_into(child, std::move(entry)));
+        if (!child_separator) {
+            return std::optional<Entry> {};
+        }
+        insert_sorted(std::move(*child_separator));
+    }
+
+    if (node.entries.size() <= max_entries(node.is_leaf)) {
+        write_node(block, node);
+        return std::optional<Entry> {};
+    }
+
+    // Split node in half.
+    auto right_block = TRY(m_file.allocate_block(BlockType::Index));
+    Node right;
+    right.is_leaf = node.is_leaf;
+
+    auto middle = node.entries.begin() + node.entries.size() / 2;
+    Entry separator;
+    if (node.is_leaf) {
+        right.entries.assign(std::make_move_iterator(middle), std::make_move_iterator(node.entries.end()));
+        node.entries.erase(middle, node.entries.end());
+        right.next_leaf = node.next_leaf;
+        node.next_leaf = right_block;
+        // Leaf entries may be removed later, so separator needs its own copy of key.
+        separator = TRY(make_entry(right.entries.front().key, right.entries.front().row));
+    }
+    else {
+        separator = std::move(*middle);
+        right.first_child = separator.child;
+        right.entries.assign(std::make_move_iterator(middle + 1), std::make_move_iterator(node.entries.end()));
+        node.entries.erase(middle, node.entries.end());
+    }
+    separator.child = right_block;
+
+    write_node(block, node);
+    write_node(right_block, right);
+    return separator;
+}
+
+Util::OsErrorOr<void> BTree::remove(Core::Tuple const& key, HeapPtr row) {
+    auto leaf = find_leaf(key, row);
+    auto node = read_node(leaf);
+    auto it = std::find_if(node.entries.begin(), node.entries.end(), [&](auto const& entry) {
+        return compare_entry(entry, key, row) == 0;
+    });
+    if (it == node.entries.end()) {
+        return Util::OsError { .error = 0, .function = "BTree: Removing nonexistent entry" };
+    }
+    TRY(free_entry(*it));
+    node.entries.erase(it);
+    write_node(leaf, node);
+    return {};
+}
+
+BlockIndex BTree::find_leaf(Core::Tuple const& key, HeapPtr row) {
+    auto block = m_root;
+    while (true) {
+        auto node = read_node(block);
+        if (node.is_leaf) {
+            return block;
+        }
+        block = child_for(node, key, row);
+    }
+}
+
+BlockIndex BTree::find_leftmost_leaf() {
+    auto block = m_root;
+    while (true) {
+        auto node = read_node(block);
+        if (node.is_leaf) {
+            return block;
+        }
+        block = node.first_child;
+    }
+}
+
+void BTree::for_each_in_range(std::optional<Bound> const& lower, std::optional<Bound> const& upper,
+    std::function<bool(Core::Tuple const& key, HeapPtr row)> const& callback) {
+    // HeapPtr 0:0 is smaller than any real row, so this finds leaf
+    // with the first entry with the key.
+    auto leaf = lower ? find_leaf(lower->key, HeapPtr { 0, 0 }) : find_leftmost_leaf();
+    while (leaf != 0) {
+        auto node = read_node(leaf);
+        for (auto const& entry : node.entries) {
+            if (lower) {
+                auto result = Core::compare_index_keys(entry.key, lower->key);
+                if (result < 0 || (result == 0 && !lower->inclusive)) {
+                    continue;
+                }
+            }
+            if (upper) {
+                auto result = Core::compare_index_keys(entry.key, upper->key);
+                if (result > 0 || (result == 0 && !upper->inclusive)) {
+                    return;
+                }
+            }
+            if (!callback(entry.key, entry.row)) {
+                return;
+            }
+        }
+        leaf = node.next_leaf;
+    }
+}
+
+Util::OsErrorOr<void> BTree::clear() {
+    return free_subtree(m_root, true);
+}
+
+Util::OsErrorOr<void> BTree::destroy() {
+    return free_subtree(m_root, false);
+}
+
+Util::OsErrorOr<void> BTree::free_subtree(BlockIndex block, bool keep_root) {
+    auto node = read_node(block);
+    for (auto const& entry : node.entries) {
+        TRY(free_entry(entry));
+        if (!node.is_leaf) {
+            TRY(free_subtree(entry.child, false));
+        }
+    }
+    if (!node.is_leaf) {
+        TRY(free_subtree(node.first_child, false));
+    }
+
+    if (keep_root) {
+        write_node(block, Node {});
+    }
+    else {
+        m_file.free_block(block);
+    }
+    return {};
+}
+
+}
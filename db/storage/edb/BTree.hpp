@@ -0,0 +1,109 @@
+#pragma once
+
+#include <EssaUtil/Error.hpp>
+#include <cstring>
+#include <db/core/Index.hpp>
+#include <db/core/Tuple.hpp>
+#include <db/storage/edb/Definitions.hpp>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Db::Storage::EDB {
+
+class EDBFile;
+
+// B+tree of (key, row) entries stored in Index blocks. The root node
+// never moves, so the tree is identified by its root block. Removing
+// entries doesn't rebalance the tree; empty leaves are just skipped
+// when scanning.
+class BTree {
+public:
+    using Bound = Core::Index::Bound;
+
+    BTree(EDBFile& file, BlockIndex root, std::vector<Core::Value::Type> key_types)
+        : m_file(file)
+        , m_root(root)
+        , m_key_types(std::move(key_types)) { }
+
+    // Allocate an empty tree and return its root block.
+    static Util::OsErrorOr<BlockIndex> create(EDBFile&);
+
+    BlockIndex root() const { return m_root; }
+
+    // Check if a node of the tree can fit enough entries to be split.
+    static bool can_store_keys(EDBFile const&, std::vector<Core::Value::Type> const& key_types);
+
+    Util::OsErrorOr<void> insert(Core::Tuple const& key, HeapPtr row);
+    Util::OsErrorOr<void> remove(Core::Tuple const& key, HeapPtr row);
+
+    // Remove all entries, keeping the root block.
+    Util::OsErrorOr<void> clear();
+
+    // Free all blocks used by the tree, including the root.
+    Util::OsErrorOr<void> destroy();
+
+    // Call `callback` for every entry with key in range, in key order,
+    // until it returns false. Unset bound means no limit.
+    void for_each_in_range(std::optional<Bound> const& lower, std::optional<Bound> const& upper,
+        std::function<bool(Core::Tuple const& key, HeapPtr row)> const& callback);
+
+private:
+    // Value is stored as bytes, because it is not trivial and thus can't
+    // be a member of a packed struct.
+    struct [[gnu::packed]] StoredValue {
+        uint8_t is_null;
+        uint8_t value_bytes[sizeof(Value)];
+
+        Value value() const {
+            Value value;
+            std::memcpy(&value, value_bytes, sizeof(Value));
+            return value;
+        }
+    };
+    static_assert(sizeof(StoredValue) == 1 + sizeof(Value));
+
+    struct Entry {
+        Core::Tuple key {};
+        // Key as stored in file. Varchars are heap-allocated and owned
+        // by the entry.
+        std::vector<StoredValue> stored_key;
+        HeapPtr row {};
+        BlockIndex child = 0;
+    };
+
+    struct Node {
+        bool is_leaf = true;
+        BlockIndex next_leaf = 0;
+        BlockIndex first_child = 0;
+        std::vector<Entry> entries;
+    };
+
+    static size_t entry_size(size_t key_size, bool is_leaf);
+    static size_t max_entries(EDBFile const&, size_t key_size, bool is_leaf);
+    size_t max_entries(bool is_leaf) const;
+
+    Node read_node(BlockIndex);
+    void write_node(BlockIndex, Node const&);
+
+    Util::OsErrorOr<Entry> make_entry(Core::Tuple const& key, HeapPtr row);
+    Util::OsErrorOr<void> free_entry(Entry const&);
+
+    // Returns separator entry that must be inserted into parent if
+    // the node was split.
+    Util::OsErrorOr<std::optional<Entry>> insert_into(BlockIndex, Entry);
+
+    // Find leaf that would contain entry (key, row).
+    BlockIndex find_leaf(Core::Tuple const& key, HeapPtr row);
+    BlockIndex find_leftmost_leaf();
+
+    // Free all blocks of a subtree. If `keep_root` is set, the subtree
+    // root is reset to an empty leaf instead.
+    Util::OsErrorOr<void> free_subtree(BlockIndex, bool keep_root);
+
+    EDBFile& m_file;
+    BlockIndex m_root;
+    std::vector<Core::Value::Type> m_key_types;
+};
+
+}
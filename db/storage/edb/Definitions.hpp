@@ -14,7 +14,7 @@ using BlockIndex = uint32_t;
 class EDBFile;
 
 constexpr uint8_t Magic[] = { 0x65, 0x73, 0x64, 0x62, 0x0d, 0x0a }; // esdb\r\n
-constexpr uint16_t CurrentVersion = 0x0001;
+constexpr uint16_t CurrentVersion = 0x0002;
 constexpr size_t RowsPerBlock = 256;
 
 struct [[gnu::packed]] HeapPtr {
@@ -30,6 +30,32 @@ struct [[gnu::packed]] HeapSpan {
 };
 
 struct [[gnu::packed]] EDBHeader {
+    uint8_t magic[6];
+    LittleEndian<uint16_t> version;
+    LittleEndian<uint32_t> block_size;
+    LittleEndian<uint64_t> row_count;
+    uint8_t column_count;
+    HeapPtr first_row_ptr;
+    HeapPtr last_row_ptr;
+    BlockIndex last_table_block;
+    BlockIndex last_heap_block;
+    // First Table block that has unused rows (0 if none)
+    BlockIndex first_free_table_block;
+    // First Free block (0 if none)
+    BlockIndex first_free_block;
+    // Blocks in use. The file may be bigger, as it grows in steps.
+    BlockIndex block_count;
+    HeapSpan table_name;
+    HeapSpan check_statement;
+    uint8_t auto_increment_value_count;
+    uint8_t key_count;
+    HeapSpan keys;
+};
+
+// Header of version 1 files, which are upgraded when opened. They have no
+// keys, free lists nor block count, and Table blocks have only the count
+// of rows before the rows.
+struct [[gnu::packed]] EDBHeaderV1 {
     uint8_t magic[6];
     LittleEndian<uint16_t> version;
     LittleEndian<uint32_t> block_size;
@@ -49,9 +75,12 @@ enum class BlockType : uint8_t {
     Free,
     Table,
     Heap,
-    Big
+    Big,
+    Index
 };
 
+// Table, Heap and Free blocks are linked by prev_block and next_block into
+// a list of their type.
 struct [[gnu::packed]] Block {
     BlockType type;
     LittleEndian<BlockIndex> prev_block;
@@ -87,6 +116,26 @@ struct Column {
     Value default_value;
 };
 
+enum class KeyType : uint8_t {
+    Primary,
+    Foreign,
+    Index,
+    UniqueIndex,
+};
+
+constexpr size_t MaxIndexColumns = 16;
+
+struct [[gnu::packed]] Key {
+    KeyType type;
+    uint8_t local_column;
+    HeapSpan referenced_table;
+    uint8_t referenced_column;
+    HeapSpan index_name;
+    uint8_t index_column_count;
+    uint8_t index_columns[MaxIndexColumns];
+    BlockIndex index_root;
+};
+
 namespace Table {
 
 struct RowSpec {
@@ -101,13 +150,47 @@ struct RowSpec {
 
 static_assert(sizeof(RowSpec) == 9);
 
-struct TableBlock {
+// Unused rows of a block are linked by their `next_row` into a list, and
+// blocks that have any unused rows are linked into a list that starts at
+// EDBHeader::first_free_table_block, so that a place for a row is found
+// without scanning the table.
+struct [[gnu::packed]] TableBlock {
     uint8_t rows_in_block;
+    HeapPtr first_free_row;
+    LittleEndian<BlockIndex> prev_free_block;
+    LittleEndian<BlockIndex> next_free_block;
     RowSpec rows[0];
 };
 
 }
 
+namespace Index {
+
+// Node of an index B+tree, stored in an Index block. Node is followed
+// by `entry_count` entries sorted by key, each consisting of:
+// - key values, each stored as `u8 is_null` + `Value`,
+// - HeapPtr of the row, used as a tiebreaker so that all entries are unique,
+// - (inner nodes only) BlockIndex of child that contains entries >= this.
+struct [[gnu::packed]] Node {
+    uint8_t is_leaf;
+    LittleEndian<uint16_t> entry_count;
+    // Leaf: next leaf in key order (0 if none)
+    LittleEndian<BlockIndex> next_leaf;
+    // Inner: child that contains entries < first entry
+    LittleEndian<BlockIndex> first_child;
+    uint8_t data[0];
+};
+
+}
+
+}
+
+namespace Db::Storage {
+
+// Convert error of an EDB file operation to one that can be reported to
+// the user.
+Core::DbError os_to_db_error(Util::OsError&&);
+
 }
 
 template<>
@@ -3,14 +3,19 @@
 #include <EssaUtil/Config.hpp>
 #include <EssaUtil/Error.hpp>
 #include <EssaUtil/ScopeGuard.hpp>
+#include <EssaUtil/Stream/MemoryStream.hpp>
 #include <EssaUtil/Stream/File.hpp>
 #include <EssaUtil/Stream/Stream.hpp>
 #include <db/core/Value.hpp>
 #include <db/storage/edb/Definitions.hpp>
 #include <db/storage/edb/MappedFile.hpp>
 #include <db/storage/edb/Serializer.hpp>
+#include <db/storage/edb/WriteAheadLog.hpp>
+#include <algorithm>
 #include <fcntl.h>
 #include <filesystem>
+#include <mutex>
+#include <set>
 #include <sys/stat.h>
 #include <type_traits>
 #include <unistd.h>
@@ -24,15 +29,28 @@ Util::OsErrorOr<void> ftruncate(int fd, off_t size) {
     return {};
 }
 
+// OsError only refers to its message, so messages are kept until the end of
+// the program. There is one for every version that was found.
+static Util::OsError unsupported_version(uint16_t version) {
+    static std::mutex mutex;
+    static std::set<std::string> messages;
+    std::lock_guard lock { mutex };
+    auto const& message = *messages.insert(fmt::format("EDBFile: Unsupported file version {} (expected {})", version, CurrentVersion)).first;
+    return Util::OsError { .error = ENOTSUP, .function = message };
+}
+
 EDBFile::EDBFile(Util::File f, MappedFile mapped_file)
     : m_mapped_file(std::move(mapped_file))
     , m_file(std::move(f)) {
 }
 
 EDBFile::~EDBFile() {
-    auto result = flush_header();
+    auto result = commit();
     if (result.is_error()) {
-        result.dump("Internal error: Failed to flush EDB header on destruction");
+        result.dump("Internal error: Failed to commit EDB file on destruction");
+    }
+    if (m_log) {
+        m_log->detach(*this);
     }
 }
 
@@ -47,6 +65,71 @@ Util::OsErrorOr<std::unique_ptr<EDBFile>> EDBFile::open(Util::File file) {
     return edb_file;
 }
 
+// Files are upgraded by reading rows with the old layout and inserting
+// them into a new file, which then replaces the old one. So the file is
+// either upgraded completely, or not at all. The new file is removed if
+// the upgrade fails.
+Util::OsErrorOr<void> EDBFile::upgrade(std::string const& path) {
+    Util::File file { ::open(path.c_str(), O_RDONLY), true };
+    if (file.fd() == -1) {
+        return Util::OsError { .error = errno, .function = "EDBFile::upgrade() open" };
+    }
+    struct stat stat;
+    if (::fstat(file.fd(), &stat) < 0) {
+        return Util::OsError { .error = errno, .function = "EDBFile::upgrade(): stat" };
+    }
+    if (static_cast<size_t>(stat.st_size) < sizeof(EDBHeaderV1)) {
+        // Let open() report it.
+        return {};
+    }
+    auto mapped_file = TRY(MappedFile::map(file.fd(), stat.st_size));
+    auto version = reinterpret_cast<EDBHeaderV1 const*>(mapped_file.data().data())->version;
+    if (version == CurrentVersion) {
+        return {};
+    }
+    if (version != 1) {
+        return unsupported_version(version);
+    }
+
+    auto old_file = std::unique_ptr<EDBFile>(new EDBFile(std::move(file), std::move(mapped_file)));
+    TRY(old_file->read_header_version_1());
+    Core::TableSetup setup {
+        .name = old_file->read_heap(old_file->m_header.table_name).decode_infallible().encode(),
+        .columns = TRY(old_file->read_columns()),
+    };
+
+    auto upgraded_path = path + ".upgrade";
+    bool renamed = false;
+    Util::ScopeGuard guard { [&] {
+        if (!renamed) {
+            ::unlink(upgraded_path.c_str());
+        }
+    } };
+    Util::File upgraded_file { ::open(upgraded_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644), true };
+    auto new_file = TRY(initialize(std::move(upgraded_file), std::move(setup)));
+    for (auto row = old_file->m_header.first_row_ptr; !row.is_null(); row = old_file->read<Table::RowSpec>(row).next_row) {
+        TRY(new_file->insert(TRY(old_file->read_row(row))));
+    }
+    TRY(new_file->commit());
+    new_file.reset();
+
+    if (::rename(upgraded_path.c_str(), path.c_str()) < 0) {
+        return Util::OsError { .error = errno, .function = "EDBFile::upgrade() rename" };
+    }
+    renamed = true;
+
+    // Make the rename durable, so that the old file doesn't come back.
+    auto directory = std::filesystem::path { path }.parent_path();
+    Util::File directory_file { ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY), true };
+    if (directory_file.fd() == -1) {
+        return Util::OsError { .error = errno, .function = "EDBFile::upgrade() open directory" };
+    }
+    if (::fsync(directory_file.fd()) < 0) {
+        return Util::OsError { .error = errno, .function = "EDBFile::upgrade() fsync directory" };
+    }
+    return {};
+}
+
 Util::OsErrorOr<std::unique_ptr<EDBFile>> EDBFile::initialize(Util::File file, Db::Core::TableSetup setup) {
     if (file.fd() == -1) {
         return Util::OsError { .error = errno, .function = "EDBFile::initialize() open" };
@@ -63,15 +146,26 @@ Util::OsErrorOr<std::unique_ptr<EDBFile>> EDBFile::initialize(Util::File file, D
     TRY(edb_file->write_header(setup));
     TRY(edb_file->read_header());
 
+    // Rows can be laid out only when columns are known.
+    edb_file->initialize_table_block(1);
+    edb_file->flush_header();
+
     return edb_file;
 }
 
+// This is required because packed fields can't be bound to
+// reference, which is normally done by fmt::print
+template<class T>
+T copy(T ref) {
+    return ref;
+}
+
 void EDBFile::dump_blocks() {
     fmt::print("Block count: {}\n", m_block_count);
     for (size_t s = 1; s < m_block_count; s++) {
-        auto block = access<Block>({ s, 0 });
-        auto type = block->type;
-        fmt::print("- {}: prev={} next={} type=", s, block->prev_block, block->next_block);
+        auto block = read<Block>({ s, 0 });
+        auto type = block.type;
+        fmt::print("- {}: prev={} next={} type=", s, copy(block.prev_block), copy(block.next_block));
         switch (type) {
         case BlockType::Free:
             fmt::print("FREE");
@@ -85,18 +179,14 @@ void EDBFile::dump_blocks() {
         case BlockType::Big:
             fmt::print("BIG");
             break;
+        case BlockType::Index:
+            fmt::print("INDEX");
+            break;
         }
         fmt::print("\n");
     }
 }
 
-// This is required because packed fields can't be bound to
-// reference, which is normally done by fmt::print
-template<class T>
-T copy(T ref) {
-    return ref;
-}
-
 void EDBFile::dump() {
     fmt::print("--- EDB File Dump ---\n");
     fmt::print("Header:\n");
@@ -113,6 +203,9 @@ void EDBFile::dump() {
     fmt::print("  last_row_ptr = {}\n", copy(m_header.last_row_ptr));
     fmt::print("  last_table_block = {}\n", copy(m_header.last_table_block));
     fmt::print("  last_heap_block = {}\n", copy(m_header.last_heap_block));
+    fmt::print("  first_free_table_block = {}\n", copy(m_header.first_free_table_block));
+    fmt::print("  first_free_block = {}\n", copy(m_header.first_free_block));
+    fmt::print("  block_count = {} (allocated {})\n", copy(m_header.block_count), allocated_block_count());
     fmt::print("  auto_increment_value_count = {}\n", copy(m_header.auto_increment_value_count));
     fmt::print("  key_count = {}\n", copy(m_header.key_count));
     fmt::print("  row size = {}\n", row_size());
@@ -120,9 +213,9 @@ void EDBFile::dump() {
 
     for (size_t s = 1; s < m_block_count; s++) {
         fmt::print("Block {}\n", s);
-        auto block = access<Block>({ s, 0 });
-        auto type = block->type;
-        fmt::print("  prev={}\n  next={}\n  type=", block->prev_block, block->next_block);
+        auto block = read<Block>({ s, 0 });
+        auto type = block.type;
+        fmt::print("  prev={}\n  next={}\n  type=", copy(block.prev_block), copy(block.next_block));
         switch (type) {
         case BlockType::Free:
             fmt::print("FREE");
@@ -136,6 +229,9 @@ void EDBFile::dump() {
         case BlockType::Big:
             fmt::print("BIG");
             break;
+        case BlockType::Index:
+            fmt::print("INDEX");
+            break;
         }
         fmt::print("\n");
 
@@ -143,8 +239,10 @@ void EDBFile::dump() {
         case BlockType::Free:
             break;
         case BlockType::Table: {
-            auto table_block = access<Table::TableBlock>({ s, sizeof(Block) });
-            fmt::print("    rows_in_block = {}\n", table_block->rows_in_block);
+            auto table_block = read<Table::TableBlock>({ s, sizeof(Block) });
+            fmt::print("    rows_in_block = {}\n", copy(table_block.rows_in_block));
+            fmt::print("    first_free_row = {} prev_free_block = {} next_free_block = {}\n",
+                copy(table_block.first_free_row), copy(table_block.prev_free_block), copy(table_block.next_free_block));
             HeapPtr ptr { s, sizeof(Block) + sizeof(Table::TableBlock) };
             auto row_size = sizeof(Table::RowSpec) + this->row_size();
             size_t idx = 0;
@@ -152,7 +250,7 @@ void EDBFile::dump() {
                 if (ptr.offset + row_size > block_size()) {
                     break;
                 }
-                auto row = access<Table::RowSpec>(ptr, row_size);
+                auto row = read<Table::RowSpec>(ptr, row_size);
                 auto old_ptr = ptr;
                 ptr.offset = ptr.offset + row_size;
                 // if (!row->is_used) {
@@ -167,12 +265,17 @@ void EDBFile::dump() {
             }
         } break;
         case BlockType::Heap: {
-            auto heap_block = access<Data::HeapBlock>({ s, sizeof(Block) }, block_size() - sizeof(Block));
+            auto heap_block = read<Data::HeapBlock>({ s, sizeof(Block) }, block_size() - sizeof(Block));
             heap_block->dump(*this, s);
         } break;
         case BlockType::Big:
             fmt::print("  TODO\n");
             break;
+        case BlockType::Index: {
+            auto node = read<Index::Node>({ s, sizeof(Block) });
+            fmt::print("    is_leaf={} entry_count={} next_leaf={} first_child={}\n",
+                node.is_leaf, copy(node.entry_count), copy(node.next_leaf), copy(node.first_child));
+        } break;
         }
     }
 }
@@ -187,9 +290,28 @@ Util::Buffer EDBFile::read_heap(HeapSpan span) const {
     return Util::Buffer { { ptr, span.size } };
 }
 
+void EDBFile::write_changes(HeapPtr ptr, std::span<uint8_t const> data) {
+    assert(!ptr.is_null());
+    assert(ptr.offset + data.size() <= block_size());
+    auto mapped_ptr = heap_ptr_to_mapped_ptr(ptr);
+    size_t end = 0;
+    while (true) {
+        size_t begin = std::mismatch(data.begin() + end, data.end(), mapped_ptr + end).first - data.begin();
+        if (begin == data.size()) {
+            break;
+        }
+        end = begin;
+        while (end < data.size() && data[end] != mapped_ptr[end]) {
+            end++;
+        }
+        std::copy(data.begin() + begin, data.begin() + end, mapped_ptr + begin);
+        mark_dirty(mapped_ptr + begin, end - begin);
+    }
+}
+
 size_t EDBFile::header_size() const {
     // TODO: AI, keys
-    return sizeof(EDBHeader) + m_header.column_count * sizeof(Column);
+    return m_header_struct_size + m_header.column_count * sizeof(Column);
 }
 
 size_t EDBFile::block_size() const {
@@ -209,30 +331,154 @@ uint8_t const* EDBFile::heap_ptr_to_mapped_ptr(HeapPtr ptr) const {
     return reinterpret_cast<uint8_t const*>(m_mapped_file.data().data() + block_offset(ptr.block) + ptr.offset);
 }
 
+void EDBFile::mark_dirty(uint8_t const* mapped_ptr, size_t size) {
+    size_t begin = mapped_ptr - m_mapped_file.data().data();
+    size_t end = begin + size;
+    // Merge with ranges that overlap or are close enough.
+    auto it = m_dirty_ranges.upper_bound(begin);
+    if (it != m_dirty_ranges.begin() && std::prev(it)->second + DirtyRangeGap >= begin) {
+        it--;
+    }
+    while (it != m_dirty_ranges.end() && it->first <= end + DirtyRangeGap) {
+        begin = std::min(begin, it->first);
+        end = std::max(end, it->second);
+        it = m_dirty_ranges.erase(it);
+    }
+    m_dirty_ranges.emplace_hint(it, begin, end);
+}
+
+Util::OsErrorOr<void> EDBFile::commit() {
+    // Files of older versions are only read to be upgraded.
+    if (m_header_struct_size != sizeof(EDBHeader)) {
+        return {};
+    }
+    flush_header();
+    if (m_shrunk) {
+        if (m_log) {
+            m_log->log_truncate(m_log_name, m_file_size);
+            m_logged = true;
+        }
+        else {
+            TRY(ftruncate(m_file.fd(), m_file_size));
+        }
+        m_shrunk = false;
+    }
+    for (auto [begin, end] : m_dirty_ranges) {
+        // Range may be truncated since it was changed.
+        if (begin >= m_file_size) {
+            break;
+        }
+        auto data = m_mapped_file.data().subspan(begin, std::min(end, m_file_size) - begin);
+        if (m_log) {
+            m_log->log_write(m_log_name, begin, data);
+            m_logged = true;
+        }
+        else if (::pwrite(m_file.fd(), data.data(), data.size(), begin) != static_cast<ssize_t>(data.size())) {
+            return Util::OsError { .error = errno, .function = "EDBFile: pwrite" };
+        }
+    }
+    if (!m_log && !m_dirty_ranges.empty() && ::fdatasync(m_file.fd()) < 0) {
+        return Util::OsError { .error = errno, .function = "EDBFile: fdatasync" };
+    }
+    m_dirty_ranges.clear();
+    return {};
+}
+
+Util::OsErrorOr<void> EDBFile::reload() {
+    if (!m_logged) {
+        return {};
+    }
+    TRY(m_mapped_file.reload());
+    m_logged = false;
+    return {};
+}
+
+Util::OsErrorOr<void> EDBFile::rollback() {
+    m_dirty_ranges.clear();
+    m_shrunk = false;
+    struct stat stat;
+    if (::fstat(m_file.fd(), &stat) < 0) {
+        return Util::OsError { .error = errno, .function = "EDBFile: rollback: stat" };
+    }
+    // The file may have been expanded or shrunk since the last commit.
+    TRY(m_mapped_file.remap(stat.st_size));
+    TRY(m_mapped_file.reload());
+    m_logged = false;
+    m_columns.clear();
+    return read_header();
+}
+
+// File grows by as many blocks as it already has, but by at most this many
+// bytes at once.
+constexpr size_t MaxFileGrowth = 64 * 1024 * 1024;
+
 Util::OsErrorOr<void> EDBFile::expand(size_t blocks) {
-    TRY(ftruncate(m_file.fd(), m_file_size + blocks * block_size()));
-    m_file_size += blocks * block_size();
+    size_t needed_blocks = m_block_count - 1 + blocks;
+    if (needed_blocks > allocated_block_count()) {
+        auto growth = std::clamp<size_t>(allocated_block_count(), 1, std::max<size_t>(MaxFileGrowth / block_size(), 1));
+        auto new_file_size = header_size() + std::max(needed_blocks, allocated_block_count() + growth) * block_size();
+        if (auto error = posix_fallocate(m_file.fd(), m_file_size, new_file_size - m_file_size); error != 0) {
+            return Util::OsError { .error = error, .function = "posix_fallocate" };
+        }
+        m_file_size = new_file_size;
+        // fmt::print("Remap to size={} block_size={}\n", m_file_size, block_size());
+        TRY(m_mapped_file.remap(m_file_size));
+    }
     m_block_count += blocks;
-    // fmt::print("Remap to size={} block_size={}\n", m_file_size, block_size());
+    m_header.block_count = m_block_count - 1;
+    return {};
+}
+
+Util::OsErrorOr<void> EDBFile::shrink(size_t blocks) {
+    m_block_count -= blocks;
+    m_header.block_count = m_block_count - 1;
+    // Space reserved for growth is given back too.
+    auto new_file_size = block_offset(m_block_count);
+    if (new_file_size == m_file_size) {
+        return {};
+    }
+    m_file_size = new_file_size;
     TRY(m_mapped_file.remap(m_file_size));
+    m_shrunk = true;
     return {};
 }
 
+std::pair<BlockIndex, BlockIndex> EDBFile::unlink_block(BlockIndex index) {
+    BlockIndex prev = 0;
+    BlockIndex next = 0;
+    {
+        auto block = access<Block>({ index, 0 });
+        prev = block->prev_block;
+        next = block->next_block;
+        block->prev_block = 0;
+        block->next_block = 0;
+    }
+    if (prev != 0) {
+        access<Block>({ prev, 0 })->next_block = next;
+    }
+    if (next != 0) {
+        access<Block>({ next, 0 })->prev_block = prev;
+    }
+    return { prev, next };
+}
+
 Util::OsErrorOr<BlockIndex> EDBFile::allocate_block(BlockType block_type) {
     // fmt::print("!!!!! allocate block\n");
 
-    BlockIndex allocated_block = 0;
-    for (BlockIndex s = 1; s < m_block_count; s++) {
-        // fmt::print("Checking block: {}\n", s);
-        auto block = access<Block>({ s, 0 });
-        if (block->type == BlockType::Free) {
-            allocated_block = s;
-            break;
-        }
+    BlockIndex allocated_block = m_header.first_free_block;
+    if (allocated_block != 0) {
+        m_header.first_free_block = unlink_block(allocated_block).second;
     }
-    // fmt::print("!!! expand {}\n", m_block_count);
-    TRY(expand(1));
-    allocated_block = m_block_count - 1;
+    else {
+        // fmt::print("!!! expand {}\n", m_block_count);
+        TRY(expand(1));
+        allocated_block = m_block_count - 1;
+    }
+    // Make it look like a newly added one. Even added blocks may contain
+    // some data if the file was shrunk, but not truncated yet.
+    auto block_ptr = heap_ptr_to_mapped_ptr({ allocated_block, 0 });
+    std::fill_n(block_ptr, block_size(), 0);
+    mark_dirty(block_ptr, block_size());
 
     auto block = access<Block>({ allocated_block, 0 }, block_size());
     block->type = block_type;
@@ -269,6 +515,7 @@ Util::OsErrorOr<BlockIndex> EDBFile::allocate_block(BlockType block_type) {
         break;
     }
     case BlockType::Big:
+    case BlockType::Index:
         break;
     }
 
@@ -277,6 +524,133 @@ Util::OsErrorOr<BlockIndex> EDBFile::allocate_block(BlockType block_type) {
     return allocated_block;
 }
 
+void EDBFile::initialize_table_block(BlockIndex index) {
+    auto row_size = sizeof(Table::RowSpec) + this->row_size();
+    auto rows = (block_size() - sizeof(Block) - sizeof(Table::TableBlock)) / row_size;
+    HeapPtr first_row { index, sizeof(Block) + sizeof(Table::TableBlock) };
+    for (size_t s = 0; s < rows; s++) {
+        auto row = access<Table::RowSpec>({ index, static_cast<uint32_t>(first_row.offset + s * row_size) });
+        row->is_used = 0;
+        row->next_row = s + 1 < rows ? HeapPtr { index, static_cast<uint32_t>(first_row.offset + (s + 1) * row_size) } : HeapPtr {};
+    }
+    {
+        auto table_block = access<Table::TableBlock>({ index, sizeof(Block) });
+        table_block->rows_in_block = 0;
+        table_block->first_free_row = first_row;
+    }
+    link_free_table_block(index);
+}
+
+void EDBFile::link_free_table_block(BlockIndex index) {
+    BlockIndex next = m_header.first_free_table_block;
+    {
+        auto table_block = access<Table::TableBlock>({ index, sizeof(Block) });
+        table_block->prev_free_block = 0;
+        table_block->next_free_block = next;
+    }
+    if (next != 0) {
+        access<Table::TableBlock>({ next, sizeof(Block) })->prev_free_block = index;
+    }
+    m_header.first_free_table_block = index;
+}
+
+void EDBFile::unlink_free_table_block(BlockIndex index) {
+    BlockIndex prev = 0;
+    BlockIndex next = 0;
+    {
+        auto table_block = access<Table::TableBlock>({ index, sizeof(Block) });
+        prev = table_block->prev_free_block;
+        next = table_block->next_free_block;
+        table_block->prev_free_block = 0;
+        table_block->next_free_block = 0;
+    }
+    if (prev != 0) {
+        access<Table::TableBlock>({ prev, sizeof(Block) })->next_free_block = next;
+    }
+    else {
+        m_header.first_free_table_block = next;
+    }
+    if (next != 0) {
+        access<Table::TableBlock>({ next, sizeof(Block) })->prev_free_block = prev;
+    }
+}
+
+HeapPtr EDBFile::take_unused_row(BlockIndex block) {
+    HeapPtr row;
+    bool block_is_full = false;
+    {
+        auto table_block = access<Table::TableBlock>({ block, sizeof(Block) });
+        row = table_block->first_free_row;
+        table_block->first_free_row = read<Table::RowSpec>(row).next_row;
+        table_block->rows_in_block++;
+        block_is_full = table_block->first_free_row.is_null();
+    }
+    if (block_is_full) {
+        unlink_free_table_block(block);
+    }
+    return row;
+}
+
+bool EDBFile::release_row(HeapPtr row) {
+    bool block_was_full = false;
+    bool block_is_empty = false;
+    {
+        auto table_block = access<Table::TableBlock>({ row.block, sizeof(Block) });
+        block_was_full = table_block->first_free_row.is_null();
+        {
+            auto row_spec = access<Table::RowSpec>(row);
+            row_spec->is_used = 0;
+            row_spec->next_row = table_block->first_free_row;
+        }
+        table_block->first_free_row = row;
+        table_block->rows_in_block--;
+        block_is_empty = table_block->rows_in_block == 0;
+    }
+    if (block_was_full) {
+        link_free_table_block(row.block);
+    }
+    return block_is_empty;
+}
+
+void EDBFile::free_block(BlockIndex index) {
+    auto type = read<Block>({ index, 0 }).type;
+    switch (type) {
+    case BlockType::Table: {
+        // Empty blocks always have unused rows.
+        unlink_free_table_block(index);
+        auto [prev, next] = unlink_block(index);
+        if (next == 0) {
+            m_header.last_table_block = prev;
+        }
+        break;
+    }
+    case BlockType::Heap: {
+        auto [prev, next] = unlink_block(index);
+        if (next == 0) {
+            m_header.last_heap_block = prev;
+        }
+        break;
+    }
+    case BlockType::Free:
+        return;
+    case BlockType::Big:
+    case BlockType::Index:
+        break;
+    }
+
+    BlockIndex next = m_header.first_free_block;
+    {
+        auto block = access<Block>({ index, 0 });
+        block->type = BlockType::Free;
+        block->prev_block = 0;
+        block->next_block = next;
+    }
+    if (next != 0) {
+        access<Block>({ next, 0 })->prev_block = index;
+    }
+    m_header.first_free_block = index;
+}
+
 Util::OsErrorOr<void> EDBFile::write_header_first_pass(Db::Core::TableSetup const& setup) {
     uint32_t block_size = 0;
     block_size += sizeof(Table::RowSpec);
@@ -294,6 +668,9 @@ Util::OsErrorOr<void> EDBFile::write_header_first_pass(Db::Core::TableSetup cons
     // fmt::print("Block size: {}\n", block_size);
     m_header.last_table_block = 0;
     m_header.last_heap_block = 0;
+    m_header.first_free_table_block = 0;
+    m_header.first_free_block = 0;
+    m_header.block_count = 0;
     m_header.column_count = setup.columns.size();
     m_file_size = header_size();
     return {};
@@ -317,14 +694,17 @@ Util::OsErrorOr<void> EDBFile::write_header(Db::Core::TableSetup const& setup) {
         .last_row_ptr = { 0, 0 },
         .last_table_block = 1,
         .last_heap_block = 2,
+        .first_free_table_block = 0,
+        .first_free_block = 0,
+        .block_count = m_block_count - 1,
         .table_name = table_name.heap_span,
         .check_statement = {},           // TODO
         .auto_increment_value_count = 0, // TODO
-        .key_count = 0,                  // TODO
+        .key_count = 0,
+        .keys = {},
     };
 
-    auto stream = Util::WritableFileStream::borrow_fd(m_file.fd());
-    TRY(stream.seek(0, Util::SeekDirection::FromStart));
+    Util::WritableMemoryStream stream;
     Util::Writer writer { stream };
     std::copy(std::begin(Magic), std::end(Magic), header.magic);
     TRY(writer.write_struct(header));
@@ -336,6 +716,10 @@ Util::OsErrorOr<void> EDBFile::write_header(Db::Core::TableSetup const& setup) {
     // TODO: AI
     // TODO: Keys
 
+    // Note: Writing columns may remap the file.
+    auto mapped_ptr = m_mapped_file.data().data();
+    std::copy(stream.data().begin(), stream.data().end(), mapped_ptr);
+    mark_dirty(mapped_ptr, stream.data().size());
     return {};
 }
 
@@ -346,11 +730,16 @@ Util::OsErrorOr<void> EDBFile::read_header() {
     }
     m_file_size = stat.st_size;
 
-    auto stream = Util::ReadableFileStream::borrow_fd(m_file.fd());
-    TRY(stream.seek(0, Util::SeekDirection::FromStart));
+    Util::ReadableMemoryStream stream { m_mapped_file.data() };
     Util::BinaryReader reader { stream };
     m_header = TRY(reader.read_struct<EDB::EDBHeader>());
-    m_block_count = (m_file_size - header_size()) / block_size() + 1;
+    if (m_header.version != CurrentVersion) {
+        return unsupported_version(m_header.version);
+    }
+    m_block_count = m_header.block_count + 1;
+    if (block_offset(m_block_count) > m_file_size) {
+        return Util::OsError { .error = 0, .function = "Corruption: EDBFile: File is smaller than its blocks" };
+    }
 
     for (size_t s = 0; s < m_header.column_count; s++) {
         m_columns.push_back(TRY(reader.read_struct<Column>()));
@@ -359,66 +748,64 @@ Util::OsErrorOr<void> EDBFile::read_header() {
     return {};
 }
 
-Util::OsErrorOr<void> EDBFile::flush_header() {
-    auto stream = Util::WritableFileStream::borrow_fd(m_file.fd());
-    TRY(stream.seek(0, Util::SeekDirection::FromStart));
-    TRY(Util::Writer { stream }.write_struct(m_header));
+Util::OsErrorOr<void> EDBFile::read_header_version_1() {
+    Util::ReadableMemoryStream stream { m_mapped_file.data() };
+    Util::BinaryReader reader { stream };
+    auto header = TRY(reader.read_struct<EDBHeaderV1>());
+    m_header_struct_size = sizeof(EDBHeaderV1);
+    m_header = {};
+    m_header.version = header.version;
+    m_header.block_size = header.block_size;
+    m_header.row_count = header.row_count;
+    m_header.column_count = header.column_count;
+    m_header.first_row_ptr = header.first_row_ptr;
+    m_header.last_row_ptr = header.last_row_ptr;
+    m_header.table_name = header.table_name;
+
+    m_file_size = m_mapped_file.data().size();
+    m_block_count = (m_file_size - header_size()) / block_size() + 1;
+    for (size_t s = 0; s < m_header.column_count; s++) {
+        m_columns.push_back(TRY(reader.read_struct<Column>()));
+    }
     return {};
 }
 
+void EDBFile::flush_header() {
+    auto mapped_ptr = m_mapped_file.data().data();
+    auto header = reinterpret_cast<uint8_t const*>(&m_header);
+    if (!std::equal(header, header + sizeof(EDBHeader), mapped_ptr)) {
+        std::copy(header, header + sizeof(EDBHeader), mapped_ptr);
+        mark_dirty(mapped_ptr, sizeof(EDBHeader));
+    }
+}
+
 Util::OsErrorOr<void> EDBFile::rename(std::string const& new_name) {
     TRY(heap_free(m_header.table_name.offset));
     m_header.table_name = TRY(copy_to_heap(new_name));
     return {};
 }
 
-Util::OsErrorOr<void> EDBFile::insert(Core::Tuple const& tuple) {
+Util::OsErrorOr<HeapPtr> EDBFile::insert(Core::Tuple const& tuple) {
     // fmt::print("===== Insert\n");
 
-    // 1. Find free place in Table blocks
-    std::optional<HeapPtr> place_for_allocation;
-    if (m_header.last_row_ptr.is_null()) {
-        place_for_allocation = { 1, sizeof(Block) + sizeof(Table::TableBlock) };
-    }
-    else {
-        HeapPtr last_row_ptr = { 1, sizeof(Block) + sizeof(Table::TableBlock) };
-        while (true) {
-            if (last_row_ptr.offset + sizeof(Table::RowSpec) + row_size() > block_size()) {
-                // TODO: Skip blocks that are full (rows_in_block == 255)
-                last_row_ptr.block = last_row_ptr.block + 1;
-                last_row_ptr.offset = sizeof(Block) + sizeof(Table::TableBlock);
-                if (last_row_ptr.block >= m_block_count) {
-                    fmt::print("no free block :(\n");
-                    break;
-                }
-            }
-            // fmt::print("Last row: {}:{}\n", last_row_ptr.block, last_row_ptr.offset);
-            auto row = access<Table::RowSpec>(last_row_ptr);
-            if (!row->is_used) {
-                place_for_allocation = last_row_ptr;
-                break;
-            }
-            last_row_ptr = { last_row_ptr.block, last_row_ptr.offset + sizeof(Table::RowSpec) + row_size() };
-        }
-    }
+    // 1. Serialize row
+    Util::WritableMemoryStream stream;
+    Util::Writer writer { stream };
+    // Note: This invalidates all Accesses.
+    TRY(Serializer::write_row(*this, writer, m_columns, tuple));
 
-    if (!place_for_allocation) {
-        // 2. If there is no free place, allocate new block
-        fmt::print("will need to allocate block\n");
-        auto block = TRY(allocate_block(BlockType::Table));
-        place_for_allocation = HeapPtr { block, sizeof(Block) + sizeof(Table::TableBlock) };
+    // 2. Take first unused row of first block that has any, or allocate
+    //    new block if all are full.
+    if (m_header.first_free_table_block == 0) {
+        initialize_table_block(TRY(allocate_block(BlockType::Table)));
     }
+    auto place_for_allocation = take_unused_row(m_header.first_free_table_block);
 
-    // fmt::print("Place for allocation: {}:{}\n", place_for_allocation->block, place_for_allocation->offset);
+    // fmt::print("Place for allocation: {}:{}\n", place_for_allocation.block, place_for_allocation.offset);
 
     // 3. Actually write row
     {
-        Util::WritableMemoryStream stream;
-        Util::Writer writer { stream };
-        // Note: This invalidates all Accesses.
-        TRY(Serializer::write_row(*this, writer, m_columns, tuple));
-
-        auto row = access<Table::RowSpec>(*place_for_allocation, sizeof(Table::RowSpec) + row_size());
+        auto row = access<Table::RowSpec>(place_for_allocation, sizeof(Table::RowSpec) + row_size());
         row->is_used = 1;
         row->next_row = {};
         std::copy(stream.data().begin(), stream.data().end(), row->row);
@@ -427,52 +814,135 @@ Util::OsErrorOr<void> EDBFile::insert(Core::Tuple const& tuple) {
     // 4. Point last row or header into the newly placed row.
     if (!m_header.last_row_ptr.is_null()) {
         auto last_row = access<Table::RowSpec>(m_header.last_row_ptr);
-        last_row->next_row = *place_for_allocation;
+        last_row->next_row = place_for_allocation;
     }
     else {
-        m_header.first_row_ptr = *place_for_allocation;
+        m_header.first_row_ptr = place_for_allocation;
     }
 
-    // 5. Update headers (EDB: last row, row count; block: rows in block)
-    m_header.last_row_ptr = *place_for_allocation;
+    // 5. Update header (last row, row count)
+    m_header.last_row_ptr = place_for_allocation;
     m_header.row_count = m_header.row_count + 1;
-    access<Table::TableBlock>({ place_for_allocation->block, sizeof(Block) })->rows_in_block++;
-    TRY(flush_header());
-    return {};
+    return place_for_allocation;
 }
 
 Util::OsErrorOr<void> EDBFile::remove(HeapPtr row, HeapPtr prev_row) {
-    // 1. Mark row as unused
-    auto current = access<Table::RowSpec>(row, row_size() + sizeof(Table::RowSpec));
-    current->is_used = false;
-    // fmt::print("remove before {}..{}..{}\n", prev_row, row, current->next_row);
-
-    // 2. Heap free data
-    TRY(current->free_data(*this));
+    // 1. Mark row as unused and heap free its data
+    HeapPtr next_row;
+    {
+        auto current = access<Table::RowSpec>(row, row_size() + sizeof(Table::RowSpec));
+        current->is_used = false;
+        next_row = current->next_row;
+        // fmt::print("remove before {}..{}..{}\n", prev_row, row, next_row);
+        TRY(current->free_data(*this));
+    }
 
-    // 3. Point previous row or header to next row
+    // 2. Point previous row or header to next row
     if (!prev_row.is_null()) {
         auto previous = access<Table::RowSpec>(prev_row);
-        previous->next_row = current->next_row;
+        previous->next_row = next_row;
     }
     else {
-        m_header.first_row_ptr = current->next_row;
+        m_header.first_row_ptr = next_row;
     }
 
-    // 4. Update block row count
-    access<Table::TableBlock>({ row.block, sizeof(Block) })->rows_in_block--;
-
-    // FIXME: 5. Free block if needed
+    // 3. Add row to unused rows of its block
+    auto block_is_empty = release_row(row);
+
+    // 4. Free block if it's empty, unless it's the only one with unused
+    //    rows, so that removing and inserting a single row doesn't free
+    //    and allocate a block every time.
+    if (block_is_empty) {
+        bool is_only_free_block = m_header.first_free_table_block == row.block
+            && read<Table::TableBlock>({ row.block, sizeof(Block) }).next_free_block == 0;
+        if (!is_only_free_block) {
+            free_block(row.block);
+        }
+    }
 
-    // 6. Update main header (last block, row count)
-    if (current->next_row.is_null()) {
+    // 5. Update main header (last block, row count)
+    if (next_row.is_null()) {
         m_header.last_row_ptr = prev_row;
     }
     m_header.row_count = m_header.row_count - 1;
-    TRY(flush_header());
     return {};
 }
 
+Util::OsErrorOr<void> EDBFile::vacuum() {
+    // 1. Find Table blocks with lowest indices that are enough for all rows.
+    std::vector<BlockIndex> table_blocks;
+    for (BlockIndex block = m_header.last_table_block; block != 0; block = read<Block>({ block, 0 }).prev_block) {
+        table_blocks.push_back(block);
+    }
+    std::sort(table_blocks.begin(), table_blocks.end());
+    auto rows_per_block = (block_size() - sizeof(Block) - sizeof(Table::TableBlock)) / (sizeof(Table::RowSpec) + row_size());
+    size_t kept_blocks = (m_header.row_count + rows_per_block - 1) / rows_per_block;
+    BlockIndex last_kept_block = kept_blocks == 0 ? 0 : table_blocks[kept_blocks - 1];
+
+    // 2. Move rows from all other blocks to unused rows of these. Moved
+    //    rows take place of the original ones in the list, so that the
+    //    order of rows doesn't change.
+    size_t target_block = 0;
+    HeapPtr prev_row;
+    for (HeapPtr row = m_header.first_row_ptr; !row.is_null();) {
+        HeapPtr next_row = read<Table::RowSpec>(row).next_row;
+        if (row.block > last_kept_block) {
+            while (read<Table::TableBlock>({ table_blocks[target_block], sizeof(Block) }).first_free_row.is_null()) {
+                target_block++;
+            }
+            auto new_row = take_unused_row(table_blocks[target_block]);
+            std::copy_n(heap_ptr_to_mapped_ptr(row), sizeof(Table::RowSpec) + row_size(), heap_ptr_to_mapped_ptr(new_row));
+            mark_dirty(heap_ptr_to_mapped_ptr(new_row), sizeof(Table::RowSpec) + row_size());
+            if (!prev_row.is_null()) {
+                access<Table::RowSpec>(prev_row)->next_row = new_row;
+            }
+            else {
+                m_header.first_row_ptr = new_row;
+            }
+            if (next_row.is_null()) {
+                m_header.last_row_ptr = new_row;
+            }
+            release_row(row);
+            row = new_row;
+        }
+        prev_row = row;
+        row = next_row;
+    }
+
+    // 3. Free blocks that are now empty.
+    for (size_t s = kept_blocks; s < table_blocks.size(); s++) {
+        free_block(table_blocks[s]);
+    }
+
+    // 4. Give Free blocks at the end of file back to the system. Heap
+    //    and Index blocks are referenced by pointers from many places,
+    //    so they are never moved and stop the truncation.
+    size_t blocks_to_truncate = 0;
+    while (true) {
+        BlockIndex block = m_block_count - 1 - blocks_to_truncate;
+        if (block == 0 || read<Block>({ block, 0 }).type != BlockType::Free) {
+            break;
+        }
+        auto [prev, next] = unlink_block(block);
+        if (prev == 0) {
+            m_header.first_free_block = next;
+        }
+        blocks_to_truncate++;
+    }
+    TRY(shrink(blocks_to_truncate));
+    return {};
+}
+
+Util::OsErrorOr<Core::Tuple> EDBFile::read_row(HeapPtr ptr) {
+    auto row = read<Table::RowSpec>(ptr, sizeof(Table::RowSpec) + row_size());
+    if (!row->is_used) {
+        return Util::OsError { 0, "EDBFile: Reading freed row" };
+    }
+    Util::ReadableMemoryStream stream { { row->row, row_size() } };
+    Util::BinaryReader reader { stream };
+    return Serializer::read_row(*this, reader, m_columns);
+}
+
 size_t EDBFile::row_size() const {
     size_t size = 0;
     for (auto const& column : m_columns) {
@@ -499,6 +969,33 @@ Util::OsErrorOr<std::vector<Core::Column>> EDBFile::read_columns() const {
     return columns;
 }
 
+std::vector<Key> EDBFile::read_keys() const {
+    if (m_header.key_count == 0) {
+        return {};
+    }
+    std::vector<Key> keys(m_header.key_count);
+    auto ptr = heap_ptr_to_mapped_ptr(m_header.keys.offset);
+    std::copy(ptr, ptr + m_header.key_count * sizeof(Key), reinterpret_cast<uint8_t*>(keys.data()));
+    return keys;
+}
+
+Util::OsErrorOr<void> EDBFile::write_keys(std::vector<Key> const& keys) {
+    if (keys.size() > 255) {
+        return Util::OsError { .error = 0, .function = "Keys > 255 not supported" };
+    }
+    if (!m_header.keys.offset.is_null()) {
+        TRY(heap_free(m_header.keys.offset));
+        m_header.keys = {};
+    }
+    if (!keys.empty()) {
+        auto span = TRY(heap_allocate_and_get_span(keys.size() * sizeof(Key)));
+        std::copy(reinterpret_cast<uint8_t const*>(keys.data()), reinterpret_cast<uint8_t const*>(keys.data() + keys.size()), span.mapped_span.begin());
+        m_header.keys = span.heap_span;
+    }
+    m_header.key_count = keys.size();
+    return {};
+}
+
 Core::Value EDBFile::read_edb_value(Core::Value::Type type, Value const& value) const {
     switch (type) {
     case Core::Value::Type::Null:
@@ -10,11 +10,19 @@
 #include <db/storage/edb/Definitions.hpp>
 #include <db/storage/edb/Heap.hpp>
 #include <db/storage/edb/MappedFile.hpp>
+#include <map>
 #include <memory>
 #include <utility>
 
 namespace Db::Storage::EDB {
 
+class WriteAheadLog;
+
+// Changes are tracked as ranges of bytes, which are written to the log when
+// they are committed. Every range is logged with a header of about this
+// size, so ranges that are closer than this are merged.
+constexpr size_t DirtyRangeGap = 32;
+
 class EDBFile {
 public:
     EDBFile(EDBFile const&) = delete;
@@ -23,17 +31,46 @@ public:
     static Util::OsErrorOr<std::unique_ptr<EDBFile>> initialize(Util::File, Db::Core::TableSetup);
     static Util::OsErrorOr<std::unique_ptr<EDBFile>> open(Util::File);
 
+    // Rewrite the file at `path` in the current format if it has an older
+    // version. Files of the current version are left unchanged.
+    static Util::OsErrorOr<void> upgrade(std::string const& path);
+
     Util::OsErrorOr<void> rename(std::string const& new_name);
-    Util::OsErrorOr<void> insert(Core::Tuple const& tuple);
+    // Returns pointer to the newly inserted row.
+    Util::OsErrorOr<HeapPtr> insert(Core::Tuple const& tuple);
     Util::OsErrorOr<void> remove(HeapPtr row, HeapPtr prev_row);
+    // Move rows to free space at the beginning of file and truncate free
+    // blocks at its end. This invalidates pointers to moved rows.
+    // Heap and Index blocks are not moved, so the file is truncated only
+    // up to the last of them that is in use.
+    Util::OsErrorOr<void> vacuum();
+    Util::OsErrorOr<Core::Tuple> read_row(HeapPtr row);
+
+    // Log changes since the last commit, or write them (durably) directly
+    // to the file if it's not attached to a log.
+    Util::OsErrorOr<void> commit();
+
+    // Read the file again, after its changes were checkpointed. Files that
+    // didn't log any changes since they were read are kept.
+    Util::OsErrorOr<void> reload();
+
+    // Discard changes since the last commit and read the file again. The
+    // log must be checkpointed first, so that the file contains all
+    // committed changes.
+    Util::OsErrorOr<void> rollback();
 
     Util::OsErrorOr<std::vector<Core::Column>> read_columns() const;
+
+    std::vector<Key> read_keys() const;
+    Util::OsErrorOr<void> write_keys(std::vector<Key> const&);
     auto const& header() const { return m_header; }
     auto const& raw_columns() const { return m_columns; }
 
     size_t block_size() const;
     size_t row_size() const;
 
+    // Accesses mark pages as changed, so they should be used only for
+    // writing. Use read() if the object isn't changed.
     template<class T>
     AlignedAccess<T> access(HeapPtr ptr) {
         assert(!ptr.is_null());
@@ -41,6 +78,7 @@ public:
         auto mapped_ptr = heap_ptr_to_mapped_ptr(ptr);
         // fmt::print(":: access: {}:{} +{} = {:x}\n", ptr.block, ptr.offset, sizeof(T), mapped_ptr - m_mapped_file.data().data());
         assert(mapped_ptr + sizeof(T) <= m_mapped_file.data().end().base());
+        mark_dirty(mapped_ptr, sizeof(T));
         return AlignedAccess<T> { mapped_ptr };
     }
 
@@ -52,11 +90,36 @@ public:
         // fmt::print(":: allocating access: {}:{} +{} = {:x}\n", ptr.block, ptr.offset, size, mapped_ptr - m_mapped_file.data().data());
         // fmt::print("   address range: {}..{}\n", fmt::ptr(mapped_ptr), fmt::ptr(mapped_ptr + size));
         assert(mapped_ptr + size <= m_mapped_file.data().end().base());
+        mark_dirty(mapped_ptr, size);
         return AllocatingAlignedAccess<T> { mapped_ptr, size };
     }
 
+    // Read-only accesses. They may be used by multiple threads at once.
+    template<class T>
+    T read(HeapPtr ptr) const {
+        assert(!ptr.is_null());
+        assert(ptr.offset + sizeof(T) <= block_size());
+        T object;
+        std::copy_n(heap_ptr_to_mapped_ptr(ptr), sizeof(T), reinterpret_cast<uint8_t*>(&object));
+        return object;
+    }
+
+    template<class T>
+    AllocatingAlignedAccess<T> read(HeapPtr ptr, size_t size) const {
+        assert(!ptr.is_null());
+        assert(ptr.offset + size <= block_size());
+        AllocatingAlignedAccess<T> access { const_cast<uint8_t*>(heap_ptr_to_mapped_ptr(ptr)), size };
+        access.discard();
+        return access;
+    }
+
     Util::Buffer read_heap(HeapSpan) const;
 
+    // Copy `data` to `ptr`, but mark only bytes that are different as
+    // changed. Used to write back objects that were changed in a copy
+    // made by read(), so that only their changes are logged.
+    void write_changes(HeapPtr ptr, std::span<uint8_t const> data);
+
     void dump_blocks();
     void dump();
 
@@ -75,13 +138,15 @@ public:
 
     Util::OsErrorOr<HeapAllocationResult> heap_allocate_and_get_span(size_t size) {
         auto span = TRY(heap_allocate(size));
-        return HeapAllocationResult { span, { heap_ptr_to_mapped_ptr(span.offset), span.size } };
+        auto mapped_ptr = heap_ptr_to_mapped_ptr(span.offset);
+        mark_dirty(mapped_ptr, span.size);
+        return HeapAllocationResult { span, { mapped_ptr, span.size } };
     }
 
     template<class T>
     Util::OsErrorOr<AllocatingAlignedAccess<T>> heap_allocate(size_t size) {
         auto addr = TRY(heap_allocate(size));
-        return AllocatingAlignedAccess<T> { heap_ptr_to_mapped_ptr(addr.offset), addr.size };
+        return access<T>(addr.offset, addr.size);
     }
 
     Util::OsErrorOr<void> heap_free(HeapPtr);
@@ -89,12 +154,20 @@ public:
     Core::Value read_edb_value(Core::Value::Type, Value const&) const;
     Util::OsErrorOr<Value> write_edb_value(Core::Value const&);
 
-    // Find first free block or expand file if it is not possible (Max O(n))
+    // Take first free block or expand file if there are none.
     Util::OsErrorOr<BlockIndex> allocate_block(BlockType);
 
+    // Remove block from list of its type and add it to free blocks, so
+    // that it can be reused by allocate_block().
+    void free_block(BlockIndex);
+
 private:
+    friend class WriteAheadLog;
+
     EDBFile(Util::File, MappedFile);
 
+    void mark_dirty(uint8_t const* mapped_ptr, size_t size);
+
     uint8_t* heap_ptr_to_mapped_ptr(HeapPtr);
     uint8_t const* heap_ptr_to_mapped_ptr(HeapPtr) const;
 
@@ -103,25 +176,66 @@ private:
 
     Util::OsErrorOr<void> read_header();
 
+    // Read header of a version 1 file. Only reading rows and columns is
+    // supported then.
+    Util::OsErrorOr<void> read_header_version_1();
+
     // Write enough header to make allocate_block() work.
     Util::OsErrorOr<void> write_header_first_pass(Db::Core::TableSetup const&);
 
     Util::OsErrorOr<void> write_header(Db::Core::TableSetup const&);
-    Util::OsErrorOr<void> flush_header();
 
-    // Add `blocks` blocks to file without initializing them.
+    // Copy header to the mapped file if it was changed.
+    void flush_header();
+
+    // Add `blocks` blocks to file without initializing them. The file is
+    // grown geometrically, so that it's rarely resized and remapped.
     Util::OsErrorOr<void> expand(size_t blocks);
 
-    size_t block_count() const { return (m_file_size - header_size()) / block_size(); }
+    // Remove `blocks` last blocks. The file is truncated when this is
+    // committed.
+    Util::OsErrorOr<void> shrink(size_t blocks);
+
+    // Mark all rows of a new Table block as unused and add it to blocks
+    // with unused rows.
+    void initialize_table_block(BlockIndex);
+
+    // Add/remove Table block to/from list of blocks with unused rows.
+    void link_free_table_block(BlockIndex);
+    void unlink_free_table_block(BlockIndex);
+
+    // Take first unused row of a block that has any.
+    HeapPtr take_unused_row(BlockIndex);
+
+    // Add row to unused rows of its block. Returns true if the block is
+    // now empty.
+    bool release_row(HeapPtr);
+
+    // Point neighbours of a block in its list to each other. Returns
+    // previous and next block, so that ends of the list can be updated.
+    std::pair<BlockIndex, BlockIndex> unlink_block(BlockIndex);
+
+    // Blocks that fit in the file. Only the first m_block_count - 1 ones
+    // are used, the rest is reserved for growth.
+    size_t allocated_block_count() const { return (m_file_size - header_size()) / block_size(); }
 
     EDBHeader m_header;
+    // Size of the header struct, which is smaller in older versions.
+    size_t m_header_struct_size = sizeof(EDBHeader);
     std::vector<Column> m_columns;
     Data::Heap m_heap { *this };
     MappedFile m_mapped_file;
     Util::File m_file;
-    std::string m_file_path;
     size_t m_file_size = 0;
     BlockIndex m_block_count = 1;
+
+    WriteAheadLog* m_log = nullptr;
+    std::string m_log_name;
+    // Offsets of beginnings and ends of changed ranges.
+    std::map<size_t, size_t> m_dirty_ranges;
+    bool m_shrunk = false;
+    // Changes were logged, so the mapping holds private copies of pages.
+    bool m_logged = false;
 };
 
 }
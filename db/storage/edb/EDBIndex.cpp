@@ -0,0 +1,51 @@
+#include "EDBIndex.hpp"
+
+#include <db/storage/edb/EDBRelationIterator.hpp>
+
+namespace Db::Storage::EDB {
+
+Core::DbErrorOr<void> EDBIndex::insert(Core::Tuple const& key, Core::RowId row) {
+    return m_tree.insert(key, row_id_to_heap_ptr(row)).map_error(os_to_db_error);
+}
+
+Core::DbErrorOr<void> EDBIndex::remove(Core::Tuple const& key, Core::RowId row) {
+    return m_tree.remove(key, row_id_to_heap_ptr(row)).map_error(os_to_db_error);
+}
+
+Core::DbErrorOr<void> EDBIndex::clear() {
+    return m_tree.clear().map_error(os_to_db_error);
+}
+
+Core::DbErrorOr<void> EDBIndex::destroy() {
+    return m_tree.destroy().map_error(os_to_db_error);
+}
+
+bool EDBIndex::contains(Core::Tuple const& key) const {
+    return find_first(key).has_value();
+}
+
+std::optional<Core::RowId> EDBIndex::find_first(Core::Tuple const& key) const {
+    std::optional<Core::RowId> result;
+    Bound bound { key, true };
+    m_tree.for_each_in_range(bound, bound, [&](Core::Tuple const&, HeapPtr row) {
+        result = heap_ptr_to_row_id(row);
+        return false;
+    });
+    return result;
+}
+
+std::vector<Core::RowId> EDBIndex::find_all(Core::Tuple const& key) const {
+    Bound bound { key, true };
+    return find_range(bound, bound);
+}
+
+std::vector<Core::RowId> EDBIndex::find_range(std::optional<Bound> const& lower, std::optional<Bound> const& upper) const {
+    std::vector<Core::RowId> rows;
+    m_tree.for_each_in_range(lower, upper, [&](Core::Tuple const&, HeapPtr row) {
+        rows.push_back(heap_ptr_to_row_id(row));
+        return true;
+    });
+    return rows;
+}
+
+}
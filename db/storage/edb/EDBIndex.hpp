@@ -0,0 +1,34 @@
+#pragma once
+
+#include <db/core/Index.hpp>
+#include <db/storage/edb/BTree.hpp>
+
+namespace Db::Storage::EDB {
+
+// Index created by CREATE INDEX, persisted as a B+tree in the EDB file.
+class EDBIndex : public Core::Index {
+public:
+    EDBIndex(EDBFile& file, BlockIndex root, std::vector<Core::Value::Type> key_types, std::string name, std::vector<size_t> columns, bool unique)
+        : Core::Index(std::move(name), std::move(columns), unique, Core::Index::Origin::User)
+        , m_tree(file, root, std::move(key_types)) { }
+
+    BlockIndex root() const { return m_tree.root(); }
+
+    virtual Core::DbErrorOr<void> insert(Core::Tuple const& key, Core::RowId) override;
+    virtual Core::DbErrorOr<void> remove(Core::Tuple const& key, Core::RowId) override;
+    virtual Core::DbErrorOr<void> clear() override;
+    virtual Core::DbErrorOr<void> destroy() override;
+
+    virtual bool contains(Core::Tuple const& key) const override;
+    virtual std::optional<Core::RowId> find_first(Core::Tuple const& key) const override;
+    virtual std::vector<Core::RowId> find_all(Core::Tuple const& key) const override;
+
+    virtual bool is_ordered() const override { return true; }
+    virtual std::vector<Core::RowId> find_range(std::optional<Bound> const& lower, std::optional<Bound> const& upper) const override;
+
+private:
+    // Reading the tree goes through the mapped file, which is not const.
+    mutable BTree m_tree;
+};
+
+}
@@ -3,6 +3,7 @@
 #include <EssaUtil/Config.hpp>
 #include <EssaUtil/Error.hpp>
 #include <EssaUtil/Stream/MemoryStream.hpp>
+#include <db/core/IndexedRelation.hpp>
 #include <db/core/Relation.hpp>
 #include <db/storage/edb/Definitions.hpp>
 #include <db/storage/edb/Serializer.hpp>
@@ -39,14 +40,25 @@ private:
     virtual Core::Tuple read() const override {
         return m_tuple;
     }
-    virtual void write(Core::Tuple const& tuple) override {
+    virtual Core::DbErrorOr<void> write(Core::Tuple const& tuple) override {
+        if (m_iterator.m_relation) {
+            TRY(m_iterator.m_relation->reindex_row(m_tuple, tuple, row_id()));
+        }
         m_tuple = tuple;
         m_should_write = true;
+        return {};
+    }
+    virtual Core::RowId row_id() const override {
+        return heap_ptr_to_row_id(m_row_ptr);
     }
-    virtual void remove() override {
-        file().remove(m_row_ptr, m_prev_row_ptr).release_value_but_fixme_should_propagate_errors();
+    virtual Core::DbErrorOr<void> remove() override {
+        if (m_iterator.m_relation) {
+            TRY(m_iterator.m_relation->unindex_row(m_tuple, row_id()));
+        }
+        TRY(file().remove(m_row_ptr, m_prev_row_ptr).map_error(os_to_db_error));
         m_should_write = false;
         m_iterator.m_prev_row_ptr = m_prev_row_ptr;
+        return {};
     }
     virtual std::unique_ptr<RowReference> clone() const override {
         return std::make_unique<EDBRowReference>(*this);
@@ -60,11 +72,11 @@ private:
 };
 
 Util::OsErrorOr<std::unique_ptr<Core::RowReference>> EDBRelationIteratorImpl::next_impl() {
-    if (m_row_ptr.is_null()) {
+    if (m_row_ptr.is_null() || (!m_end_ptr.is_null() && heap_ptr_to_row_id(m_row_ptr) == heap_ptr_to_row_id(m_end_ptr))) {
         return std::unique_ptr<Core::RowReference> {};
     }
 
-    auto row = m_file.access<Table::RowSpec>(m_row_ptr, m_file.row_size() + sizeof(Table::RowSpec));
+    auto row = m_file.read<Table::RowSpec>(m_row_ptr, m_file.row_size() + sizeof(Table::RowSpec));
     // fmt::print("{}..{}..{}\n", m_prev_row_ptr, m_row_ptr, row->next_row);
     if (!row->is_used) {
         fmt::print("{} is already freed, aborting\n", m_row_ptr);
@@ -76,50 +88,10 @@ Util::OsErrorOr<std::unique_ptr<Core::RowReference>> EDBRelationIteratorImpl::ne
     m_row_ptr = row->next_row;
 
     Util::ReadableMemoryStream stream { { row->row, m_file.row_size() } };
-    Util::BinaryReader writer { stream };
-
-    std::vector<Core::Value> values;
-    for (auto const& column : m_file.raw_columns()) {
-        auto is_null = column.not_null ? false : TRY(writer.read_little_endian<uint8_t>());
-        switch (static_cast<Core::Value::Type>(column.type)) {
-        case Core::Value::Type::Null:
-            ESSA_UNREACHABLE;
-            break;
-        case Core::Value::Type::Int: {
-            auto i = TRY(writer.read_little_endian<uint32_t>());
-            values.push_back(is_null ? Core::Value::null() : Core::Value::create_int(i));
-            break;
-        }
-        case Core::Value::Type::Float: {
-            auto f = TRY(writer.read_little_endian<float>());
-            values.push_back(is_null ? Core::Value::null() : Core::Value::create_float(f));
-            break;
-        }
-        case Core::Value::Type::Varchar: {
-            auto span = TRY(writer.read_struct<HeapSpan>());
-            values.push_back(is_null ? Core::Value::null() : Core::Value::create_varchar(m_file.read_heap(span).decode_infallible().encode()));
-            break;
-        }
-        case Core::Value::Type::Bool: {
-            auto b = TRY(writer.read_little_endian<uint8_t>());
-            values.push_back(is_null ? Core::Value::null() : Core::Value::create_bool(b));
-            break;
-        }
-        case Core::Value::Type::Time: {
-            auto time = TRY(writer.read_struct<Date>());
-            values.push_back(is_null ? Core::Value::null() : Core::Value::create_time(Core::Date { .year = time.year, .month = time.month, .day = time.day }));
-            break;
-        }
-        }
-    }
-
-    // fmt::print("D: ");
-    // for (auto const& v : values) {
-    //     fmt::print("{} ", v.to_debug_string());
-    // }
-    // fmt::print("\n");
+    Util::BinaryReader reader { stream };
+    auto tuple = TRY(Serializer::read_row(m_file, reader, m_file.raw_columns()));
 
-    return std::make_unique<EDBRowReference>(Core::Tuple { values }, m_prev_row_ptr, prev_row_ptr, *this);
+    return std::make_unique<EDBRowReference>(std::move(tuple), m_prev_row_ptr, prev_row_ptr, *this);
 }
 
 }
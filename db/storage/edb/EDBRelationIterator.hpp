@@ -5,12 +5,30 @@
 
 namespace Db::Storage::EDB {
 
+inline Core::RowId heap_ptr_to_row_id(HeapPtr ptr) {
+    return (static_cast<Core::RowId>(ptr.block) << 32) | ptr.offset;
+}
+
+inline HeapPtr row_id_to_heap_ptr(Core::RowId id) {
+    return HeapPtr { static_cast<BlockIndex>(id >> 32), static_cast<uint32_t>(id) };
+}
+
+// If `relation` is given, its indexes are updated on every write and remove.
 class EDBRelationIteratorImpl : public Core::RelationIteratorImpl {
 public:
-    explicit EDBRelationIteratorImpl(EDBFile& file)
+    explicit EDBRelationIteratorImpl(EDBFile& file, Core::IndexedRelation* relation = nullptr)
         : m_file(file)
+        , m_relation(relation)
         , m_row_ptr { file.header().first_row_ptr } { }
 
+    // Reads rows from `begin` up to (but not including) `end`, or up to the
+    // last row if `end` is null. Rows can't be modified.
+    EDBRelationIteratorImpl(EDBFile& file, HeapPtr begin, HeapPtr end)
+        : m_file(file)
+        , m_relation(nullptr)
+        , m_row_ptr { begin }
+        , m_end_ptr { end } { }
+
     virtual std::unique_ptr<Core::RowReference> next() override;
 
 private:
@@ -19,8 +37,10 @@ private:
     Util::OsErrorOr<std::unique_ptr<Core::RowReference>> next_impl();
 
     EDBFile& m_file;
+    Core::IndexedRelation* m_relation;
     HeapPtr m_prev_row_ptr { 0, 0 };
     HeapPtr m_row_ptr;
+    HeapPtr m_end_ptr { 0, 0 };
 };
 
 }
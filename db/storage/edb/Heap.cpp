@@ -121,6 +121,21 @@ Util::OsErrorOr<void> HeapBlock::free(uint32_t offset) {
     return {};
 }
 
+bool HeapBlock::is_empty(EDBFile& file) {
+    uint8_t* header_ptr = m_data;
+    while (header_ptr + sizeof(HeapHeader) <= m_data + data_size(file)) {
+        AlignedAccess<HeapHeader> header { header_ptr };
+        if (header->signature == Signature::Used) {
+            return false;
+        }
+        if (header->signature == Signature::EndEdge) {
+            break;
+        }
+        header_ptr += header->size + sizeof(HeapHeader);
+    }
+    return true;
+}
+
 void HeapBlock::leak_check() {
     fmt::print("TODO: Leak check\n");
 }
@@ -155,7 +170,9 @@ Util::OsErrorOr<HeapPtr> Heap::alloc(size_t size) {
         // Note: First heap block is always 2.
         size_t current_block = 2;
         while (true) {
-            auto block = m_file.access<Block>(HeapPtr { current_block, 0 }, m_file.block_size());
+            // Blocks are only read, so that the ones without enough space
+            // aren't marked as changed.
+            auto block = m_file.read<Block>(HeapPtr { current_block, 0 }, m_file.block_size());
             if (block->type != BlockType::Heap) {
                 return Util::OsError { .error = 0, .function = "Corruption: Found non-heap block in heap block list" };
             }
@@ -163,6 +180,9 @@ Util::OsErrorOr<HeapPtr> Heap::alloc(size_t size) {
             auto& heap_block = reinterpret_cast<HeapBlock&>(block->data);
             auto result = TRY(heap_block.alloc(m_file, size));
             if (result) {
+                // Only headers that were changed by the allocation are
+                // written to the block itself.
+                m_file.write_changes(HeapPtr { current_block, 0 }, { reinterpret_cast<uint8_t const*>(&*block), m_file.block_size() });
                 return HeapPtr { current_block, *result + sizeof(Block) };
             }
             // FIXME: Merge&cleanup here
@@ -188,7 +208,7 @@ Util::OsErrorOr<HeapPtr> Heap::alloc(size_t size) {
 
 void Heap::dump() const {
     fmt::print("----- HEAP DUMP BEGIN -----\n");
-    auto block = m_file.access<HeapBlock>(HeapPtr { 2, sizeof(Block) }, m_file.block_size() - sizeof(Block));
+    auto block = m_file.read<HeapBlock>(HeapPtr { 2, sizeof(Block) }, m_file.block_size() - sizeof(Block));
     block->dump(m_file, 2);
     fmt::print("----- HEAP DUMP END -----\n");
 }
@@ -198,9 +218,17 @@ void Heap::leak_check() const {
 }
 
 Util::OsErrorOr<void> Heap::free(HeapPtr ptr) {
-    auto block = m_file.access<HeapBlock>(HeapPtr { ptr.block, sizeof(Block) }, m_file.block_size() - sizeof(Block));
-    TRY(block->free(ptr.offset - sizeof(Block)));
-    block.flush();
+    bool is_empty = false;
+    {
+        auto block = m_file.read<HeapBlock>(HeapPtr { ptr.block, sizeof(Block) }, m_file.block_size() - sizeof(Block));
+        TRY(block->free(ptr.offset - sizeof(Block)));
+        is_empty = block->is_empty(m_file);
+        m_file.write_changes(HeapPtr { ptr.block, sizeof(Block) }, { reinterpret_cast<uint8_t const*>(&*block), m_file.block_size() - sizeof(Block) });
+    }
+    // First heap block is kept, as it is where allocation starts.
+    if (is_empty && ptr.block != 2) {
+        m_file.free_block(ptr.block);
+    }
     return {};
 }
 
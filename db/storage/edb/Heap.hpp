@@ -41,6 +41,8 @@ public:
     void init(EDBFile&);
     Util::OsErrorOr<std::optional<uint32_t>> alloc(EDBFile&, size_t size);
     Util::OsErrorOr<void> free(uint32_t offset);
+    // True if no memory in the block is allocated.
+    bool is_empty(EDBFile&);
     void leak_check();
     void dump(EDBFile&, BlockIndex);
 
@@ -16,7 +16,7 @@ Util::OsErrorOr<MappedFile> MappedFile::map(int fd, size_t size) {
         return file;
     }
     // fmt::print("size = {}\n", size);
-    auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
     if (ptr == MAP_FAILED) {
         return Util::OsError { .error = errno, .function = "MappedFile::map" };
     }
@@ -26,10 +26,12 @@ Util::OsErrorOr<MappedFile> MappedFile::map(int fd, size_t size) {
 }
 
 Util::OsErrorOr<void> MappedFile::remap(size_t new_size) {
-    msync(m_ptr, m_size, MS_SYNC);
-    munmap(m_ptr, m_size);
     // fmt::print("old size = {} new size = {}\n", m_size, new_size);
-    auto ptr = mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    // Pages stay mapped (with private changes), they are just moved if the
+    // mapping can't be extended in place.
+    auto ptr = m_ptr
+        ? mremap(m_ptr, m_size, new_size, MREMAP_MAYMOVE)
+        : mmap(nullptr, new_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, m_fd, 0);
     if (ptr == MAP_FAILED) {
         return Util::OsError { .error = errno, .function = "MappedFile::remap" };
     }
@@ -41,13 +43,23 @@ Util::OsErrorOr<void> MappedFile::remap(size_t new_size) {
     return {};
 }
 
+Util::OsErrorOr<void> MappedFile::reload() {
+    if (!m_ptr) {
+        return {};
+    }
+    // Mapping the file again at the same address replaces all pages.
+    if (mmap(m_ptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, m_fd, 0) == MAP_FAILED) {
+        return Util::OsError { .error = errno, .function = "MappedFile::reload" };
+    }
+    return {};
+}
+
 void MappedFile::dump() const {
     fmt::print("MappedFile[{} +{}]\n", fmt::ptr(m_ptr), m_size);
 }
 
 MappedFile::~MappedFile() {
     if (m_ptr) {
-        msync(m_ptr, m_size, MS_SYNC);
         munmap(m_ptr, m_size);
     }
 }
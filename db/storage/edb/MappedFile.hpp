@@ -26,8 +26,13 @@ public:
     ~MappedFile();
     static Util::OsErrorOr<MappedFile> map(int fd, size_t size);
 
+    // Resize mapping. This doesn't sync it, and it may move it.
     Util::OsErrorOr<void> remap(size_t new_size);
 
+    // Drop private copies of pages, so that they are read from the file
+    // again. Changes are never written to the file through the mapping.
+    Util::OsErrorOr<void> reload();
+
     std::span<uint8_t const> data() const;
     std::span<uint8_t> data();
 
@@ -55,4 +55,42 @@ Util::OsErrorOr<void> Serializer::write_row(EDBFile& file, Util::Writer& writer,
     return {};
 }
 
+Util::OsErrorOr<Core::Tuple> Serializer::read_row(EDBFile const& file, Util::BinaryReader& reader, std::vector<Column> const& columns) {
+    std::vector<Core::Value> values;
+    for (auto const& column : columns) {
+        auto is_null = column.not_null ? false : TRY(reader.read_little_endian<uint8_t>());
+        switch (static_cast<Core::Value::Type>(column.type)) {
+        case Core::Value::Type::Null:
+            ESSA_UNREACHABLE;
+            break;
+        case Core::Value::Type::Int: {
+            auto i = TRY(reader.read_little_endian<uint32_t>());
+            values.push_back(is_null ? Core::Value::null() : Core::Value::create_int(i));
+            break;
+        }
+        case Core::Value::Type::Float: {
+            auto f = TRY(reader.read_little_endian<float>());
+            values.push_back(is_null ? Core::Value::null() : Core::Value::create_float(f));
+            break;
+        }
+        case Core::Value::Type::Varchar: {
+            auto span = TRY(reader.read_struct<HeapSpan>());
+            values.push_back(is_null ? Core::Value::null() : Core::Value::create_varchar(file.read_heap(span).decode_infallible().encode()));
+            break;
+        }
+        case Core::Value::Type::Bool: {
+            auto b = TRY(reader.read_little_endian<uint8_t>());
+            values.push_back(is_null ? Core::Value::null() : Core::Value::create_bool(b));
+            break;
+        }
+        case Core::Value::Type::Time: {
+            auto time = TRY(reader.read_struct<Date>());
+            values.push_back(is_null ? Core::Value::null() : Core::Value::create_time(Core::Date { .year = time.year, .month = time.month, .day = time.day }));
+            break;
+        }
+        }
+    }
+    return Core::Tuple { std::move(values) };
+}
+
 }
@@ -13,6 +13,7 @@ namespace Serializer {
 
 Util::OsErrorOr<void> write_column(EDBFile&, Util::Writer&, Core::Column const&);
 Util::OsErrorOr<void> write_row(EDBFile&, Util::Writer& writer, std::vector<Column> const& columns, Core::Tuple const& tuple);
+Util::OsErrorOr<Core::Tuple> read_row(EDBFile const&, Util::BinaryReader& reader, std::vector<Column> const& columns);
 
 };
 
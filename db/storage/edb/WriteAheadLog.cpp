@@ -0,0 +1,419 @@
+#include "WriteAheadLog.hpp"
+
+#include "EDBFile.hpp"
+
+#include <EssaUtil/Endianness.hpp>
+#include <EssaUtil/Stream/File.hpp>
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <map>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Db::Storage::EDB {
+
+namespace {
+
+constexpr auto LogFileName = "wal.log";
+
+// FNV-1a
+uint64_t checksum(std::span<uint8_t const> data) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (auto byte : data) {
+        hash = (hash ^ byte) * 0x100000001b3;
+    }
+    return hash;
+}
+
+Util::OsErrorOr<void> write_all(int fd, std::span<uint8_t const> data, off_t offset) {
+    while (!data.empty()) {
+        auto written = ::pwrite(fd, data.data(), data.size(), offset);
+        if (written < 0) {
+            return Util::OsError { .error = errno, .function = "WriteAheadLog: pwrite" };
+        }
+        data = data.subspan(written);
+        offset += written;
+    }
+    return {};
+}
+
+// Reads records from a copy of the log. Returns nothing if the log ends
+// in the middle of the value.
+class RecordReader {
+public:
+    explicit RecordReader(std::span<uint8_t const> data)
+        : m_data(data) { }
+
+    template<class T>
+    std::optional<T> read() {
+        if (m_offset + sizeof(T) > m_data.size()) {
+            return {};
+        }
+        T value;
+        std::memcpy(&value, m_data.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return Util::convert_from_little_to_host_endian(value);
+    }
+
+    std::optional<std::span<uint8_t const>> read_bytes(size_t size) {
+        if (m_offset + size > m_data.size()) {
+            return {};
+        }
+        auto bytes = m_data.subspan(m_offset, size);
+        m_offset += size;
+        return bytes;
+    }
+
+    size_t offset() const { return m_offset; }
+    bool at_end() const { return m_offset == m_data.size(); }
+
+private:
+    std::span<uint8_t const> m_data;
+    size_t m_offset = 0;
+};
+
+}
+
+WriteAheadLog::WriteAheadLog(std::string directory, int fd)
+    : m_directory(std::move(directory))
+    , m_fd(fd)
+    , m_syncer([this] { run_syncer(); }) {
+}
+
+WriteAheadLog::~WriteAheadLog() {
+    // Files were already destroyed, so changes of a transaction that wasn't
+    // committed can only be dropped.
+    if (m_in_transaction) {
+        m_in_transaction = false;
+        m_buffer.clear();
+    }
+    auto result = checkpoint();
+    if (result.is_error()) {
+        result.dump("Internal error: Failed to checkpoint WAL on destruction");
+    }
+    for (auto file : m_files) {
+        file->m_log = nullptr;
+    }
+    {
+        std::lock_guard lock { m_mutex };
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    m_syncer.join();
+    ::close(m_fd);
+}
+
+Util::OsErrorOr<std::unique_ptr<WriteAheadLog>> WriteAheadLog::open(std::string const& directory) {
+    auto path = directory + "/" + LogFileName;
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return Util::OsError { .error = errno, .function = "WriteAheadLog: open" };
+    }
+    auto log = std::unique_ptr<WriteAheadLog>(new WriteAheadLog(directory, fd));
+    TRY(log->replay());
+    return log;
+}
+
+void WriteAheadLog::attach(EDBFile& file, std::string file_name) {
+    if (std::find(m_files.begin(), m_files.end(), &file) == m_files.end()) {
+        m_files.push_back(&file);
+    }
+    file.m_log = this;
+    file.m_log_name = std::move(file_name);
+}
+
+void WriteAheadLog::detach(EDBFile& file) {
+    std::erase(m_files, &file);
+    file.m_log = nullptr;
+}
+
+template<class T>
+void WriteAheadLog::append(T value) {
+    value = Util::convert_from_host_to_little_endian(value);
+    auto bytes = reinterpret_cast<uint8_t const*>(&value);
+    m_buffer.insert(m_buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void WriteAheadLog::append_record_header(RecordType type, std::string const& file_name) {
+    append(static_cast<uint8_t>(type));
+    append(static_cast<uint16_t>(file_name.size()));
+    m_buffer.insert(m_buffer.end(), file_name.begin(), file_name.end());
+}
+
+void WriteAheadLog::log_write(std::string const& file_name, size_t offset, std::span<uint8_t const> data) {
+    append_record_header(RecordType::Write, file_name);
+    append(static_cast<uint64_t>(offset));
+    append(static_cast<uint32_t>(data.size()));
+    m_buffer.insert(m_buffer.end(), data.begin(), data.end());
+}
+
+void WriteAheadLog::log_truncate(std::string const& file_name, size_t size) {
+    append_record_header(RecordType::Truncate, file_name);
+    append(static_cast<uint64_t>(size));
+}
+
+Util::OsErrorOr<void> WriteAheadLog::commit() {
+    if (m_in_transaction) {
+        return {};
+    }
+    for (auto file : m_files) {
+        TRY(file->commit());
+    }
+    if (m_buffer.empty()) {
+        return {};
+    }
+    auto records_checksum = checksum(m_buffer);
+    append(static_cast<uint8_t>(RecordType::Commit));
+    append(records_checksum);
+
+    size_t commit_end = 0;
+    bool asynchronous = false;
+    {
+        std::lock_guard lock { m_mutex };
+        if (m_sync_error) {
+            m_buffer.clear();
+            return *m_sync_error;
+        }
+        auto result = write_all(m_fd, m_buffer, m_size);
+        if (result.is_error()) {
+            m_buffer.clear();
+            // Don't leave a partial commit, so that next ones can be recovered.
+            (void)::ftruncate(m_fd, m_size);
+            return result.release_error();
+        }
+        m_size += m_buffer.size();
+        m_buffer.clear();
+        commit_end = m_size;
+        asynchronous = m_asynchronous_commit;
+    }
+    if (asynchronous) {
+        m_condition.notify_all();
+    }
+    else {
+        TRY(sync_until(commit_end));
+    }
+
+    if (m_size > CheckpointSize) {
+        TRY(checkpoint());
+    }
+    return {};
+}
+
+Util::OsErrorOr<void> WriteAheadLog::begin_transaction() {
+    TRY(commit());
+    m_in_transaction = true;
+    return {};
+}
+
+Util::OsErrorOr<void> WriteAheadLog::commit_transaction() {
+    m_in_transaction = false;
+    return commit();
+}
+
+Util::OsErrorOr<void> WriteAheadLog::rollback_transaction() {
+    m_in_transaction = false;
+    m_buffer.clear();
+    // Earlier commits may be still only in the log, and files are read
+    // again from the disk.
+    TRY(apply());
+    for (auto file : m_files) {
+        TRY(file->rollback());
+    }
+    return {};
+}
+
+void WriteAheadLog::set_asynchronous_commit(bool asynchronous) {
+    {
+        std::lock_guard lock { m_mutex };
+        m_asynchronous_commit = asynchronous;
+    }
+    m_condition.notify_all();
+}
+
+size_t WriteAheadLog::synced_size() const {
+    std::lock_guard lock { m_mutex };
+    return m_synced_size;
+}
+
+Util::OsErrorOr<void> WriteAheadLog::sync() {
+    return sync_until(m_size);
+}
+
+Util::OsErrorOr<void> WriteAheadLog::sync_until(size_t size) {
+    std::unique_lock lock { m_mutex };
+    while (m_synced_size < size) {
+        TRY(sync_impl(lock));
+    }
+    return {};
+}
+
+// The first caller that needs the log to be synced (the leader) syncs
+// everything that was written until then, and the ones that come in the
+// meantime (followers) wait for it. If their records were written after
+// the leader started, one of them syncs them next.
+Util::OsErrorOr<void> WriteAheadLog::sync_impl(std::unique_lock<std::mutex>& lock) {
+    if (m_sync_error) {
+        return *m_sync_error;
+    }
+    if (m_syncing) {
+        m_condition.wait(lock, [this] { return !m_syncing; });
+        return {};
+    }
+    auto size = m_size;
+    m_syncing = true;
+    lock.unlock();
+    auto result = ::fdatasync(m_fd);
+    auto error = errno;
+    lock.lock();
+    m_syncing = false;
+    m_condition.notify_all();
+    if (result < 0) {
+        // Pages that failed to be written may be marked clean by the kernel,
+        // so syncing again could succeed without them.
+        m_sync_error = Util::OsError { .error = error, .function = "WriteAheadLog: fdatasync" };
+        return *m_sync_error;
+    }
+    m_synced_size = std::max(m_synced_size, size);
+    return {};
+}
+
+void WriteAheadLog::run_syncer() {
+    std::unique_lock lock { m_mutex };
+    while (true) {
+        m_condition.wait(lock, [this] { return m_stopping || (m_asynchronous_commit && !m_sync_error && m_synced_size < m_size); });
+        if (m_stopping) {
+            return;
+        }
+        // Let more commits come, so that they are synced together.
+        m_condition.wait_for(lock, GroupCommitInterval, [this] { return m_stopping; });
+        if (!m_sync_error && m_synced_size < m_size) {
+            auto result = sync_impl(lock);
+            if (result.is_error()) {
+                result.dump("WriteAheadLog: Failed to sync");
+            }
+        }
+    }
+}
+
+Util::OsErrorOr<void> WriteAheadLog::checkpoint() {
+    TRY(commit());
+    TRY(apply());
+    // Mappings of files with changes of a transaction are kept. Their
+    // pages that weren't changed are read from the file anyway. Files
+    // that logged nothing are not read again.
+    if (!m_in_transaction) {
+        for (auto file : m_files) {
+            TRY(file->reload());
+        }
+    }
+    return {};
+}
+
+Util::OsErrorOr<void> WriteAheadLog::apply() {
+    // Files may be changed only when the log is durable, so that an
+    // interrupted checkpoint can be recovered.
+    TRY(sync());
+    std::unique_lock lock { m_mutex };
+    m_condition.wait(lock, [this] { return !m_syncing; });
+    return replay();
+}
+
+Util::OsErrorOr<void> WriteAheadLog::replay() {
+    struct stat stat;
+    if (::fstat(m_fd, &stat) < 0) {
+        return Util::OsError { .error = errno, .function = "WriteAheadLog: stat" };
+    }
+    std::vector<uint8_t> data(stat.st_size);
+    if (::pread(m_fd, data.data(), data.size(), 0) != static_cast<ssize_t>(data.size())) {
+        return Util::OsError { .error = errno, .function = "WriteAheadLog: pread" };
+    }
+
+    struct Record {
+        RecordType type;
+        std::string file_name;
+        uint64_t offset;
+        std::span<uint8_t const> data;
+    };
+
+    // Files that don't exist anymore are skipped.
+    std::map<std::string, Util::File> files;
+    auto file_fd = [&](std::string const& name) {
+        auto it = files.find(name);
+        if (it == files.end()) {
+            auto path = m_directory + "/" + name;
+            it = files.insert({ name, Util::File { ::open(path.c_str(), O_RDWR), true } }).first;
+        }
+        return it->second.fd();
+    };
+
+    RecordReader reader { data };
+    std::vector<Record> records;
+    size_t commit_start = 0;
+    while (!reader.at_end()) {
+        auto type = reader.read<uint8_t>();
+        if (!type) {
+            break;
+        }
+        if (static_cast<RecordType>(*type) == RecordType::Commit) {
+            auto expected_checksum = reader.read<uint64_t>();
+            if (!expected_checksum || *expected_checksum != checksum(std::span { data }.subspan(commit_start, reader.offset() - sizeof(uint64_t) - 1 - commit_start))) {
+                break;
+            }
+            for (auto const& record : records) {
+                auto fd = file_fd(record.file_name);
+                if (fd < 0) {
+                    continue;
+                }
+                if (record.type == RecordType::Write) {
+                    TRY(write_all(fd, record.data, record.offset));
+                }
+                else if (::ftruncate(fd, record.offset) < 0) {
+                    return Util::OsError { .error = errno, .function = "WriteAheadLog: ftruncate" };
+                }
+            }
+            records.clear();
+            commit_start = reader.offset();
+            continue;
+        }
+
+        Record record { .type = static_cast<RecordType>(*type), .file_name = {}, .offset = 0, .data = {} };
+        auto name_size = reader.read<uint16_t>();
+        auto name = name_size ? reader.read_bytes(*name_size) : std::nullopt;
+        auto offset = name ? reader.read<uint64_t>() : std::nullopt;
+        if (!offset) {
+            break;
+        }
+        record.file_name = std::string { name->begin(), name->end() };
+        record.offset = *offset;
+        if (record.type == RecordType::Write) {
+            auto size = reader.read<uint32_t>();
+            auto bytes = size ? reader.read_bytes(*size) : std::nullopt;
+            if (!bytes) {
+                break;
+            }
+            record.data = *bytes;
+        }
+        else if (record.type != RecordType::Truncate) {
+            break;
+        }
+        records.push_back(std::move(record));
+    }
+
+    for (auto const& [name, file] : files) {
+        if (file.fd() >= 0 && ::fsync(file.fd()) < 0) {
+            return Util::OsError { .error = errno, .function = "WriteAheadLog: fsync" };
+        }
+    }
+    if (::ftruncate(m_fd, 0) < 0) {
+        return Util::OsError { .error = errno, .function = "WriteAheadLog: ftruncate" };
+    }
+    if (::fsync(m_fd) < 0) {
+        return Util::OsError { .error = errno, .function = "WriteAheadLog: fsync" };
+    }
+    m_size = 0;
+    m_synced_size = 0;
+    return {};
+}
+
+}
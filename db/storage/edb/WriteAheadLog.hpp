@@ -0,0 +1,132 @@
+#pragma once
+
+#include <EssaUtil/Error.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Db::Storage::EDB {
+
+class EDBFile;
+
+// With asynchronous commit, commits that are written within this time are
+// made durable with a single fsync by a background thread. A crash of the
+// system (but not just of the process) may lose commits from this time.
+constexpr auto GroupCommitInterval = std::chrono::milliseconds(10);
+
+// Log is checkpointed when it gets bigger than this.
+constexpr size_t CheckpointSize = 16 * 1024 * 1024;
+
+// Redo log shared by all EDB files of a database. Files are mapped
+// privately, so their changes reach the disk only through the log: when
+// changes are committed, changed byte ranges of every file are appended to
+// the log, followed by a commit record with a checksum. A checkpoint copies
+// committed changes to the files and empties the log. When the database is
+// opened, committed changes that were not checkpointed are recovered, and
+// ones after the last valid commit record are ignored.
+class WriteAheadLog {
+public:
+    WriteAheadLog(WriteAheadLog const&) = delete;
+    WriteAheadLog& operator=(WriteAheadLog const&) = delete;
+    ~WriteAheadLog();
+
+    // Open log in the database directory and recover it.
+    static Util::OsErrorOr<std::unique_ptr<WriteAheadLog>> open(std::string const& directory);
+
+    // Changes of attached files are logged as changes of `file_name` in
+    // the database directory. Attaching a file again changes its name.
+    void attach(EDBFile&, std::string file_name);
+    void detach(EDBFile&);
+
+    void log_write(std::string const& file_name, size_t offset, std::span<uint8_t const>);
+    void log_truncate(std::string const& file_name, size_t size);
+
+    // Log changes of all attached files and a commit record, and wait until
+    // the record is durable. Commits that are written while the log is
+    // synced wait for each other and are synced together; there's no delay
+    // to wait for more of them, so a single committing thread syncs once
+    // per commit. With asynchronous commit, this returns right away and the
+    // log is synced by a background thread. This does nothing in a
+    // transaction.
+    Util::OsErrorOr<void> commit();
+
+    // Off by default. Asynchronous commits may be lost on system crash (see
+    // GroupCommitInterval), but never partially.
+    void set_asynchronous_commit(bool);
+
+    // Changes made until commit_transaction() are committed at once, and
+    // all of them are discarded by rollback_transaction(). Files keep them
+    // in their private mappings in the meantime.
+    Util::OsErrorOr<void> begin_transaction();
+    Util::OsErrorOr<void> commit_transaction();
+    Util::OsErrorOr<void> rollback_transaction();
+    bool in_transaction() const { return m_in_transaction; }
+
+    // Wait until all commits are durable. If syncing the log fails once,
+    // it's not known what reached the disk, so this and all later commits
+    // fail with the same error.
+    Util::OsErrorOr<void> sync();
+
+    // Commit, copy all committed changes to the files and empty the log.
+    // This is also done before files are created, renamed or removed, so
+    // that the log refers only to existing files. In a transaction, changes
+    // of the transaction stay in the files' mappings.
+    Util::OsErrorOr<void> checkpoint();
+
+    // Size of committed records in the log.
+    size_t size() const { return m_size; }
+
+    // Size of committed records that are known to be durable.
+    size_t synced_size() const;
+
+private:
+    enum class RecordType : uint8_t {
+        Write,
+        Truncate,
+        Commit,
+    };
+
+    WriteAheadLog(std::string directory, int fd);
+
+    void append_record_header(RecordType, std::string const& file_name);
+    template<class T>
+    void append(T value);
+
+    // Apply records of all complete commits to the files.
+    Util::OsErrorOr<void> replay();
+
+    // Sync the log and replay it into the files.
+    Util::OsErrorOr<void> apply();
+
+    // Wait until the log is durable up to `size`.
+    Util::OsErrorOr<void> sync_until(size_t size);
+    Util::OsErrorOr<void> sync_impl(std::unique_lock<std::mutex>&);
+    void run_syncer();
+
+    std::string m_directory;
+    int m_fd = -1;
+    std::vector<EDBFile*> m_files;
+
+    // Records since the last commit.
+    std::vector<uint8_t> m_buffer;
+    size_t m_size = 0;
+    bool m_in_transaction = false;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    size_t m_synced_size = 0;
+    bool m_syncing = false;
+    bool m_stopping = false;
+    bool m_asynchronous_commit = false;
+    std::optional<Util::OsError> m_sync_error;
+    std::thread m_syncer;
+};
+
+}
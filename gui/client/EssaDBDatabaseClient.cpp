@@ -15,7 +15,7 @@ Util::OsErrorOr<std::unique_ptr<EssaDBDatabaseClient>> EssaDBDatabaseClient::cre
 }
 
 Db::Sql::SQLErrorOr<Db::Core::ValueOrResultSet> EssaDBDatabaseClient::run_query(std::string const& source) {
-    return Db::Sql::run_query(m_db, source);
+    return TRY(Db::Sql::run_query(m_db, source)).collect();
 }
 
 Db::Core::DbErrorOr<Structure::Database> EssaDBDatabaseClient::structure() const {
@@ -21,19 +21,43 @@ void run_query(Db::Core::Database& db, std::string const& query) {
     //     std::cout << (int)token.type << ": " << token.value << std::endl;
     // }
 
+    auto display_error = [&](Db::Sql::SQLError const& error) {
+        Db::Sql::display_error(error, tokens[error.token()].start, tokens[error.token()].end, query);
+    };
+
     auto statement = Db::Sql::Parser::parse_statement(tokens);
     if (statement.is_error()) {
-        auto error = statement.release_error();
-        Db::Sql::display_error(error, tokens[error.token()].start, tokens[error.token()].end, query);
+        display_error(statement.release_error());
         return;
     }
-    auto result = statement.release_value()->execute(db);
-    if (result.is_error()) {
-        auto error = result.release_error();
-        Db::Sql::display_error(error, tokens[error.token()].start, tokens[error.token()].end, query);
+    auto maybe_cursor = Db::Sql::Cursor::open(db, statement.release_value());
+    if (maybe_cursor.is_error()) {
+        display_error(maybe_cursor.release_error());
         return;
     }
-    result.release_value().repl_dump(std::cerr, Db::Core::ResultSet::FancyDump::Yes);
+    auto cursor = maybe_cursor.release_value();
+    if (cursor.is_value()) {
+        cursor.value().repl_dump(std::cerr);
+        return;
+    }
+
+    // Display rows as soon as a batch of them is computed.
+    bool displayed_any_row = false;
+    while (true) {
+        auto batch = cursor.next_batch();
+        if (batch.is_error()) {
+            display_error(batch.release_error());
+            return;
+        }
+        if (batch.value().empty()) {
+            break;
+        }
+        Db::Core::ResultSet { cursor.column_names(), batch.release_value() }.dump(std::cerr, Db::Core::ResultSet::FancyDump::Yes);
+        displayed_any_row = true;
+    }
+    if (!displayed_any_row) {
+        Db::Core::ResultSet { cursor.column_names(), {} }.dump(std::cerr, Db::Core::ResultSet::FancyDump::Yes);
+    }
 }
 
 void display_error(Db::Core::DbError const& error, ssize_t error_start, ssize_t error_end, std::string const& file_name) {
@@ -0,0 +1,161 @@
+CREATE TABLE test (id INT PRIMARY KEY, value INT);
+INSERT INTO test (id, value) VALUES (1, 100);
+
+BEGIN;
+INSERT INTO test (id, value) VALUES (2, 200);
+UPDATE test SET value = value + 1;
+DELETE FROM test WHERE id = 1;
+
+-- output:
+-- | id | value |
+-- |  2 |   201 |
+SELECT * FROM test;
+
+ROLLBACK;
+
+-- output:
+-- | id | value |
+-- |  1 |   100 |
+SELECT * FROM test;
+
+-- error: Primary key must be unique
+INSERT INTO test (id, value) VALUES (1, 0);
+
+BEGIN TRANSACTION;
+INSERT INTO test (id, value) VALUES (3, 300);
+COMMIT TRANSACTION;
+
+-- error: No transaction is running
+ROLLBACK;
+
+-- output:
+-- | id | value |
+-- |  1 |   100 |
+-- |  3 |   300 |
+SELECT * FROM test;
+
+-- Rows inserted before the failing one are rolled back
+CREATE TABLE source (id INT, value INT);
+INSERT INTO source (id, value) VALUES (4, 400);
+INSERT INTO source (id, value) VALUES (1, 0);
+-- error: Primary key must be unique
+INSERT INTO test (id, value) SELECT * FROM source;
+
+-- output:
+-- | id | value |
+-- |  1 |   100 |
+-- |  3 |   300 |
+SELECT * FROM test;
+
+BEGIN;
+-- error: Transaction is already running
+BEGIN;
+-- error: VACUUM cannot be run in a transaction
+VACUUM;
+DROP TABLE test;
+CREATE TABLE test (other VARCHAR);
+INSERT INTO test (other) VALUES ('x');
+TRUNCATE TABLE source;
+ROLLBACK;
+
+-- output:
+-- | id | value |
+-- |  1 |   100 |
+-- |  3 |   300 |
+SELECT * FROM test;
+
+-- output:
+-- | id | value |
+-- |  4 |   400 |
+-- |  1 |     0 |
+SELECT * FROM source;
+
+-- Table isn't left renamed if its rows can't be copied
+INSERT INTO source (id) VALUES (5);
+-- error: NULL given for NOT NULL column 'value'
+ALTER TABLE source ALTER COLUMN value INT NOT NULL;
+
+-- output:
+-- | id | value |
+-- |  4 |   400 |
+-- |  1 |     0 |
+-- |  5 |  null |
+SELECT * FROM source;
+
+CREATE TABLE numbers (id INT PRIMARY KEY, value INT) ENGINE COLUMNAR;
+INSERT INTO numbers (id, value) VALUES (1, 10);
+BEGIN;
+INSERT INTO numbers (id, value) VALUES (2, 20);
+UPDATE numbers SET value = value * 2;
+DELETE FROM numbers WHERE id = 1;
+ROLLBACK;
+INSERT INTO numbers (id, value) VALUES (2, 30);
+
+-- output:
+-- | id | value |
+-- |  1 |    10 |
+-- |  2 |    30 |
+SELECT * FROM numbers;
+
+DROP TABLE numbers;
+DROP TABLE test;
+
+-- output:
+-- |   name |
+-- | source |
+SHOW TABLES;
+
+-- A statement that fails in a transaction may have changed some rows
+-- already, so the whole transaction is rolled back
+CREATE TABLE accounts (id INT PRIMARY KEY, balance INT);
+INSERT INTO accounts (id, balance) VALUES (1, 100);
+BEGIN;
+INSERT INTO accounts (id, balance) VALUES (2, 200);
+-- error: Primary key must be unique
+INSERT INTO accounts (id, balance) SELECT * FROM source;
+-- error: Transaction was aborted because a statement failed, statements are ignored until COMMIT or ROLLBACK
+SELECT * FROM accounts;
+-- error: Transaction was aborted because a statement failed, statements are ignored until COMMIT or ROLLBACK
+INSERT INTO accounts (id, balance) VALUES (3, 300);
+-- error: Transaction was rolled back because a statement failed
+COMMIT;
+
+-- output:
+-- | id | balance |
+-- |  1 |     100 |
+SELECT * FROM accounts;
+
+BEGIN;
+INSERT INTO accounts (id, balance) VALUES (3, 300);
+-- error: Primary key must be unique
+INSERT INTO accounts (id, balance) VALUES (1, 0);
+ROLLBACK;
+INSERT INTO accounts (id, balance) VALUES (2, 200);
+
+-- output:
+-- | id | balance |
+-- |  1 |     100 |
+-- |  2 |     200 |
+SELECT * FROM accounts;
+
+DROP TABLE accounts;
+
+-- Created and dropped indexes are restored too
+CREATE TABLE indexed (id INT, name VARCHAR);
+INSERT INTO indexed (id, name) VALUES (1, 'a');
+INSERT INTO indexed (id, name) VALUES (2, 'b');
+CREATE UNIQUE INDEX by_id ON indexed (id);
+BEGIN;
+CREATE UNIQUE INDEX by_name ON indexed (name);
+DROP INDEX by_id ON indexed;
+INSERT INTO indexed (id, name) VALUES (1, 'c');
+ROLLBACK;
+INSERT INTO indexed (id, name) VALUES (3, 'a');
+
+-- error: Duplicate key (int 1) for unique index 'by_id'
+INSERT INTO indexed (id, name) VALUES (1, 'd');
+
+-- error: Index 'by_name' doesn't exist
+DROP INDEX by_name ON indexed;
+
+DROP TABLE indexed;
@@ -0,0 +1,43 @@
+CREATE TABLE test (id INT, name VARCHAR, city VARCHAR);
+INSERT INTO test (id, name, city) VALUES (1, 'Alice', 'Paris');
+INSERT INTO test (id, name, city) VALUES (2, 'Bob', 'Berlin');
+INSERT INTO test (id, name, city) VALUES (3, 'Alice', 'Berlin');
+
+CREATE INDEX by_city ON test (city);
+CREATE UNIQUE INDEX by_name_city ON test (name, city);
+
+-- error: Index 'by_city' already exists
+CREATE INDEX by_city ON test (name);
+
+-- error: Column 'country' does not exist in table 'test'
+CREATE INDEX by_country ON test (country);
+
+-- error: Cannot create unique index 'by_name' because of duplicate key (varchar 'Alice')
+CREATE UNIQUE INDEX by_name ON test (name);
+
+-- error: Duplicate key (varchar 'Bob', varchar 'Berlin') for unique index 'by_name_city'
+INSERT INTO test (id, name, city) VALUES (4, 'Bob', 'Berlin');
+
+-- Unique index follows deletes and updates
+DELETE FROM test WHERE id = 2;
+INSERT INTO test (id, name, city) VALUES (4, 'Bob', 'Berlin');
+UPDATE test SET city = CASE WHEN id = 4 THEN 'Warsaw' ELSE city END;
+INSERT INTO test (id, name, city) VALUES (5, 'Bob', 'Berlin');
+
+-- error: Duplicate key (varchar 'Bob', varchar 'Warsaw') for unique index 'by_name_city'
+INSERT INTO test (id, name, city) VALUES (6, 'Bob', 'Warsaw');
+
+DROP INDEX by_name_city ON test;
+INSERT INTO test (id, name, city) VALUES (6, 'Bob', 'Warsaw');
+
+-- error: Index 'by_name_city' doesn't exist
+DROP INDEX by_name_city ON test;
+
+-- output:
+-- | id |  name |   city |
+-- |  1 | Alice |  Paris |
+-- |  3 | Alice | Berlin |
+-- |  4 |   Bob | Warsaw |
+-- |  5 |   Bob | Berlin |
+-- |  6 |   Bob | Warsaw |
+SELECT * FROM test;
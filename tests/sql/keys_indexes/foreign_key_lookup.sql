@@ -0,0 +1,26 @@
+CREATE TABLE parents (id INT, name VARCHAR);
+INSERT INTO parents (id, name) VALUES (1, 'a');
+INSERT INTO parents (id, name) VALUES (2, 'b');
+
+CREATE TABLE children (id INT PRIMARY KEY, parent_id INT FOREIGN KEY REFERENCES parents(id));
+INSERT INTO children (id, parent_id) VALUES (1, 1);
+INSERT INTO children (id, parent_id) VALUES (2, 2);
+
+-- Referenced column index must follow changes in the referenced table
+DELETE FROM parents WHERE id = 2;
+
+-- error: Foreign key 'parent_id' requires matching value in referenced column 'parents.id'
+INSERT INTO children (id, parent_id) VALUES (3, 2);
+
+UPDATE parents SET id = id + 2;
+INSERT INTO children (id, parent_id) VALUES (3, 3);
+
+-- error: Foreign key 'parent_id' requires matching value in referenced column 'parents.id'
+INSERT INTO children (id, parent_id) VALUES (4, 1);
+
+-- output:
+-- | id | parent_id |
+-- |  1 |         1 |
+-- |  2 |         2 |
+-- |  3 |         3 |
+SELECT * FROM children;
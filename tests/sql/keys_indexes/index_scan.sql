@@ -0,0 +1,57 @@
+CREATE TABLE test (id INT PRIMARY KEY, score INT, name VARCHAR);
+INSERT INTO test (id, score, name) VALUES (1, 50, 'e');
+INSERT INTO test (id, score, name) VALUES (2, 20, 'b');
+INSERT INTO test (id, score, name) VALUES (3, NULL, 'c');
+INSERT INTO test (id, score, name) VALUES (4, 40, 'a');
+INSERT INTO test (id, score, name) VALUES (5, 20, 'd');
+CREATE INDEX by_score ON test (score);
+CREATE INDEX by_name ON test (name);
+
+-- Primary key lookup
+-- output:
+-- | id | score | name |
+-- |  4 |    40 |    a |
+SELECT * FROM test WHERE id = 4;
+
+-- Rows found by index are returned in index order
+-- output:
+-- | id | score | name |
+-- |  2 |    20 |    b |
+-- |  5 |    20 |    d |
+-- |  4 |    40 |    a |
+SELECT * FROM test WHERE score BETWEEN 20 AND 45;
+
+-- The rest of WHERE is still checked
+-- output:
+-- | id | score | name |
+-- |  5 |    20 |    d |
+SELECT * FROM test WHERE score = 20 AND name = 'd';
+
+-- output:
+-- | id | score | name |
+-- |  4 |    40 |    a |
+-- |  1 |    50 |    e |
+SELECT * FROM test WHERE score > 20 AND 51 > score;
+
+-- NULL is smaller than any value
+-- output:
+-- | id | score | name |
+-- |  3 |  null |    c |
+-- |  2 |    20 |    b |
+-- |  5 |    20 |    d |
+SELECT * FROM test WHERE score < 40;
+
+-- output:
+-- | id | score | name |
+-- |  4 |    40 |    a |
+-- |  2 |    20 |    b |
+-- |  1 |    50 |    e |
+SELECT * FROM test WHERE name IN ('a', 'b', 'e', 'x', 'a');
+
+DELETE FROM test WHERE score < 21;
+
+-- output:
+-- | id | score | name |
+-- |  1 |    50 |    e |
+-- |  4 |    40 |    a |
+SELECT * FROM test;
@@ -0,0 +1,29 @@
+CREATE TABLE test (id INT PRIMARY KEY, code VARCHAR UNIQUE);
+INSERT INTO test (id, code) VALUES (1, 'a');
+INSERT INTO test (id, code) VALUES (2, 'b');
+INSERT INTO test (id, code) VALUES (3, 'c');
+
+-- Removed keys can be reused
+DELETE FROM test WHERE id = 2;
+INSERT INTO test (id, code) VALUES (2, 'b');
+
+-- error: Primary key must be unique
+INSERT INTO test (id, code) VALUES (2, 'd');
+
+-- Updated keys are reindexed
+UPDATE test SET id = id + 10;
+INSERT INTO test (id, code) VALUES (1, 'd');
+
+-- error: Primary key must be unique
+INSERT INTO test (id, code) VALUES (11, 'e');
+
+-- error: Column 'code' must contain unique values
+INSERT INTO test (id, code) VALUES (4, 'c');
+
+-- output:
+-- | id | code |
+-- | 11 |    a |
+-- | 13 |    c |
+-- | 12 |    b |
+-- |  1 |    d |
+SELECT * FROM test;
@@ -2,5 +2,5 @@ IMPORT CSV 'aggregate.csv' INTO test;
 
 -- output:
 -- | SUM((id + 1)) |
--- |     32.000000 |
+-- |            32 |
 SELECT SUM(id + 1) FROM test;
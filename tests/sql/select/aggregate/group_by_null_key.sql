@@ -0,0 +1,17 @@
+CREATE TABLE test (id INT, number INT);
+INSERT INTO test (id, number) VALUES (0, 1);
+INSERT INTO test (id, number) VALUES (0, 2);
+INSERT INTO test (number) VALUES (3);
+INSERT INTO test (id, number) VALUES (1, 4);
+
+-- output:
+-- |   id | COUNT(number) |
+-- | null |             1 |
+-- |    0 |             2 |
+-- |    1 |             1 |
+SELECT id, COUNT(number) FROM test GROUP BY id;
+
+-- output:
+-- | id |
+-- |  0 |
+SELECT id FROM test GROUP BY id HAVING COUNT(number) > 1;
@@ -0,0 +1,20 @@
+CREATE TABLE test (id INT, score FLOAT);
+INSERT INTO test (id, score) VALUES (16777217, 1.5);
+INSERT INTO test (id, score) VALUES (2, 2.25);
+INSERT INTO test (id, score) VALUES (NULL, 4.5);
+
+-- FLOAT can't store 16777219 exactly.
+-- output:
+-- |  SUM(id) | AVG(score) | MAX((score - 10)) |
+-- | 16777219 |   2.750000 |         -5.500000 |
+SELECT SUM(id), AVG(score), MAX(score - 10) FROM test;
+
+-- output:
+-- |  SUM(id) | AVG(score) | MAX((score - 10)) |
+-- | 16777219 |   2.750000 |         -5.500000 |
+SELECT SUM(id), AVG(score), MAX(score - 10) FROM test HAVING COUNT(id) > 0;
+
+INSERT INTO test (id, score) VALUES (2147483647, 0.0);
+
+-- error: SUM of INTs is out of range: 2164260866
+SELECT SUM(id) FROM test;
@@ -10,8 +10,8 @@ SELECT * FROM test;
 SELECT COUNT(id) FROM test;
 
 -- output:
--- |   SUM(id) |
--- | 25.000000 |
+-- | SUM(id) |
+-- |      25 |
 SELECT SUM(id) FROM test;
 
 -- output:
@@ -9,3 +9,30 @@ IMPORT CSV 'distinct.csv' INTO test;
 -- |      5 |    tej |
 -- |      1 |   2137 |
 SELECT DISTINCT * FROM test;
+
+-- Rows are compared after SELECT
+-- output:
+-- | number |
+-- |      1 |
+-- |      2 |
+-- |      3 |
+-- |      4 |
+-- |      5 |
+SELECT DISTINCT number FROM test;
+
+-- output:
+-- | number |
+-- |      5 |
+-- |      4 |
+SELECT DISTINCT TOP 2 number FROM test ORDER BY number DESC;
+
+-- output:
+-- | string |
+-- |   test |
+-- |    abc |
+SELECT DISTINCT TOP 2 string FROM test;
+
+-- output:
+-- | COUNT(number) |
+-- |            11 |
+SELECT DISTINCT COUNT(number) FROM test;
@@ -0,0 +1,70 @@
+CREATE TABLE orders (id INT, customer INT, total FLOAT);
+INSERT INTO orders (id, customer, total) VALUES (1, 10, 5.5);
+INSERT INTO orders (id, customer, total) VALUES (2, 20, 7.0);
+INSERT INTO orders (id, customer, total) VALUES (3, 10, 1.25);
+INSERT INTO orders (id, customer, total) VALUES (4, NULL, 3.0);
+INSERT INTO orders (id, customer, total) VALUES (5, 40, 30.0);
+
+CREATE TABLE customers (customer INT, name VARCHAR);
+INSERT INTO customers (customer, name) VALUES (10, 'a');
+INSERT INTO customers (customer, name) VALUES (20, 'b');
+INSERT INTO customers (customer, name) VALUES (10, 'c');
+INSERT INTO customers (customer, name) VALUES (30, 'd');
+INSERT INTO customers (customer, name) VALUES (NULL, 'e');
+
+-- Many-to-many
+-- output:
+-- | id | customer |    total | customer | name |
+-- |  1 |       10 | 5.500000 |       10 |    a |
+-- |  1 |       10 | 5.500000 |       10 |    c |
+-- |  2 |       20 | 7.000000 |       20 |    b |
+-- |  3 |       10 | 1.250000 |       10 |    a |
+-- |  3 |       10 | 1.250000 |       10 |    c |
+SELECT * FROM orders INNER JOIN customers ON orders.customer = customers.customer;
+
+-- NULLs don't match anything
+-- output:
+-- | id | customer |     total | customer | name |
+-- |  1 |       10 |  5.500000 |       10 |    a |
+-- |  1 |       10 |  5.500000 |       10 |    c |
+-- |  2 |       20 |  7.000000 |       20 |    b |
+-- |  3 |       10 |  1.250000 |       10 |    a |
+-- |  3 |       10 |  1.250000 |       10 |    c |
+-- |  4 |     null |  3.000000 |     null | null |
+-- |  5 |       40 | 30.000000 |     null | null |
+SELECT * FROM orders LEFT JOIN customers ON orders.customer = customers.customer;
+
+-- output:
+-- |   id | customer |    total | customer | name |
+-- |    1 |       10 | 5.500000 |       10 |    a |
+-- |    1 |       10 | 5.500000 |       10 |    c |
+-- |    2 |       20 | 7.000000 |       20 |    b |
+-- |    3 |       10 | 1.250000 |       10 |    a |
+-- |    3 |       10 | 1.250000 |       10 |    c |
+-- | null |     null |     null |       30 |    d |
+-- | null |     null |     null |     null |    e |
+SELECT * FROM orders RIGHT JOIN customers ON orders.customer = customers.customer;
+
+-- output:
+-- |   id | customer |     total | customer | name |
+-- |    1 |       10 |  5.500000 |       10 |    a |
+-- |    1 |       10 |  5.500000 |       10 |    c |
+-- |    2 |       20 |  7.000000 |       20 |    b |
+-- |    3 |       10 |  1.250000 |       10 |    a |
+-- |    3 |       10 |  1.250000 |       10 |    c |
+-- |    4 |     null |  3.000000 |     null | null |
+-- |    5 |       40 | 30.000000 |     null | null |
+-- | null |     null |      null |       30 |    d |
+-- | null |     null |      null |     null |    e |
+SELECT * FROM orders FULL OUTER JOIN customers ON orders.customer = customers.customer;
+
+-- INTs match integral FLOATs
+-- output:
+-- | customer | name | id | customer |     total |
+-- |       30 |    d |  5 |       40 | 30.000000 |
+SELECT * FROM customers INNER JOIN orders ON customers.customer = orders.total;
+
+-- output:
+-- | COUNT(id) |
+-- |         5 |
+SELECT COUNT(id) FROM orders INNER JOIN customers ON orders.customer = customers.customer;
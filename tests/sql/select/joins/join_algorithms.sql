@@ -0,0 +1,100 @@
+CREATE TABLE customers (id INT PRIMARY KEY, name VARCHAR);
+INSERT INTO customers (id, name) VALUES (10, 'a');
+INSERT INTO customers (id, name) VALUES (20, 'b');
+INSERT INTO customers (id, name) VALUES (30, 'c');
+INSERT INTO customers (id, name) VALUES (40, 'd');
+INSERT INTO customers (id, name) VALUES (50, 'e');
+
+CREATE TABLE orders (id INT, customer FLOAT);
+INSERT INTO orders (id, customer) VALUES (1, 20.0);
+INSERT INTO orders (id, customer) VALUES (2, 10.5);
+INSERT INTO orders (id, customer) VALUES (3, NULL);
+
+-- Primary key is used to look up customers of orders
+-- output:
+-- |                                                                    plan |
+-- | Index nested loop join (LEFT JOIN), using index 'PRIMARY' of right side |
+-- |                                              Scan table orders (3 rows) |
+-- |                                           Scan table customers (5 rows) |
+EXPLAIN SELECT * FROM orders LEFT JOIN customers ON orders.customer = customers.id;
+
+-- output:
+-- | id |  customer |   id | name |
+-- |  1 | 20.000000 |   20 |    b |
+-- |  2 | 10.500000 | null | null |
+-- |  3 |      null | null | null |
+SELECT * FROM orders LEFT JOIN customers ON orders.customer = customers.id;
+
+-- output:
+-- |                                                                    plan |
+-- | Index nested loop join (INNER JOIN), using index 'PRIMARY' of left side |
+-- |                                           Scan table customers (5 rows) |
+-- |                                              Scan table orders (3 rows) |
+EXPLAIN SELECT * FROM customers INNER JOIN orders ON customers.id = orders.customer;
+
+-- output:
+-- | id | name | id |  customer |
+-- | 20 |    b |  1 | 20.000000 |
+SELECT * FROM customers INNER JOIN orders ON customers.id = orders.customer;
+
+-- Unmatched customers must be output too, so the index can't be used
+-- output:
+-- |                                            plan |
+-- | Hash join (RIGHT JOIN), hash table of left side |
+-- |                      Scan table orders (3 rows) |
+-- |                   Scan table customers (5 rows) |
+EXPLAIN SELECT * FROM orders RIGHT JOIN customers ON orders.customer = customers.id;
+
+CREATE INDEX by_id ON customers (id);
+CREATE INDEX by_customer ON orders (customer);
+
+-- Ordered indexes of both sides are merged
+-- output:
+-- |                                                                                                  plan |
+-- | Merge join (FULL OUTER JOIN), left side read by index 'by_customer', right side read by index 'by_id' |
+-- |                                                                            Scan table orders (3 rows) |
+-- |                                                                         Scan table customers (5 rows) |
+EXPLAIN SELECT * FROM orders FULL OUTER JOIN customers ON orders.customer = customers.id;
+
+-- output:
+-- |   id |  customer |   id | name |
+-- |    3 |      null | null | null |
+-- | null |      null |   10 |    a |
+-- |    2 | 10.500000 | null | null |
+-- |    1 | 20.000000 |   20 |    b |
+-- | null |      null |   30 |    c |
+-- | null |      null |   40 |    d |
+-- | null |      null |   50 |    e |
+SELECT * FROM orders FULL OUTER JOIN customers ON orders.customer = customers.id;
+
+-- Subqueries sorted by the key are merged
+-- output:
+-- |                                                              plan |
+-- | Merge join (FULL OUTER JOIN), left side sorted, right side sorted |
+-- |                             Subquery (3 rows), sorted by customer |
+-- |                                   Subquery (5 rows), sorted by id |
+EXPLAIN SELECT * FROM (SELECT * FROM orders ORDER BY customer) FULL OUTER JOIN (SELECT * FROM customers ORDER BY id) ON customer = id;
+
+-- output:
+-- |   id |  customer |   id | name |
+-- |    3 |      null | null | null |
+-- | null |      null |   10 |    a |
+-- |    2 | 10.500000 | null | null |
+-- |    1 | 20.000000 |   20 |    b |
+-- | null |      null |   30 |    c |
+-- | null |      null |   40 |    d |
+-- | null |      null |   50 |    e |
+SELECT * FROM (SELECT * FROM orders ORDER BY customer) FULL OUTER JOIN (SELECT * FROM customers ORDER BY id) ON customer = id;
+
+-- Sorted by other column than the key
+-- output:
+-- |                                                  plan |
+-- | Hash join (FULL OUTER JOIN), hash table of right side |
+-- |                     Subquery (5 rows), sorted by name |
+-- |                 Subquery (3 rows), sorted by customer |
+EXPLAIN SELECT * FROM (SELECT id AS cid, name FROM customers ORDER BY name) FULL OUTER JOIN (SELECT * FROM orders ORDER BY customer) ON cid = customer;
+
+-- output:
+-- |     plan |
+-- | No table |
+EXPLAIN SELECT 1;
@@ -103,3 +103,29 @@ SELECT number AS number_alias FROM test ORDER BY number DESC;
 -- |  5 |
 -- |  2 |
 SELECT id FROM test ORDER BY number DESC;
+
+-- Order by with TOP, ties keep the table order
+-- output:
+-- | id | number |
+-- |  6 |   1234 |
+-- |  3 |    420 |
+-- |  0 |     69 |
+-- |  4 |     69 |
+SELECT TOP 4 id, number FROM test WHERE id > 2 OR number < 100 ORDER BY number DESC;
+
+-- Order by with TOP larger than the table
+-- output:
+-- | id | number |
+-- |  2 |   null |
+-- |  0 |     69 |
+-- |  4 |     69 |
+-- |  5 |     69 |
+-- |  3 |    420 |
+-- |  6 |   1234 |
+-- |  1 |   2137 |
+SELECT TOP 10 id, number FROM test ORDER BY number;
+
+-- Order by with TOP 0
+-- output:
+-- Empty result set
+SELECT TOP 0 id FROM test ORDER BY number;
@@ -0,0 +1,21 @@
+CREATE TABLE test (id INT);
+INSERT INTO test (id) VALUES (1);
+INSERT INTO test (id) VALUES (2);
+INSERT INTO test (id) VALUES (0);
+
+-- Rows after TOP are not computed
+-- output:
+-- | (10 / id) |
+-- |        10 |
+-- |         5 |
+SELECT TOP 2 10 / id FROM test;
+
+-- error: Cannot divide by 0
+SELECT TOP 2 10 / id FROM test ORDER BY id;
+
+-- error: Cannot divide by 0
+SELECT TOP 3 10 / id FROM test;
+
+-- Only two rows of subqueries are computed
+-- error: Select expression must return a single row with a single value
+SELECT (SELECT 10 / id FROM test);
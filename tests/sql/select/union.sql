@@ -15,7 +15,6 @@ INSERT INTO test (id, number, integer, date) VALUES (3, 420, 100, #1990-02-12#);
 -- |  4 |   69 | test1 |
 -- |  5 |   69 | test2 |
 -- |  3 |  420 |  null |
--- |  3 |  420 |  null |
 -- |  1 | 2137 |  null |
 SELECT id AS ID, number AS NUM, string AS STR FROM test ORDER BY number ASC UNION SELECT id AS ID, number AS NUM, string AS STR FROM test ORDER BY number DESC
 
@@ -37,3 +36,43 @@ SELECT id AS ID, number AS NUM, string AS STR FROM test ORDER BY number ASC UNIO
 -- |  5 |   69 | test2 |
 -- |  2 | null |  null |
 SELECT id AS ID, number AS NUM, string AS STR FROM test ORDER BY number ASC UNION ALL SELECT id AS ID, number AS NUM, string AS STR FROM test ORDER BY number DESC
+
+-- Union removes duplicates of both sides
+-- output:
+-- | NUM |
+-- |  69 |
+-- | 420 |
+-- |   1 |
+SELECT number AS NUM FROM test WHERE number < 1000 AND number IS NOT NULL UNION SELECT id AS NUM FROM test WHERE id = 1;
+
+-- Intersect
+-- output:
+-- |  NUM |
+-- | 2137 |
+-- |  420 |
+SELECT number AS NUM FROM test INTERSECT SELECT number AS NUM FROM test WHERE number > 100;
+
+-- Except
+-- output:
+-- | NUM |
+-- |  69 |
+-- | 420 |
+SELECT number AS NUM FROM test EXCEPT SELECT number AS NUM FROM test WHERE number > 1000 OR number IS NULL;
+
+-- Intersect is evaluated first
+-- output:
+-- | ID |
+-- |  0 |
+-- |  1 |
+-- |  4 |
+SELECT id AS ID FROM test WHERE id < 2 UNION SELECT id AS ID FROM test INTERSECT SELECT id AS ID FROM test WHERE id = 4;
+
+-- Chains are evaluated from left to right
+-- output:
+-- | ID |
+-- |  0 |
+-- |  2 |
+SELECT id AS ID FROM test WHERE id < 3 EXCEPT SELECT id AS ID FROM test WHERE id = 1 UNION SELECT id AS ID FROM test WHERE id = 2;
+
+-- error: Queries with different column count
+SELECT id, number FROM test INTERSECT SELECT id FROM test;
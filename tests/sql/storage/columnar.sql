@@ -0,0 +1,34 @@
+CREATE TABLE test (id INT PRIMARY KEY, name VARCHAR, score FLOAT, active BOOL) ENGINE COLUMNAR;
+INSERT INTO test (id, name, score, active) VALUES (1, 'a', 1.5, true);
+INSERT INTO test (id, name, score, active) VALUES (2, 'b', NULL, false);
+INSERT INTO test (id, name, score, active) VALUES (3, 'a', 3.5, NULL);
+INSERT INTO test (id, name, score, active) VALUES (4, NULL, 4.5, true);
+
+-- error: Primary key must be unique
+INSERT INTO test (id, name, score, active) VALUES (1, 'x', 0.5, true);
+
+DELETE FROM test WHERE id = 2;
+UPDATE test SET score = score * 2;
+INSERT INTO test (id, name, score, active) VALUES (2, 'c', 2.5, false);
+
+-- Values that can't be converted to the column type are not stored as NULL
+-- error: 'x' is not a valid float
+UPDATE test SET score = 'x';
+
+-- output:
+-- | id | name |    score | active |
+-- |  1 |    a | 3.000000 |   true |
+-- |  3 |    a | 7.000000 |   null |
+-- |  4 | null | 9.000000 |   true |
+-- |  2 |    c | 2.500000 |  false |
+SELECT * FROM test;
+
+-- output:
+-- | name | SUM(score) |
+-- | null |   9.000000 |
+-- |    a |  10.000000 |
+-- |    c |   2.500000 |
+SELECT name, SUM(score) FROM test GROUP BY name;
+
+-- error: Checks are not supported by the columnar engine
+CREATE TABLE checked (id INT CHECK id > 0) ENGINE COLUMNAR;
@@ -0,0 +1,21 @@
+CREATE TABLE test (id INT, name VARCHAR, score FLOAT, amount INT) ENGINE COLUMNAR;
+INSERT INTO test (id, name, score, amount) VALUES (1, 'a', 1.5, 10);
+INSERT INTO test (id, name, score, amount) VALUES (2, 'b', NULL, 0);
+INSERT INTO test (id, name, score, amount) VALUES (3, 'a', 3.5, NULL);
+INSERT INTO test (id, name, score, amount) VALUES (4, NULL, 4.5, 40);
+INSERT INTO test (id, name, score, amount) VALUES (5, 'c', 5.5, 50);
+DELETE FROM test WHERE id = 5;
+
+-- output:
+-- | COUNT(amount) | SUM(amount) | MIN(amount) | MAX(amount) |
+-- |             2 |          40 |    0.000000 |   40.000000 |
+SELECT COUNT(amount), SUM(amount), MIN(amount), MAX(amount) FROM test WHERE id > 1;
+
+-- output:
+-- | COUNT(score) | SUM(score) | MIN(score) | MAX(score) |
+-- |            2 |   6.000000 |   1.500000 |   4.500000 |
+SELECT COUNT(score), SUM(score), MIN(score), MAX(score) FROM test WHERE amount > 5;
+
+-- output:
+-- Empty result set
+SELECT COUNT(id), MAX(score) FROM test WHERE amount BETWEEN 1 AND 5;
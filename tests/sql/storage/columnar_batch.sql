@@ -0,0 +1,35 @@
+CREATE TABLE test (id INT, name VARCHAR, score FLOAT, amount INT) ENGINE COLUMNAR;
+INSERT INTO test (id, name, score, amount) VALUES (1, 'a', 1.5, 10);
+INSERT INTO test (id, name, score, amount) VALUES (2, 'b', NULL, 0);
+INSERT INTO test (id, name, score, amount) VALUES (3, 'a', 3.5, NULL);
+INSERT INTO test (id, name, score, amount) VALUES (4, NULL, 4.5, 40);
+INSERT INTO test (id, name, score, amount) VALUES (5, 'c', 5.5, 50);
+DELETE FROM test WHERE id = 5;
+
+-- output:
+-- | id |    x |
+-- |  1 |   21 |
+-- |  2 |    2 |
+-- |  3 | null |
+-- |  4 |   84 |
+SELECT id, amount * 2 + id AS [x] FROM test WHERE score < 4 OR name IS NULL;
+
+-- output:
+-- | id |
+-- |  2 |
+SELECT id FROM test WHERE amount = 0;
+
+-- output:
+-- | id |
+-- |  1 |
+SELECT id FROM test WHERE amount BETWEEN 5 AND 40 AND name IN ('a', 'b');
+
+-- output:
+-- | id |
+-- |  2 |
+-- |  3 |
+-- |  4 |
+SELECT id FROM test WHERE id IN (2, 4, 5) OR score > 3;
+
+-- error: Cannot divide by 0
+SELECT id, 100 / amount FROM test WHERE id != 3;
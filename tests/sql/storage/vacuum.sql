@@ -0,0 +1,32 @@
+CREATE TABLE test (id INT PRIMARY KEY, name VARCHAR);
+INSERT INTO test (id, name) VALUES (1, 'first');
+INSERT INTO test (id, name) VALUES (2, 'second');
+INSERT INTO test (id, name) VALUES (3, 'third');
+INSERT INTO test (id, name) VALUES (4, 'fourth');
+DELETE FROM test WHERE id = 1 OR id = 3;
+VACUUM test;
+
+-- Rows are kept in order
+-- output:
+-- | id |   name |
+-- |  2 | second |
+-- |  4 | fourth |
+SELECT * FROM test;
+
+-- output:
+-- | id |   name |
+-- |  4 | fourth |
+SELECT * FROM test WHERE id = 4;
+
+INSERT INTO test (id, name) VALUES (5, 'fifth');
+VACUUM;
+
+-- output:
+-- | id |   name |
+-- |  2 | second |
+-- |  4 | fourth |
+-- |  5 |  fifth |
+SELECT * FROM test;
+
+-- error: Nonexistent table: missing
+VACUUM missing;
@@ -30,7 +30,7 @@ DbErrorOr<void> csv_export_import() {
     table->export_to_csv("test.csv");
 
     auto new_table = TRY(db.import_to_table("test.csv", "newtest", Db::Core::ImportMode::Csv, Db::Core::DatabaseEngine::Memory));
-    auto result = TRY(Db::Sql::run_query(db, "SELECT * FROM newtest;").map_error(sql_to_db_error)).as_result_set();
+    auto result = TRY(TRY(Db::Sql::run_query(db, "SELECT * FROM newtest;").map_error(sql_to_db_error)).collect().map_error(sql_to_db_error)).as_result_set();
 
     TRY(expect_equal(table->size(), new_table->size(), "original and imported tables have equal sizes"));
     TRY(expect(result.column_names() == std::vector<std::string> { "id", "number", "string", "integer" }, "columns have proper names"));
@@ -41,13 +41,13 @@ DbErrorOr<void> csv_export_import() {
 DbErrorOr<void> csv_export_import_with_aliases() {
     auto db = TRY(setup_db());
 
-    auto result = TRY(Db::Sql::run_query(db, "SELECT id AS [ID], number AS [NUM], string AS [STR], integer AS [INT] FROM test;").map_error(sql_to_db_error)).as_result_set();
+    auto result = TRY(TRY(Db::Sql::run_query(db, "SELECT id AS [ID], number AS [NUM], string AS [STR], integer AS [INT] FROM test;").map_error(sql_to_db_error)).collect().map_error(sql_to_db_error)).as_result_set();
     result.dump(std::cout, Db::Core::ResultSet::FancyDump::Yes);
     auto table = TRY(db.create_table_from_query(result, "test_from_query"));
     table->export_to_csv("test.csv");
 
     auto new_table = TRY(db.import_to_table("test.csv", "new_test", Db::Core::ImportMode::Csv, Db::Core::DatabaseEngine::Memory));
-    result = TRY(Db::Sql::run_query(db, "SELECT * FROM [new_test];").map_error(sql_to_db_error)).as_result_set();
+    result = TRY(TRY(Db::Sql::run_query(db, "SELECT * FROM [new_test];").map_error(sql_to_db_error)).collect().map_error(sql_to_db_error)).as_result_set();
     result.dump(std::cout, Db::Core::ResultSet::FancyDump::Yes);
 
     TRY(expect_equal(table->size(), new_table->size(), "original and imported tables have equal sizes"));
@@ -59,14 +59,14 @@ DbErrorOr<void> csv_export_import_with_aliases() {
 DbErrorOr<void> csv_import_statement() {
     auto db = TRY(setup_db());
 
-    auto result = TRY(Db::Sql::run_query(db, "SELECT id AS [ID], number AS [NUM], string AS [STR], integer AS [INT] FROM test;").map_error(sql_to_db_error)).as_result_set();
+    auto result = TRY(TRY(Db::Sql::run_query(db, "SELECT id AS [ID], number AS [NUM], string AS [STR], integer AS [INT] FROM test;").map_error(sql_to_db_error)).collect().map_error(sql_to_db_error)).as_result_set();
     result.dump(std::cout, Db::Core::ResultSet::FancyDump::Yes);
     auto table = TRY(db.create_table_from_query(result, "test_from_query"));
     table->export_to_csv("test.csv");
 
     TRY(Db::Sql::run_query(db, "IMPORT CSV 'test.csv' INTO new_test").map_error(sql_to_db_error));
 
-    result = TRY(Db::Sql::run_query(db, "SELECT * FROM [new_test];").map_error(sql_to_db_error)).as_result_set();
+    result = TRY(TRY(Db::Sql::run_query(db, "SELECT * FROM [new_test];").map_error(sql_to_db_error)).collect().map_error(sql_to_db_error)).as_result_set();
     result.dump(std::cout, Db::Core::ResultSet::FancyDump::Yes);
 
     auto new_table = TRY(db.table("new_test"));
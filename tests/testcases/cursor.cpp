@@ -0,0 +1,89 @@
+#include <tests/setup.hpp>
+
+#include <db/core/Database.hpp>
+#include <db/sql/SQL.hpp>
+
+#include <fmt/format.h>
+
+using namespace Db::Core;
+
+auto sql_to_db_error(Db::Sql::SQLError&& e) { return DbError { e.message() }; }
+
+DbErrorOr<Database> setup_db(size_t size) {
+    Database db = Database::create_memory_backed();
+    TRY(Db::Sql::run_query(db, "CREATE TABLE test (id INT, string VARCHAR)").map_error(sql_to_db_error));
+    for (size_t s = 0; s < size; s++) {
+        TRY(Db::Sql::run_query(db, fmt::format("INSERT INTO test (id, string) VALUES ({}, 'row{}')", s, s)).map_error(sql_to_db_error));
+    }
+    return db;
+}
+
+DbErrorOr<void> cursor_batches() {
+    auto db = TRY(setup_db(25));
+    auto cursor = TRY(Db::Sql::run_query(db, "SELECT id FROM test WHERE id < 13").map_error(sql_to_db_error));
+    TRY(expect(!cursor.is_value(), "SELECT returns rows"));
+    TRY(expect(cursor.column_names() == std::vector<std::string> { "id" }, "columns have proper names"));
+
+    std::vector<size_t> batch_sizes;
+    int expected_id = 0;
+    while (true) {
+        auto batch = TRY(cursor.next_batch(5).map_error(sql_to_db_error));
+        if (batch.empty()) {
+            break;
+        }
+        batch_sizes.push_back(batch.size());
+        for (auto const& row : batch) {
+            TRY(expect_equal(TRY(row.value(0).to_int()), expected_id, "rows are returned in order"));
+            expected_id++;
+        }
+    }
+    TRY(expect(batch_sizes == std::vector<size_t> { 5, 5, 3 }, "rows are split into batches"));
+    TRY(expect(TRY(cursor.next_batch().map_error(sql_to_db_error)).empty(), "no rows after the end"));
+    return {};
+}
+
+DbErrorOr<void> cursor_collect_rest() {
+    auto db = TRY(setup_db(10));
+    auto cursor = TRY(Db::Sql::run_query(db, "SELECT * FROM test").map_error(sql_to_db_error));
+    TRY(expect_equal(TRY(cursor.next_batch(4).map_error(sql_to_db_error)).size(), (size_t)4, "first batch"));
+    auto rest = TRY(cursor.collect().map_error(sql_to_db_error));
+    TRY(expect(rest.is_result_set(), "collect returns a result set"));
+    TRY(expect_equal(rest.as_result_set().rows().size(), (size_t)6, "collect returns remaining rows"));
+    return {};
+}
+
+DbErrorOr<void> cursor_value() {
+    auto db = TRY(setup_db(0));
+    auto cursor = TRY(Db::Sql::run_query(db, "INSERT INTO test (id, string) VALUES (1, 'row1')").map_error(sql_to_db_error));
+    TRY(expect(cursor.is_value(), "INSERT returns a value"));
+    TRY(expect_equal(TRY(db.table("test"))->size(), (size_t)1, "statement is run when the cursor is created"));
+    TRY(expect(TRY(cursor.next_batch().map_error(sql_to_db_error)).empty(), "value has no rows"));
+    return {};
+}
+
+DbErrorOr<void> cursor_outlives_write() {
+    auto db = TRY(setup_db(20));
+    auto cursor = TRY(Db::Sql::run_query(db, "SELECT id FROM test").map_error(sql_to_db_error));
+    TRY(expect_equal(TRY(cursor.next_batch(5).map_error(sql_to_db_error)).size(), (size_t)5, "first batch"));
+
+    // Rows that weren't read yet are removed and changed.
+    TRY(Db::Sql::run_query(db, "DELETE FROM test WHERE id > 14").map_error(sql_to_db_error));
+    TRY(Db::Sql::run_query(db, "UPDATE test SET id = 100").map_error(sql_to_db_error));
+
+    auto rest = TRY(cursor.collect().map_error(sql_to_db_error));
+    auto const& rows = rest.as_result_set().rows();
+    TRY(expect_equal(rows.size(), (size_t)15, "rows are read before the write"));
+    for (size_t s = 0; s < rows.size(); s++) {
+        TRY(expect_equal(TRY(rows[s].value(0).to_int()), static_cast<int>(s + 5), "rows are not changed by the write"));
+    }
+    return {};
+}
+
+std::map<std::string, TestFunc> get_tests() {
+    return {
+        { "cursor_batches", cursor_batches },
+        { "cursor_collect_rest", cursor_collect_rest },
+        { "cursor_value", cursor_value },
+        { "cursor_outlives_write", cursor_outlives_write },
+    };
+}
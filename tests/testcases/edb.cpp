@@ -0,0 +1,539 @@
+#include <tests/setup.hpp>
+
+#include <db/core/Database.hpp>
+#include <db/sql/SQL.hpp>
+#include <db/storage/edb/Definitions.hpp>
+#include <db/storage/edb/WriteAheadLog.hpp>
+
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace Db::Core;
+
+auto sql_to_db_error(Db::Sql::SQLError&& e) { return DbError { e.message() }; }
+
+static DbErrorOr<void> run(Database& db, std::string const& query) {
+    TRY(Db::Sql::run_query(db, query).map_error(sql_to_db_error));
+    return {};
+}
+
+static DbErrorOr<void> insert_rows(Table& table, int first, int count) {
+    for (int s = first; s < first + count; s++) {
+        TRY(table.insert_unchecked(Tuple { Value::create_int(s), Value::create_int(s * 2) }));
+    }
+    return {};
+}
+
+static DbErrorOr<Database> open_database(std::filesystem::path const& path) {
+    return Database::create_or_open_file_backed(path.string()).map_error([](Util::OsError const& error) {
+        return DbError { fmt::format("{}", error) };
+    });
+}
+
+// Runs `callback` with a file-backed database in a fresh directory.
+template<class Callback>
+static DbErrorOr<void> with_database(std::string const& name, Callback&& callback) {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-{}-{}", name, getpid());
+    std::filesystem::remove_all(path);
+    DbErrorOr<void> result;
+    {
+        auto db = TRY(open_database(path));
+        result = callback(db, path / "test.edb");
+    }
+    std::filesystem::remove_all(path);
+    return result;
+}
+
+DbErrorOr<void> removed_rows_are_reused() {
+    return with_database("free-space", [](Database& db, std::filesystem::path const& file) -> DbErrorOr<void> {
+        TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+        auto table = TRY(db.table("test"));
+        TRY(insert_rows(*table, 0, 1000));
+        auto size = std::filesystem::file_size(file);
+
+        // Free rows in all blocks and fill them again.
+        TRY(run(db, "DELETE FROM test WHERE id > 100 AND id < 900"));
+        TRY(expect_equal(table->size(), (size_t)201, "rows are removed"));
+        TRY(insert_rows(*table, 101, 799));
+        TRY(expect_equal(table->size(), (size_t)1000, "rows are inserted"));
+        TRY(expect_equal(std::filesystem::file_size(file), size, "unused rows are reused"));
+
+        size_t count = 0;
+        TRY(table->rows().try_for_each_row([&](Tuple const& row) -> DbErrorOr<void> {
+            auto id = TRY(row.value(0).to_int());
+            TRY(expect_equal(TRY(row.value(1).to_int()), id * 2, "rows are not changed"));
+            count++;
+            return {};
+        }));
+        TRY(expect_equal(count, (size_t)1000, "all rows are read"));
+        return {};
+    });
+}
+
+DbErrorOr<void> vacuum_truncates_file() {
+    return with_database("vacuum", [](Database& db, std::filesystem::path const& file) -> DbErrorOr<void> {
+        TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+        TRY(run(db, "CREATE INDEX by_id ON test (id)"));
+        auto table = TRY(db.table("test"));
+        TRY(insert_rows(*table, 0, 100));
+        auto size = std::filesystem::file_size(file);
+        TRY(insert_rows(*table, 100, 1900));
+
+        // Keep some rows at the end, so that they must be moved.
+        TRY(run(db, "DELETE FROM test WHERE id > 49 AND id < 1950"));
+        TRY(run(db, "VACUUM test"));
+        TRY(expect(std::filesystem::file_size(file) <= size, "file is truncated"));
+
+        int expected_id = 0;
+        TRY(table->rows().try_for_each_row([&](Tuple const& row) -> DbErrorOr<void> {
+            auto id = TRY(row.value(0).to_int());
+            TRY(expect_equal(id, expected_id, "rows are kept in order"));
+            TRY(expect_equal(TRY(row.value(1).to_int()), id * 2, "rows are not changed"));
+            expected_id = expected_id == 49 ? 1950 : expected_id + 1;
+            return {};
+        }));
+        TRY(expect_equal(expected_id, 2000, "all rows are read"));
+
+        auto index = table->index("by_id");
+        TRY(expect(index != nullptr, "index exists"));
+        auto ids = index->find_all(Tuple { Value::create_int(1990) });
+        TRY(expect_equal(ids.size(), (size_t)1, "moved row is found by index"));
+        TRY(expect_equal(TRY(table->read_row(ids[0]).value(1).to_int()), 1990 * 2, "index points to moved row"));
+
+        TRY(insert_rows(*table, 2000, 10));
+        TRY(expect_equal(table->size(), (size_t)110, "rows can be inserted after vacuum"));
+        return {};
+    });
+}
+
+// Reopens the database, checks rows and inserts `rows_to_insert` more.
+static DbErrorOr<void> reopen_and_insert(std::filesystem::path const& path, size_t expected_rows, int rows_to_insert) {
+    auto db = TRY(open_database(path));
+    auto table = TRY(db.table("test"));
+    TRY(expect_equal(table->size(), expected_rows, "all rows are kept"));
+    int expected_id = 0;
+    TRY(table->rows().try_for_each_row([&](Tuple const& row) -> DbErrorOr<void> {
+        TRY(expect_equal(TRY(row.value(0).to_int()), expected_id, "rows are kept in order"));
+        expected_id++;
+        return {};
+    }));
+    TRY(insert_rows(*table, expected_id, rows_to_insert));
+    return {};
+}
+
+DbErrorOr<void> grown_file_is_reopened() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-reopen-{}", getpid());
+    std::filesystem::remove_all(path);
+    auto result = [&]() -> DbErrorOr<void> {
+        {
+            auto db = TRY(open_database(path));
+            TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+            TRY(insert_rows(*TRY(db.table("test")), 0, 2000));
+        }
+        // Blocks reserved for growth must not be used as ones with rows.
+        TRY(reopen_and_insert(path, 2000, 1000));
+        TRY(reopen_and_insert(path, 3000, 0));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    return result;
+}
+
+// Copies the database directory while the database is open, which is what
+// would be left on the disk if the process crashed.
+static void copy_as_crashed(std::filesystem::path const& path, std::filesystem::path const& crashed_path) {
+    std::filesystem::remove_all(crashed_path);
+    std::filesystem::copy(path, crashed_path);
+}
+
+DbErrorOr<void> committed_rows_are_recovered() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-recovery-{}", getpid());
+    auto crashed_path = std::filesystem::temp_directory_path() / fmt::format("essadb-recovery-crashed-{}", getpid());
+    std::filesystem::remove_all(path);
+    auto result = [&]() -> DbErrorOr<void> {
+        auto db = TRY(open_database(path));
+        TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+        auto table = TRY(db.table("test"));
+        TRY(insert_rows(*table, 0, 500));
+        TRY(db.commit());
+        TRY(run(db, "DELETE FROM test WHERE id > 199"));
+        // Not committed, so it must not be recovered.
+        TRY(insert_rows(*table, 200, 100));
+
+        copy_as_crashed(path, crashed_path);
+        TRY(expect(std::filesystem::file_size(crashed_path / "wal.log") > 0, "changes are logged"));
+        TRY(reopen_and_insert(crashed_path, 200, 10));
+        TRY(reopen_and_insert(crashed_path, 210, 0));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    std::filesystem::remove_all(crashed_path);
+    return result;
+}
+
+DbErrorOr<void> torn_commit_is_ignored() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-torn-{}", getpid());
+    auto crashed_path = std::filesystem::temp_directory_path() / fmt::format("essadb-torn-crashed-{}", getpid());
+    std::filesystem::remove_all(path);
+    auto result = [&]() -> DbErrorOr<void> {
+        auto db = TRY(open_database(path));
+        TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+        auto table = TRY(db.table("test"));
+        TRY(insert_rows(*table, 0, 100));
+        TRY(db.commit());
+        auto committed_size = std::filesystem::file_size(path / "wal.log");
+        TRY(insert_rows(*table, 100, 100));
+        TRY(db.commit());
+        TRY(db.sync());
+
+        // Last commit is written only partially.
+        copy_as_crashed(path, crashed_path);
+        auto log_size = std::filesystem::file_size(crashed_path / "wal.log");
+        std::filesystem::resize_file(crashed_path / "wal.log", (committed_size + log_size) / 2);
+        TRY(reopen_and_insert(crashed_path, 100, 0));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    std::filesystem::remove_all(crashed_path);
+    return result;
+}
+
+DbErrorOr<void> rolled_back_changes_are_discarded() {
+    return with_database("rollback", [](Database& db, std::filesystem::path const&) -> DbErrorOr<void> {
+        TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+        TRY(run(db, "CREATE INDEX by_id ON test (id)"));
+        auto table = TRY(db.table("test"));
+        TRY(insert_rows(*table, 0, 100));
+        TRY(db.commit());
+
+        // Enough rows to expand the file.
+        TRY(db.begin_transaction());
+        TRY(insert_rows(*table, 100, 2000));
+        TRY(run(db, "DELETE FROM test WHERE id < 50"));
+        TRY(expect_equal(table->size(), (size_t)2050, "rows are changed in transaction"));
+        TRY(db.rollback_transaction());
+
+        TRY(expect_equal(table->size(), (size_t)100, "rows are restored"));
+        int expected_id = 0;
+        TRY(table->rows().try_for_each_row([&](Tuple const& row) -> DbErrorOr<void> {
+            TRY(expect_equal(TRY(row.value(0).to_int()), expected_id, "rows are kept in order"));
+            expected_id++;
+            return {};
+        }));
+        auto index = table->index("by_id");
+        TRY(expect(index != nullptr, "index exists"));
+        TRY(expect_equal(index->find_all(Tuple { Value::create_int(10) }).size(), (size_t)1, "removed row is indexed again"));
+        TRY(expect(index->find_all(Tuple { Value::create_int(1000) }).empty(), "inserted row is not indexed"));
+
+        TRY(insert_rows(*table, 100, 10));
+        TRY(expect_equal(table->size(), (size_t)110, "rows can be inserted after rollback"));
+        return {};
+    });
+}
+
+DbErrorOr<void> transaction_is_committed_at_once() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-transaction-{}", getpid());
+    auto crashed_path = std::filesystem::temp_directory_path() / fmt::format("essadb-transaction-crashed-{}", getpid());
+    std::filesystem::remove_all(path);
+    auto result = [&]() -> DbErrorOr<void> {
+        auto db = TRY(open_database(path));
+        TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+        auto table = TRY(db.table("test"));
+        TRY(db.begin_transaction());
+        TRY(insert_rows(*table, 0, 1000));
+        TRY(run(db, "UPDATE test SET number = 0"));
+        TRY(expect_equal(std::filesystem::file_size(path / "wal.log"), (uintmax_t)0, "changes are not logged before commit"));
+        TRY(db.commit_transaction());
+
+        // Not committed, so it must not be recovered.
+        TRY(db.begin_transaction());
+        TRY(insert_rows(*table, 1000, 100));
+        TRY(db.commit());
+
+        copy_as_crashed(path, crashed_path);
+        TRY(reopen_and_insert(crashed_path, 1000, 0));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    std::filesystem::remove_all(crashed_path);
+    return result;
+}
+
+DbErrorOr<void> only_changed_bytes_are_logged() {
+    return with_database("log-size", [](Database& db, std::filesystem::path const& file) -> DbErrorOr<void> {
+        auto log_path = file.parent_path() / "wal.log";
+        TRY(run(db, "CREATE TABLE test (id INT, name VARCHAR)"));
+        TRY(run(db, "CREATE INDEX by_id ON test (id)"));
+        for (int s = 0; s < 100; s++) {
+            TRY(run(db, fmt::format("INSERT INTO test (id, name) VALUES ({}, 'row{}')", s, s)));
+        }
+        auto size_before = std::filesystem::file_size(log_path);
+        TRY(run(db, "INSERT INTO test (id, name) VALUES (1000, 'row1000')"));
+        auto insert_size = std::filesystem::file_size(log_path) - size_before;
+        // Row, its heap string, index entries and headers are much smaller
+        // than the blocks that contain them.
+        TRY(expect(insert_size > 0 && insert_size < 1024, fmt::format("insert logs only changed bytes ({} bytes)", insert_size)));
+
+        size_before = std::filesystem::file_size(log_path);
+        TRY(run(db, "DELETE FROM test WHERE id = 1000"));
+        auto delete_size = std::filesystem::file_size(log_path) - size_before;
+        TRY(expect(delete_size > 0 && delete_size < 1024, fmt::format("delete logs only changed bytes ({} bytes)", delete_size)));
+
+        TRY(db.commit());
+        return {};
+    });
+}
+
+static auto os_error_to_db_error(Util::OsError&& error) { return DbError { fmt::format("{}", error) }; }
+
+DbErrorOr<void> commit_waits_for_sync() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-sync-{}", getpid());
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directories(path);
+    auto result = [&]() -> DbErrorOr<void> {
+        using Db::Storage::EDB::WriteAheadLog;
+        auto log = TRY(WriteAheadLog::open(path.string()).map_error(os_error_to_db_error));
+        std::vector<uint8_t> data(100, 0x55);
+
+        // Records of files that don't exist are skipped on replay.
+        log->log_write("missing.edb", 0, data);
+        TRY(log->commit().map_error(os_error_to_db_error));
+        TRY(expect(log->size() > 0, "commit is logged"));
+        TRY(expect_equal(log->synced_size(), log->size(), "commit is synced when it returns"));
+
+        log->set_asynchronous_commit(true);
+        for (size_t s = 0; s < 10; s++) {
+            log->log_write("missing.edb", s * data.size(), data);
+            TRY(log->commit().map_error(os_error_to_db_error));
+        }
+        // Whoever syncs first syncs for the others.
+        std::vector<std::thread> threads;
+        std::vector<Util::OsErrorOr<void>> results(4);
+        for (size_t s = 0; s < results.size(); s++) {
+            threads.emplace_back([&, s] { results[s] = log->sync(); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (auto& result : results) {
+            TRY(std::move(result).map_error(os_error_to_db_error));
+        }
+        TRY(expect_equal(log->synced_size(), log->size(), "asynchronous commits are synced"));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    return result;
+}
+
+// Checks that `index` on the number column finds rows with numbers in
+// [lower, upper) in order.
+static DbErrorOr<void> expect_index_range(Table& table, Index& index, int lower, int upper, size_t expected_rows) {
+    auto rows = index.find_range(Index::Bound { Tuple { Value::create_int(lower) }, true }, Index::Bound { Tuple { Value::create_int(upper) }, false });
+    TRY(expect_equal(rows.size(), expected_rows, "all rows in range are found"));
+    int last_number = lower - 1;
+    for (auto row : rows) {
+        auto number = TRY(table.read_row(row).value(1).to_int());
+        TRY(expect(number > last_number && number < upper, "rows are found in key order"));
+        last_number = number;
+    }
+    return {};
+}
+
+DbErrorOr<void> btree_is_split() {
+    return with_database("btree", [](Database& db, std::filesystem::path const&) -> DbErrorOr<void> {
+        TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+        TRY(run(db, "CREATE INDEX by_number ON test (number)"));
+        auto table = TRY(db.table("test"));
+        // Enough rows for the tree to have more than 2 levels, inserted in
+        // descending order so that leftmost leaves are split.
+        constexpr int RowCount = 20000;
+        for (int s = RowCount - 1; s >= 0; s--) {
+            TRY(table->insert_unchecked(Tuple { Value::create_int(s), Value::create_int(s * 2) }));
+        }
+        auto index = table->index("by_number");
+        TRY(expect(index != nullptr, "index exists"));
+        TRY(expect_index_range(*table, *index, 0, RowCount * 2, RowCount));
+        TRY(expect_index_range(*table, *index, 1000, 1200, 100));
+        for (int s = 0; s < RowCount; s += 997) {
+            auto rows = index->find_all(Tuple { Value::create_int(s * 2) });
+            TRY(expect_equal(rows.size(), (size_t)1, "row is found by key"));
+            TRY(expect_equal(TRY(table->read_row(rows[0]).value(0).to_int()), s, "key points to its row"));
+        }
+        TRY(expect(index->find_all(Tuple { Value::create_int(1) }).empty(), "missing key is not found"));
+
+        TRY(run(db, "DELETE FROM test WHERE id > 99 AND id < 19900"));
+        TRY(expect_index_range(*table, *index, 0, RowCount * 2, 200));
+        TRY(expect_index_range(*table, *index, 150, 39850, 50));
+        return {};
+    });
+}
+
+DbErrorOr<void> index_is_kept_after_reopen() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-index-{}", getpid());
+    std::filesystem::remove_all(path);
+    auto result = [&]() -> DbErrorOr<void> {
+        {
+            auto db = TRY(open_database(path));
+            TRY(run(db, "CREATE TABLE test (id INT, number INT)"));
+            auto table = TRY(db.table("test"));
+            TRY(insert_rows(*table, 0, 1000));
+            TRY(run(db, "CREATE INDEX by_number ON test (number)"));
+        }
+        {
+            auto db = TRY(open_database(path));
+            auto table = TRY(db.table("test"));
+            auto index = table->index("by_number");
+            TRY(expect(index != nullptr, "index is loaded"));
+            TRY(expect_index_range(*table, *index, 0, 2000, 1000));
+            TRY(insert_rows(*table, 1000, 1000));
+        }
+        auto db = TRY(open_database(path));
+        auto table = TRY(db.table("test"));
+        auto index = table->index("by_number");
+        TRY(expect(index != nullptr, "index is loaded again"));
+        TRY(expect_index_range(*table, *index, 0, 4000, 2000));
+        TRY(expect_index_range(*table, *index, 1990, 2010, 10));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    return result;
+}
+
+// Writes a file laid out like version 1 did, with (id INT NOT NULL,
+// name VARCHAR) columns and a row for every name.
+static void write_version_1_file(std::filesystem::path const& path, uint16_t version, std::vector<std::string> const& names) {
+    using namespace Db::Storage::EDB;
+    namespace EDB = Db::Storage::EDB;
+    constexpr uint32_t BlockSize = 512;
+    constexpr size_t RowSize = sizeof(Table::RowSpec) + 4 + 1 + sizeof(HeapSpan);
+
+    std::vector<uint8_t> table_block(BlockSize);
+    std::vector<uint8_t> heap_block(BlockSize);
+    auto write_block_header = [](std::vector<uint8_t>& block, BlockType type) {
+        Block header { .type = type, .prev_block = 0, .next_block = 0 };
+        std::memcpy(block.data(), &header, sizeof(Block));
+    };
+    write_block_header(table_block, BlockType::Table);
+    write_block_header(heap_block, BlockType::Heap);
+    size_t heap_size = sizeof(Block);
+    auto copy_to_heap = [&](std::string const& string) {
+        HeapSpan span { .offset = { .block = 2, .offset = static_cast<uint32_t>(heap_size) }, .size = string.size() };
+        std::memcpy(heap_block.data() + heap_size, string.data(), string.size());
+        heap_size += string.size();
+        return span;
+    };
+
+    EDBHeaderV1 header {};
+    std::copy(std::begin(Magic), std::end(Magic), header.magic);
+    header.version = version;
+    header.block_size = BlockSize;
+    header.row_count = names.size();
+    header.column_count = 2;
+    header.last_table_block = 1;
+    header.last_heap_block = 2;
+    header.table_name = copy_to_heap("test");
+
+    EDB::Column columns[2] {};
+    columns[0].column_name = copy_to_heap("id");
+    columns[0].type = static_cast<uint8_t>(Db::Core::Value::Type::Int);
+    columns[0].not_null = true;
+    columns[1].column_name = copy_to_heap("name");
+    columns[1].type = static_cast<uint8_t>(Db::Core::Value::Type::Varchar);
+
+    // Table block starts with the count of rows.
+    table_block[sizeof(Block)] = names.size();
+    for (size_t s = 0; s < names.size(); s++) {
+        uint32_t offset = sizeof(Block) + 1 + s * RowSize;
+        HeapPtr next_row {};
+        if (s + 1 < names.size()) {
+            next_row = { .block = 1, .offset = static_cast<uint32_t>(offset + RowSize) };
+        }
+        if (s == 0) {
+            header.first_row_ptr = { .block = 1, .offset = offset };
+        }
+        header.last_row_ptr = { .block = 1, .offset = offset };
+
+        auto row = table_block.data() + offset;
+        std::memcpy(row, &next_row, sizeof(HeapPtr));
+        row[sizeof(HeapPtr)] = 1;
+        row += sizeof(Table::RowSpec);
+        LittleEndian<uint32_t> id = s;
+        std::memcpy(row, &id, 4);
+        row[4] = false;
+        auto name = copy_to_heap(names[s]);
+        std::memcpy(row + 5, &name, sizeof(HeapSpan));
+    }
+
+    std::ofstream file { path, std::ios::binary };
+    file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    file.write(reinterpret_cast<char const*>(columns), sizeof(columns));
+    file.write(reinterpret_cast<char const*>(table_block.data()), table_block.size());
+    file.write(reinterpret_cast<char const*>(heap_block.data()), heap_block.size());
+}
+
+DbErrorOr<void> version_1_file_is_upgraded() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-upgrade-{}", getpid());
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directory(path);
+    std::vector<std::string> names { "first", "second", "third" };
+    write_version_1_file(path / "test.edb", 1, names);
+    auto result = [&]() -> DbErrorOr<void> {
+        {
+            auto db = TRY(open_database(path));
+            auto table = TRY(db.table("test"));
+            TRY(expect_equal(table->size(), names.size(), "all rows are upgraded"));
+            size_t index = 0;
+            TRY(table->rows().try_for_each_row([&](Tuple const& row) -> DbErrorOr<void> {
+                TRY(expect_equal(TRY(row.value(0).to_int()), static_cast<int>(index), "INT is upgraded"));
+                TRY(expect_equal(TRY(row.value(1).to_string()), names[index], "VARCHAR is upgraded"));
+                index++;
+                return {};
+            }));
+            TRY(run(db, "INSERT INTO test (id, name) VALUES (3, 'fourth')"));
+        }
+        auto db = TRY(open_database(path));
+        TRY(expect_equal(TRY(db.table("test"))->size(), (size_t)4, "upgraded file is reopened"));
+        TRY(expect(!std::filesystem::exists(path / "test.edb.upgrade"), "upgraded file replaces the old one"));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    return result;
+}
+
+DbErrorOr<void> unknown_version_is_rejected() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-version-{}", getpid());
+    std::filesystem::remove_all(path);
+    std::filesystem::create_directory(path);
+    write_version_1_file(path / "test.edb", 0x1234, { "first" });
+    auto result = [&]() -> DbErrorOr<void> {
+        auto db = open_database(path);
+        TRY(expect(db.is_error(), "file of unknown version is not opened"));
+        auto message = db.release_error().message();
+        TRY(expect(message.find("version 4660 (expected 2)") != std::string::npos, fmt::format("error has versions ({})", message)));
+        return {};
+    }();
+    std::filesystem::remove_all(path);
+    return result;
+}
+
+std::map<std::string, TestFunc> get_tests() {
+    return {
+        { "removed_rows_are_reused", removed_rows_are_reused },
+        { "vacuum_truncates_file", vacuum_truncates_file },
+        { "grown_file_is_reopened", grown_file_is_reopened },
+        { "committed_rows_are_recovered", committed_rows_are_recovered },
+        { "torn_commit_is_ignored", torn_commit_is_ignored },
+        { "rolled_back_changes_are_discarded", rolled_back_changes_are_discarded },
+        { "transaction_is_committed_at_once", transaction_is_committed_at_once },
+        { "commit_waits_for_sync", commit_waits_for_sync },
+        { "only_changed_bytes_are_logged", only_changed_bytes_are_logged },
+        { "btree_is_split", btree_is_split },
+        { "index_is_kept_after_reopen", index_is_kept_after_reopen },
+        { "version_1_file_is_upgraded", version_1_file_is_upgraded },
+        { "unknown_version_is_rejected", unknown_version_is_rejected },
+    };
+}
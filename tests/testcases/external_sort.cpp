@@ -0,0 +1,122 @@
+#include <tests/setup.hpp>
+
+#include <db/core/Database.hpp>
+#include <db/core/ExternalSort.hpp>
+#include <db/core/SortKey.hpp>
+#include <db/sql/SQL.hpp>
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <random>
+#include <set>
+
+using namespace Db::Core;
+
+// Sorts rows of (key, index) by key with the sorter and checks that the
+// result matches a stable in-memory sort.
+static DbErrorOr<size_t> sort_and_check(size_t size, size_t memory_budget) {
+    std::mt19937 random { static_cast<unsigned>(size) };
+    std::uniform_int_distribution<int> distribution { 0, static_cast<int>(size / 4) };
+    SortKeyEncoder encoder { { false } };
+
+    ExternalSorter sorter { memory_budget };
+    std::vector<std::pair<std::string, int>> expected;
+    for (size_t s = 0; s < size; s++) {
+        auto key = encoder.encode({ Value::create_int(distribution(random)) });
+        expected.emplace_back(key, static_cast<int>(s));
+        TRY(sorter.add(key, Tuple { Value::create_int(static_cast<int>(s)), Value::create_varchar(fmt::format("row {}", s)) }));
+    }
+    TRY(sorter.finish());
+    TRY(expect_equal(sorter.row_count(), size, "all rows are counted"));
+
+    std::stable_sort(expected.begin(), expected.end(), [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; });
+    for (auto const& [key, index] : expected) {
+        auto row = TRY(sorter.next());
+        TRY(expect(row.has_value(), "sorter returns all rows"));
+        TRY(expect_equal(TRY(row->value(0).to_int()), index, "rows are sorted stably"));
+        TRY(expect_equal(TRY(row->value(1).to_string()), fmt::format("row {}", index), "rows are not changed"));
+    }
+    TRY(expect(!TRY(sorter.next()).has_value(), "no rows after the last one"));
+    return sorter.spilled_run_count();
+}
+
+DbErrorOr<void> in_memory_sort() {
+    auto runs = TRY(sort_and_check(1000, DefaultSortMemoryBudget));
+    TRY(expect_equal(runs, (size_t)0, "rows are not spilled"));
+    return {};
+}
+
+DbErrorOr<void> spilled_sort() {
+    auto runs = TRY(sort_and_check(5000, 32 * 1024));
+    TRY(expect(runs > 2, "rows are spilled to multiple runs"));
+    return {};
+}
+
+DbErrorOr<void> empty_sort() {
+    TRY(sort_and_check(0, DefaultSortMemoryBudget));
+    TRY(sort_and_check(0, 0));
+    return {};
+}
+
+auto sql_to_db_error(Db::Sql::SQLError&& e) { return DbError { e.message() }; }
+
+// Runs a query and returns values of the first column.
+static DbErrorOr<std::vector<Value>> query_column(Database& db, std::string const& query) {
+    auto result = TRY(Db::Sql::run_query(db, query).map_error(sql_to_db_error));
+    auto collected = TRY(result.collect().map_error(sql_to_db_error));
+    std::vector<Value> values;
+    for (auto const& row : collected.as_result_set().rows()) {
+        values.push_back(row.value(0));
+    }
+    return values;
+}
+
+static DbErrorOr<Database> setup_names_db(size_t sort_memory_budget) {
+    auto db = Database::create_memory_backed();
+    db.set_sort_memory_budget(sort_memory_budget);
+    TRY(Db::Sql::run_query(db, "CREATE TABLE test (id INT, name VARCHAR)").map_error(sql_to_db_error));
+    for (int s = 0; s < 2000; s++) {
+        TRY(Db::Sql::run_query(db, fmt::format("INSERT INTO test (id, name) VALUES ({}, 'name{}')", s, (s * 7) % 300)).map_error(sql_to_db_error));
+    }
+    return db;
+}
+
+DbErrorOr<void> spilled_distinct() {
+    auto db = TRY(setup_names_db(4 * 1024));
+    auto names = TRY(query_column(db, "SELECT DISTINCT name FROM test"));
+    TRY(expect_equal(names.size(), (size_t)300, "every name is returned once"));
+    std::set<std::string> unique_names;
+    for (auto const& name : names) {
+        unique_names.insert(TRY(name.to_string()));
+    }
+    TRY(expect_equal(unique_names.size(), (size_t)300, "names are not repeated"));
+
+    auto sorted_names = TRY(query_column(db, "SELECT DISTINCT name FROM test ORDER BY name"));
+    TRY(expect_equal(sorted_names.size(), (size_t)300, "every sorted name is returned once"));
+    for (size_t s = 1; s < sorted_names.size(); s++) {
+        TRY(expect(TRY(sorted_names[s - 1].to_string()) < TRY(sorted_names[s].to_string()), "names are sorted"));
+    }
+    return {};
+}
+
+DbErrorOr<void> spilled_order_by() {
+    auto db = TRY(setup_names_db(4 * 1024));
+    auto ids = TRY(query_column(db, "SELECT id FROM test ORDER BY name, id DESC"));
+    auto expected_db = TRY(setup_names_db(DefaultSortMemoryBudget));
+    auto expected_ids = TRY(query_column(expected_db, "SELECT id FROM test ORDER BY name, id DESC"));
+    TRY(expect_equal(ids.size(), expected_ids.size(), "all rows are sorted"));
+    for (size_t s = 0; s < ids.size(); s++) {
+        TRY(expect_equal(TRY(ids[s].to_int()), TRY(expected_ids[s].to_int()), "rows are in the same order as with enough memory"));
+    }
+    return {};
+}
+
+std::map<std::string, TestFunc> get_tests() {
+    return {
+        { "in_memory_sort", in_memory_sort },
+        { "spilled_sort", spilled_sort },
+        { "empty_sort", empty_sort },
+        { "spilled_distinct", spilled_distinct },
+        { "spilled_order_by", spilled_order_by },
+    };
+}
@@ -0,0 +1,256 @@
+#include <tests/setup.hpp>
+
+#include <db/core/Join.hpp>
+#include <db/core/Index.hpp>
+#include <db/core/Table.hpp>
+#include <db/core/TableSetup.hpp>
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <random>
+
+using namespace Db::Core;
+
+static constexpr JoinType JoinTypes[] = { JoinType::Inner, JoinType::Left, JoinType::Right, JoinType::Full };
+
+// Keys repeat a lot and some are NULL, so that there are many-to-many
+// matches and unmatched rows on both sides.
+static std::unique_ptr<MemoryBackedTable> create_table(std::string const& name, size_t size, unsigned seed, bool indexed = false) {
+    std::vector<Column> columns {
+        Column { "key", Value::Type::Int, false, false, false },
+        Column { "string", Value::Type::Varchar, false, false, false },
+    };
+    auto table = std::make_unique<MemoryBackedTable>(nullptr, TableSetup { name, columns });
+
+    std::mt19937 random { seed };
+    std::uniform_int_distribution<int> distribution { 0, static_cast<int>(size / 3) };
+    for (size_t s = 0; s < size; s++) {
+        auto key = distribution(random);
+        auto key_value = key == 0 ? Value::null() : Value::create_int(key);
+        table->raw_rows().push_back(Tuple { key_value, Value::create_varchar(fmt::format("{}-{}", name, s)) });
+    }
+    if (indexed) {
+        table->create_index("key", { 0 }, false).release_value();
+    }
+    return table;
+}
+
+static DbErrorOr<std::vector<std::string>> read_sorted(Relation const& relation) {
+    std::vector<std::string> rows;
+    relation.rows().for_each_row([&](Tuple const& row) {
+        rows.push_back(fmt::format("{}", row));
+    });
+    std::sort(rows.begin(), rows.end());
+    TRY(expect_equal(relation.size(), rows.size(), "size() matches row count"));
+    return rows;
+}
+
+// Result of a nested loop join, for comparison.
+static std::vector<std::string> expected_join(Relation const& lhs, Relation const& rhs, JoinType type) {
+    auto matches = [](Tuple const& lhs_row, Tuple const& rhs_row) {
+        auto lhs_key = join_key(lhs_row.value(0));
+        auto rhs_key = join_key(rhs_row.value(0));
+        return lhs_key && rhs_key && IndexValueEqual {}(*lhs_key, *rhs_key);
+    };
+    Tuple null_row { Value::null(), Value::null() };
+
+    std::vector<std::string> rows;
+    lhs.rows().for_each_row([&](Tuple const& lhs_row) {
+        bool matched = false;
+        rhs.rows().for_each_row([&](Tuple const& rhs_row) {
+            if (matches(lhs_row, rhs_row)) {
+                rows.push_back(fmt::format("{}", Tuple { lhs_row.value(0), lhs_row.value(1), rhs_row.value(0), rhs_row.value(1) }));
+                matched = true;
+            }
+        });
+        if (!matched && (type == JoinType::Left || type == JoinType::Full)) {
+            rows.push_back(fmt::format("{}", Tuple { lhs_row.value(0), lhs_row.value(1), Value::null(), Value::null() }));
+        }
+    });
+    rhs.rows().for_each_row([&](Tuple const& rhs_row) {
+        bool matched = false;
+        lhs.rows().for_each_row([&](Tuple const& lhs_row) {
+            matched |= matches(lhs_row, rhs_row);
+        });
+        if (!matched && (type == JoinType::Right || type == JoinType::Full)) {
+            rows.push_back(fmt::format("{}", Tuple { Value::null(), Value::null(), rhs_row.value(0), rhs_row.value(1) }));
+        }
+    });
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+// Compares joins created by `join` of tables of given sizes with a nested
+// loop join, for all join types for which `join` returns a relation.
+template<class Join>
+static DbErrorOr<void> check_join(size_t lhs_size, size_t rhs_size, Join&& join) {
+    for (auto type : JoinTypes) {
+        auto expected = expected_join(*create_table("lhs", lhs_size, 1), *create_table("rhs", rhs_size, 2), type);
+        auto relation = TRY(join(create_table("lhs", lhs_size, 1, true), create_table("rhs", rhs_size, 2, true), type));
+        if (!relation) {
+            continue;
+        }
+        auto actual = TRY(read_sorted(*relation));
+        TRY(expect_equal(expected.size(), actual.size(), fmt::format("row count for {}", join_type_to_string(type))));
+        TRY(expect(expected == actual, fmt::format("rows for {}", join_type_to_string(type))));
+    }
+    return {};
+}
+
+static DbErrorOr<void> check_hash_join(size_t lhs_size, size_t rhs_size, size_t memory_budget) {
+    return check_join(lhs_size, rhs_size, [&](auto lhs, auto rhs, JoinType type) {
+        return hash_join({ std::move(lhs), 0 }, { std::move(rhs), 0 }, type, memory_budget);
+    });
+}
+
+DbErrorOr<void> in_memory_join() {
+    TRY(check_hash_join(100, 50, DefaultHashJoinMemoryBudget));
+    TRY(check_hash_join(50, 100, DefaultHashJoinMemoryBudget));
+    TRY(check_hash_join(0, 10, DefaultHashJoinMemoryBudget));
+    TRY(check_hash_join(10, 0, DefaultHashJoinMemoryBudget));
+    return {};
+}
+
+DbErrorOr<void> spilled_join() {
+    // Everything is partitioned to disk as soon as a single row is read.
+    TRY(check_hash_join(300, 200, 1));
+    TRY(check_hash_join(200, 300, 1));
+    // Some rows are read to memory first.
+    TRY(check_hash_join(3000, 2000, 16 * 1024));
+    return {};
+}
+
+DbErrorOr<void> sorted_join() {
+    auto merge = [](auto lhs, auto rhs, JoinType type) {
+        return merge_join({ std::move(lhs), 0 }, { std::move(rhs), 0 }, type);
+    };
+    TRY(check_join(100, 50, merge));
+    TRY(check_join(50, 100, merge));
+    TRY(check_join(0, 10, merge));
+    TRY(check_join(10, 0, merge));
+    return {};
+}
+
+DbErrorOr<void> indexed_join() {
+    for (bool inner_is_lhs : { false, true }) {
+        auto index_nested_loop = [&](auto lhs, auto rhs, JoinType type) -> DbErrorOr<std::unique_ptr<Relation>> {
+            bool preserve_inner = inner_is_lhs ? type == JoinType::Left || type == JoinType::Full : type == JoinType::Right || type == JoinType::Full;
+            if (preserve_inner) {
+                return nullptr;
+            }
+            return index_nested_loop_join({ std::move(lhs), 0 }, { std::move(rhs), 0 }, type, inner_is_lhs);
+        };
+        TRY(check_join(100, 50, index_nested_loop));
+        TRY(check_join(50, 100, index_nested_loop));
+        TRY(check_join(0, 10, index_nested_loop));
+        TRY(check_join(10, 0, index_nested_loop));
+    }
+    return {};
+}
+
+// Relation which rows end with an error after `row_count` rows, like
+// ones of a join which spill file can't be read.
+class FailingRelation : public Relation {
+public:
+    FailingRelation(std::unique_ptr<Relation> relation, size_t row_count)
+        : m_relation(std::move(relation))
+        , m_row_count(row_count) { }
+
+    virtual std::vector<Column> const& columns() const override { return m_relation->columns(); }
+    virtual MutableRelationIterator writable_rows() override { ESSA_UNREACHABLE; }
+    virtual size_t size() const override { return m_relation->size(); }
+    virtual DbErrorOr<void> read_error() const override {
+        if (m_failed) {
+            return DbError { "Reading failed" };
+        }
+        return {};
+    }
+
+    virtual RelationIterator rows() const override {
+        class Impl : public RelationIteratorImpl {
+        public:
+            Impl(FailingRelation const& relation)
+                : m_relation(relation)
+                , m_rows(relation.m_relation->rows()) { }
+
+            virtual std::unique_ptr<RowReference> next() override {
+                if (m_read == m_relation.m_row_count) {
+                    m_relation.m_failed = true;
+                    return {};
+                }
+                m_read++;
+                return m_rows.next();
+            }
+
+        private:
+            FailingRelation const& m_relation;
+            RelationIterator m_rows;
+            size_t m_read = 0;
+        };
+        return RelationIterator { std::make_unique<Impl>(*this) };
+    }
+
+private:
+    std::unique_ptr<Relation> m_relation;
+    size_t m_row_count;
+    mutable bool m_failed = false;
+};
+
+// The error must be returned when the join is created or after reading
+// its rows, instead of the rows being just incomplete.
+static DbErrorOr<void> expect_read_error(DbErrorOr<std::unique_ptr<Relation>> join, std::string const& message) {
+    if (join.is_error()) {
+        return {};
+    }
+    join.value()->rows().for_each_row([](Tuple const&) { });
+    return expect(join.value()->read_error().is_error(), message);
+}
+
+DbErrorOr<void> failed_read_is_reported() {
+    auto failing = [] { return std::make_unique<FailingRelation>(create_table("lhs", 300, 1), 100); };
+    for (size_t memory_budget : { DefaultHashJoinMemoryBudget, size_t { 1 } }) {
+        for (bool build_lhs : { false, true }) {
+            auto join = hash_join({ failing(), 0 }, { create_table("rhs", 200, 2), 0 }, JoinType::Full, memory_budget, build_lhs);
+            TRY(expect_read_error(std::move(join), fmt::format("error of hash join, budget {}, build lhs {}", memory_budget, build_lhs)));
+        }
+    }
+    TRY(expect_read_error(index_nested_loop_join({ failing(), 0 }, { create_table("rhs", 200, 2, true), 0 }, JoinType::Left, false),
+        "error of index nested loop join"));
+
+    // Error of a nested join is reported by the outer one.
+    auto nested = TRY(hash_join({ failing(), 0 }, { create_table("rhs", 200, 2), 0 }, JoinType::Left, DefaultHashJoinMemoryBudget, false));
+    TRY(expect_read_error(hash_join({ std::move(nested), 0 }, { create_table("other", 200, 3), 0 }, JoinType::Inner, DefaultHashJoinMemoryBudget, false),
+        "error of nested join"));
+    return {};
+}
+
+DbErrorOr<void> join_plan() {
+    auto plan = [](size_t lhs_size, size_t rhs_size, bool lhs_indexed, bool rhs_indexed, JoinType type) {
+        return plan_join({ create_table("lhs", lhs_size, 1, lhs_indexed), 0 }, { create_table("rhs", rhs_size, 2, rhs_indexed), 0 }, type);
+    };
+
+    auto hash = plan(100, 1000, false, false, JoinType::Inner);
+    TRY(expect(hash.algorithm == JoinAlgorithm::Hash && hash.inner_is_lhs, "hash table of smaller side"));
+
+    auto index = plan(10, 1000, false, true, JoinType::Left);
+    TRY(expect(index.algorithm == JoinAlgorithm::IndexNestedLoop && !index.inner_is_lhs, "index of large side"));
+
+    // Rows of the indexed side must be output even if they don't match.
+    auto preserved = plan(10, 1000, false, true, JoinType::Right);
+    TRY(expect(preserved.algorithm == JoinAlgorithm::Hash, "no index of preserved side"));
+
+    auto merge = plan(1000, 1000, true, true, JoinType::Full);
+    TRY(expect(merge.algorithm == JoinAlgorithm::Merge, "merge of indexed sides"));
+    return {};
+}
+
+std::map<std::string, TestFunc> get_tests() {
+    return {
+        { "in_memory_join", in_memory_join },
+        { "spilled_join", spilled_join },
+        { "sorted_join", sorted_join },
+        { "indexed_join", indexed_join },
+        { "failed_read_is_reported", failed_read_is_reported },
+        { "join_plan", join_plan },
+    };
+}
@@ -0,0 +1,142 @@
+#include <tests/setup.hpp>
+
+#include <db/core/Kernels.hpp>
+
+#include <cmath>
+#include <random>
+#include <string>
+
+using namespace Db::Core;
+
+// Sizes around bitmap word and SIMD block boundaries.
+static constexpr size_t Sizes[] = { 0, 1, 7, 63, 64, 65, 200, 1024 };
+
+static std::vector<int> random_ints(size_t size) {
+    std::mt19937 random { static_cast<unsigned>(size) };
+    std::uniform_int_distribution<int> distribution { -50, 50 };
+    std::vector<int> values(size);
+    for (auto& value : values) {
+        value = distribution(random);
+    }
+    if (size > 3) {
+        values[1] = std::numeric_limits<int>::min();
+        values[2] = std::numeric_limits<int>::max();
+    }
+    return values;
+}
+
+static std::vector<float> random_floats(size_t size, bool with_nan) {
+    std::mt19937 random { static_cast<unsigned>(size) };
+    std::uniform_real_distribution<float> distribution { -50, 50 };
+    std::vector<float> values(size);
+    for (auto& value : values) {
+        value = std::round(distribution(random));
+    }
+    if (with_nan && size > 3) {
+        values[3] = NAN;
+    }
+    return values;
+}
+
+static std::vector<uint64_t> random_mask(size_t size) {
+    std::mt19937_64 random { size };
+    std::vector<uint64_t> mask(Kernels::bitmap_words(size));
+    for (auto& word : mask) {
+        word = random();
+    }
+    if (!mask.empty()) {
+        mask[0] = ~uint64_t { 0 };
+    }
+    return mask;
+}
+
+static constexpr Kernels::Comparison Comparisons[] = {
+    Kernels::Comparison::Equal,
+    Kernels::Comparison::NotEqual,
+    Kernels::Comparison::Less,
+    Kernels::Comparison::LessEqual,
+    Kernels::Comparison::Greater,
+    Kernels::Comparison::GreaterEqual,
+};
+
+DbErrorOr<void> compare_matches_scalar() {
+    auto const& scalar = Kernels::scalar();
+    for (auto implementation : Kernels::implementations()) {
+        for (auto size : Sizes) {
+            auto ints = random_ints(size);
+            auto floats = random_floats(size, true);
+            for (auto comparison : Comparisons) {
+                auto message = std::string { implementation->name } + " size=" + std::to_string(size) + " comparison=" + std::to_string(static_cast<int>(comparison));
+
+                std::vector<uint64_t> expected(Kernels::bitmap_words(size));
+                std::vector<uint64_t> actual(Kernels::bitmap_words(size));
+                scalar.compare_ints(ints, comparison, 10, expected);
+                implementation->compare_ints(ints, comparison, 10, actual);
+                TRY(expect(expected == actual, "ints " + message));
+
+                scalar.compare_floats(floats, comparison, 10, expected);
+                implementation->compare_floats(floats, comparison, 10, actual);
+                TRY(expect(expected == actual, "floats " + message));
+            }
+        }
+    }
+    return {};
+}
+
+DbErrorOr<void> between_matches_scalar() {
+    auto const& scalar = Kernels::scalar();
+    for (auto implementation : Kernels::implementations()) {
+        for (auto size : Sizes) {
+            auto message = std::string { implementation->name } + " size=" + std::to_string(size);
+            auto ints = random_ints(size);
+            auto floats = random_floats(size, true);
+
+            std::vector<uint64_t> expected(Kernels::bitmap_words(size));
+            std::vector<uint64_t> actual(Kernels::bitmap_words(size));
+            scalar.between_ints(ints, -10, 20, expected);
+            implementation->between_ints(ints, -10, 20, actual);
+            TRY(expect(expected == actual, "ints " + message));
+
+            scalar.between_floats(floats, -10, 20, expected);
+            implementation->between_floats(floats, -10, 20, actual);
+            TRY(expect(expected == actual, "floats " + message));
+        }
+    }
+    return {};
+}
+
+DbErrorOr<void> aggregate_matches_scalar() {
+    auto const& scalar = Kernels::scalar();
+    for (auto implementation : Kernels::implementations()) {
+        for (auto size : Sizes) {
+            auto message = std::string { implementation->name } + " size=" + std::to_string(size);
+            auto ints = random_ints(size);
+            auto floats = random_floats(size, false);
+            auto mask = random_mask(size);
+
+            auto expected_ints = scalar.aggregate_ints(ints, mask);
+            auto actual_ints = implementation->aggregate_ints(ints, mask);
+            TRY(expect_equal(expected_ints.sum, actual_ints.sum, "int sum " + message));
+            TRY(expect_equal(expected_ints.min, actual_ints.min, "int min " + message));
+            TRY(expect_equal(expected_ints.max, actual_ints.max, "int max " + message));
+            TRY(expect_equal(expected_ints.count, actual_ints.count, "int count " + message));
+
+            // Values are whole numbers, so sums are exact regardless of order.
+            auto expected_floats = scalar.aggregate_floats(floats, mask);
+            auto actual_floats = implementation->aggregate_floats(floats, mask);
+            TRY(expect_equal(expected_floats.sum, actual_floats.sum, "float sum " + message));
+            TRY(expect_equal(expected_floats.min, actual_floats.min, "float min " + message));
+            TRY(expect_equal(expected_floats.max, actual_floats.max, "float max " + message));
+            TRY(expect_equal(expected_floats.count, actual_floats.count, "float count " + message));
+        }
+    }
+    return {};
+}
+
+std::map<std::string, TestFunc> get_tests() {
+    return {
+        { "compare_matches_scalar", compare_matches_scalar },
+        { "between_matches_scalar", between_matches_scalar },
+        { "aggregate_matches_scalar", aggregate_matches_scalar },
+    };
+}
@@ -0,0 +1,175 @@
+#include <tests/setup.hpp>
+
+#include <db/core/Database.hpp>
+#include <db/core/ThreadPool.hpp>
+#include <db/sql/Pipeline.hpp>
+#include <db/sql/SQL.hpp>
+
+#include <atomic>
+#include <filesystem>
+#include <fmt/format.h>
+#include <latch>
+
+using namespace Db::Core;
+using namespace Db::Sql::AST;
+
+auto sql_to_db_error(Db::Sql::SQLError&& e) { return DbError { e.message() }; }
+
+static DbErrorOr<Table*> create_table(Database& db, size_t size) {
+    TRY(Db::Sql::run_query(db, "CREATE TABLE test (id INT, string VARCHAR)").map_error(sql_to_db_error));
+    auto table = TRY(db.table("test"));
+    for (size_t s = 0; s < size; s++) {
+        TRY(table->insert_unchecked(Tuple { Value::create_int(static_cast<int>(s)), Value::create_varchar(fmt::format("row{}", s)) }));
+    }
+    return table;
+}
+
+// Checks that morsels together contain all rows in order.
+static DbErrorOr<void> check_morsels(Relation const& relation, size_t rows_per_morsel, size_t expected_morsels) {
+    auto morsels = relation.morsels(rows_per_morsel);
+    TRY(expect_equal(morsels.size(), expected_morsels, "rows are split into morsels"));
+    int expected_id = 0;
+    for (auto& morsel : morsels) {
+        TRY(morsel.try_for_each_row([&](Tuple const& row) -> DbErrorOr<void> {
+            TRY(expect_equal(TRY(row.value(0).to_int()), expected_id, "morsels contain rows in order"));
+            expected_id++;
+            return {};
+        }));
+    }
+    TRY(expect_equal(static_cast<size_t>(expected_id), relation.size(), "morsels contain all rows"));
+    return {};
+}
+
+DbErrorOr<void> thread_pool_tasks() {
+    ThreadPool pool { 4 };
+    std::atomic<size_t> sum = 0;
+    // Every task submits another one from a worker, which may be stolen.
+    std::latch done { 200 };
+    for (size_t s = 0; s < 100; s++) {
+        pool.submit([&, s] {
+            sum += s;
+            pool.submit([&, s] {
+                sum += s;
+                done.count_down();
+            });
+            done.count_down();
+        });
+    }
+    done.wait();
+    TRY(expect_equal(sum.load(), (size_t)(2 * 4950), "all tasks were run"));
+    return {};
+}
+
+DbErrorOr<void> memory_table_morsels() {
+    auto db = Database::create_memory_backed();
+    auto table = TRY(create_table(db, 2500));
+    TRY(check_morsels(*table, 1000, 3));
+    TRY(check_morsels(*table, 2500, 1));
+    return {};
+}
+
+DbErrorOr<void> edb_table_morsels() {
+    auto path = std::filesystem::temp_directory_path() / fmt::format("essadb-parallel-scan-{}", getpid());
+    std::filesystem::remove_all(path);
+    {
+        auto db = TRY(Database::create_or_open_file_backed(path.string()).map_error([](Util::OsError const& error) {
+            return DbError { fmt::format("{}", error) };
+        }));
+        auto table = TRY(create_table(db, 1000));
+
+        auto morsels = table->morsels(300);
+        TRY(expect(morsels.size() > 1, "rows are split into morsels"));
+        TRY(check_morsels(*table, 300, morsels.size()));
+        TRY(check_morsels(*table, 1000, 1));
+    }
+    std::filesystem::remove_all(path);
+    return {};
+}
+
+DbErrorOr<void> parallel_scan_order() {
+    auto db = Database::create_memory_backed();
+    auto table = TRY(create_table(db, 10000));
+    ThreadPool pool { 4 };
+
+    // SELECT string WHERE id < 7500
+    std::vector<SelectColumns::Column> columns;
+    columns.push_back({ .column = std::make_unique<IndexExpression>(0, 1, "string") });
+    SelectColumns select_columns { std::move(columns) };
+    BinaryOperator where { std::make_unique<IndexExpression>(0, 0, "id"), BinaryOperator::Operation::Less, std::make_unique<Literal>(0, Value::create_int(7500)) };
+
+    EvaluationContext context { .db = &db, .frames = {} };
+    context.frames.emplace_back(nullptr, select_columns);
+
+    ParallelScanOperator scan { pool, table->morsels(100), context, &where, true };
+    for (size_t s = 0; s < 7500; s++) {
+        auto row = TRY(scan.next().map_error(sql_to_db_error));
+        TRY(expect(row.has_value(), "all matching rows are returned"));
+        TRY(expect_equal(TRY(row->tuple.value(0).to_string()), fmt::format("row{}", s), "rows are returned in order"));
+    }
+    TRY(expect(!TRY(scan.next().map_error(sql_to_db_error)).has_value(), "no rows after the last one"));
+    TRY(expect(scan.read_any_row(), "rows were read"));
+    return {};
+}
+
+// Large enough to be aggregated in parallel on multi-core machines.
+DbErrorOr<void> parallel_group_by() {
+    auto db = Database::create_memory_backed();
+    TRY(Db::Sql::run_query(db, "CREATE TABLE numbers (id INT, number INT)").map_error(sql_to_db_error));
+    auto table = TRY(db.table("numbers"));
+    size_t const size = 3 * MorselSize;
+    for (size_t s = 0; s < size; s++) {
+        TRY(table->insert_unchecked(Tuple { Value::create_int(static_cast<int>(s % 7)), Value::create_int(static_cast<int>(s)) }));
+    }
+
+    auto result = TRY(TRY(Db::Sql::run_query(db, "SELECT id, COUNT(number), SUM(number) FROM numbers WHERE number > 10 GROUP BY id").map_error(sql_to_db_error)).collect().map_error(sql_to_db_error));
+    auto const& rows = result.as_result_set().rows();
+    TRY(expect_equal(rows.size(), (size_t)7, "all groups are returned"));
+    for (int id = 0; id < 7; id++) {
+        size_t count = 0;
+        double sum = 0;
+        for (size_t s = id; s < size; s += 7) {
+            if (s > 10) {
+                count++;
+                sum += static_cast<double>(s);
+            }
+        }
+        auto const& row = rows[id];
+        TRY(expect_equal(TRY(row.value(0).to_int()), id, "groups are sorted"));
+        TRY(expect_equal(TRY(row.value(1).to_int()), static_cast<int>(count), "rows are counted"));
+        TRY(expect_equal(TRY(row.value(2).to_float()), static_cast<float>(sum), "rows are summed"));
+    }
+    return {};
+}
+
+// Large enough to be scanned in parallel on multi-core machines. Morsels
+// that are read ahead must not see rows removed while the cursor is open.
+DbErrorOr<void> parallel_scan_outlives_write() {
+    auto db = Database::create_memory_backed();
+    size_t const size = 3 * MorselSize;
+    auto table = TRY(create_table(db, size));
+    auto cursor = TRY(Db::Sql::run_query(db, "SELECT id FROM test WHERE id > -1").map_error(sql_to_db_error));
+    auto first_batch = TRY(cursor.next_batch(100).map_error(sql_to_db_error));
+    TRY(expect_equal(first_batch.size(), (size_t)100, "first batch"));
+
+    TRY(Db::Sql::run_query(db, "DELETE FROM test").map_error(sql_to_db_error));
+    TRY(expect_equal(table->size(), (size_t)0, "rows are removed"));
+
+    auto rest = TRY(cursor.collect().map_error(sql_to_db_error));
+    auto const& rows = rest.as_result_set().rows();
+    TRY(expect_equal(rows.size(), size - 100, "rows are read before the write"));
+    for (size_t s = 0; s < rows.size(); s++) {
+        TRY(expect_equal(TRY(rows[s].value(0).to_int()), static_cast<int>(s + 100), "rows are returned in order"));
+    }
+    return {};
+}
+
+std::map<std::string, TestFunc> get_tests() {
+    return {
+        { "thread_pool_tasks", thread_pool_tasks },
+        { "memory_table_morsels", memory_table_morsels },
+        { "edb_table_morsels", edb_table_morsels },
+        { "parallel_scan_order", parallel_scan_order },
+        { "parallel_group_by", parallel_group_by },
+        { "parallel_scan_outlives_write", parallel_scan_outlives_write },
+    };
+}
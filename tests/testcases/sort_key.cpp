@@ -0,0 +1,124 @@
+#include <tests/setup.hpp>
+
+#include <db/core/SortKey.hpp>
+
+#include <fmt/format.h>
+#include <random>
+
+using namespace Db::Core;
+
+// Compares values like ORDER BY does without normalized keys. NULLs are
+// handled separately, because `==` converts them to the type of the other
+// value.
+static bool values_less(std::vector<Value> const& lhs, std::vector<Value> const& rhs, std::vector<bool> const& descending) {
+    for (size_t s = 0; s < lhs.size(); s++) {
+        auto const& a = descending[s] ? rhs[s] : lhs[s];
+        auto const& b = descending[s] ? lhs[s] : rhs[s];
+        if (a.is_null() || b.is_null()) {
+            if (a.is_null() && b.is_null())
+                continue;
+            return a.is_null();
+        }
+        if ((a == b).release_value())
+            continue;
+        return (a < b).release_value();
+    }
+    return false;
+}
+
+static DbErrorOr<void> check_order(std::vector<std::vector<Value>> const& tuples, std::vector<bool> const& descending) {
+    SortKeyEncoder encoder { descending };
+    std::vector<std::string> keys;
+    for (auto const& tuple : tuples) {
+        keys.push_back(encoder.encode(tuple));
+    }
+    for (size_t i = 0; i < tuples.size(); i++) {
+        for (size_t j = 0; j < tuples.size(); j++) {
+            if (values_less(tuples[i], tuples[j], descending) != (keys[i] < keys[j])) {
+                return DbError { fmt::format("Order of tuples {} and {} differs", i, j) };
+            }
+        }
+    }
+    return {};
+}
+
+static Value random_value(std::mt19937& random, Value::Type type) {
+    if (random() % 8 == 0) {
+        return Value::null();
+    }
+    switch (type) {
+    case Value::Type::Int:
+        if (random() % 8 == 0)
+            return Value::create_int(random() % 2 ? std::numeric_limits<int>::min() : std::numeric_limits<int>::max());
+        return Value::create_int(static_cast<int>(random() % 21) - 10);
+    case Value::Type::Float:
+        return Value::create_float(static_cast<float>(static_cast<int>(random() % 41) - 20) / 4);
+    case Value::Type::Varchar: {
+        std::string string;
+        auto length = random() % 4;
+        for (size_t s = 0; s < length; s++) {
+            // Includes zero bytes and bytes above 0x7f.
+            char const chars[] = { 0, 'a', 'b', static_cast<char>(0xff) };
+            string.push_back(chars[random() % 4]);
+        }
+        return Value::create_varchar(string);
+    }
+    case Value::Type::Bool:
+        return Value::create_bool(random() % 2);
+    default:
+        return Value::null();
+    }
+}
+
+DbErrorOr<void> sort_key_single_column() {
+    std::mt19937 random { 1 };
+    for (auto type : { Value::Type::Int, Value::Type::Float, Value::Type::Varchar, Value::Type::Bool }) {
+        for (bool descending : { false, true }) {
+            std::vector<std::vector<Value>> tuples;
+            for (size_t s = 0; s < 50; s++) {
+                tuples.push_back({ random_value(random, type) });
+            }
+            TRY(check_order(tuples, { descending }));
+        }
+    }
+    return {};
+}
+
+DbErrorOr<void> sort_key_multiple_columns() {
+    std::mt19937 random { 2 };
+    std::vector<std::vector<Value>> tuples;
+    for (size_t s = 0; s < 100; s++) {
+        tuples.push_back({ random_value(random, Value::Type::Varchar), random_value(random, Value::Type::Int), random_value(random, Value::Type::Float) });
+    }
+    TRY(check_order(tuples, { false, true, false }));
+    TRY(check_order(tuples, { true, false, true }));
+    return {};
+}
+
+DbErrorOr<void> sort_key_negative_zero() {
+    SortKeyEncoder encoder { { false } };
+    TRY(expect(encoder.encode({ Value::create_float(-0.f) }) == encoder.encode({ Value::create_float(0.f) }), "-0 and 0 have equal keys"));
+    return {};
+}
+
+DbErrorOr<void> sort_key_mixed_types() {
+    SortKeyEncoder encoder { { false } };
+    auto null = encoder.encode({ Value::null() });
+    auto int_1 = encoder.encode({ Value::create_int(1) });
+    auto float_1_5 = encoder.encode({ Value::create_float(1.5) });
+    auto int_2 = encoder.encode({ Value::create_int(2) });
+    auto varchar = encoder.encode({ Value::create_varchar("0") });
+    TRY(expect(null < int_1 && int_1 < float_1_5 && float_1_5 < int_2, "numbers are compared numerically"));
+    TRY(expect(encoder.encode({ Value::create_float(2) }) == int_2, "equal INT and FLOAT have equal keys"));
+    TRY(expect(int_2 < varchar, "values of different types are ordered by type"));
+    return {};
+}
+
+std::map<std::string, TestFunc> get_tests() {
+    return {
+        { "sort_key_single_column", sort_key_single_column },
+        { "sort_key_multiple_columns", sort_key_multiple_columns },
+        { "sort_key_negative_zero", sort_key_negative_zero },
+        { "sort_key_mixed_types", sort_key_mixed_types },
+    };
+}
@@ -44,7 +44,11 @@ Db::Sql::SQLErrorOr<Db::Core::ValueOrResultSet> run_query(Db::Core::Database& db
             Db::Sql::display_error(error, tokens[error.token()].start, tokens[error.token()].end, sql_statement.statement);
         return error;
     }
-    auto result = statement.release_value()->execute(db);
+    // Rows are read through a cursor, like by clients.
+    auto result = [&]() -> Db::Sql::SQLErrorOr<Db::Core::ValueOrResultSet> {
+        auto cursor = TRY(Db::Sql::Cursor::open(db, statement.release_value()));
+        return cursor.collect();
+    }();
     if (result.is_error()) {
         auto error = result.release_error();
         if (sql_statement.display)